@@ -5,6 +5,12 @@
 CFLAGS="-Wall -Wextra -g -O2"
 LDFLAGS="-lm"
 
+# Hosted builds can run nested in X11 (see core/graphics/x11_present.h)
+if pkg-config --exists x11 xext xrender 2>/dev/null; then
+    CFLAGS="$CFLAGS -DAMOS_X11"
+    LDFLAGS="$LDFLAGS $(pkg-config --libs x11 xext xrender)"
+fi
+
 # Create build directory structure
 mkdir -p build
 mkdir -p build/core
@@ -13,12 +19,14 @@ mkdir -p build/core/3d
 mkdir -p build/desktop
 mkdir -p build/desktop/integration
 mkdir -p build/kernel
+mkdir -p build/demos
+mkdir -p bin
 
 echo "Building AMOS Desktop OS..."
 
 # First, build the native rendering system
 echo "Building native rendering system..."
-./build_native.sh
+bash ./build_native.sh || exit 1
 
 # Compile kernel files
 echo "Compiling kernel..."
@@ -27,10 +35,24 @@ gcc $CFLAGS -c kernel/kernel.c -o build/kernel/kernel.o
 # Compile desktop integration files
 echo "Compiling desktop integration..."
 gcc $CFLAGS -c desktop/integration/desktop_init.c -o build/desktop/integration/desktop_init.o
+gcc $CFLAGS -c desktop/integration/event_channel.c -o build/desktop/integration/event_channel.o
+gcc $CFLAGS -c desktop/integration/input_trace.c -o build/desktop/integration/input_trace.o
+
+# Build the event channel benchmark
+echo "Building demos/event_channel_bench..."
+gcc $CFLAGS demos/event_channel_bench.c build/desktop/integration/event_channel.o -lpthread -o build/demos/event_channel_bench
+
+# Build the input replay benchmark against the real desktop
+echo "Building demos/input_replay_bench..."
+gcc $CFLAGS demos/input_replay_bench.c build/desktop/integration/desktop_init.o \
+    build/desktop/integration/event_channel.o build/desktop/integration/input_trace.o \
+    build/libamos_renderer.a $LDFLAGS -o build/demos/input_replay_bench
 
 # Link everything into the final executable
 echo "Linking AMOS Desktop OS..."
-gcc -o bin/amos-desktop build/kernel/kernel.o build/desktop/integration/desktop_init.o build/libamos_renderer.a $LDFLAGS
+gcc -o bin/amos-desktop build/kernel/kernel.o build/desktop/integration/desktop_init.o \
+    build/desktop/integration/event_channel.o build/desktop/integration/input_trace.o \
+    build/libamos_renderer.a $LDFLAGS
 
 # Check if build was successful
 if [ $? -eq 0 ]; then
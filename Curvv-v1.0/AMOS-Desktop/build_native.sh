@@ -1,13 +1,14 @@
 #!/bin/bash
 # AMOS Desktop OS - Native Renderer Build Script
 
+set -e
+
 # Create output directories
 mkdir -p build/core/graphics
 mkdir -p build/core/3d
 
 # Set compiler flags
 CFLAGS="-Wall -Wextra -g -O2 -I."
-ASFLAGS="-f elf32"
 LDFLAGS="-lm"
 
 echo "Building AMOS Desktop OS Native Rendering System..."
@@ -20,20 +21,121 @@ gcc $CFLAGS -c core/graphics/framebuffer.c -o build/core/graphics/framebuffer.o
 echo "  Compiling core/graphics/window.c..."
 gcc $CFLAGS -c core/graphics/window.c -o build/core/graphics/window.o
 
+# Compile damage tracking
+echo "  Compiling core/graphics/damage.c..."
+gcc $CFLAGS -c core/graphics/damage.c -o build/core/graphics/damage.o
+
+# Compile text rendering
+echo "  Compiling core/graphics/text.c..."
+gcc $CFLAGS -c core/graphics/text.c -o build/core/graphics/text.o
+
+# Compile software cursor
+echo "  Compiling core/graphics/cursor.c..."
+gcc $CFLAGS -c core/graphics/cursor.c -o build/core/graphics/cursor.o
+
+# Compile frame scheduler
+echo "  Compiling core/graphics/frame_scheduler.c..."
+gcc $CFLAGS -c core/graphics/frame_scheduler.c -o build/core/graphics/frame_scheduler.o
+
+# Compile frame statistics
+echo "  Compiling core/graphics/frame_stats.c..."
+gcc $CFLAGS -c core/graphics/frame_stats.c -o build/core/graphics/frame_stats.o
+
+# Compile X11 presentation when the X libraries are available; the
+# desktop itself is built with -DAMOS_X11 by build.sh
+X11_OBJS=""
+X11_LIBS=""
+if pkg-config --exists x11 xext xrender 2>/dev/null; then
+    echo "  Compiling core/graphics/x11_present.c..."
+    gcc $CFLAGS $(pkg-config --cflags x11 xext xrender) -c core/graphics/x11_present.c -o build/core/graphics/x11_present.o
+    X11_OBJS="build/core/graphics/x11_present.o"
+    X11_LIBS=$(pkg-config --libs x11 xext xrender)
+else
+    echo "  x11, xext or xrender not found; skipping X11 presentation"
+fi
+
 # Compile 3D renderer
 echo "  Compiling core/3d/renderer3d.c..."
 gcc $CFLAGS -c core/3d/renderer3d.c -o build/core/3d/renderer3d.o
 
-# Assemble 3D renderer assembly optimizations
-echo "  Assembling core/3d/renderer3d_asm.s..."
-nasm $ASFLAGS core/3d/renderer3d_asm.s -o build/core/3d/renderer3d_asm.o
+# Compile 3D math
+echo "  Compiling core/3d/math3d.c..."
+gcc $CFLAGS -c core/3d/math3d.c -o build/core/3d/math3d.o
+
+# Compile shader programs
+echo "  Compiling core/3d/shaders.c..."
+gcc $CFLAGS -c core/3d/shaders.c -o build/core/3d/shaders.o
+
+# Compile mesh file format
+echo "  Compiling core/3d/mesh_format.c..."
+gcc $CFLAGS -c core/3d/mesh_format.c -o build/core/3d/mesh_format.o
+
+# Compile mesh LOD generation
+echo "  Compiling core/3d/mesh_lod.c..."
+gcc $CFLAGS -c core/3d/mesh_lod.c -o build/core/3d/mesh_lod.o
+
+# Compile tiled light culling
+echo "  Compiling core/3d/light_culling.c..."
+gcc $CFLAGS -c core/3d/light_culling.c -o build/core/3d/light_culling.o
+
+# Compile specialized raster pipelines
+echo "  Compiling core/3d/pipeline.c..."
+gcc $CFLAGS -c core/3d/pipeline.c -o build/core/3d/pipeline.o
+
+# Compile shader language
+echo "  Compiling core/3d/shader_dsl.c..."
+gcc $CFLAGS -c core/3d/shader_dsl.c -o build/core/3d/shader_dsl.o
+
+# Compile 3D window views
+echo "  Compiling core/3d/window3d.c..."
+gcc $CFLAGS -c core/3d/window3d.c -o build/core/3d/window3d.o
+
+echo "  Compiling core/3d/texture.c..."
+gcc $CFLAGS -c core/3d/texture.c -o build/core/3d/texture.o
+
+echo "  Compiling core/3d/compositor3d.c..."
+gcc $CFLAGS -c core/3d/compositor3d.c -o build/core/3d/compositor3d.o
 
 # Link everything into a static library
 echo "  Creating libamos_renderer.a..."
 ar rcs build/libamos_renderer.a \
     build/core/graphics/framebuffer.o \
     build/core/graphics/window.o \
+    build/core/graphics/damage.o \
+    build/core/graphics/text.o \
+    build/core/graphics/cursor.o \
+    build/core/graphics/frame_scheduler.o \
+    build/core/graphics/frame_stats.o \
+    $X11_OBJS \
     build/core/3d/renderer3d.o \
-    build/core/3d/renderer3d_asm.o
+    build/core/3d/math3d.o \
+    build/core/3d/shaders.o \
+    build/core/3d/mesh_format.o \
+    build/core/3d/mesh_lod.o \
+    build/core/3d/light_culling.o \
+    build/core/3d/pipeline.o \
+    build/core/3d/shader_dsl.o \
+    build/core/3d/window3d.o \
+    build/core/3d/texture.o \
+    build/core/3d/compositor3d.o
+
+# Build mesh tools
+mkdir -p build/tools
+echo "  Building tools/obj2amesh..."
+gcc $CFLAGS tools/obj2amesh.c build/libamos_renderer.a $LDFLAGS -o build/tools/obj2amesh
+
+# Build the renderer benchmarks and demos (run from this directory;
+# renderer_bench compares against demos/golden)
+mkdir -p build/demos
+for demo in renderer_bench compositor3d_bench mesh_load_bench light_culling_bench view_present_bench text_bench cursor_bench frame_scheduler_bench frame_stats_bench shader_demo; do
+    echo "  Building demos/$demo..."
+    gcc $CFLAGS demos/$demo.c build/libamos_renderer.a $LDFLAGS -o build/demos/$demo
+done
+
+# Build the X11 presentation benchmark (run it with scripts/x11_present_xvfb.sh)
+if [ -n "$X11_OBJS" ]; then
+    echo "  Building demos/x11_present_bench..."
+    gcc $CFLAGS demos/x11_present_bench.c build/libamos_renderer.a $X11_LIBS $LDFLAGS -o build/demos/x11_present_bench
+fi
 
 echo "Build complete. Library available at build/libamos_renderer.a"
\ No newline at end of file
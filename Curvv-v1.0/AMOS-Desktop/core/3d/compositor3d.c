@@ -0,0 +1,343 @@
+/**
+ * AMOS Desktop OS - 3D Compositor Implementation
+ *
+ * This file implements the 3D compositor. The camera is placed so the
+ * z = 0 plane maps one unit to one screen pixel, which makes the flat
+ * layout pixel-exact; effects then move, scale and turn each window's
+ * quad away from that layout. Windows are drawn front to back so
+ * covered pixels fail the depth test before they are textured. While
+ * no effect is applied the windows are copied row by row instead,
+ * since the quads would only reproduce their pixels.
+ */
+
+#include "compositor3d.h"
+#include "pipeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define COMPOSITOR_FOV 60.0f
+#define COMPOSITOR_PI 3.14159265f
+
+// Height of the tab strip above tabbed window content (see amos_window_get_tab_area_rect)
+#define COMPOSITOR_TAB_HEIGHT 25
+
+// Where one window's quad ends up
+typedef struct {
+    float cx, cy, cz;       // Centre
+    float sx, sy;           // Size
+    float yaw;              // Rotation about the vertical axis
+} placement_t;
+
+// A window to draw and the content it shows
+typedef struct {
+    amos_framebuffer_t* content;
+    amos_rect_t rect;       // Client rect in screen coordinates
+} visible_window_t;
+
+// Initialize the compositor
+bool amos_compositor3d_init(amos_compositor3d_t* compositor, amos_renderer3d_t* renderer) {
+    if (!compositor || !renderer) {
+        return false;
+    }
+
+    memset(compositor, 0, sizeof(*compositor));
+    compositor->renderer = renderer;
+    compositor->effect = AMOS_COMPOSITOR3D_FLAT;
+
+    // Unit quad facing +z, counter-clockwise, v = 0 along the top edge
+    static const float corners[4][4] = {
+        {-0.5f, 0.5f, 0.0f, 0.0f},
+        {0.5f, 0.5f, 1.0f, 0.0f},
+        {0.5f, -0.5f, 1.0f, 1.0f},
+        {-0.5f, -0.5f, 0.0f, 1.0f}
+    };
+    for (int i = 0; i < 4; i++) {
+        amos_vertex_t* v = &compositor->quad_vertices[i];
+        v->position = (amos_vec3_t){corners[i][0], corners[i][1], 0.0f};
+        v->normal = (amos_vec3_t){0.0f, 0.0f, 1.0f};
+        v->texcoord = (amos_vec2_t){corners[i][2], corners[i][3]};
+        v->color = (amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f};
+    }
+    static const uint32_t indices[6] = {0, 3, 2, 0, 2, 1};
+    memcpy(compositor->quad_indices, indices, sizeof(indices));
+
+    compositor->quad.vertices = compositor->quad_vertices;
+    compositor->quad.indices = compositor->quad_indices;
+    compositor->quad.vertex_count = 4;
+    compositor->quad.index_count = 6;
+
+    // Unlit: the flat colour is the ambient term, modulated by the texture
+    for (int i = 0; i < AMOS_MAX_WINDOWS; i++) {
+        amos_material_t* m = &compositor->materials[i];
+        m->ambient = (amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f};
+        m->diffuse = (amos_vec4_t){0.0f, 0.0f, 0.0f, 1.0f};
+        m->specular = (amos_vec4_t){0.0f, 0.0f, 0.0f, 1.0f};
+        m->shininess = 1.0f;
+        m->diffuse_texture = NULL;
+        m->shader = NULL;
+        m->shading_model = AMOS_SHADING_FLAT;
+    }
+
+    return true;
+}
+
+// Release the compositor's depth buffer
+void amos_compositor3d_cleanup(amos_compositor3d_t* compositor) {
+    if (!compositor) {
+        return;
+    }
+
+    free(compositor->depth_buffer);
+    compositor->depth_buffer = NULL;
+    compositor->depth_capacity = 0;
+}
+
+// Select the effect and how far it has progressed
+void amos_compositor3d_set_effect(
+    amos_compositor3d_t* compositor,
+    amos_compositor3d_effect_t effect,
+    float progress
+) {
+    if (!compositor) {
+        return;
+    }
+
+    compositor->effect = effect;
+    compositor->progress = progress < 0.0f ? 0.0f : (progress > 1.0f ? 1.0f : progress);
+}
+
+// Collect the windows that would be visible on a plain desktop, bottom to top
+static int collect_windows(const amos_window_system_t* system, visible_window_t* out) {
+    int count = 0;
+    for (int i = 0; i < system->window_count; i++) {
+        amos_window_t* window = system->windows[i];
+        if (window->flags & (AMOS_WINDOW_FLAG_HIDDEN | AMOS_WINDOW_FLAG_MINIMIZED | AMOS_WINDOW_FLAG_TABBED)) {
+            continue;
+        }
+
+        amos_framebuffer_t* content = window->framebuffer;
+        amos_rect_t rect;
+        amos_window_get_client_rect(window, &rect);
+
+        if ((window->flags & AMOS_WINDOW_FLAG_TABBABLE) && window->tab_count > 0) {
+            amos_window_t* tab = amos_window_get_active_tab(window);
+            if (tab && tab->framebuffer && tab->framebuffer->initialized) {
+                content = tab->framebuffer;
+                rect.y += COMPOSITOR_TAB_HEIGHT;
+                rect.height -= COMPOSITOR_TAB_HEIGHT;
+            }
+        }
+
+        if (!content || !content->initialized || content->bytes_per_pixel != 4) {
+            continue;
+        }
+
+        // The quad shows the whole framebuffer, as the 2D blit does
+        rect.width = content->width;
+        rect.height = content->height;
+        out[count++] = (visible_window_t){content, rect};
+    }
+    return count;
+}
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+static float smoothstep(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// Blend one placement towards another
+static void blend(placement_t* p, const placement_t* target, float t) {
+    p->cx = lerp(p->cx, target->cx, t);
+    p->cy = lerp(p->cy, target->cy, t);
+    p->cz = lerp(p->cz, target->cz, t);
+    p->sx = lerp(p->sx, target->sx, t);
+    p->sy = lerp(p->sy, target->sy, t);
+    p->yaw = lerp(p->yaw, target->yaw, t);
+}
+
+// Place window k of n for the current effect
+static void place_window(
+    const amos_compositor3d_t* compositor,
+    const visible_window_t* window,
+    int k,
+    int n,
+    float screen_w,
+    float screen_h,
+    float distance,
+    placement_t* p
+) {
+    const amos_rect_t* r = &window->rect;
+    float t = smoothstep(compositor->progress);
+
+    // Plain desktop: stacked by depth, scaled so the projection stays pixel-exact
+    float cz = (float)k;
+    float perspective = (distance - cz) / distance;
+    p->cx = ((float)r->x + r->width * 0.5f - screen_w * 0.5f) * perspective;
+    p->cy = (screen_h * 0.5f - ((float)r->y + r->height * 0.5f)) * perspective;
+    p->cz = cz;
+    p->sx = (float)r->width * perspective;
+    p->sy = (float)r->height * perspective;
+    p->yaw = 0.0f;
+
+    switch (compositor->effect) {
+        case AMOS_COMPOSITOR3D_EXPOSE: {
+            int cols = (int)ceilf(sqrtf((float)n));
+            int rows = (n + cols - 1) / cols;
+            float cell_w = screen_w / cols;
+            float cell_h = screen_h / rows;
+            float scale = fminf(fminf(cell_w * 0.9f / r->width, cell_h * 0.9f / r->height), 1.0f);
+            placement_t grid = {
+                (k % cols + 0.5f) * cell_w - screen_w * 0.5f,
+                screen_h * 0.5f - (k / cols + 0.5f) * cell_h,
+                0.0f,
+                r->width * scale,
+                r->height * scale,
+                0.0f
+            };
+            blend(p, &grid, t);
+            break;
+        }
+
+        case AMOS_COMPOSITOR3D_FLIP: {
+            // Topmost window in front, the rest receding up and to the left
+            float depth = (float)(n - 1 - k);
+            float scale = fminf(fminf(screen_w * 0.55f / r->width, screen_h * 0.55f / r->height), 1.0f);
+            placement_t stack = {
+                screen_w * 0.1f - depth * screen_w * 0.06f,
+                depth * screen_h * 0.04f,
+                -depth * screen_w * 0.04f,
+                r->width * scale,
+                r->height * scale,
+                30.0f * COMPOSITOR_PI / 180.0f
+            };
+            blend(p, &stack, t);
+            break;
+        }
+
+        case AMOS_COMPOSITOR3D_CUBE: {
+            // Turn the desktop plane about the cube centre, backing away mid-turn
+            float angle = t * COMPOSITOR_PI * 0.5f;
+            float c = cosf(angle), s = sinf(angle);
+            float half = screen_w * 0.5f;
+            float x = p->cx, z = p->cz + half;
+            p->cx = x * c + z * s;
+            p->cz = -x * s + z * c - half - sinf(t * COMPOSITOR_PI) * screen_w * 0.25f;
+            p->yaw = angle;
+            break;
+        }
+
+        case AMOS_COMPOSITOR3D_FLAT:
+        default:
+            break;
+    }
+}
+
+// Model matrix: translate(c) * rotate_y(yaw) * scale(sx, sy, 1)
+static void placement_matrix(const placement_t* p, amos_mat4_t* m) {
+    float c = cosf(p->yaw), s = sinf(p->yaw);
+    amos_mat4_identity(m);
+    m->m[0][0] = c * p->sx;  m->m[0][2] = s;  m->m[0][3] = p->cx;
+    m->m[1][1] = p->sy;                       m->m[1][3] = p->cy;
+    m->m[2][0] = -s * p->sx; m->m[2][2] = c;  m->m[2][3] = p->cz;
+}
+
+// Copy a window's content to its screen position, clipped to the target
+static void blit_window(const visible_window_t* window, amos_framebuffer_t* target) {
+    const amos_rect_t* r = &window->rect;
+    int x0 = r->x < 0 ? 0 : r->x;
+    int y0 = r->y < 0 ? 0 : r->y;
+    int x1 = r->x + r->width > target->width ? target->width : r->x + r->width;
+    int y1 = r->y + r->height > target->height ? target->height : r->y + r->height;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    const amos_framebuffer_t* content = window->content;
+    for (int y = y0; y < y1; y++) {
+        const uint8_t* src = content->buffer + (size_t)(y - r->y) * content->pitch + (size_t)(x0 - r->x) * 4;
+        uint8_t* dst = target->buffer + (size_t)y * target->pitch + (size_t)x0 * 4;
+        memcpy(dst, src, (size_t)(x1 - x0) * 4);
+    }
+}
+
+// Draw every visible window into a target framebuffer
+bool amos_compositor3d_draw(
+    amos_compositor3d_t* compositor,
+    const amos_window_system_t* system,
+    amos_framebuffer_t* target,
+    amos_color_t background
+) {
+    if (!compositor || !system || !target || !target->initialized || target->bytes_per_pixel != 4) {
+        return false;
+    }
+
+    visible_window_t windows[AMOS_MAX_WINDOWS];
+    int count = collect_windows(system, windows);
+
+    // Plain desktop layout: every effect starts from it at progress 0
+    if (compositor->effect == AMOS_COMPOSITOR3D_FLAT || compositor->progress == 0.0f) {
+        amos_fb_clear(target, background);
+        for (int k = 0; k < count; k++) {
+            blit_window(&windows[k], target);
+        }
+        amos_fb_mark_changed(target);
+        return true;
+    }
+
+    size_t pixels = (size_t)target->width * (size_t)target->height;
+    if (pixels > compositor->depth_capacity) {
+        float* depth = (float*)realloc(compositor->depth_buffer, pixels * sizeof(float));
+        if (!depth) {
+            printf("Failed to allocate compositor depth buffer\n");
+            return false;
+        }
+        compositor->depth_buffer = depth;
+        compositor->depth_capacity = pixels;
+    }
+
+    float screen_w = (float)target->width;
+    float screen_h = (float)target->height;
+    float distance = screen_h * 0.5f / tanf(COMPOSITOR_FOV * 0.5f * COMPOSITOR_PI / 180.0f);
+
+    amos_renderer3d_t* renderer = compositor->renderer;
+    renderer->color_buffer = target;
+    renderer->depth_buffer = compositor->depth_buffer;
+    renderer->width = target->width;
+    renderer->height = target->height;
+    renderer->camera.position = (amos_vec3_t){0.0f, 0.0f, distance};
+    renderer->camera.target = (amos_vec3_t){0.0f, 0.0f, 0.0f};
+    renderer->camera.up = (amos_vec3_t){0.0f, 1.0f, 0.0f};
+    renderer->camera.fov = COMPOSITOR_FOV;
+    renderer->camera.aspect = screen_w / screen_h;
+    renderer->camera.near_clip = 1.0f;
+    renderer->camera.far_clip = distance * 4.0f + screen_w * 2.0f;
+    renderer->current_shader = NULL;
+    renderer->light_count = 0;
+    renderer->depth_test_enabled = true;
+    renderer->backface_culling_enabled = true;
+    renderer->wireframe_mode = false;
+
+    amos_fb_clear(target, background);
+    for (size_t i = 0; i < pixels; i++) {
+        compositor->depth_buffer[i] = renderer->camera.far_clip;
+    }
+
+    // Front to back: every effect keeps the topmost window nearest
+    for (int k = count - 1; k >= 0; k--) {
+        placement_t placement;
+        place_window(compositor, &windows[k], k, count, screen_w, screen_h, distance, &placement);
+        placement_matrix(&placement, &renderer->model_matrix);
+
+        amos_material_t* material = &compositor->materials[k];
+        material->diffuse_texture = windows[k].content;
+        compositor->quad.material = material;
+        amos_renderer3d_draw_mesh(renderer, &compositor->quad);
+    }
+
+    return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * AMOS Desktop OS - 3D Compositor
+ *
+ * This file defines a compositor mode that draws every visible window
+ * as a textured quad through the 3D pipeline, for desktop effects such
+ * as exposé, window flip and the workspace cube. Window framebuffers
+ * are sampled in place as textures; their mip levels are rebuilt only
+ * when a window's content changes. The plain desktop layout is copied
+ * without going through the 3D pipeline.
+ */
+
+#ifndef AMOS_COMPOSITOR3D_H
+#define AMOS_COMPOSITOR3D_H
+
+#include "renderer3d.h"
+#include "../graphics/window.h"
+
+// Desktop effects
+typedef enum {
+    AMOS_COMPOSITOR3D_FLAT,     // Windows at their screen positions
+    AMOS_COMPOSITOR3D_EXPOSE,   // Windows scaled into a grid
+    AMOS_COMPOSITOR3D_FLIP,     // Windows stacked and angled along the view axis
+    AMOS_COMPOSITOR3D_CUBE      // Desktop on the front face of a turning cube
+} amos_compositor3d_effect_t;
+
+// Compositor state
+typedef struct {
+    amos_renderer3d_t* renderer;        // Dedicated renderer, owned by the caller
+    amos_compositor3d_effect_t effect;
+    float progress;                     // 0 = plain desktop, 1 = effect fully applied
+
+    amos_mesh_t quad;                   // Unit quad centred on the origin
+    amos_vertex_t quad_vertices[4];
+    uint32_t quad_indices[6];
+    amos_material_t materials[AMOS_MAX_WINDOWS];
+
+    float* depth_buffer;
+    size_t depth_capacity;              // In floats
+} amos_compositor3d_t;
+
+/**
+ * Initialize the compositor
+ *
+ * @param compositor Pointer to compositor structure
+ * @param renderer Renderer to draw with; its camera, lights and targets
+ *                 are overwritten on every draw
+ * @return true if initialization was successful, false otherwise
+ */
+bool amos_compositor3d_init(amos_compositor3d_t* compositor, amos_renderer3d_t* renderer);
+
+/**
+ * Release the compositor's depth buffer
+ *
+ * @param compositor Pointer to compositor structure
+ */
+void amos_compositor3d_cleanup(amos_compositor3d_t* compositor);
+
+/**
+ * Select the effect and how far it has progressed
+ *
+ * @param compositor Pointer to compositor structure
+ * @param effect Effect to show
+ * @param progress 0 for the plain desktop layout up to 1 for the full effect
+ */
+void amos_compositor3d_set_effect(
+    amos_compositor3d_t* compositor,
+    amos_compositor3d_effect_t effect,
+    float progress
+);
+
+/**
+ * Draw every visible window into a target framebuffer
+ *
+ * @param compositor Pointer to compositor structure
+ * @param system Window system whose windows are drawn
+ * @param target 32bpp framebuffer to draw into
+ * @param background Colour behind the windows
+ * @return true if the desktop was drawn, false on invalid state or allocation failure
+ */
+bool amos_compositor3d_draw(
+    amos_compositor3d_t* compositor,
+    const amos_window_system_t* system,
+    amos_framebuffer_t* target,
+    amos_color_t background
+);
+
+#endif /* AMOS_COMPOSITOR3D_H */
@@ -0,0 +1,410 @@
+/**
+ * AMOS Desktop OS - Tiled Light Culling Implementation
+ *
+ * This file implements per-tile light lists for the AMOS 3D renderer.
+ */
+
+#include "light_culling.h"
+#include "light_eval.inl"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+// Camera basis used to move light bounds into view space
+typedef struct {
+    amos_vec3_t eye;
+    amos_vec3_t right;
+    amos_vec3_t up;
+    amos_vec3_t forward;
+    float scale_x;      // Projection scale for view x / depth
+    float scale_y;      // Projection scale for view y / depth
+    float near_clip;
+    float far_clip;
+} view_basis_t;
+
+static void view_basis_init(view_basis_t* basis, const amos_renderer3d_t* renderer) {
+    const amos_camera_t* camera = &renderer->camera;
+
+    basis->eye = camera->position;
+    amos_vec3_subtract(&camera->target, &camera->position, &basis->forward);
+    amos_vec3_normalize(&basis->forward, &basis->forward);
+    amos_vec3_cross(&basis->forward, &camera->up, &basis->right);
+    amos_vec3_normalize(&basis->right, &basis->right);
+    amos_vec3_cross(&basis->right, &basis->forward, &basis->up);
+
+    float aspect = camera->aspect > 0.0f ? camera->aspect : (float)renderer->width / (float)renderer->height;
+    float focal = 1.0f / tanf(camera->fov * 0.5f * AMOS_LIGHT_DEG_TO_RAD);
+    basis->scale_x = focal / aspect;
+    basis->scale_y = focal;
+    basis->near_clip = camera->near_clip;
+    basis->far_clip = camera->far_clip;
+}
+
+// Free the per-tile arrays
+static void free_tiles(amos_light_grid_t* grid) {
+    free(grid->tile_min_depth);
+    free(grid->tile_max_depth);
+    free(grid->tile_offsets);
+    grid->tile_min_depth = NULL;
+    grid->tile_max_depth = NULL;
+    grid->tile_offsets = NULL;
+}
+
+// Initialize a light grid
+bool amos_light_grid_init(amos_light_grid_t* grid, int width, int height) {
+    if (!grid) {
+        return false;
+    }
+
+    memset(grid, 0, sizeof(amos_light_grid_t));
+    return amos_light_grid_resize(grid, width, height);
+}
+
+// Clean up and release grid resources
+void amos_light_grid_cleanup(amos_light_grid_t* grid) {
+    if (!grid) {
+        return;
+    }
+
+    free_tiles(grid);
+    free(grid->tile_lights);
+    free(grid->global_lights);
+    free(grid->light_rects);
+    memset(grid, 0, sizeof(amos_light_grid_t));
+}
+
+// Resize the grid to a new render target size
+bool amos_light_grid_resize(amos_light_grid_t* grid, int width, int height) {
+    if (!grid || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    int tiles_x = (width + AMOS_LIGHT_TILE_SIZE - 1) / AMOS_LIGHT_TILE_SIZE;
+    int tiles_y = (height + AMOS_LIGHT_TILE_SIZE - 1) / AMOS_LIGHT_TILE_SIZE;
+    int tile_count = tiles_x * tiles_y;
+
+    free_tiles(grid);
+    grid->tile_min_depth = (float*)malloc(tile_count * sizeof(float));
+    grid->tile_max_depth = (float*)malloc(tile_count * sizeof(float));
+    grid->tile_offsets = (uint32_t*)calloc(tile_count + 1, sizeof(uint32_t));
+
+    if (!grid->tile_min_depth || !grid->tile_max_depth || !grid->tile_offsets) {
+        free_tiles(grid);
+        return false;
+    }
+
+    grid->width = width;
+    grid->height = height;
+    grid->tiles_x = tiles_x;
+    grid->tiles_y = tiles_y;
+
+    return true;
+}
+
+// Compute the depth range of every tile from a view-space depth buffer.
+// Tiles covering only background get an empty range (min > max).
+static void compute_tile_depths(
+    amos_light_grid_t* grid,
+    const amos_renderer3d_t* renderer,
+    const view_basis_t* basis,
+    bool use_depth_buffer
+) {
+    int tile_count = grid->tiles_x * grid->tiles_y;
+
+    if (!use_depth_buffer || !renderer->depth_buffer ||
+        renderer->width != grid->width || renderer->height != grid->height) {
+        for (int t = 0; t < tile_count; t++) {
+            grid->tile_min_depth[t] = basis->near_clip;
+            grid->tile_max_depth[t] = basis->far_clip;
+        }
+        return;
+    }
+
+    for (int ty = 0; ty < grid->tiles_y; ty++) {
+        int y0 = ty * AMOS_LIGHT_TILE_SIZE;
+        int y1 = y0 + AMOS_LIGHT_TILE_SIZE < grid->height ? y0 + AMOS_LIGHT_TILE_SIZE : grid->height;
+
+        for (int tx = 0; tx < grid->tiles_x; tx++) {
+            int x0 = tx * AMOS_LIGHT_TILE_SIZE;
+            int x1 = x0 + AMOS_LIGHT_TILE_SIZE < grid->width ? x0 + AMOS_LIGHT_TILE_SIZE : grid->width;
+            float min_depth = basis->far_clip;
+            float max_depth = basis->near_clip;
+
+            for (int y = y0; y < y1; y++) {
+                const float* row = renderer->depth_buffer + (size_t)y * grid->width;
+                for (int x = x0; x < x1; x++) {
+                    float d = row[x];
+                    if (d >= basis->far_clip) {
+                        continue;
+                    }
+                    if (d < min_depth) min_depth = d;
+                    if (d > max_depth) max_depth = d;
+                }
+            }
+
+            int t = ty * grid->tiles_x + tx;
+            grid->tile_min_depth[t] = min_depth;
+            grid->tile_max_depth[t] = max_depth;
+        }
+    }
+}
+
+// Bounding sphere of a point or spot light
+static void light_bounding_sphere(const amos_light_t* light, amos_vec3_t* center, float* radius) {
+    if (light->type != AMOS_LIGHT_SPOT || light->spot_angle >= 90.0f) {
+        *center = light->position;
+        *radius = light->range;
+        return;
+    }
+
+    // Tightest sphere around a cone of the given half-angle
+    float angle = light->spot_angle * AMOS_LIGHT_DEG_TO_RAD;
+    float c = cosf(angle);
+    float r;
+    float offset;
+    if (angle > 3.14159265f * 0.25f) {
+        offset = c * light->range;
+        r = sinf(angle) * light->range;
+    } else {
+        offset = light->range / (2.0f * c);
+        r = offset;
+    }
+
+    amos_vec3_t dir;
+    amos_vec3_normalize(&light->direction, &dir);
+    center->x = light->position.x + dir.x * offset;
+    center->y = light->position.y + dir.y * offset;
+    center->z = light->position.z + dir.z * offset;
+    *radius = r;
+}
+
+// Project a light's bounding sphere to a tile rectangle and depth range
+static bool light_tile_rect(
+    const amos_light_grid_t* grid,
+    const view_basis_t* basis,
+    const amos_light_t* light,
+    amos_light_tile_rect_t* rect
+) {
+    amos_vec3_t center, rel;
+    float radius;
+    light_bounding_sphere(light, &center, &radius);
+    amos_vec3_subtract(&center, &basis->eye, &rel);
+
+    float vx = amos_vec3_dot(&rel, &basis->right);
+    float vy = amos_vec3_dot(&rel, &basis->up);
+    float vz = amos_vec3_dot(&rel, &basis->forward);
+
+    if (vz + radius < basis->near_clip || vz - radius > basis->far_clip) {
+        return false;
+    }
+
+    rect->min_depth = vz - radius;
+    rect->max_depth = vz + radius;
+
+    // Spheres crossing the near plane cover the whole screen
+    if (vz - radius <= basis->near_clip) {
+        rect->tile_x0 = 0;
+        rect->tile_y0 = 0;
+        rect->tile_x1 = grid->tiles_x - 1;
+        rect->tile_y1 = grid->tiles_y - 1;
+        return true;
+    }
+
+    // Project the corners of the view-space box around the sphere
+    float z_near = vz - radius;
+    float z_far = vz + radius;
+    float x_min = fminf((vx - radius) / z_near, (vx - radius) / z_far) * basis->scale_x;
+    float x_max = fmaxf((vx + radius) / z_near, (vx + radius) / z_far) * basis->scale_x;
+    float y_min = fminf((vy - radius) / z_near, (vy - radius) / z_far) * basis->scale_y;
+    float y_max = fmaxf((vy + radius) / z_near, (vy + radius) / z_far) * basis->scale_y;
+
+    if (x_max < -1.0f || x_min > 1.0f || y_max < -1.0f || y_min > 1.0f) {
+        return false;
+    }
+
+    // NDC to pixels (y down)
+    float px0 = (x_min * 0.5f + 0.5f) * grid->width;
+    float px1 = (x_max * 0.5f + 0.5f) * grid->width;
+    float py0 = (0.5f - y_max * 0.5f) * grid->height;
+    float py1 = (0.5f - y_min * 0.5f) * grid->height;
+
+    rect->tile_x0 = px0 <= 0.0f ? 0 : (int)px0 / AMOS_LIGHT_TILE_SIZE;
+    rect->tile_y0 = py0 <= 0.0f ? 0 : (int)py0 / AMOS_LIGHT_TILE_SIZE;
+    rect->tile_x1 = px1 >= grid->width ? grid->tiles_x - 1 : (int)px1 / AMOS_LIGHT_TILE_SIZE;
+    rect->tile_y1 = py1 >= grid->height ? grid->tiles_y - 1 : (int)py1 / AMOS_LIGHT_TILE_SIZE;
+
+    return true;
+}
+
+// Build the per-tile light lists
+static bool build_lists(amos_light_grid_t* grid, const amos_renderer3d_t* renderer, bool use_depth_buffer) {
+    if (!grid || !renderer || !grid->tile_offsets) {
+        return false;
+    }
+
+    int tile_count = grid->tiles_x * grid->tiles_y;
+    int light_count = renderer->light_count;
+
+    if (light_count > grid->light_rects_capacity) {
+        amos_light_tile_rect_t* rects = (amos_light_tile_rect_t*)realloc(
+            grid->light_rects, light_count * sizeof(amos_light_tile_rect_t));
+        uint32_t* globals = (uint32_t*)realloc(grid->global_lights, light_count * sizeof(uint32_t));
+        if (rects) {
+            grid->light_rects = rects;
+        }
+        if (globals) {
+            grid->global_lights = globals;
+        }
+        if (!rects || !globals) {
+            return false;
+        }
+        grid->light_rects_capacity = light_count;
+    }
+
+    view_basis_t basis;
+    view_basis_init(&basis, renderer);
+    if (!use_depth_buffer) {
+        // Nothing limits how far away a fragment can be
+        basis.far_clip = FLT_MAX;
+    }
+    compute_tile_depths(grid, renderer, &basis, use_depth_buffer);
+
+    memset(grid->tile_offsets, 0, (tile_count + 1) * sizeof(uint32_t));
+    grid->global_light_count = 0;
+
+    // Count pass: tile_offsets[t + 1] holds the number of lights in tile t.
+    // Lights in no tile get a rectangle that is empty on both axes, since
+    // the fill pass walks the rows before the columns.
+    const amos_light_tile_rect_t empty_rect = {1, 1, 0, 0, 0.0f, 0.0f};
+    size_t total = 0;
+    for (int i = 0; i < light_count; i++) {
+        const amos_light_t* light = &renderer->lights[i];
+        amos_light_tile_rect_t* rect = &grid->light_rects[i];
+
+        if (light->type == AMOS_LIGHT_DIRECTIONAL) {
+            grid->global_lights[grid->global_light_count++] = (uint32_t)i;
+            *rect = empty_rect;
+            continue;
+        }
+
+        if (!light_tile_rect(grid, &basis, light, rect)) {
+            *rect = empty_rect;
+            continue;
+        }
+
+        for (int ty = rect->tile_y0; ty <= rect->tile_y1; ty++) {
+            for (int tx = rect->tile_x0; tx <= rect->tile_x1; tx++) {
+                int t = ty * grid->tiles_x + tx;
+                if (rect->max_depth >= grid->tile_min_depth[t] && rect->min_depth <= grid->tile_max_depth[t]) {
+                    grid->tile_offsets[t + 1]++;
+                    total++;
+                }
+            }
+        }
+    }
+
+    if (total > grid->tile_lights_capacity) {
+        size_t capacity = grid->tile_lights_capacity ? grid->tile_lights_capacity : 1024;
+        while (capacity < total) {
+            capacity *= 2;
+        }
+        uint32_t* tile_lights = (uint32_t*)realloc(grid->tile_lights, capacity * sizeof(uint32_t));
+        if (!tile_lights) {
+            return false;
+        }
+        grid->tile_lights = tile_lights;
+        grid->tile_lights_capacity = capacity;
+    }
+
+    // Prefix sum: tile_offsets[t] becomes the start of tile t
+    for (int t = 0; t < tile_count; t++) {
+        grid->tile_offsets[t + 1] += grid->tile_offsets[t];
+    }
+
+    // Fill pass, using tile_offsets[t] as the write cursor of tile t
+    for (int i = 0; i < light_count; i++) {
+        const amos_light_tile_rect_t* rect = &grid->light_rects[i];
+        for (int ty = rect->tile_y0; ty <= rect->tile_y1; ty++) {
+            for (int tx = rect->tile_x0; tx <= rect->tile_x1; tx++) {
+                int t = ty * grid->tiles_x + tx;
+                if (rect->max_depth >= grid->tile_min_depth[t] && rect->min_depth <= grid->tile_max_depth[t]) {
+                    grid->tile_lights[grid->tile_offsets[t]++] = (uint32_t)i;
+                }
+            }
+        }
+    }
+
+    // Cursors now point at the end of each tile; shift back to starts
+    for (int t = tile_count; t > 0; t--) {
+        grid->tile_offsets[t] = grid->tile_offsets[t - 1];
+    }
+    grid->tile_offsets[0] = 0;
+
+    return true;
+}
+
+// Cull the renderer's lights against the screen tiles
+bool amos_light_grid_build(amos_light_grid_t* grid, const amos_renderer3d_t* renderer) {
+    return build_lists(grid, renderer, true);
+}
+
+// Cull the renderer's lights against the screen tiles only
+bool amos_light_grid_build_screen(amos_light_grid_t* grid, const amos_renderer3d_t* renderer) {
+    return build_lists(grid, renderer, false);
+}
+
+// Get the light list of the tile containing a pixel
+const uint32_t* amos_light_grid_get_lights(const amos_light_grid_t* grid, int x, int y, int* count) {
+    if (!grid || !grid->tile_offsets || x < 0 || y < 0 || x >= grid->width || y >= grid->height) {
+        *count = 0;
+        return NULL;
+    }
+
+    int t = (y / AMOS_LIGHT_TILE_SIZE) * grid->tiles_x + (x / AMOS_LIGHT_TILE_SIZE);
+    *count = (int)(grid->tile_offsets[t + 1] - grid->tile_offsets[t]);
+    return grid->tile_lights + grid->tile_offsets[t];
+}
+
+// Accumulate the contribution of one light at a surface point
+void amos_light_accumulate(
+    const amos_light_t* light,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    const amos_vec3_t* view_dir,
+    float shininess,
+    amos_vec3_t* diffuse,
+    amos_vec3_t* specular
+) {
+    amos_light_eval(light, position, normal, view_dir, shininess, diffuse, specular);
+}
+
+// Shade a surface point with the lights of its tile
+void amos_light_grid_shade(
+    const amos_light_grid_t* grid,
+    const amos_light_t* lights,
+    int x,
+    int y,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    const amos_vec3_t* view_dir,
+    float shininess,
+    amos_vec3_t* diffuse,
+    amos_vec3_t* specular
+) {
+    *diffuse = (amos_vec3_t){0.0f, 0.0f, 0.0f};
+    *specular = (amos_vec3_t){0.0f, 0.0f, 0.0f};
+
+    for (int i = 0; i < grid->global_light_count; i++) {
+        amos_light_accumulate(&lights[grid->global_lights[i]], position, normal, view_dir,
+                              shininess, diffuse, specular);
+    }
+
+    int count;
+    const uint32_t* indices = amos_light_grid_get_lights(grid, x, y, &count);
+    for (int i = 0; i < count; i++) {
+        amos_light_accumulate(&lights[indices[i]], position, normal, view_dir,
+                              shininess, diffuse, specular);
+    }
+}
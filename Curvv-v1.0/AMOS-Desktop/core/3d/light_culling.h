@@ -0,0 +1,172 @@
+/**
+ * AMOS Desktop OS - Tiled Light Culling
+ *
+ * This file defines Forward+ style light culling for the AMOS 3D
+ * renderer. The screen is split into 16x16 pixel tiles; each frame the
+ * bounding sphere of every point and spot light is tested against the
+ * screen rectangle and depth range of each tile, producing a compact
+ * per-tile light list. Fragment shading then only iterates the lights
+ * of its own tile. Directional lights affect every tile and are kept
+ * in a separate global list.
+ *
+ * The Phong pipelines (pipeline.h) build the grid for draws with many
+ * lights and hand it to their rasterizers directly. Shader programs
+ * are not given the grid and visit every light.
+ */
+
+#ifndef AMOS_LIGHT_CULLING_H
+#define AMOS_LIGHT_CULLING_H
+
+#include "renderer3d.h"
+
+// Tile size in pixels
+#define AMOS_LIGHT_TILE_SIZE 16
+
+// Screen tile rectangle and view depth range covered by one light
+typedef struct {
+    int tile_x0, tile_y0;
+    int tile_x1, tile_y1;   // Inclusive
+    float min_depth;
+    float max_depth;
+} amos_light_tile_rect_t;
+
+// Light grid
+typedef struct {
+    int width;
+    int height;
+    int tiles_x;
+    int tiles_y;
+
+    // View-space depth range of each tile
+    float* tile_min_depth;
+    float* tile_max_depth;
+
+    // Per-tile light lists: lights of tile t are
+    // tile_lights[tile_offsets[t] .. tile_offsets[t + 1])
+    uint32_t* tile_offsets;
+    uint32_t* tile_lights;
+    size_t tile_lights_capacity;
+
+    // Lights that affect every tile (directional)
+    uint32_t* global_lights;
+    int global_light_count;
+
+    // Per-light screen tile rectangles (scratch)
+    amos_light_tile_rect_t* light_rects;
+    int light_rects_capacity;
+} amos_light_grid_t;
+
+/**
+ * Initialize a light grid
+ *
+ * @param grid Pointer to grid structure
+ * @param width Render target width
+ * @param height Render target height
+ * @return true if initialization was successful, false otherwise
+ */
+bool amos_light_grid_init(amos_light_grid_t* grid, int width, int height);
+
+/**
+ * Clean up and release grid resources
+ *
+ * @param grid Pointer to grid structure
+ */
+void amos_light_grid_cleanup(amos_light_grid_t* grid);
+
+/**
+ * Resize the grid to a new render target size
+ *
+ * @param grid Pointer to grid structure
+ * @param width New width
+ * @param height New height
+ * @return true if resize was successful, false otherwise
+ */
+bool amos_light_grid_resize(amos_light_grid_t* grid, int width, int height);
+
+/**
+ * Cull the renderer's lights against the screen tiles
+ *
+ * When the renderer has a depth buffer (view-space depth, as written by
+ * a depth pre-pass) it is used to tighten each tile's depth range;
+ * otherwise tiles span the whole near..far range.
+ *
+ * @param grid Pointer to grid structure
+ * @param renderer Renderer providing lights, camera and depth buffer
+ * @return true if culling succeeded, false on allocation failure
+ */
+bool amos_light_grid_build(amos_light_grid_t* grid, const amos_renderer3d_t* renderer);
+
+/**
+ * Cull the renderer's lights against the screen tiles only
+ *
+ * For shading while the depth buffer is still being written: every
+ * tile spans everything in front of the near plane, so a light is only
+ * dropped from tiles its bounding sphere does not cover on screen and
+ * shading with the lists matches shading with every light.
+ *
+ * @param grid Pointer to grid structure
+ * @param renderer Renderer providing lights and camera
+ * @return true if culling succeeded, false on allocation failure
+ */
+bool amos_light_grid_build_screen(amos_light_grid_t* grid, const amos_renderer3d_t* renderer);
+
+/**
+ * Get the light list of the tile containing a pixel
+ *
+ * @param grid Pointer to grid structure
+ * @param x Pixel x coordinate
+ * @param y Pixel y coordinate
+ * @param count Output number of lights
+ * @return Pointer to the tile's light indices
+ */
+const uint32_t* amos_light_grid_get_lights(const amos_light_grid_t* grid, int x, int y, int* count);
+
+/**
+ * Accumulate the contribution of one light at a surface point
+ *
+ * @param light Light to evaluate
+ * @param position Surface position (world space)
+ * @param normal Surface normal (normalized)
+ * @param view_dir Direction from surface to eye (normalized)
+ * @param shininess Specular exponent
+ * @param diffuse Diffuse accumulator
+ * @param specular Specular accumulator
+ */
+void amos_light_accumulate(
+    const amos_light_t* light,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    const amos_vec3_t* view_dir,
+    float shininess,
+    amos_vec3_t* diffuse,
+    amos_vec3_t* specular
+);
+
+/**
+ * Shade a surface point with the lights of its tile
+ *
+ * @param grid Pointer to grid structure
+ * @param lights Light array the grid was built from
+ * @param x Pixel x coordinate
+ * @param y Pixel y coordinate
+ * @param position Surface position (world space)
+ * @param normal Surface normal (normalized)
+ * @param view_dir Direction from surface to eye (normalized)
+ * @param shininess Specular exponent
+ * @param diffuse Output diffuse light
+ * @param specular Output specular light
+ */
+void amos_light_grid_shade(
+    const amos_light_grid_t* grid,
+    const amos_light_t* lights,
+    int x,
+    int y,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    const amos_vec3_t* view_dir,
+    float shininess,
+    amos_vec3_t* diffuse,
+    amos_vec3_t* specular
+);
+
+#endif /* AMOS_LIGHT_CULLING_H */
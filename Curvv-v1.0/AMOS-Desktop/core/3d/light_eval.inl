@@ -0,0 +1,105 @@
+/**
+ * AMOS Desktop OS - Light Evaluation
+ *
+ * Inline Blinn-Phong evaluation of a single light, shared by the tiled
+ * light culling code and the specialized raster pipelines so the light
+ * loop can be inlined into their inner loops.
+ *
+ * Point and spot lights use a smooth falloff that reaches zero exactly
+ * at the light's range, which is also its culling radius.
+ */
+
+#ifndef AMOS_LIGHT_EVAL_INL
+#define AMOS_LIGHT_EVAL_INL
+
+#include "renderer3d.h"
+#include <math.h>
+
+#define AMOS_LIGHT_DEG_TO_RAD (3.14159265f / 180.0f)
+
+// Accumulate the contribution of one light at a surface point
+static inline void amos_light_eval(
+    const amos_light_t* light,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    const amos_vec3_t* view_dir,
+    float shininess,
+    amos_vec3_t* diffuse,
+    amos_vec3_t* specular
+) {
+    float lx, ly, lz;
+    float attenuation = light->intensity;
+
+    if (light->type == AMOS_LIGHT_DIRECTIONAL) {
+        lx = -light->direction.x;
+        ly = -light->direction.y;
+        lz = -light->direction.z;
+        float len = sqrtf(lx * lx + ly * ly + lz * lz);
+        if (len <= 0.0f) {
+            return;
+        }
+        lx /= len;
+        ly /= len;
+        lz /= len;
+    } else {
+        lx = light->position.x - position->x;
+        ly = light->position.y - position->y;
+        lz = light->position.z - position->z;
+        float dist_sq = lx * lx + ly * ly + lz * lz;
+        float range_sq = light->range * light->range;
+        if (dist_sq >= range_sq || dist_sq <= 0.0f) {
+            return;
+        }
+        float inv_dist = 1.0f / sqrtf(dist_sq);
+        lx *= inv_dist;
+        ly *= inv_dist;
+        lz *= inv_dist;
+
+        float falloff = 1.0f - dist_sq / range_sq;
+        attenuation *= falloff * falloff;
+
+        if (light->type == AMOS_LIGHT_SPOT) {
+            const amos_vec3_t* d = &light->direction;
+            float dir_len = sqrtf(d->x * d->x + d->y * d->y + d->z * d->z);
+            if (dir_len <= 0.0f) {
+                return;
+            }
+            float cos_angle = -(lx * d->x + ly * d->y + lz * d->z) / dir_len;
+            float cos_outer = cosf(light->spot_angle * AMOS_LIGHT_DEG_TO_RAD);
+            float cos_inner = cosf(light->spot_angle * 0.8f * AMOS_LIGHT_DEG_TO_RAD);
+            if (cos_angle <= cos_outer) {
+                return;
+            }
+            float edge = (cos_angle - cos_outer) / (cos_inner - cos_outer);
+            attenuation *= edge < 1.0f ? edge : 1.0f;
+        }
+    }
+
+    float n_dot_l = normal->x * lx + normal->y * ly + normal->z * lz;
+    if (n_dot_l <= 0.0f) {
+        return;
+    }
+
+    float d = attenuation * n_dot_l;
+    diffuse->x += light->color.x * d;
+    diffuse->y += light->color.y * d;
+    diffuse->z += light->color.z * d;
+
+    // Blinn-Phong specular
+    float hx = lx + view_dir->x;
+    float hy = ly + view_dir->y;
+    float hz = lz + view_dir->z;
+    float h_len = sqrtf(hx * hx + hy * hy + hz * hz);
+    if (h_len <= 0.0f) {
+        return;
+    }
+    float n_dot_h = (normal->x * hx + normal->y * hy + normal->z * hz) / h_len;
+    if (n_dot_h > 0.0f) {
+        float s = attenuation * powf(n_dot_h, shininess);
+        specular->x += light->color.x * s;
+        specular->y += light->color.y * s;
+        specular->z += light->color.z * s;
+    }
+}
+
+#endif /* AMOS_LIGHT_EVAL_INL */
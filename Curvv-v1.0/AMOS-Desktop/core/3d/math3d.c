@@ -45,6 +45,19 @@ void amos_vec3_normalize(const amos_vec3_t* v, amos_vec3_t* result) {
     }
 }
 
+// Normalize without the small-length cutoff of amos_vec3_normalize, which
+// would zero the face normals of finely tessellated meshes
+void amos_vec3_normalize_exact(const amos_vec3_t* v, amos_vec3_t* result) {
+    float length = amos_vec3_length(v);
+    if (length > 0.0f) {
+        result->x = v->x / length;
+        result->y = v->y / length;
+        result->z = v->z / length;
+    } else {
+        *result = *v;
+    }
+}
+
 float amos_vec3_dot(const amos_vec3_t* a, const amos_vec3_t* b) {
     return a->x * b->x + a->y * b->y + a->z * b->z;
 }
@@ -0,0 +1,549 @@
+/**
+ * AMOS Desktop OS - Binary Mesh Format Implementation
+ *
+ * This file implements zero-copy loading of AMOS mesh files via mmap,
+ * the mesh file writer and the meshlet builder used by the converter.
+ */
+
+#include "mesh_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Files are little-endian and mapped without conversion, so only
+// little-endian hosts can read or write them
+static bool host_little_endian(void) {
+    const uint32_t probe = 1;
+    return *(const uint8_t*)&probe == 1;
+}
+
+// Round a size up to the section alignment
+static uint64_t align_up(uint64_t value) {
+    return (value + (AMOS_MESH_FILE_ALIGNMENT - 1)) & ~(uint64_t)(AMOS_MESH_FILE_ALIGNMENT - 1);
+}
+
+// Check that a section lies inside the file and has the expected size
+static bool section_valid(const amos_mesh_file_header_t* header, int section, uint64_t expected_size, bool optional) {
+    const amos_mesh_file_section_t* s = &header->sections[section];
+
+    if (s->size == 0) {
+        return optional || expected_size == 0;
+    }
+
+    if (s->offset % AMOS_MESH_FILE_ALIGNMENT != 0) {
+        return false;
+    }
+
+    if (s->offset < header->header_size || s->offset > header->file_size ||
+        s->size > header->file_size - s->offset) {
+        return false;
+    }
+
+    return expected_size == 0 || s->size == expected_size;
+}
+
+// Check that every index refers to a vertex
+static bool indices_valid(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count) {
+    for (uint32_t i = 0; i < index_count; i++) {
+        if (indices[i] >= vertex_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check that every meshlet's ranges lie inside the vertex and triangle
+// tables and that its entries refer to existing vertices
+static bool meshlets_valid(
+    const amos_meshlet_t* meshlets,
+    uint32_t meshlet_count,
+    const uint32_t* vertices,
+    uint64_t vertex_entries,
+    const uint8_t* triangles,
+    uint64_t triangle_bytes,
+    uint32_t vertex_count
+) {
+    for (uint32_t m = 0; m < meshlet_count; m++) {
+        const amos_meshlet_t* meshlet = &meshlets[m];
+
+        if (meshlet->vertex_count > AMOS_MESHLET_MAX_VERTICES ||
+            meshlet->triangle_count > AMOS_MESHLET_MAX_TRIANGLES ||
+            meshlet->vertex_offset > vertex_entries ||
+            meshlet->vertex_count > vertex_entries - meshlet->vertex_offset ||
+            meshlet->triangle_offset > triangle_bytes ||
+            (uint64_t)meshlet->triangle_count * 3 > triangle_bytes - meshlet->triangle_offset) {
+            return false;
+        }
+
+        if (!indices_valid(vertices + meshlet->vertex_offset, meshlet->vertex_count, vertex_count)) {
+            return false;
+        }
+
+        const uint8_t* tri = triangles + meshlet->triangle_offset;
+        for (uint32_t i = 0; i < meshlet->triangle_count * 3; i++) {
+            if (tri[i] >= meshlet->vertex_count) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Map a mesh file into memory
+bool amos_mesh_file_map(const char* path, amos_mesh_t* mesh) {
+    if (!path || !mesh) {
+        return false;
+    }
+
+    if (!host_little_endian()) {
+        printf("Cannot map mesh file %s: mesh files are little-endian\n", path);
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Failed to open mesh file %s\n", path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(amos_mesh_file_header_t)) {
+        printf("Mesh file %s is too small\n", path);
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        printf("Failed to map mesh file %s\n", path);
+        return false;
+    }
+
+    // Hint the kernel that the streams will be read front to back; the
+    // index and meshlet checks below fault them in anyway
+    madvise(base, size, MADV_WILLNEED);
+
+    const amos_mesh_file_header_t* header = (const amos_mesh_file_header_t*)base;
+    const uint8_t* bytes = (const uint8_t*)base;
+
+    // Validate header and section table before exposing any pointers
+    bool valid = header->magic == AMOS_MESH_FILE_MAGIC &&
+                 header->version == AMOS_MESH_FILE_VERSION &&
+                 header->header_size >= sizeof(amos_mesh_file_header_t) &&
+                 header->file_size == size &&
+                 header->vertex_count > 0 &&
+                 header->index_count % 3 == 0;
+
+    if (valid) {
+        uint64_t vc = header->vertex_count;
+        valid = section_valid(header, AMOS_MESH_SECTION_POSITIONS, vc * sizeof(amos_vec3_t), false) &&
+                section_valid(header, AMOS_MESH_SECTION_NORMALS, vc * sizeof(amos_vec3_t), true) &&
+                section_valid(header, AMOS_MESH_SECTION_TEXCOORDS, vc * sizeof(amos_vec2_t), true) &&
+                section_valid(header, AMOS_MESH_SECTION_COLORS, vc * sizeof(amos_vec4_t), true) &&
+                section_valid(header, AMOS_MESH_SECTION_INDICES,
+                              (uint64_t)header->index_count * sizeof(uint32_t), false) &&
+                section_valid(header, AMOS_MESH_SECTION_MESHLETS,
+                              (uint64_t)header->meshlet_count * sizeof(amos_meshlet_t), true) &&
+                section_valid(header, AMOS_MESH_SECTION_MESHLET_VERTICES, 0, true) &&
+                section_valid(header, AMOS_MESH_SECTION_MESHLET_TRIANGLES, 0, true);
+    }
+
+    // Indices and meshlets are dereferenced by the renderer without checks
+    const amos_mesh_file_section_t* s = header->sections;
+    if (valid) {
+        valid = indices_valid((const uint32_t*)(bytes + s[AMOS_MESH_SECTION_INDICES].offset),
+                              header->index_count, header->vertex_count);
+    }
+
+    bool has_meshlets = header->meshlet_count > 0 &&
+                        s[AMOS_MESH_SECTION_MESHLETS].size &&
+                        s[AMOS_MESH_SECTION_MESHLET_VERTICES].size &&
+                        s[AMOS_MESH_SECTION_MESHLET_TRIANGLES].size;
+    if (valid && has_meshlets) {
+        valid = s[AMOS_MESH_SECTION_MESHLET_VERTICES].size % sizeof(uint32_t) == 0 &&
+                meshlets_valid((const amos_meshlet_t*)(bytes + s[AMOS_MESH_SECTION_MESHLETS].offset),
+                               header->meshlet_count,
+                               (const uint32_t*)(bytes + s[AMOS_MESH_SECTION_MESHLET_VERTICES].offset),
+                               s[AMOS_MESH_SECTION_MESHLET_VERTICES].size / sizeof(uint32_t),
+                               bytes + s[AMOS_MESH_SECTION_MESHLET_TRIANGLES].offset,
+                               s[AMOS_MESH_SECTION_MESHLET_TRIANGLES].size,
+                               header->vertex_count);
+    }
+
+    if (!valid) {
+        printf("Invalid mesh file %s\n", path);
+        munmap(base, size);
+        return false;
+    }
+
+    memset(mesh, 0, sizeof(amos_mesh_t));
+
+    mesh->positions = (const amos_vec3_t*)(bytes + s[AMOS_MESH_SECTION_POSITIONS].offset);
+    if (s[AMOS_MESH_SECTION_NORMALS].size) {
+        mesh->normals = (const amos_vec3_t*)(bytes + s[AMOS_MESH_SECTION_NORMALS].offset);
+    }
+    if (s[AMOS_MESH_SECTION_TEXCOORDS].size) {
+        mesh->texcoords = (const amos_vec2_t*)(bytes + s[AMOS_MESH_SECTION_TEXCOORDS].offset);
+    }
+    if (s[AMOS_MESH_SECTION_COLORS].size) {
+        mesh->colors = (const amos_vec4_t*)(bytes + s[AMOS_MESH_SECTION_COLORS].offset);
+    }
+
+    // The index buffer is read-only; the renderer never writes through it
+    mesh->indices = (uint32_t*)(bytes + s[AMOS_MESH_SECTION_INDICES].offset);
+    mesh->vertex_count = (int)header->vertex_count;
+    mesh->index_count = (int)header->index_count;
+    mesh->bounds = header->bounds;
+
+    if (has_meshlets) {
+        mesh->meshlets = (const amos_meshlet_t*)(bytes + s[AMOS_MESH_SECTION_MESHLETS].offset);
+        mesh->meshlet_vertices = (const uint32_t*)(bytes + s[AMOS_MESH_SECTION_MESHLET_VERTICES].offset);
+        mesh->meshlet_triangles = bytes + s[AMOS_MESH_SECTION_MESHLET_TRIANGLES].offset;
+        mesh->meshlet_count = (int)header->meshlet_count;
+    }
+
+    mesh->mapping = base;
+    mesh->mapping_size = size;
+
+    return true;
+}
+
+// Release a mesh file mapping
+void amos_mesh_file_unmap(amos_mesh_t* mesh) {
+    if (!mesh || !mesh->mapping) {
+        return;
+    }
+
+    munmap(mesh->mapping, mesh->mapping_size);
+    memset(mesh, 0, sizeof(amos_mesh_t));
+}
+
+// Write a section followed by zero padding up to the next aligned offset
+static bool write_section(FILE* file, const void* data, uint64_t size) {
+    static const uint8_t padding[AMOS_MESH_FILE_ALIGNMENT] = {0};
+
+    if (size > 0 && fwrite(data, 1, size, file) != size) {
+        return false;
+    }
+
+    uint64_t pad = align_up(size) - size;
+    return pad == 0 || fwrite(padding, 1, pad, file) == pad;
+}
+
+// Write a mesh file
+bool amos_mesh_file_write(const char* path, const amos_mesh_file_data_t* data) {
+    if (!path || !data || !data->positions || !data->indices ||
+        data->vertex_count == 0 || data->index_count % 3 != 0) {
+        return false;
+    }
+
+    if (!host_little_endian()) {
+        printf("Cannot write mesh file %s: mesh files are little-endian\n", path);
+        return false;
+    }
+
+    amos_meshlet_t* meshlets = NULL;
+    uint32_t* meshlet_vertices = NULL;
+    uint8_t* meshlet_triangles = NULL;
+    uint32_t meshlet_count = 0;
+    uint32_t meshlet_vertex_count = 0;
+    uint32_t meshlet_triangle_bytes = 0;
+
+    if (data->build_meshlets &&
+        !amos_mesh_build_meshlets(data->positions, data->vertex_count,
+                                  data->indices, data->index_count,
+                                  &meshlets, &meshlet_vertices, &meshlet_triangles,
+                                  &meshlet_count, &meshlet_vertex_count,
+                                  &meshlet_triangle_bytes)) {
+        return false;
+    }
+
+    // Section sources and sizes in file order
+    uint64_t vc = data->vertex_count;
+    const void* sources[AMOS_MESH_SECTION_COUNT] = {
+        data->positions, data->normals, data->texcoords, data->colors,
+        data->indices, meshlets, meshlet_vertices, meshlet_triangles
+    };
+    uint64_t sizes[AMOS_MESH_SECTION_COUNT] = {
+        vc * sizeof(amos_vec3_t),
+        data->normals ? vc * sizeof(amos_vec3_t) : 0,
+        data->texcoords ? vc * sizeof(amos_vec2_t) : 0,
+        data->colors ? vc * sizeof(amos_vec4_t) : 0,
+        (uint64_t)data->index_count * sizeof(uint32_t),
+        (uint64_t)meshlet_count * sizeof(amos_meshlet_t),
+        (uint64_t)meshlet_vertex_count * sizeof(uint32_t),
+        meshlet_triangle_bytes
+    };
+
+    amos_mesh_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = AMOS_MESH_FILE_MAGIC;
+    header.version = AMOS_MESH_FILE_VERSION;
+    header.header_size = sizeof(amos_mesh_file_header_t);
+    header.vertex_count = data->vertex_count;
+    header.index_count = data->index_count;
+    header.meshlet_count = meshlet_count;
+    amos_mesh_compute_bounds(data->positions, data->vertex_count, &header.bounds);
+
+    uint64_t offset = align_up(sizeof(amos_mesh_file_header_t));
+    for (int i = 0; i < AMOS_MESH_SECTION_COUNT; i++) {
+        if (sizes[i] == 0) {
+            continue;
+        }
+        header.sections[i].offset = offset;
+        header.sections[i].size = sizes[i];
+        offset += align_up(sizes[i]);
+    }
+    header.file_size = offset;
+
+    bool ok = false;
+    FILE* file = fopen(path, "wb");
+    if (file) {
+        ok = write_section(file, &header, sizeof(header));
+        for (int i = 0; ok && i < AMOS_MESH_SECTION_COUNT; i++) {
+            if (sizes[i] > 0) {
+                ok = write_section(file, sources[i], sizes[i]);
+            }
+        }
+        ok = (fclose(file) == 0) && ok;
+    }
+
+    if (!ok) {
+        printf("Failed to write mesh file %s\n", path);
+    }
+
+    free(meshlets);
+    free(meshlet_vertices);
+    free(meshlet_triangles);
+
+    return ok;
+}
+
+// Compute bounds for a set of positions
+void amos_mesh_compute_bounds(const amos_vec3_t* positions, uint32_t count, amos_bounds_t* bounds) {
+    if (!bounds) {
+        return;
+    }
+
+    memset(bounds, 0, sizeof(amos_bounds_t));
+    if (!positions || count == 0) {
+        return;
+    }
+
+    bounds->min = positions[0];
+    bounds->max = positions[0];
+    for (uint32_t i = 1; i < count; i++) {
+        const amos_vec3_t* p = &positions[i];
+        if (p->x < bounds->min.x) bounds->min.x = p->x;
+        if (p->y < bounds->min.y) bounds->min.y = p->y;
+        if (p->z < bounds->min.z) bounds->min.z = p->z;
+        if (p->x > bounds->max.x) bounds->max.x = p->x;
+        if (p->y > bounds->max.y) bounds->max.y = p->y;
+        if (p->z > bounds->max.z) bounds->max.z = p->z;
+    }
+
+    bounds->center.x = (bounds->min.x + bounds->max.x) * 0.5f;
+    bounds->center.y = (bounds->min.y + bounds->max.y) * 0.5f;
+    bounds->center.z = (bounds->min.z + bounds->max.z) * 0.5f;
+
+    // Sphere around the box centre, tightened to the furthest point
+    float max_dist_sq = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        float dx = positions[i].x - bounds->center.x;
+        float dy = positions[i].y - bounds->center.y;
+        float dz = positions[i].z - bounds->center.z;
+        float d = dx * dx + dy * dy + dz * dz;
+        if (d > max_dist_sq) {
+            max_dist_sq = d;
+        }
+    }
+    bounds->radius = sqrtf(max_dist_sq);
+}
+
+// Fill in bounding sphere and normal cone for a finished meshlet
+static void finish_meshlet(
+    amos_meshlet_t* meshlet,
+    const amos_vec3_t* positions,
+    const uint32_t* vertices,
+    const uint8_t* triangles
+) {
+    amos_vec3_t* local = (amos_vec3_t*)malloc(meshlet->vertex_count * sizeof(amos_vec3_t));
+    if (!local) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < meshlet->vertex_count; i++) {
+        local[i] = positions[vertices[meshlet->vertex_offset + i]];
+    }
+
+    amos_bounds_t bounds;
+    amos_mesh_compute_bounds(local, meshlet->vertex_count, &bounds);
+    meshlet->center = bounds.center;
+    meshlet->radius = bounds.radius;
+
+    // Average face normal, then the widest deviation from it
+    const uint8_t* tri = triangles + meshlet->triangle_offset;
+    amos_vec3_t axis = {0.0f, 0.0f, 0.0f};
+    for (uint32_t t = 0; t < meshlet->triangle_count; t++) {
+        amos_vec3_t e1, e2, n;
+        amos_vec3_subtract(&local[tri[t * 3 + 1]], &local[tri[t * 3]], &e1);
+        amos_vec3_subtract(&local[tri[t * 3 + 2]], &local[tri[t * 3]], &e2);
+        amos_vec3_cross(&e1, &e2, &n);
+        amos_vec3_normalize_exact(&n, &n);
+        amos_vec3_add(&axis, &n, &axis);
+    }
+    amos_vec3_normalize_exact(&axis, &axis);
+    meshlet->cone_axis = axis;
+
+    float min_dot = 1.0f;
+    for (uint32_t t = 0; t < meshlet->triangle_count; t++) {
+        amos_vec3_t e1, e2, n;
+        amos_vec3_subtract(&local[tri[t * 3 + 1]], &local[tri[t * 3]], &e1);
+        amos_vec3_subtract(&local[tri[t * 3 + 2]], &local[tri[t * 3]], &e2);
+        amos_vec3_cross(&e1, &e2, &n);
+        amos_vec3_normalize_exact(&n, &n);
+        float d = amos_vec3_dot(&n, &meshlet->cone_axis);
+        if (d < min_dot) {
+            min_dot = d;
+        }
+    }
+    meshlet->cone_cutoff = min_dot;
+
+    free(local);
+}
+
+// Split an index buffer into meshlets
+bool amos_mesh_build_meshlets(
+    const amos_vec3_t* positions,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count,
+    amos_meshlet_t** meshlets,
+    uint32_t** meshlet_vertices,
+    uint8_t** meshlet_triangles,
+    uint32_t* meshlet_count,
+    uint32_t* meshlet_vertex_count,
+    uint32_t* meshlet_triangle_bytes
+) {
+    if (!positions || !indices || !meshlets || !meshlet_vertices || !meshlet_triangles ||
+        !meshlet_count || !meshlet_vertex_count || !meshlet_triangle_bytes) {
+        return false;
+    }
+
+    uint32_t triangle_count = index_count / 3;
+
+    // A meshlet only closes once it holds at least 62 vertices, i.e. 21 triangles
+    uint32_t max_meshlets = triangle_count / 21 + 2;
+
+    amos_meshlet_t* out_meshlets = (amos_meshlet_t*)calloc(max_meshlets, sizeof(amos_meshlet_t));
+    uint32_t* out_vertices = (uint32_t*)malloc((size_t)index_count * sizeof(uint32_t) + sizeof(uint32_t));
+    uint8_t* out_triangles = (uint8_t*)malloc((size_t)index_count + 1);
+    int32_t* slot = (int32_t*)malloc((size_t)vertex_count * sizeof(int32_t));
+
+    if (!out_meshlets || !out_vertices || !out_triangles || !slot) {
+        free(out_meshlets);
+        free(out_vertices);
+        free(out_triangles);
+        free(slot);
+        return false;
+    }
+
+    memset(slot, 0xff, (size_t)vertex_count * sizeof(int32_t));
+
+    uint32_t count = 0;
+    uint32_t vertex_total = 0;
+    uint32_t triangle_bytes = 0;
+    amos_meshlet_t* current = &out_meshlets[0];
+
+    for (uint32_t t = 0; t < triangle_count; t++) {
+        const uint32_t* tri = &indices[t * 3];
+
+        if (tri[0] >= vertex_count || tri[1] >= vertex_count || tri[2] >= vertex_count) {
+            continue;
+        }
+
+        uint32_t new_vertices = 0;
+        for (int k = 0; k < 3; k++) {
+            if (slot[tri[k]] < 0) {
+                new_vertices++;
+            }
+        }
+
+        // Close the current meshlet if this triangle does not fit
+        if (current->vertex_count + new_vertices > AMOS_MESHLET_MAX_VERTICES ||
+            current->triangle_count + 1 > AMOS_MESHLET_MAX_TRIANGLES) {
+            for (uint32_t i = 0; i < current->vertex_count; i++) {
+                slot[out_vertices[current->vertex_offset + i]] = -1;
+            }
+            count++;
+            current = &out_meshlets[count];
+            current->vertex_offset = vertex_total;
+            current->triangle_offset = triangle_bytes;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            if (slot[tri[k]] < 0) {
+                slot[tri[k]] = (int32_t)current->vertex_count;
+                out_vertices[vertex_total++] = tri[k];
+                current->vertex_count++;
+            }
+            out_triangles[triangle_bytes++] = (uint8_t)slot[tri[k]];
+        }
+        current->triangle_count++;
+    }
+
+    if (current->triangle_count > 0) {
+        count++;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        finish_meshlet(&out_meshlets[i], positions, out_vertices, out_triangles);
+    }
+
+    free(slot);
+
+    *meshlets = out_meshlets;
+    *meshlet_vertices = out_vertices;
+    *meshlet_triangles = out_triangles;
+    *meshlet_count = count;
+    *meshlet_vertex_count = vertex_total;
+    *meshlet_triangle_bytes = triangle_bytes;
+
+    return true;
+}
+
+// Fetch a vertex from either the interleaved or the SoA representation
+void amos_mesh_fetch_vertex(const amos_mesh_t* mesh, uint32_t index, amos_vertex_t* vertex) {
+    if (mesh->vertices) {
+        *vertex = mesh->vertices[index];
+        return;
+    }
+
+    vertex->position = mesh->positions[index];
+
+    if (mesh->normals) {
+        vertex->normal = mesh->normals[index];
+    } else {
+        vertex->normal = (amos_vec3_t){0.0f, 0.0f, 1.0f};
+    }
+
+    if (mesh->texcoords) {
+        vertex->texcoord = mesh->texcoords[index];
+    } else {
+        vertex->texcoord = (amos_vec2_t){0.0f, 0.0f};
+    }
+
+    if (mesh->colors) {
+        vertex->color = mesh->colors[index];
+    } else {
+        vertex->color = (amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f};
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * AMOS Desktop OS - Binary Mesh Format
+ *
+ * This file defines the on-disk mesh container used by the AMOS 3D
+ * renderer. Files are versioned, every section is 64-byte aligned and
+ * vertex data is stored as structure-of-arrays streams, so a mesh can
+ * be used directly from a read-only memory mapping without parsing.
+ *
+ * Layout:
+ *   amos_mesh_file_header_t           (section table, counts, bounds)
+ *   positions[vertex_count]           amos_vec3_t
+ *   normals[vertex_count]             amos_vec3_t   (optional)
+ *   texcoords[vertex_count]           amos_vec2_t   (optional)
+ *   colors[vertex_count]              amos_vec4_t   (optional)
+ *   indices[index_count]              uint32_t
+ *   meshlets[meshlet_count]           amos_meshlet_t (optional)
+ *   meshlet_vertices[]                uint32_t      (optional)
+ *   meshlet_triangles[]               uint8_t x 3   (optional)
+ *
+ * All values are little-endian. Files are used without byte swapping,
+ * so big-endian hosts refuse to map or write them.
+ */
+
+#ifndef AMOS_MESH_FORMAT_H
+#define AMOS_MESH_FORMAT_H
+
+#include "renderer3d.h"
+
+// File identification
+#define AMOS_MESH_FILE_MAGIC     0x48534D41u  // "AMSH"
+#define AMOS_MESH_FILE_VERSION   1
+#define AMOS_MESH_FILE_ALIGNMENT 64
+
+// Meshlet limits used by the builder
+#define AMOS_MESHLET_MAX_VERTICES  64
+#define AMOS_MESHLET_MAX_TRIANGLES 124
+
+// Section identifiers
+typedef enum {
+    AMOS_MESH_SECTION_POSITIONS,
+    AMOS_MESH_SECTION_NORMALS,
+    AMOS_MESH_SECTION_TEXCOORDS,
+    AMOS_MESH_SECTION_COLORS,
+    AMOS_MESH_SECTION_INDICES,
+    AMOS_MESH_SECTION_MESHLETS,
+    AMOS_MESH_SECTION_MESHLET_VERTICES,
+    AMOS_MESH_SECTION_MESHLET_TRIANGLES,
+    AMOS_MESH_SECTION_COUNT
+} amos_mesh_section_t;
+
+// Section table entry (size 0 means the section is absent)
+typedef struct {
+    uint64_t offset;
+    uint64_t size;
+} amos_mesh_file_section_t;
+
+// File header
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t flags;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t meshlet_count;
+    uint32_t reserved;
+    uint64_t file_size;
+    amos_mesh_file_section_t sections[AMOS_MESH_SECTION_COUNT];
+    amos_bounds_t bounds;
+} amos_mesh_file_header_t;
+
+// Source data for writing a mesh file
+typedef struct {
+    const amos_vec3_t* positions;
+    const amos_vec3_t* normals;       // May be NULL
+    const amos_vec2_t* texcoords;     // May be NULL
+    const amos_vec4_t* colors;        // May be NULL
+    const uint32_t* indices;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    bool build_meshlets;
+} amos_mesh_file_data_t;
+
+/**
+ * Map a mesh file into memory and point a mesh at its streams
+ *
+ * The mesh streams reference the mapping directly; nothing is copied.
+ * Indices and meshlet tables are range-checked once here, which reads
+ * them in full, so the renderer can use them without checks. The
+ * mapping stays valid until amos_mesh_file_unmap is called.
+ *
+ * @param path Path to the mesh file
+ * @param mesh Mesh structure to fill in
+ * @return true if the file was mapped and validated, false otherwise
+ *         (including on big-endian hosts)
+ */
+bool amos_mesh_file_map(const char* path, amos_mesh_t* mesh);
+
+/**
+ * Release a mesh file mapping
+ *
+ * @param mesh Mesh previously filled in by amos_mesh_file_map
+ */
+void amos_mesh_file_unmap(amos_mesh_t* mesh);
+
+/**
+ * Write a mesh file
+ *
+ * @param path Output path
+ * @param data Source streams
+ * @return true if the file was written, false otherwise (including on
+ *         big-endian hosts)
+ */
+bool amos_mesh_file_write(const char* path, const amos_mesh_file_data_t* data);
+
+/**
+ * Compute bounds for a set of positions
+ *
+ * @param positions Position stream
+ * @param count Number of positions
+ * @param bounds Output bounds
+ */
+void amos_mesh_compute_bounds(const amos_vec3_t* positions, uint32_t count, amos_bounds_t* bounds);
+
+/**
+ * Split an index buffer into meshlets
+ *
+ * Output arrays are allocated with malloc and owned by the caller.
+ *
+ * @param positions Position stream
+ * @param vertex_count Number of vertices
+ * @param indices Triangle list indices
+ * @param index_count Number of indices
+ * @param meshlets Output meshlet array
+ * @param meshlet_vertices Output meshlet vertex table
+ * @param meshlet_triangles Output meshlet triangle table (local indices)
+ * @param meshlet_count Output number of meshlets
+ * @param meshlet_vertex_count Output number of meshlet vertex entries
+ * @param meshlet_triangle_bytes Output size of the triangle table in bytes
+ * @return true if meshlets were built, false otherwise
+ */
+bool amos_mesh_build_meshlets(
+    const amos_vec3_t* positions,
+    uint32_t vertex_count,
+    const uint32_t* indices,
+    uint32_t index_count,
+    amos_meshlet_t** meshlets,
+    uint32_t** meshlet_vertices,
+    uint8_t** meshlet_triangles,
+    uint32_t* meshlet_count,
+    uint32_t* meshlet_vertex_count,
+    uint32_t* meshlet_triangle_bytes
+);
+
+/**
+ * Fetch a vertex from either the interleaved or the SoA representation
+ *
+ * @param mesh Mesh to read from
+ * @param index Vertex index
+ * @param vertex Output vertex
+ */
+void amos_mesh_fetch_vertex(const amos_mesh_t* mesh, uint32_t index, amos_vertex_t* vertex);
+
+#endif /* AMOS_MESH_FORMAT_H */
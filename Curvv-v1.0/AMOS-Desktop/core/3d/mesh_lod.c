@@ -0,0 +1,617 @@
+/**
+ * AMOS Desktop OS - Mesh Level of Detail Implementation
+ *
+ * This file implements quadric error metric simplification. Vertices
+ * are collapsed onto a neighbour (half-edge collapse) in order of
+ * increasing quadric error, so every simplified level reuses a subset
+ * of the source vertices and their attributes. Each level is
+ * emitted while simplification continues towards the next one.
+ */
+
+#include "mesh_lod.h"
+#include "pipeline.h"
+#include "mesh_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define NONE 0xffffffffu
+
+// Weight of the planes that keep open borders in place
+#define BOUNDARY_WEIGHT 10.0
+
+// Symmetric 4x4 quadric: a2 ab ac ad b2 bc bd c2 cd d2
+typedef struct {
+    double q[10];
+} quadric_t;
+
+// Candidate collapse of one vertex onto another
+typedef struct {
+    float cost;
+    uint32_t from;
+    uint32_t to;
+} collapse_t;
+
+// Sortable edge record used to find borders
+typedef struct {
+    uint64_t key;
+    uint32_t triangle;
+} edge_t;
+
+// Simplifier state
+typedef struct {
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+    uint32_t live_triangles;
+    const uint32_t* indices;
+    amos_vec3_t* positions;
+    quadric_t* quadrics;
+    uint32_t* remap;
+    uint8_t* locked;
+    uint8_t* dead;
+
+    // Per-vertex triangle lists, concatenated on collapse
+    uint32_t* list_head;
+    uint32_t* list_tail;
+    uint32_t* list_next;
+
+    // Candidate buffer reused by every pass
+    collapse_t* candidates;
+
+    float max_error;
+} simplifier_t;
+
+static void quadric_add_plane(quadric_t* q, double a, double b, double c, double d, double w) {
+    q->q[0] += w * a * a; q->q[1] += w * a * b; q->q[2] += w * a * c; q->q[3] += w * a * d;
+    q->q[4] += w * b * b; q->q[5] += w * b * c; q->q[6] += w * b * d;
+    q->q[7] += w * c * c; q->q[8] += w * c * d;
+    q->q[9] += w * d * d;
+}
+
+static double quadric_eval(const quadric_t* a, const quadric_t* b, const amos_vec3_t* p) {
+    double q[10];
+    for (int i = 0; i < 10; i++) {
+        q[i] = a->q[i] + b->q[i];
+    }
+
+    double x = p->x, y = p->y, z = p->z;
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x +
+           q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y +
+           q[7] * z * z + 2 * q[8] * z +
+           q[9];
+}
+
+// Find the vertex a collapsed vertex now lives in
+static uint32_t resolve(simplifier_t* s, uint32_t v) {
+    while (s->remap[v] != v) {
+        s->remap[v] = s->remap[s->remap[v]];
+        v = s->remap[v];
+    }
+    return v;
+}
+
+static float collapse_cost(simplifier_t* s, uint32_t from, uint32_t to) {
+    return (float)fabs(quadric_eval(&s->quadrics[from], &s->quadrics[to], &s->positions[to]));
+}
+
+static void triangle_normal(const amos_vec3_t* a, const amos_vec3_t* b, const amos_vec3_t* c, amos_vec3_t* n) {
+    amos_vec3_t e1, e2;
+    amos_vec3_subtract(b, a, &e1);
+    amos_vec3_subtract(c, a, &e2);
+    amos_vec3_cross(&e1, &e2, n);
+}
+
+// Drop dead triangles from a vertex list so later walks stay short
+static void compact_list(simplifier_t* s, uint32_t v) {
+    uint32_t prev = NONE;
+    for (uint32_t node = s->list_head[v]; node != NONE; node = s->list_next[node]) {
+        if (!s->dead[node / 3]) {
+            prev = node;
+            continue;
+        }
+        if (prev == NONE) {
+            s->list_head[v] = s->list_next[node];
+        } else {
+            s->list_next[prev] = s->list_next[node];
+        }
+        if (s->list_tail[v] == node) {
+            s->list_tail[v] = prev;
+        }
+    }
+}
+
+// Reject collapses that would flip a surviving triangle
+static bool collapse_flips(simplifier_t* s, uint32_t from, uint32_t to) {
+    for (uint32_t node = s->list_head[from]; node != NONE; node = s->list_next[node]) {
+        uint32_t t = node / 3;
+        if (s->dead[t]) {
+            continue;
+        }
+
+        uint32_t v[3];
+        bool has_to = false;
+        for (int k = 0; k < 3; k++) {
+            v[k] = resolve(s, s->indices[t * 3 + k]);
+            has_to |= v[k] == to;
+        }
+        if (has_to) {
+            continue;
+        }
+
+        amos_vec3_t before, after;
+        amos_vec3_t p[3];
+        for (int k = 0; k < 3; k++) {
+            p[k] = s->positions[v[k]];
+        }
+        triangle_normal(&p[0], &p[1], &p[2], &before);
+        for (int k = 0; k < 3; k++) {
+            if (v[k] == from) {
+                p[k] = s->positions[to];
+            }
+        }
+        triangle_normal(&p[0], &p[1], &p[2], &after);
+
+        if (amos_vec3_dot(&before, &after) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void collapse(simplifier_t* s, const collapse_t* c) {
+    uint32_t from = c->from;
+    uint32_t to = c->to;
+
+    // Triangles spanning the collapsed edge disappear
+    for (uint32_t node = s->list_head[from]; node != NONE; node = s->list_next[node]) {
+        uint32_t t = node / 3;
+        if (s->dead[t]) {
+            continue;
+        }
+        for (int k = 0; k < 3; k++) {
+            if (resolve(s, s->indices[t * 3 + k]) == to) {
+                s->dead[t] = 1;
+                s->live_triangles--;
+                break;
+            }
+        }
+    }
+
+    s->remap[from] = to;
+    for (int i = 0; i < 10; i++) {
+        s->quadrics[to].q[i] += s->quadrics[from].q[i];
+    }
+
+    if (s->list_head[from] != NONE) {
+        if (s->list_head[to] == NONE) {
+            s->list_head[to] = s->list_head[from];
+        } else {
+            s->list_next[s->list_tail[to]] = s->list_head[from];
+        }
+        s->list_tail[to] = s->list_tail[from];
+        s->list_head[from] = NONE;
+    }
+    compact_list(s, to);
+
+    // Lock the neighbourhood: costs around it are stale until the next pass
+    s->locked[to] = 1;
+    for (uint32_t node = s->list_head[to]; node != NONE; node = s->list_next[node]) {
+        uint32_t t = node / 3;
+        for (int k = 0; k < 3; k++) {
+            s->locked[resolve(s, s->indices[t * 3 + k])] = 1;
+        }
+    }
+
+    if (c->cost > s->max_error) {
+        s->max_error = c->cost;
+    }
+}
+
+static int compare_edges(const void* a, const void* b) {
+    uint64_t ka = ((const edge_t*)a)->key;
+    uint64_t kb = ((const edge_t*)b)->key;
+    return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+static int compare_collapses(const void* a, const void* b) {
+    float ca = ((const collapse_t*)a)->cost;
+    float cb = ((const collapse_t*)b)->cost;
+    return ca < cb ? -1 : (ca > cb ? 1 : 0);
+}
+
+// Build quadrics and adjacency
+static bool simplifier_init(simplifier_t* s, const amos_mesh_t* mesh) {
+    memset(s, 0, sizeof(simplifier_t));
+    s->vertex_count = (uint32_t)mesh->vertex_count;
+    s->triangle_count = (uint32_t)mesh->index_count / 3;
+    s->indices = mesh->indices;
+
+    uint32_t vc = s->vertex_count;
+    uint32_t tc = s->triangle_count;
+
+    s->positions = (amos_vec3_t*)malloc(vc * sizeof(amos_vec3_t));
+    s->quadrics = (quadric_t*)calloc(vc, sizeof(quadric_t));
+    s->remap = (uint32_t*)malloc(vc * sizeof(uint32_t));
+    s->locked = (uint8_t*)calloc(vc, 1);
+    s->dead = (uint8_t*)calloc(tc, 1);
+    s->list_head = (uint32_t*)malloc(vc * sizeof(uint32_t));
+    s->list_tail = (uint32_t*)malloc(vc * sizeof(uint32_t));
+    s->list_next = (uint32_t*)malloc((size_t)tc * 3 * sizeof(uint32_t));
+    s->candidates = (collapse_t*)malloc((size_t)tc * 3 * sizeof(collapse_t));
+    edge_t* edges = (edge_t*)malloc((size_t)tc * 3 * sizeof(edge_t));
+
+    if (!s->positions || !s->quadrics || !s->remap || !s->locked || !s->dead ||
+        !s->list_head || !s->list_tail || !s->list_next || !s->candidates || !edges) {
+        free(edges);
+        return false;
+    }
+
+    for (uint32_t v = 0; v < vc; v++) {
+        amos_vertex_t vertex;
+        amos_mesh_fetch_vertex(mesh, v, &vertex);
+        s->positions[v] = vertex.position;
+        s->remap[v] = v;
+        s->list_head[v] = NONE;
+        s->list_tail[v] = NONE;
+    }
+
+    size_t edge_count = 0;
+    for (uint32_t t = 0; t < tc; t++) {
+        const uint32_t* tri = &s->indices[t * 3];
+
+        if (tri[0] >= vc || tri[1] >= vc || tri[2] >= vc ||
+            tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+            s->dead[t] = 1;
+            continue;
+        }
+        s->live_triangles++;
+
+        // Face plane quadric
+        amos_vec3_t n;
+        triangle_normal(&s->positions[tri[0]], &s->positions[tri[1]], &s->positions[tri[2]], &n);
+        if (amos_vec3_length(&n) > 0.0f) {
+            amos_vec3_normalize_exact(&n, &n);
+            double d = -amos_vec3_dot(&n, &s->positions[tri[0]]);
+            for (int k = 0; k < 3; k++) {
+                quadric_add_plane(&s->quadrics[tri[k]], n.x, n.y, n.z, d, 1.0);
+            }
+        }
+
+        for (int k = 0; k < 3; k++) {
+            uint32_t node = t * 3 + k;
+            uint32_t v = tri[k];
+            s->list_next[node] = NONE;
+            if (s->list_head[v] == NONE) {
+                s->list_head[v] = node;
+            } else {
+                s->list_next[s->list_tail[v]] = node;
+            }
+            s->list_tail[v] = node;
+
+            uint32_t a = tri[k];
+            uint32_t b = tri[(k + 1) % 3];
+            edges[edge_count].key = a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+            edges[edge_count].triangle = t;
+            edge_count++;
+        }
+    }
+
+    qsort(edges, edge_count, sizeof(edge_t), compare_edges);
+
+    for (size_t i = 0; i < edge_count;) {
+        size_t j = i + 1;
+        while (j < edge_count && edges[j].key == edges[i].key) {
+            j++;
+        }
+
+        // Border edge: add a plane perpendicular to the face through the edge
+        if (j - i == 1) {
+            uint32_t a = (uint32_t)(edges[i].key >> 32);
+            uint32_t b = (uint32_t)(edges[i].key & 0xffffffffu);
+            const uint32_t* tri = &s->indices[edges[i].triangle * 3];
+            amos_vec3_t face, dir, n;
+            triangle_normal(&s->positions[tri[0]], &s->positions[tri[1]], &s->positions[tri[2]], &face);
+            amos_vec3_subtract(&s->positions[b], &s->positions[a], &dir);
+            amos_vec3_cross(&dir, &face, &n);
+            if (amos_vec3_length(&n) > 0.0f) {
+                amos_vec3_normalize_exact(&n, &n);
+                double d = -amos_vec3_dot(&n, &s->positions[a]);
+                quadric_add_plane(&s->quadrics[a], n.x, n.y, n.z, d, BOUNDARY_WEIGHT);
+                quadric_add_plane(&s->quadrics[b], n.x, n.y, n.z, d, BOUNDARY_WEIGHT);
+            }
+        }
+
+        i = j;
+    }
+
+    free(edges);
+    return true;
+}
+
+static void simplifier_cleanup(simplifier_t* s) {
+    free(s->positions);
+    free(s->quadrics);
+    free(s->remap);
+    free(s->locked);
+    free(s->dead);
+    free(s->list_head);
+    free(s->list_tail);
+    free(s->list_next);
+    free(s->candidates);
+}
+
+// Collapse edges until at most target triangles remain.
+// Each pass ranks every live edge by its cheaper collapse direction and
+// performs collapses in order, skipping vertices whose neighbourhood
+// already changed during the pass.
+static void simplify_to(simplifier_t* s, uint32_t target) {
+    while (s->live_triangles > target) {
+        size_t count = 0;
+        for (uint32_t t = 0; t < s->triangle_count; t++) {
+            if (s->dead[t]) {
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = resolve(s, s->indices[t * 3 + k]);
+                uint32_t b = resolve(s, s->indices[t * 3 + (k + 1) % 3]);
+                float ab = collapse_cost(s, a, b);
+                float ba = collapse_cost(s, b, a);
+                collapse_t* c = &s->candidates[count++];
+                c->cost = ab <= ba ? ab : ba;
+                c->from = ab <= ba ? a : b;
+                c->to = ab <= ba ? b : a;
+            }
+        }
+
+        qsort(s->candidates, count, sizeof(collapse_t), compare_collapses);
+        memset(s->locked, 0, s->vertex_count);
+
+        uint32_t before = s->live_triangles;
+        for (size_t i = 0; i < count && s->live_triangles > target; i++) {
+            const collapse_t* c = &s->candidates[i];
+
+            if (s->locked[c->from] || s->locked[c->to] ||
+                s->remap[c->from] != c->from || s->remap[c->to] != c->to) {
+                continue;
+            }
+
+            if (collapse_flips(s, c->from, c->to)) {
+                continue;
+            }
+
+            collapse(s, c);
+        }
+
+        if (s->live_triangles == before) {
+            break;
+        }
+    }
+}
+
+// Copy the surviving triangles and vertices into a new mesh
+static amos_mesh_t* emit_level(simplifier_t* s, const amos_mesh_t* source, uint32_t* out_index) {
+    amos_mesh_t* mesh = (amos_mesh_t*)calloc(1, sizeof(amos_mesh_t));
+    if (!mesh) {
+        return NULL;
+    }
+
+    memset(out_index, 0xff, s->vertex_count * sizeof(uint32_t));
+
+    uint32_t vertex_count = 0;
+    for (uint32_t t = 0; t < s->triangle_count; t++) {
+        if (s->dead[t]) {
+            continue;
+        }
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = resolve(s, s->indices[t * 3 + k]);
+            if (out_index[v] == NONE) {
+                out_index[v] = vertex_count++;
+            }
+        }
+    }
+
+    mesh->vertices = (amos_vertex_t*)malloc(vertex_count * sizeof(amos_vertex_t));
+    mesh->indices = (uint32_t*)malloc((size_t)s->live_triangles * 3 * sizeof(uint32_t));
+    if (!mesh->vertices || !mesh->indices) {
+        free(mesh->vertices);
+        free(mesh->indices);
+        free(mesh);
+        return NULL;
+    }
+
+    for (uint32_t v = 0; v < s->vertex_count; v++) {
+        if (out_index[v] != NONE) {
+            amos_mesh_fetch_vertex(source, v, &mesh->vertices[out_index[v]]);
+        }
+    }
+
+    uint32_t n = 0;
+    for (uint32_t t = 0; t < s->triangle_count; t++) {
+        if (s->dead[t]) {
+            continue;
+        }
+        for (int k = 0; k < 3; k++) {
+            mesh->indices[n++] = out_index[resolve(s, s->indices[t * 3 + k])];
+        }
+    }
+
+    mesh->vertex_count = (int)vertex_count;
+    mesh->index_count = (int)n;
+    mesh->material = source->material;
+    mesh->bounds = source->bounds;
+
+    return mesh;
+}
+
+// Build a LOD chain for a mesh
+bool amos_mesh_lod_build(amos_mesh_lod_chain_t* chain, const amos_mesh_t* mesh, int level_count) {
+    if (!chain || !mesh || !mesh->indices || mesh->vertex_count <= 0 || mesh->index_count < 3 ||
+        (!mesh->vertices && !mesh->positions)) {
+        return false;
+    }
+
+    if (level_count < AMOS_MESH_LOD_MIN_LEVELS) {
+        level_count = AMOS_MESH_LOD_MIN_LEVELS;
+    } else if (level_count > AMOS_MESH_LOD_MAX_LEVELS) {
+        level_count = AMOS_MESH_LOD_MAX_LEVELS;
+    }
+
+    memset(chain, 0, sizeof(amos_mesh_lod_chain_t));
+    chain->levels[0] = mesh;
+    chain->errors[0] = 0.0f;
+    chain->triangle_counts[0] = mesh->index_count / 3;
+    chain->level_count = 1;
+
+    simplifier_t s;
+    memset(&s, 0, sizeof(s));
+    uint32_t* out_index = (uint32_t*)malloc(mesh->vertex_count * sizeof(uint32_t));
+    if (!out_index || !simplifier_init(&s, mesh)) {
+        printf("Failed to initialize mesh simplifier\n");
+        free(out_index);
+        simplifier_cleanup(&s);
+        return false;
+    }
+
+    // Procedural meshes carry no bounds; derive them for LOD selection
+    chain->bounds = mesh->bounds;
+    if (chain->bounds.radius <= 0.0f) {
+        amos_mesh_compute_bounds(s.positions, s.vertex_count, &chain->bounds);
+    }
+
+    bool ok = true;
+    uint32_t target = s.live_triangles;
+    for (int level = 1; level < level_count; level++) {
+        target /= 2;
+        uint32_t before = s.live_triangles;
+
+        simplify_to(&s, target);
+
+        // Stop once the mesh cannot be reduced any further
+        if (s.live_triangles == before || s.live_triangles == 0) {
+            break;
+        }
+
+        amos_mesh_t* lod = emit_level(&s, mesh, out_index);
+        if (!lod) {
+            ok = false;
+            break;
+        }
+
+        chain->levels[level] = lod;
+        chain->errors[level] = sqrtf(s.max_error);
+        chain->triangle_counts[level] = (int)s.live_triangles;
+        chain->level_count++;
+    }
+
+    simplifier_cleanup(&s);
+    free(out_index);
+
+    if (!ok) {
+        printf("Failed to build mesh LOD chain\n");
+        amos_mesh_lod_destroy(chain);
+    }
+
+    return ok;
+}
+
+// Destroy a LOD chain and the simplified meshes it owns
+void amos_mesh_lod_destroy(amos_mesh_lod_chain_t* chain) {
+    if (!chain) {
+        return;
+    }
+
+    for (int i = 1; i < chain->level_count; i++) {
+        amos_mesh_t* lod = (amos_mesh_t*)chain->levels[i];
+        if (lod) {
+            free(lod->vertices);
+            free(lod->indices);
+            free(lod);
+        }
+    }
+
+    memset(chain, 0, sizeof(amos_mesh_lod_chain_t));
+}
+
+// Select a LOD level from the projected screen-space error
+int amos_mesh_lod_select(
+    const amos_mesh_lod_chain_t* chain,
+    const amos_renderer3d_t* renderer,
+    const amos_mat4_t* model_matrix,
+    float pixel_error,
+    int current_level
+) {
+    if (!chain || chain->level_count == 0 || !renderer || !model_matrix) {
+        return 0;
+    }
+
+    const amos_mat4_t* m = model_matrix;
+    const amos_bounds_t* b = &chain->bounds;
+
+    // World-space bounding sphere (scale taken from the longest basis vector)
+    amos_vec3_t center = {
+        b->center.x * m->m[0][0] + b->center.y * m->m[0][1] + b->center.z * m->m[0][2] + m->m[0][3],
+        b->center.x * m->m[1][0] + b->center.y * m->m[1][1] + b->center.z * m->m[1][2] + m->m[1][3],
+        b->center.x * m->m[2][0] + b->center.y * m->m[2][1] + b->center.z * m->m[2][2] + m->m[2][3]
+    };
+
+    float scale = 0.0f;
+    for (int i = 0; i < 3; i++) {
+        amos_vec3_t axis = {m->m[0][i], m->m[1][i], m->m[2][i]};
+        float len = amos_vec3_length(&axis);
+        if (len > scale) {
+            scale = len;
+        }
+    }
+
+    amos_vec3_t to_center;
+    amos_vec3_subtract(&center, &renderer->camera.position, &to_center);
+    float distance = amos_vec3_length(&to_center) - b->radius * scale;
+
+    if (distance <= renderer->camera.near_clip) {
+        return 0;
+    }
+
+    float half_fov = renderer->camera.fov * 0.5f * 3.14159265f / 180.0f;
+    float pixels_per_unit = renderer->height / (2.0f * distance * tanf(half_fov));
+
+    int level = current_level;
+    if (level < 0) {
+        level = 0;
+    } else if (level >= chain->level_count) {
+        level = chain->level_count - 1;
+    }
+
+    // Refine immediately when the current level is too coarse
+    while (level > 0 && chain->errors[level] * scale * pixels_per_unit > pixel_error) {
+        level--;
+    }
+
+    // Only coarsen once the next level is comfortably under the threshold
+    float coarsen_error = pixel_error * (1.0f - AMOS_MESH_LOD_HYSTERESIS);
+    while (level + 1 < chain->level_count &&
+           chain->errors[level + 1] * scale * pixels_per_unit <= coarsen_error) {
+        level++;
+    }
+
+    return level;
+}
+
+// Render a mesh through its LOD chain
+void amos_renderer3d_render_mesh_lod(
+    amos_renderer3d_t* renderer,
+    const amos_mesh_lod_chain_t* chain,
+    int* current_level
+) {
+    if (!renderer || !chain || chain->level_count == 0 || !current_level) {
+        return;
+    }
+
+    int level = amos_mesh_lod_select(chain, renderer, &renderer->model_matrix,
+                                     AMOS_MESH_LOD_PIXEL_ERROR, *current_level);
+    *current_level = level;
+
+    renderer->stats.triangles_saved += (uint32_t)(chain->triangle_counts[0] - chain->triangle_counts[level]);
+
+    amos_renderer3d_draw_mesh(renderer, chain->levels[level]);
+}
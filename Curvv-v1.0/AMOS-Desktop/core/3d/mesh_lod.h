@@ -0,0 +1,92 @@
+/**
+ * AMOS Desktop OS - Mesh Level of Detail
+ *
+ * This file defines automatic LOD chain generation for AMOS meshes
+ * using quadric error metric edge collapse, and screen-space LOD
+ * selection with hysteresis.
+ */
+
+#ifndef AMOS_MESH_LOD_H
+#define AMOS_MESH_LOD_H
+
+#include "renderer3d.h"
+
+// Limits on the number of levels in a chain (including the source mesh)
+#define AMOS_MESH_LOD_MIN_LEVELS 3
+#define AMOS_MESH_LOD_MAX_LEVELS 5
+
+// Default maximum projected simplification error in pixels
+#define AMOS_MESH_LOD_PIXEL_ERROR 1.0f
+
+// Fraction the projected error must drop below the threshold before
+// switching to a coarser level, so objects near a boundary don't flicker
+#define AMOS_MESH_LOD_HYSTERESIS 0.25f
+
+// LOD chain
+typedef struct {
+    const amos_mesh_t* levels[AMOS_MESH_LOD_MAX_LEVELS]; // levels[0] is the source mesh
+    float errors[AMOS_MESH_LOD_MAX_LEVELS];              // Geometric error in object units
+    int triangle_counts[AMOS_MESH_LOD_MAX_LEVELS];
+    amos_bounds_t bounds;                                // Bounds of the source mesh
+    int level_count;
+} amos_mesh_lod_chain_t;
+
+/**
+ * Build a LOD chain for a mesh
+ *
+ * Each level halves the triangle count of the previous one. Levels
+ * stop early if the mesh cannot be simplified further. The source
+ * mesh is referenced, not copied, and must outlive the chain.
+ *
+ * @param chain Chain to fill in
+ * @param mesh Source mesh (interleaved or SoA)
+ * @param level_count Requested number of levels, clamped to 3..5
+ * @return true if the chain was built, false otherwise
+ */
+bool amos_mesh_lod_build(amos_mesh_lod_chain_t* chain, const amos_mesh_t* mesh, int level_count);
+
+/**
+ * Destroy a LOD chain and the simplified meshes it owns
+ *
+ * @param chain Chain to destroy
+ */
+void amos_mesh_lod_destroy(amos_mesh_lod_chain_t* chain);
+
+/**
+ * Select a LOD level from the projected screen-space error
+ *
+ * Hysteresis works from the level the instance used last frame, so
+ * every instance of a chain keeps its own level (start with 0).
+ *
+ * @param chain LOD chain
+ * @param renderer Renderer (camera and viewport)
+ * @param model_matrix Model matrix of the instance
+ * @param pixel_error Maximum tolerated error in pixels
+ * @param current_level Level the instance used last frame
+ * @return Selected level index
+ */
+int amos_mesh_lod_select(
+    const amos_mesh_lod_chain_t* chain,
+    const amos_renderer3d_t* renderer,
+    const amos_mat4_t* model_matrix,
+    float pixel_error,
+    int current_level
+);
+
+/**
+ * Render a mesh through its LOD chain
+ *
+ * Uses the renderer's current model matrix and records the number of
+ * triangles saved in the renderer statistics.
+ *
+ * @param renderer Pointer to renderer structure
+ * @param chain LOD chain
+ * @param current_level The instance's level, updated to the one drawn
+ */
+void amos_renderer3d_render_mesh_lod(
+    amos_renderer3d_t* renderer,
+    const amos_mesh_lod_chain_t* chain,
+    int* current_level
+);
+
+#endif /* AMOS_MESH_LOD_H */
@@ -0,0 +1,822 @@
+/**
+ * AMOS Desktop OS - Specialized Raster Pipelines
+ *
+ * This file implements mesh drawing for the AMOS 3D renderer. The
+ * vertex stage transforms a mesh once per draw; triangles are then
+ * handed to a rasterizer chosen from a table of variants generated by
+ * pipeline_variant.inl, or to the generic path that runs the
+ * material's shader program per vertex and per fragment.
+ */
+
+#include "pipeline.h"
+#include "shaders.h"
+#include "shader_dsl.h"
+#include "mesh_format.h"
+#include "light_culling.h"
+#include "light_eval.inl"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Shading models as preprocessor constants for the variant template
+#define RV_FLAT 0
+#define RV_GOURAUD 1
+#define RV_PHONG 2
+
+#define RV_PASTE2(a, b) a##b
+#define RV_PASTE(a, b) RV_PASTE2(a, b)
+
+// Variants per shading model (textured x depth test x single light)
+#define RV_SET_SIZE 8
+
+// Vertices or fragments shaded together by the generic path
+#define PIPELINE_BATCH AMOS_SHADER_DSL_LANES
+
+// Per-pixel draws with at least this many lights shade from tile lists
+#define PIPELINE_TILED_LIGHTS 8
+
+// Scratch buffers reused across draws
+struct amos_pipeline_cache_t {
+    amos_raster_vertex_t* vertices;
+    int vertex_capacity;
+    uint8_t* varyings;          // Generic path: per-vertex varyings plus one fragment batch
+    size_t varying_capacity;
+    uint32_t* triangles;        // First index of each triangle that survived binning
+    int triangle_capacity;
+    amos_light_grid_t light_grid;   // Per-tile light lists, rebuilt per draw
+    bool light_grid_ready;      // light_grid has been initialized
+};
+
+// Material used when a mesh has none
+static const amos_material_t default_material = {
+    {0.1f, 0.1f, 0.1f, 1.0f},
+    {0.8f, 0.8f, 0.8f, 1.0f},
+    {0.0f, 0.0f, 0.0f, 1.0f},
+    32.0f,
+    NULL,
+    NULL,
+    AMOS_SHADING_GOURAUD
+};
+
+// Normalize in place, leaving zero vectors untouched
+static inline void pipeline_normalize(amos_vec3_t* v) {
+    float len_sq = v->x * v->x + v->y * v->y + v->z * v->z;
+    if (len_sq > 0.0f) {
+        float inv_len = 1.0f / sqrtf(len_sq);
+        v->x *= inv_len;
+        v->y *= inv_len;
+        v->z *= inv_len;
+    }
+}
+
+// Evaluate material lighting at a surface point
+static inline void pipeline_light(
+    const amos_raster_context_t* context,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    int light_count,
+    amos_vec3_t* color
+) {
+    amos_vec3_t view_dir = {
+        context->eye.x - position->x,
+        context->eye.y - position->y,
+        context->eye.z - position->z
+    };
+    pipeline_normalize(&view_dir);
+
+    amos_vec3_t diffuse = {0.0f, 0.0f, 0.0f};
+    amos_vec3_t specular = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < light_count; i++) {
+        amos_light_eval(&context->lights[i], position, normal, &view_dir,
+                        context->shininess, &diffuse, &specular);
+    }
+
+    color->x = context->ambient.x + context->diffuse.x * diffuse.x + context->specular.x * specular.x;
+    color->y = context->ambient.y + context->diffuse.y * diffuse.y + context->specular.y * specular.y;
+    color->z = context->ambient.z + context->diffuse.z * diffuse.z + context->specular.z * specular.z;
+}
+
+// Evaluate material lighting at a pixel with only the lights of its tile.
+// The tile list and the global list are merged in light order, so the
+// sums are accumulated exactly as pipeline_light accumulates them.
+static inline void pipeline_light_tiled(
+    const amos_raster_context_t* context,
+    int x,
+    int y,
+    const amos_vec3_t* position,
+    const amos_vec3_t* normal,
+    amos_vec3_t* color
+) {
+    const amos_light_grid_t* grid = context->light_grid;
+    amos_vec3_t view_dir = {
+        context->eye.x - position->x,
+        context->eye.y - position->y,
+        context->eye.z - position->z
+    };
+    pipeline_normalize(&view_dir);
+
+    int t = (y / AMOS_LIGHT_TILE_SIZE) * grid->tiles_x + x / AMOS_LIGHT_TILE_SIZE;
+    const uint32_t* tile = grid->tile_lights + grid->tile_offsets[t];
+    const uint32_t* tile_end = grid->tile_lights + grid->tile_offsets[t + 1];
+    const uint32_t* global = grid->global_lights;
+    const uint32_t* global_end = global + grid->global_light_count;
+
+    amos_vec3_t diffuse = {0.0f, 0.0f, 0.0f};
+    amos_vec3_t specular = {0.0f, 0.0f, 0.0f};
+    while (tile < tile_end || global < global_end) {
+        uint32_t index;
+        if (global == global_end || (tile < tile_end && *tile < *global)) {
+            index = *tile++;
+        } else {
+            index = *global++;
+        }
+        amos_light_eval(&context->lights[index], position, normal, &view_dir,
+                        context->shininess, &diffuse, &specular);
+    }
+
+    color->x = context->ambient.x + context->diffuse.x * diffuse.x + context->specular.x * specular.x;
+    color->y = context->ambient.y + context->diffuse.y * diffuse.y + context->specular.y * specular.y;
+    color->z = context->ambient.z + context->diffuse.z * diffuse.z + context->specular.z * specular.z;
+}
+
+// Mip level for a pixel covering `footprint` level-0 texels:
+// round(log2(footprint) / 2), read from the float exponent
+static inline const amos_texture_level_t* pipeline_mip_level(
+    const amos_raster_context_t* context,
+    float footprint
+) {
+    union {
+        float f;
+        uint32_t u;
+    } bits = {footprint * 2.0f};
+    int level = ((int)((bits.u >> 23) & 0xFF) - 127) >> 1;
+    if (level < 0) {
+        level = 0;
+    } else if (level > context->texture_max_level) {
+        level = context->texture_max_level;
+    }
+    return &context->texture_levels[level];
+}
+
+// Nearest-neighbour texture lookup with wrapping
+static inline uint32_t pipeline_sample(const amos_texture_level_t* level, float u, float v) {
+    u -= floorf(u);
+    v -= floorf(v);
+    int tx = (int)(u * (float)level->width);
+    int ty = (int)(v * (float)level->height);
+    if (tx >= level->width) {
+        tx = level->width - 1;
+    }
+    if (ty >= level->height) {
+        ty = level->height - 1;
+    }
+    return level->texels[(size_t)ty * level->pitch + tx];
+}
+
+static inline uint32_t pack_channel(float c) {
+    if (c <= 0.0f) {
+        return 0;
+    }
+    if (c >= 1.0f) {
+        return 255;
+    }
+    return (uint32_t)(c * 255.0f + 0.5f);
+}
+
+// Pack a linear colour into the framebuffer's RGBA layout
+static inline uint32_t pipeline_pack(const amos_vec3_t* color) {
+    return 0xFF000000u |
+           (pack_channel(color->z) << 16) |
+           (pack_channel(color->y) << 8) |
+           pack_channel(color->x);
+}
+
+// Draw one edge in a fixed colour, one pixel per step along the major axis
+static uint64_t wireframe_edge(
+    amos_raster_context_t* context,
+    const amos_raster_vertex_t* a,
+    const amos_raster_vertex_t* b,
+    uint32_t color
+) {
+    float dx = b->x - a->x;
+    float dy = b->y - a->y;
+    int steps = (int)ceilf(fmaxf(fabsf(dx), fabsf(dy)));
+    float step = steps > 0 ? 1.0f / (float)steps : 0.0f;
+
+    uint64_t fragments = 0;
+    for (int i = 0; i <= steps; i++) {
+        float t = (float)i * step;
+        int x = (int)floorf(a->x + dx * t);
+        int y = (int)floorf(a->y + dy * t);
+        if (x < 0 || y < 0 || x >= context->width || y >= context->height) {
+            continue;
+        }
+        context->color[(size_t)y * context->pitch + x] = color;
+        fragments++;
+    }
+    return fragments;
+}
+
+// Wireframe mode: the triangle's edges in the unlit diffuse colour
+static void raster_wireframe(
+    amos_raster_context_t* context,
+    const amos_raster_vertex_t* v0,
+    const amos_raster_vertex_t* v1,
+    const amos_raster_vertex_t* v2
+) {
+    uint32_t color = pipeline_pack(&context->diffuse);
+    context->fragments += wireframe_edge(context, v0, v1, color);
+    context->fragments += wireframe_edge(context, v1, v2, color);
+    context->fragments += wireframe_edge(context, v2, v0, color);
+}
+
+#define RV_PREFIX raster_flat
+#define RV_SHADING RV_FLAT
+#include "pipeline_variant_set.inl"
+
+#define RV_PREFIX raster_gouraud
+#define RV_SHADING RV_GOURAUD
+#include "pipeline_variant_set.inl"
+
+#define RV_PREFIX raster_phong
+#define RV_SHADING RV_PHONG
+#include "pipeline_variant_set.inl"
+
+#define RV_SET_ENTRIES(prefix) \
+    prefix##_t0_d0_s0, prefix##_t0_d0_s1, prefix##_t0_d1_s0, prefix##_t0_d1_s1, \
+    prefix##_t1_d0_s0, prefix##_t1_d0_s1, prefix##_t1_d1_s0, prefix##_t1_d1_s1
+
+// Gouraud lighting happens per vertex, so its rasterizers do not depend
+// on the light count and one variant serves both entries
+#define RV_SET_ENTRIES_UNLIT(prefix) \
+    prefix##_t0_d0, prefix##_t0_d0, prefix##_t0_d1, prefix##_t0_d1, \
+    prefix##_t1_d0, prefix##_t1_d0, prefix##_t1_d1, prefix##_t1_d1
+
+// Indexed by shading * 8 + textured * 4 + depth_test * 2 + single_light
+static const amos_raster_fn raster_variants[3 * RV_SET_SIZE] = {
+    RV_SET_ENTRIES(raster_flat),
+    RV_SET_ENTRIES_UNLIT(raster_gouraud),
+    RV_SET_ENTRIES(raster_phong)
+};
+
+// Select the specialized pipeline variant for a material
+amos_raster_fn amos_pipeline_select(
+    const amos_renderer3d_t* renderer,
+    const amos_material_t* material
+) {
+    if (!renderer || !renderer->color_buffer || renderer->color_buffer->bytes_per_pixel != 4) {
+        return NULL;
+    }
+
+    if (!material) {
+        material = &default_material;
+    }
+
+    const amos_framebuffer_t* texture = material->diffuse_texture;
+    if (texture && (!texture->buffer || texture->bytes_per_pixel != 4 ||
+                    texture->width <= 0 || texture->height <= 0)) {
+        return NULL;
+    }
+
+    // Wireframe draws only edges, whatever the material shades with
+    if (renderer->wireframe_mode) {
+        return raster_wireframe;
+    }
+
+    // Programmable draws go through the generic path
+    if (material->shader || renderer->current_shader) {
+        return NULL;
+    }
+
+    int shading = (int)material->shading_model;
+    if (shading < RV_FLAT || shading > RV_PHONG) {
+        shading = RV_GOURAUD;
+    }
+
+    int textured = texture ? 1 : 0;
+    int depth_test = (renderer->depth_test_enabled && renderer->depth_buffer) ? 1 : 0;
+    int single_light = renderer->light_count == 1 ? 1 : 0;
+
+    return raster_variants[shading * RV_SET_SIZE + textured * 4 + depth_test * 2 + single_light];
+}
+
+// Grow the scratch buffers to fit a draw
+static bool reserve_cache(amos_renderer3d_t* renderer, const amos_mesh_t* mesh, size_t varying_bytes) {
+    int vertex_count = mesh->vertex_count;
+    int triangle_count = mesh->index_count / 3;
+
+    struct amos_pipeline_cache_t* cache = renderer->pipeline_cache;
+    if (!cache) {
+        cache = (struct amos_pipeline_cache_t*)calloc(1, sizeof(*cache));
+        if (!cache) {
+            printf("Failed to allocate pipeline cache\n");
+            return false;
+        }
+        renderer->pipeline_cache = cache;
+    }
+
+    if (vertex_count > cache->vertex_capacity) {
+        amos_raster_vertex_t* vertices = (amos_raster_vertex_t*)realloc(
+            cache->vertices, (size_t)vertex_count * sizeof(amos_raster_vertex_t));
+        if (!vertices) {
+            printf("Failed to allocate %d transformed vertices\n", vertex_count);
+            return false;
+        }
+        cache->vertices = vertices;
+        cache->vertex_capacity = vertex_count;
+    }
+
+    if (triangle_count > cache->triangle_capacity) {
+        uint32_t* triangles = (uint32_t*)realloc(cache->triangles, (size_t)triangle_count * sizeof(uint32_t));
+        if (!triangles) {
+            printf("Failed to allocate triangle list for %d triangles\n", triangle_count);
+            return false;
+        }
+        cache->triangles = triangles;
+        cache->triangle_capacity = triangle_count;
+    }
+
+    if (varying_bytes > cache->varying_capacity) {
+        uint8_t* varyings = (uint8_t*)realloc(cache->varyings, varying_bytes);
+        if (!varyings) {
+            printf("Failed to allocate varying storage\n");
+            return false;
+        }
+        cache->varyings = varyings;
+        cache->varying_capacity = varying_bytes;
+    }
+
+    return true;
+}
+
+// Row-major matrix times point (w = 1)
+static void transform_point(const amos_mat4_t* m, const amos_vec3_t* p, amos_vec4_t* result) {
+    result->x = m->m[0][0] * p->x + m->m[0][1] * p->y + m->m[0][2] * p->z + m->m[0][3];
+    result->y = m->m[1][0] * p->x + m->m[1][1] * p->y + m->m[1][2] * p->z + m->m[1][3];
+    result->z = m->m[2][0] * p->x + m->m[2][1] * p->y + m->m[2][2] * p->z + m->m[2][3];
+    result->w = m->m[3][0] * p->x + m->m[3][1] * p->y + m->m[3][2] * p->z + m->m[3][3];
+}
+
+// Clip-space position to window coordinates
+static void to_window(const amos_renderer3d_t* renderer, const amos_vec4_t* clip, amos_raster_vertex_t* out) {
+    out->depth = clip->w;
+    if (clip->w < renderer->camera.near_clip) {
+        out->inv_w = 0.0f;
+        out->x = 0.0f;
+        out->y = 0.0f;
+        return;
+    }
+    out->inv_w = 1.0f / clip->w;
+    out->x = (clip->x * out->inv_w * 0.5f + 0.5f) * (float)renderer->width;
+    out->y = (0.5f - clip->y * out->inv_w * 0.5f) * (float)renderer->height;
+}
+
+// Reject triangles crossing the near plane and (optionally) back faces
+static bool triangle_visible(
+    const amos_renderer3d_t* renderer,
+    const amos_raster_vertex_t* v0,
+    const amos_raster_vertex_t* v1,
+    const amos_raster_vertex_t* v2
+) {
+    if (v0->inv_w == 0.0f || v1->inv_w == 0.0f || v2->inv_w == 0.0f) {
+        return false;
+    }
+
+    if (renderer->backface_culling_enabled) {
+        // Counter-clockwise front faces have negative area with y pointing down
+        float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+        if (area >= 0.0f) {
+            return false;
+        }
+    }
+
+    // Entirely outside the viewport
+    float width = (float)renderer->width;
+    float height = (float)renderer->height;
+    if ((v0->x < 0.0f && v1->x < 0.0f && v2->x < 0.0f) ||
+        (v0->y < 0.0f && v1->y < 0.0f && v2->y < 0.0f) ||
+        (v0->x > width && v1->x > width && v2->x > width) ||
+        (v0->y > height && v1->y > height && v2->y > height)) {
+        return false;
+    }
+
+    return true;
+}
+
+// Collect the triangles worth rasterizing; returns how many were kept
+static int bin_triangles(
+    const amos_renderer3d_t* renderer,
+    const amos_mesh_t* mesh,
+    const amos_raster_vertex_t* out,
+    uint32_t* triangles
+) {
+    int count = 0;
+    for (int i = 0; i + 2 < mesh->index_count; i += 3) {
+        uint32_t i0 = mesh->indices[i];
+        uint32_t i1 = mesh->indices[i + 1];
+        uint32_t i2 = mesh->indices[i + 2];
+        if (i0 >= (uint32_t)mesh->vertex_count || i1 >= (uint32_t)mesh->vertex_count ||
+            i2 >= (uint32_t)mesh->vertex_count) {
+            continue;
+        }
+
+        if (triangle_visible(renderer, &out[i0], &out[i1], &out[i2])) {
+            triangles[count++] = (uint32_t)i;
+        }
+    }
+    return count;
+}
+
+// Monotonic timestamp for stage timing, 0 when timing is disabled
+static inline uint64_t stage_clock(const amos_renderer3d_t* renderer) {
+    if (!renderer->stage_timing_enabled) {
+        return 0;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Cull the renderer's lights into the cached grid; NULL if it can't be built
+static const amos_light_grid_t* build_light_grid(amos_renderer3d_t* renderer) {
+    struct amos_pipeline_cache_t* cache = renderer->pipeline_cache;
+    amos_light_grid_t* grid = &cache->light_grid;
+
+    if (!cache->light_grid_ready) {
+        if (!amos_light_grid_init(grid, renderer->width, renderer->height)) {
+            return NULL;
+        }
+        cache->light_grid_ready = true;
+    } else if ((grid->width != renderer->width || grid->height != renderer->height) &&
+               !amos_light_grid_resize(grid, renderer->width, renderer->height)) {
+        return NULL;
+    }
+
+    return amos_light_grid_build_screen(grid, renderer) ? grid : NULL;
+}
+
+// Build the view-projection matrix from the camera
+static void build_view_projection(const amos_renderer3d_t* renderer, amos_mat4_t* view_projection) {
+    const amos_camera_t* camera = &renderer->camera;
+    amos_mat4_t view, projection;
+
+    float aspect = camera->aspect > 0.0f ? camera->aspect : (float)renderer->width / (float)renderer->height;
+    amos_mat4_look_at(&view, &camera->position, &camera->target, &camera->up);
+    amos_mat4_perspective(&projection, camera->fov * AMOS_LIGHT_DEG_TO_RAD, aspect,
+                          camera->near_clip, camera->far_clip);
+    amos_mat4_multiply(&projection, &view, view_projection);
+}
+
+// Draw through a specialized variant
+static void draw_specialized(
+    amos_renderer3d_t* renderer,
+    const amos_mesh_t* mesh,
+    const amos_material_t* material,
+    amos_raster_fn raster
+) {
+    amos_raster_context_t context;
+    amos_framebuffer_t* target = renderer->color_buffer;
+    const amos_mat4_t* model = &renderer->model_matrix;
+
+    context.color = (uint32_t*)target->buffer;
+    context.pitch = target->pitch / 4;
+    context.depth = renderer->depth_buffer;
+    context.depth_pitch = renderer->width;
+    context.width = renderer->width < target->width ? renderer->width : target->width;
+    context.height = renderer->height < target->height ? renderer->height : target->height;
+    context.ambient = (amos_vec3_t){material->ambient.x, material->ambient.y, material->ambient.z};
+    context.diffuse = (amos_vec3_t){material->diffuse.x, material->diffuse.y, material->diffuse.z};
+    context.specular = (amos_vec3_t){material->specular.x, material->specular.y, material->specular.z};
+    context.shininess = material->shininess;
+    context.texture_levels = NULL;
+    context.texture_max_level = 0;
+    context.texture_area = 0.0f;
+    amos_texture_level_t base_level;
+    if (material->diffuse_texture && !renderer->wireframe_mode) {
+        // Sample the framebuffer in place; without mips fall back to level 0 alone
+        const amos_framebuffer_t* texture = material->diffuse_texture;
+        const amos_texture_mips_t* mips = amos_texture_cache_get(renderer, texture);
+        if (mips) {
+            context.texture_levels = mips->levels;
+            context.texture_max_level = mips->level_count - 1;
+        } else {
+            base_level.texels = (const uint32_t*)texture->buffer;
+            base_level.width = texture->width;
+            base_level.height = texture->height;
+            base_level.pitch = texture->pitch / 4;
+            context.texture_levels = &base_level;
+        }
+        context.texture_area = (float)texture->width * (float)texture->height;
+    }
+    context.lights = renderer->lights;
+    context.light_count = renderer->light_count;
+    context.light_grid = NULL;
+    context.eye = renderer->camera.position;
+    context.fragments = 0;
+
+    // Per-pixel shading with many lights only visits the lights whose
+    // bounds cover the pixel's tile
+    if (material->shading_model == AMOS_SHADING_PHONG && renderer->light_culling_enabled &&
+        renderer->light_count >= PIPELINE_TILED_LIGHTS && !renderer->wireframe_mode) {
+        context.light_grid = build_light_grid(renderer);
+    }
+
+    uint64_t start = stage_clock(renderer);
+
+    amos_mat4_t view_projection;
+    build_view_projection(renderer, &view_projection);
+
+    // Vertex stage
+    amos_raster_vertex_t* out = renderer->pipeline_cache->vertices;
+    bool gouraud = material->shading_model == AMOS_SHADING_GOURAUD && !renderer->wireframe_mode;
+    for (int i = 0; i < mesh->vertex_count; i++) {
+        amos_vertex_t vertex;
+        amos_mesh_fetch_vertex(mesh, (uint32_t)i, &vertex);
+
+        amos_vec4_t world, clip;
+        transform_point(model, &vertex.position, &world);
+        out[i].world = (amos_vec3_t){world.x, world.y, world.z};
+        transform_point(&view_projection, &out[i].world, &clip);
+        to_window(renderer, &clip, &out[i]);
+
+        // Upper 3x3 of the model matrix; assumes uniform scale
+        const amos_vec3_t* n = &vertex.normal;
+        out[i].normal.x = model->m[0][0] * n->x + model->m[0][1] * n->y + model->m[0][2] * n->z;
+        out[i].normal.y = model->m[1][0] * n->x + model->m[1][1] * n->y + model->m[1][2] * n->z;
+        out[i].normal.z = model->m[2][0] * n->x + model->m[2][1] * n->y + model->m[2][2] * n->z;
+        pipeline_normalize(&out[i].normal);
+
+        out[i].texcoord = vertex.texcoord;
+
+        if (gouraud) {
+            pipeline_light(&context, &out[i].world, &out[i].normal, context.light_count, &out[i].color);
+        }
+    }
+    uint64_t transformed = stage_clock(renderer);
+
+    // Bin stage
+    uint32_t* triangles = renderer->pipeline_cache->triangles;
+    int drawn = bin_triangles(renderer, mesh, out, triangles);
+    uint64_t binned = stage_clock(renderer);
+
+    // Raster stage
+    for (int t = 0; t < drawn; t++) {
+        const uint32_t* index = mesh->indices + triangles[t];
+        raster(&context, &out[index[0]], &out[index[1]], &out[index[2]]);
+    }
+    uint64_t rasterized = stage_clock(renderer);
+
+    renderer->stats.triangles_drawn += (uint32_t)drawn;
+    renderer->stats.fragments_shaded += context.fragments;
+    renderer->stats.transform_ns += transformed - start;
+    renderer->stats.bin_ns += binned - transformed;
+    renderer->stats.raster_ns += rasterized - binned;
+}
+
+// Fragments waiting to be shaded by the generic path
+typedef struct {
+    int x[PIPELINE_BATCH];
+    int y[PIPELINE_BATCH];
+    float depth[PIPELINE_BATCH];
+    int count;
+    uint8_t* varyings;      // PIPELINE_BATCH slots of varying_size bytes
+    uint64_t shade_ns;      // Time spent in the shader program
+} fragment_batch_t;
+
+// Shade and write the queued fragments
+static void flush_fragments(
+    amos_renderer3d_t* renderer,
+    amos_shader_program_t* program,
+    fragment_batch_t* batch
+) {
+    amos_framebuffer_t* target = renderer->color_buffer;
+    bool depth_test = renderer->depth_test_enabled && renderer->depth_buffer;
+    size_t stride = (size_t)program->varying_size;
+    amos_vec4_t colors[PIPELINE_BATCH];
+
+    uint64_t start = stage_clock(renderer);
+    if (program->compiled) {
+        amos_shader_dsl_run_fragments(program, batch->varyings, batch->count, colors);
+    } else {
+        for (int i = 0; i < batch->count; i++) {
+            program->fragment_x = batch->x[i];
+            program->fragment_y = batch->y[i];
+            amos_shader_process_fragment(program, batch->varyings + i * stride, &colors[i]);
+        }
+    }
+    batch->shade_ns += stage_clock(renderer) - start;
+
+    for (int i = 0; i < batch->count; i++) {
+        int x = batch->x[i];
+        int y = batch->y[i];
+        amos_vec3_t rgb = {colors[i].x, colors[i].y, colors[i].z};
+        uint32_t packed = (pipeline_pack(&rgb) & 0x00FFFFFFu) | (pack_channel(colors[i].w) << 24);
+        if (target->bytes_per_pixel == 4) {
+            ((uint32_t*)(target->buffer + (size_t)y * target->pitch))[x] = packed;
+        } else {
+            amos_fb_set_pixel(target, x, y, packed);
+        }
+        if (depth_test) {
+            renderer->depth_buffer[(size_t)y * renderer->width + x] = batch->depth[i];
+        }
+    }
+
+    batch->count = 0;
+}
+
+// Rasterize one triangle through a shader program
+static uint64_t raster_generic(
+    amos_renderer3d_t* renderer,
+    amos_shader_program_t* program,
+    const amos_raster_vertex_t* v0,
+    const amos_raster_vertex_t* v1,
+    const amos_raster_vertex_t* v2,
+    const void* varying0,
+    const void* varying1,
+    const void* varying2,
+    fragment_batch_t* batch
+) {
+    amos_framebuffer_t* target = renderer->color_buffer;
+    int width = renderer->width < target->width ? renderer->width : target->width;
+    int height = renderer->height < target->height ? renderer->height : target->height;
+    bool depth_test = renderer->depth_test_enabled && renderer->depth_buffer;
+    size_t stride = (size_t)program->varying_size;
+
+    float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+    if (area == 0.0f) {
+        return 0;
+    }
+    float inv_area = 1.0f / area;
+
+    int x0 = (int)ceilf(fmaxf(fminf(v0->x, fminf(v1->x, v2->x)) - 0.5f, 0.0f));
+    int y0 = (int)ceilf(fmaxf(fminf(v0->y, fminf(v1->y, v2->y)) - 0.5f, 0.0f));
+    int x1 = (int)floorf(fminf(fmaxf(v0->x, fmaxf(v1->x, v2->x)) - 0.5f, (float)(width - 1)));
+    int y1 = (int)floorf(fminf(fmaxf(v0->y, fmaxf(v1->y, v2->y)) - 0.5f, (float)(height - 1)));
+
+    // Fragments of one triangle never overlap, so depth writes can wait
+    // until the batch is flushed
+    uint64_t fragments = 0;
+    for (int y = y0; y <= y1; y++) {
+        float py = (float)y + 0.5f;
+        for (int x = x0; x <= x1; x++) {
+            float px = (float)x + 0.5f;
+            float w0 = ((v2->x - v1->x) * (py - v1->y) - (v2->y - v1->y) * (px - v1->x)) * inv_area;
+            float w1 = ((v0->x - v2->x) * (py - v2->y) - (v0->y - v2->y) * (px - v2->x)) * inv_area;
+            float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                continue;
+            }
+
+            float z = 1.0f / (w0 * v0->inv_w + w1 * v1->inv_w + w2 * v2->inv_w);
+            if (depth_test && z >= renderer->depth_buffer[(size_t)y * renderer->width + x]) {
+                continue;
+            }
+
+            amos_vec3_t barycentric = {w0 * v0->inv_w * z, w1 * v1->inv_w * z, w2 * v2->inv_w * z};
+            amos_shader_interpolate_varying(varying0, varying1, varying2, &barycentric,
+                                            program->varying_size,
+                                            batch->varyings + batch->count * stride);
+            batch->x[batch->count] = x;
+            batch->y[batch->count] = y;
+            batch->depth[batch->count] = z;
+            if (++batch->count == PIPELINE_BATCH) {
+                flush_fragments(renderer, program, batch);
+            }
+            fragments++;
+        }
+    }
+
+    if (batch->count > 0) {
+        flush_fragments(renderer, program, batch);
+    }
+
+    return fragments;
+}
+
+// Draw through the material's shader program
+static void draw_generic(
+    amos_renderer3d_t* renderer,
+    const amos_mesh_t* mesh,
+    amos_shader_program_t* program
+) {
+    struct amos_pipeline_cache_t* cache = renderer->pipeline_cache;
+    amos_raster_vertex_t* out = cache->vertices;
+    size_t stride = (size_t)program->varying_size;
+    uint8_t* varyings = cache->varyings;
+
+    fragment_batch_t batch;
+    batch.count = 0;
+    batch.varyings = varyings + (size_t)mesh->vertex_count * stride;
+    batch.shade_ns = 0;
+
+    uint64_t start = stage_clock(renderer);
+
+    // Vertex stage, PIPELINE_BATCH vertices at a time
+    for (int first = 0; first < mesh->vertex_count; first += PIPELINE_BATCH) {
+        int count = mesh->vertex_count - first;
+        if (count > PIPELINE_BATCH) {
+            count = PIPELINE_BATCH;
+        }
+
+        amos_vertex_t vertices[PIPELINE_BATCH];
+        amos_vec4_t clip[PIPELINE_BATCH];
+        for (int i = 0; i < count; i++) {
+            amos_mesh_fetch_vertex(mesh, (uint32_t)(first + i), &vertices[i]);
+        }
+
+        if (program->compiled) {
+            amos_shader_dsl_run_vertices(program, vertices, count, clip, varyings + (size_t)first * stride);
+        } else {
+            for (int i = 0; i < count; i++) {
+                amos_shader_process_vertex(program, &vertices[i], &clip[i], varyings + (size_t)(first + i) * stride);
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            to_window(renderer, &clip[i], &out[first + i]);
+        }
+    }
+    uint64_t transformed = stage_clock(renderer);
+
+    uint32_t* triangles = cache->triangles;
+    int drawn = bin_triangles(renderer, mesh, out, triangles);
+    uint64_t binned = stage_clock(renderer);
+
+    uint64_t fragments = 0;
+    for (int t = 0; t < drawn; t++) {
+        const uint32_t* index = mesh->indices + triangles[t];
+        fragments += raster_generic(renderer, program, &out[index[0]], &out[index[1]], &out[index[2]],
+                                    varyings + index[0] * stride, varyings + index[1] * stride,
+                                    varyings + index[2] * stride, &batch);
+    }
+    uint64_t rasterized = stage_clock(renderer);
+
+    renderer->stats.triangles_drawn += (uint32_t)drawn;
+    renderer->stats.fragments_shaded += fragments;
+    renderer->stats.transform_ns += transformed - start;
+    renderer->stats.bin_ns += binned - transformed;
+    renderer->stats.raster_ns += rasterized - binned - batch.shade_ns;
+    renderer->stats.shade_ns += batch.shade_ns;
+}
+
+// Draw a mesh with the renderer's current model matrix
+bool amos_renderer3d_draw_mesh(amos_renderer3d_t* renderer, const amos_mesh_t* mesh) {
+    if (!renderer || !mesh || !renderer->color_buffer || !renderer->color_buffer->buffer) {
+        return false;
+    }
+
+    if (!mesh->indices || mesh->vertex_count <= 0 || (!mesh->vertices && !mesh->positions)) {
+        return false;
+    }
+
+    const amos_material_t* material = mesh->material ? mesh->material : &default_material;
+    amos_raster_fn raster = amos_pipeline_select(renderer, material);
+
+    if (raster) {
+        if (!reserve_cache(renderer, mesh, 0)) {
+            return false;
+        }
+        draw_specialized(renderer, mesh, material, raster);
+        amos_fb_mark_changed(renderer->color_buffer);
+        return true;
+    }
+
+    amos_shader_program_t* program = material->shader ? material->shader : renderer->current_shader;
+    if (!program || !program->vertex_shader || !program->fragment_shader) {
+        printf("No shader program available for mesh draw\n");
+        return false;
+    }
+
+    // Vertex varyings followed by one fragment batch; keep the buffer
+    // non-empty since the shader entry points reject NULL varyings
+    size_t varying_bytes = ((size_t)mesh->vertex_count + PIPELINE_BATCH) * (size_t)program->varying_size;
+    if (!reserve_cache(renderer, mesh, varying_bytes ? varying_bytes : sizeof(float))) {
+        return false;
+    }
+    draw_generic(renderer, mesh, program);
+    amos_fb_mark_changed(renderer->color_buffer);
+    return true;
+}
+
+// Release the per-draw scratch buffers and texture mip chains owned by the pipeline
+void amos_pipeline_release(amos_renderer3d_t* renderer) {
+    if (!renderer) {
+        return;
+    }
+
+    amos_texture_cache_release(renderer);
+    if (!renderer->pipeline_cache) {
+        return;
+    }
+
+    free(renderer->pipeline_cache->vertices);
+    free(renderer->pipeline_cache->varyings);
+    free(renderer->pipeline_cache->triangles);
+    if (renderer->pipeline_cache->light_grid_ready) {
+        amos_light_grid_cleanup(&renderer->pipeline_cache->light_grid);
+    }
+    free(renderer->pipeline_cache);
+    renderer->pipeline_cache = NULL;
+}
@@ -0,0 +1,103 @@
+/**
+ * AMOS Desktop OS - Specialized Raster Pipelines
+ *
+ * This file defines the mesh drawing entry point of the 3D renderer.
+ * Common material configurations (flat, Gouraud or Phong shading,
+ * optionally textured, with or without depth testing, one light or
+ * many) are served by pipeline variants generated at compile time from
+ * a single template, so the inner raster loop contains no function
+ * pointer calls or per-pixel state branches. Textured variants pick a
+ * mip level per pixel. Phong draws with many lights shade each pixel
+ * with the lights of its screen tile only (see light_culling.h).
+ * Materials with a custom shader program fall back to the generic
+ * programmable path.
+ */
+
+#ifndef AMOS_PIPELINE_H
+#define AMOS_PIPELINE_H
+
+#include "renderer3d.h"
+#include "texture.h"
+#include "light_culling.h"
+
+// Vertex after transformation, ready for rasterization
+typedef struct {
+    float x, y;             // Window coordinates
+    float depth;            // View-space depth (clip w)
+    float inv_w;            // 1 / depth, for perspective-correct interpolation
+    amos_vec3_t world;      // World-space position
+    amos_vec3_t normal;     // World-space normal
+    amos_vec2_t texcoord;
+    amos_vec3_t color;      // Lit colour (Gouraud variants only)
+} amos_raster_vertex_t;
+
+// State shared by every triangle of a draw call
+typedef struct {
+    uint32_t* color;        // 32bpp colour buffer
+    int pitch;              // Colour buffer row length in pixels
+    float* depth;           // View-space depth buffer
+    int depth_pitch;        // Depth buffer row length (the renderer's width)
+    int width;
+    int height;
+
+    amos_vec3_t ambient;
+    amos_vec3_t diffuse;
+    amos_vec3_t specular;
+    float shininess;
+
+    const amos_texture_level_t* texture_levels;  // Mip chain, NULL when untextured
+    int texture_max_level;      // Index of the smallest level
+    float texture_area;         // Texels in level 0
+
+    const amos_light_t* lights;
+    int light_count;
+    const amos_light_grid_t* light_grid;    // Tile light lists, NULL to visit every light
+    amos_vec3_t eye;
+
+    uint64_t fragments;     // Fragments written during the draw
+} amos_raster_context_t;
+
+// Triangle rasterizer for one pipeline variant
+typedef void (*amos_raster_fn)(
+    amos_raster_context_t* context,
+    const amos_raster_vertex_t* v0,
+    const amos_raster_vertex_t* v1,
+    const amos_raster_vertex_t* v2
+);
+
+/**
+ * Select the specialized pipeline variant for a material
+ *
+ * @param renderer Pointer to renderer structure
+ * @param material Material to draw with (NULL for the default material)
+ * @return Rasterizer for the variant (an edge rasterizer in wireframe
+ *         mode, drawing in the unlit diffuse colour), or NULL if the
+ *         draw needs the generic programmable path (custom shader or a
+ *         render target/texture that is not 32bpp)
+ */
+amos_raster_fn amos_pipeline_select(
+    const amos_renderer3d_t* renderer,
+    const amos_material_t* material
+);
+
+/**
+ * Draw a mesh with the renderer's current model matrix
+ *
+ * Triangles with a vertex behind the near plane are rejected rather
+ * than clipped.
+ *
+ * @param renderer Pointer to renderer structure
+ * @param mesh Mesh to draw (interleaved or SoA)
+ * @return true if the mesh was drawn, false on invalid state or allocation failure
+ */
+bool amos_renderer3d_draw_mesh(amos_renderer3d_t* renderer, const amos_mesh_t* mesh);
+
+/**
+ * Release the per-draw scratch buffers and texture mip chains owned by
+ * the pipeline
+ *
+ * @param renderer Pointer to renderer structure
+ */
+void amos_pipeline_release(amos_renderer3d_t* renderer);
+
+#endif /* AMOS_PIPELINE_H */
@@ -0,0 +1,195 @@
+/**
+ * AMOS Desktop OS - Pipeline Variant Template
+ *
+ * Included by pipeline_variant_set.inl once per variant. Each inclusion
+ * defines one triangle rasterizer named RV_NAME, specialized on:
+ *
+ *   RV_SHADING       RV_FLAT, RV_GOURAUD or RV_PHONG
+ *   RV_TEXTURED      0 or 1
+ *   RV_DEPTH_TEST    0 or 1
+ *   RV_SINGLE_LIGHT  1 to fold the light loop to exactly one light
+ *
+ * All four are compile-time constants, so the disabled stages vanish
+ * from the inner loop. RV_NAME, RV_TEXTURED, RV_DEPTH_TEST and
+ * RV_SINGLE_LIGHT are undefined at the end of the file.
+ */
+
+#if RV_SINGLE_LIGHT
+#define RV_LIGHT_COUNT 1
+#else
+#define RV_LIGHT_COUNT context->light_count
+#endif
+
+static void RV_NAME(
+    amos_raster_context_t* context,
+    const amos_raster_vertex_t* v0,
+    const amos_raster_vertex_t* v1,
+    const amos_raster_vertex_t* v2
+) {
+    float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+    if (area == 0.0f) {
+        return;
+    }
+    float inv_area = 1.0f / area;
+
+    // Pixels whose centres fall inside the clamped bounding box
+    float min_x = fminf(v0->x, fminf(v1->x, v2->x));
+    float max_x = fmaxf(v0->x, fmaxf(v1->x, v2->x));
+    float min_y = fminf(v0->y, fminf(v1->y, v2->y));
+    float max_y = fmaxf(v0->y, fmaxf(v1->y, v2->y));
+    int x0 = (int)ceilf(fmaxf(min_x - 0.5f, 0.0f));
+    int y0 = (int)ceilf(fmaxf(min_y - 0.5f, 0.0f));
+    int x1 = (int)floorf(fminf(max_x - 0.5f, (float)(context->width - 1)));
+    int y1 = (int)floorf(fminf(max_y - 0.5f, (float)(context->height - 1)));
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    // Normalized edge functions: w_i = a_i * x + b_i * y + c_i
+    float a0 = (v1->y - v2->y) * inv_area;
+    float b0 = (v2->x - v1->x) * inv_area;
+    float c0 = (v1->x * v2->y - v2->x * v1->y) * inv_area;
+    float a1 = (v2->y - v0->y) * inv_area;
+    float b1 = (v0->x - v2->x) * inv_area;
+    float c1 = (v2->x * v0->y - v0->x * v2->y) * inv_area;
+    float a2 = (v0->y - v1->y) * inv_area;
+    float b2 = (v1->x - v0->x) * inv_area;
+    float c2 = (v0->x * v1->y - v1->x * v0->y) * inv_area;
+
+#if RV_TEXTURED
+    // Texture coordinates are a projective map U/Q, V/Q of window
+    // coordinates, so the texels under a pixel are |det[U;V;Q]| * z^3
+    float tex_scale;
+    {
+        float i0 = v0->inv_w, i1 = v1->inv_w, i2 = v2->inv_w;
+        float qa = a0 * i0 + a1 * i1 + a2 * i2;
+        float qb = b0 * i0 + b1 * i1 + b2 * i2;
+        float qc = c0 * i0 + c1 * i1 + c2 * i2;
+        float u0 = v0->texcoord.x * i0, u1 = v1->texcoord.x * i1, u2 = v2->texcoord.x * i2;
+        float ua = a0 * u0 + a1 * u1 + a2 * u2;
+        float ub = b0 * u0 + b1 * u1 + b2 * u2;
+        float uc = c0 * u0 + c1 * u1 + c2 * u2;
+        float t0 = v0->texcoord.y * i0, t1 = v1->texcoord.y * i1, t2 = v2->texcoord.y * i2;
+        float va = a0 * t0 + a1 * t1 + a2 * t2;
+        float vb = b0 * t0 + b1 * t1 + b2 * t2;
+        float vc = c0 * t0 + c1 * t1 + c2 * t2;
+        float det = ua * (vb * qc - vc * qb) - ub * (va * qc - vc * qa) + uc * (va * qb - vb * qa);
+        tex_scale = fabsf(det) * context->texture_area;
+    }
+#endif
+
+#if RV_SHADING == RV_FLAT
+    // One lighting evaluation for the whole triangle
+    amos_vec3_t flat_color;
+    {
+        amos_vec3_t e1 = {v1->world.x - v0->world.x, v1->world.y - v0->world.y, v1->world.z - v0->world.z};
+        amos_vec3_t e2 = {v2->world.x - v0->world.x, v2->world.y - v0->world.y, v2->world.z - v0->world.z};
+        amos_vec3_t normal = {
+            e1.y * e2.z - e1.z * e2.y,
+            e1.z * e2.x - e1.x * e2.z,
+            e1.x * e2.y - e1.y * e2.x
+        };
+        pipeline_normalize(&normal);
+        amos_vec3_t centroid = {
+            (v0->world.x + v1->world.x + v2->world.x) * (1.0f / 3.0f),
+            (v0->world.y + v1->world.y + v2->world.y) * (1.0f / 3.0f),
+            (v0->world.z + v1->world.z + v2->world.z) * (1.0f / 3.0f)
+        };
+        pipeline_light(context, &centroid, &normal, RV_LIGHT_COUNT, &flat_color);
+    }
+#endif
+
+    uint64_t fragments = 0;
+
+    for (int y = y0; y <= y1; y++) {
+        float py = (float)y + 0.5f;
+        float px = (float)x0 + 0.5f;
+        float w0 = a0 * px + b0 * py + c0;
+        float w1 = a1 * px + b1 * py + c1;
+        float w2 = a2 * px + b2 * py + c2;
+
+        uint32_t* color_row = context->color + (size_t)y * context->pitch;
+#if RV_DEPTH_TEST
+        float* depth_row = context->depth + (size_t)y * context->depth_pitch;
+#endif
+
+        for (int x = x0; x <= x1; x++, w0 += a0, w1 += a1, w2 += a2) {
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                continue;
+            }
+
+#if RV_DEPTH_TEST || RV_SHADING != RV_FLAT || RV_TEXTURED
+            float z = 1.0f / (w0 * v0->inv_w + w1 * v1->inv_w + w2 * v2->inv_w);
+#endif
+#if RV_DEPTH_TEST
+            if (z >= depth_row[x]) {
+                continue;
+            }
+#endif
+
+#if RV_SHADING != RV_FLAT || RV_TEXTURED
+            // Perspective-correct weights
+            float p0 = w0 * v0->inv_w * z;
+            float p1 = w1 * v1->inv_w * z;
+            float p2 = w2 * v2->inv_w * z;
+#endif
+
+#if RV_SHADING == RV_FLAT
+            amos_vec3_t color = flat_color;
+#elif RV_SHADING == RV_GOURAUD
+            amos_vec3_t color = {
+                p0 * v0->color.x + p1 * v1->color.x + p2 * v2->color.x,
+                p0 * v0->color.y + p1 * v1->color.y + p2 * v2->color.y,
+                p0 * v0->color.z + p1 * v1->color.z + p2 * v2->color.z
+            };
+#else
+            amos_vec3_t position = {
+                p0 * v0->world.x + p1 * v1->world.x + p2 * v2->world.x,
+                p0 * v0->world.y + p1 * v1->world.y + p2 * v2->world.y,
+                p0 * v0->world.z + p1 * v1->world.z + p2 * v2->world.z
+            };
+            amos_vec3_t normal = {
+                p0 * v0->normal.x + p1 * v1->normal.x + p2 * v2->normal.x,
+                p0 * v0->normal.y + p1 * v1->normal.y + p2 * v2->normal.y,
+                p0 * v0->normal.z + p1 * v1->normal.z + p2 * v2->normal.z
+            };
+            pipeline_normalize(&normal);
+            amos_vec3_t color;
+#if RV_SINGLE_LIGHT
+            pipeline_light(context, &position, &normal, RV_LIGHT_COUNT, &color);
+#else
+            if (context->light_grid) {
+                pipeline_light_tiled(context, x, y, &position, &normal, &color);
+            } else {
+                pipeline_light(context, &position, &normal, RV_LIGHT_COUNT, &color);
+            }
+#endif
+#endif
+
+#if RV_TEXTURED
+            uint32_t texel = pipeline_sample(
+                pipeline_mip_level(context, tex_scale * z * z * z),
+                p0 * v0->texcoord.x + p1 * v1->texcoord.x + p2 * v2->texcoord.x,
+                p0 * v0->texcoord.y + p1 * v1->texcoord.y + p2 * v2->texcoord.y
+            );
+            color.x *= (float)(texel & 0xFF) * (1.0f / 255.0f);
+            color.y *= (float)((texel >> 8) & 0xFF) * (1.0f / 255.0f);
+            color.z *= (float)((texel >> 16) & 0xFF) * (1.0f / 255.0f);
+#endif
+
+            color_row[x] = pipeline_pack(&color);
+#if RV_DEPTH_TEST
+            depth_row[x] = z;
+#endif
+            fragments++;
+        }
+    }
+
+    context->fragments += fragments;
+}
+
+#undef RV_LIGHT_COUNT
+#undef RV_NAME
+#undef RV_TEXTURED
+#undef RV_DEPTH_TEST
+#undef RV_SINGLE_LIGHT
@@ -0,0 +1,77 @@
+/**
+ * AMOS Desktop OS - Pipeline Variant Set
+ *
+ * Instantiates pipeline_variant.inl for every combination of texturing,
+ * depth testing and light count under the current RV_SHADING. The
+ * rasterizers are named RV_PREFIX##_t<textured>_d<depth>_s<single>,
+ * matching the order of RV_SET_ENTRIES in pipeline.c. Gouraud variants
+ * light per vertex, so they are not split by light count and are named
+ * RV_PREFIX##_t<textured>_d<depth> (RV_SET_ENTRIES_UNLIT).
+ */
+
+#if RV_SHADING == RV_GOURAUD
+// Lit per vertex: the light count does not reach the rasterizer
+#define RV_VARIANT(t, d, l) RV_PASTE(RV_PREFIX, _##t##_##d)
+#else
+#define RV_VARIANT(t, d, l) RV_PASTE(RV_PREFIX, _##t##_##d##_##l)
+#endif
+
+#define RV_NAME RV_VARIANT(t0, d0, s0)
+#define RV_TEXTURED 0
+#define RV_DEPTH_TEST 0
+#define RV_SINGLE_LIGHT 0
+#include "pipeline_variant.inl"
+
+#if RV_SHADING != RV_GOURAUD
+#define RV_NAME RV_VARIANT(t0, d0, s1)
+#define RV_TEXTURED 0
+#define RV_DEPTH_TEST 0
+#define RV_SINGLE_LIGHT 1
+#include "pipeline_variant.inl"
+#endif
+
+#define RV_NAME RV_VARIANT(t0, d1, s0)
+#define RV_TEXTURED 0
+#define RV_DEPTH_TEST 1
+#define RV_SINGLE_LIGHT 0
+#include "pipeline_variant.inl"
+
+#if RV_SHADING != RV_GOURAUD
+#define RV_NAME RV_VARIANT(t0, d1, s1)
+#define RV_TEXTURED 0
+#define RV_DEPTH_TEST 1
+#define RV_SINGLE_LIGHT 1
+#include "pipeline_variant.inl"
+#endif
+
+#define RV_NAME RV_VARIANT(t1, d0, s0)
+#define RV_TEXTURED 1
+#define RV_DEPTH_TEST 0
+#define RV_SINGLE_LIGHT 0
+#include "pipeline_variant.inl"
+
+#if RV_SHADING != RV_GOURAUD
+#define RV_NAME RV_VARIANT(t1, d0, s1)
+#define RV_TEXTURED 1
+#define RV_DEPTH_TEST 0
+#define RV_SINGLE_LIGHT 1
+#include "pipeline_variant.inl"
+#endif
+
+#define RV_NAME RV_VARIANT(t1, d1, s0)
+#define RV_TEXTURED 1
+#define RV_DEPTH_TEST 1
+#define RV_SINGLE_LIGHT 0
+#include "pipeline_variant.inl"
+
+#if RV_SHADING != RV_GOURAUD
+#define RV_NAME RV_VARIANT(t1, d1, s1)
+#define RV_TEXTURED 1
+#define RV_DEPTH_TEST 1
+#define RV_SINGLE_LIGHT 1
+#include "pipeline_variant.inl"
+#endif
+
+#undef RV_VARIANT
+#undef RV_PREFIX
+#undef RV_SHADING
@@ -10,6 +10,7 @@
 
 #include "../graphics/framebuffer.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // Forward declarations
@@ -45,6 +46,26 @@ typedef struct {
     amos_vec4_t color;
 } amos_vertex_t;
 
+// Axis-aligned bounding box plus bounding sphere
+typedef struct {
+    amos_vec3_t min;
+    amos_vec3_t max;
+    amos_vec3_t center;
+    float radius;
+} amos_bounds_t;
+
+// Meshlet (small triangle cluster used for coarse culling)
+typedef struct {
+    uint32_t vertex_offset;   // First entry in the meshlet vertex table
+    uint32_t triangle_offset; // First byte in the meshlet triangle table
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+    amos_vec3_t center;       // Bounding sphere
+    float radius;
+    amos_vec3_t cone_axis;    // Normal cone for backface rejection
+    float cone_cutoff;
+} amos_meshlet_t;
+
 // Mesh structure
 struct amos_mesh_t {
     amos_vertex_t* vertices;
@@ -52,8 +73,33 @@ struct amos_mesh_t {
     int vertex_count;
     int index_count;
     amos_material_t* material;
+
+    // Structure-of-arrays streams. Set instead of vertices when the mesh
+    // is backed by a mapped mesh file; any stream except positions may be NULL.
+    const amos_vec3_t* positions;
+    const amos_vec3_t* normals;
+    const amos_vec2_t* texcoords;
+    const amos_vec4_t* colors;
+
+    // Bounding volumes and meshlet clusters
+    amos_bounds_t bounds;
+    const amos_meshlet_t* meshlets;
+    const uint32_t* meshlet_vertices;
+    const uint8_t* meshlet_triangles;
+    int meshlet_count;
+
+    // Backing file mapping (NULL for heap-allocated meshes)
+    void* mapping;
+    size_t mapping_size;
 };
 
+// Lighting model used by the built-in pipelines
+typedef enum {
+    AMOS_SHADING_FLAT,      // Lit once per triangle
+    AMOS_SHADING_GOURAUD,   // Lit per vertex, colour interpolated
+    AMOS_SHADING_PHONG      // Lit per pixel
+} amos_shading_model_t;
+
 // Material structure
 struct amos_material_t {
     amos_vec4_t ambient;
@@ -62,6 +108,7 @@ struct amos_material_t {
     float shininess;
     amos_framebuffer_t* diffuse_texture;
     amos_shader_program_t* shader;
+    amos_shading_model_t shading_model;
 };
 
 // Camera structure
@@ -84,6 +131,9 @@ typedef enum {
     AMOS_LIGHT_SPOT
 } amos_light_type_t;
 
+// Upper bound on lights per renderer
+#define AMOS_MAX_LIGHTS 1024
+
 // Light structure
 struct amos_light_t {
     amos_light_type_t type;
@@ -95,6 +145,21 @@ struct amos_light_t {
     float spot_angle;
 };
 
+// Per-frame render statistics
+typedef struct {
+    uint32_t triangles_saved;       // Triangles skipped by LOD selection
+    uint32_t triangles_drawn;       // Triangles that reached the rasterizer
+    uint64_t fragments_shaded;      // Fragments that passed the depth test
+
+    // Stage times in nanoseconds, filled when stage_timing_enabled is set.
+    // Specialized pipelines shade while rasterizing, so their shading
+    // time is counted under raster_ns.
+    uint64_t transform_ns;          // Vertex transform (and Gouraud lighting)
+    uint64_t bin_ns;                // Triangle culling and setup list
+    uint64_t raster_ns;             // Scan conversion and depth test
+    uint64_t shade_ns;              // Fragment shader programs
+} amos_render_stats_t;
+
 // Renderer structure
 struct amos_renderer3d_t {
     int width;
@@ -102,24 +167,40 @@ struct amos_renderer3d_t {
     amos_framebuffer_t* color_buffer;
     float* depth_buffer;
     
+    // Targets allocated by amos_renderer3d_init. color_buffer and
+    // depth_buffer point at these unless a caller binds its own.
+    amos_framebuffer_t* own_color_buffer;
+    float* own_depth_buffer;
+    
     amos_camera_t camera;
     
-    amos_light_t lights[8];
+    amos_light_t* lights;       // Grows on demand up to AMOS_MAX_LIGHTS
     int light_count;
+    int light_capacity;
     
     amos_mat4_t model_matrix;
     amos_mat4_t view_matrix;
     amos_mat4_t projection_matrix;
     amos_mat4_t mvp_matrix;
     
-    // Shader programs
+    // Shader program for materials without one of their own
     amos_shader_program_t* current_shader;
-    amos_shader_program_t default_shader;
     
     // Render states
     bool depth_test_enabled;
     bool backface_culling_enabled;
     bool wireframe_mode;
+    bool stage_timing_enabled;  // Time each pipeline stage into stats
+    bool light_culling_enabled; // Shade many-light Phong draws from tile light lists
+    
+    // Statistics for the current frame
+    amos_render_stats_t stats;
+    
+    // Per-draw scratch owned by the pipeline module
+    struct amos_pipeline_cache_t* pipeline_cache;
+    
+    // Mip chains of the textures drawn with, owned by the texture module
+    struct amos_texture_cache_t* texture_cache;
 };
 
 /**
@@ -294,6 +375,13 @@ void amos_renderer3d_render_mesh(
     const amos_mesh_t* mesh
 );
 
+/**
+ * Reset the per-frame render statistics
+ * 
+ * @param renderer Pointer to renderer structure
+ */
+void amos_renderer3d_reset_stats(amos_renderer3d_t* renderer);
+
 /**
  * Get the output framebuffer
  * 
@@ -311,6 +399,7 @@ void amos_vec3_add(const amos_vec3_t* a, const amos_vec3_t* b, amos_vec3_t* resu
 void amos_vec3_subtract(const amos_vec3_t* a, const amos_vec3_t* b, amos_vec3_t* result);
 void amos_vec3_multiply(const amos_vec3_t* a, float scalar, amos_vec3_t* result);
 void amos_vec3_normalize(const amos_vec3_t* v, amos_vec3_t* result);
+void amos_vec3_normalize_exact(const amos_vec3_t* v, amos_vec3_t* result);
 float amos_vec3_dot(const amos_vec3_t* a, const amos_vec3_t* b);
 void amos_vec3_cross(const amos_vec3_t* a, const amos_vec3_t* b, amos_vec3_t* result);
 float amos_vec3_length(const amos_vec3_t* v);
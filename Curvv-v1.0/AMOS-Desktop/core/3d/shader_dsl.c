@@ -0,0 +1,1460 @@
+/**
+ * AMOS Desktop OS - Shader Language Implementation
+ *
+ * This file implements the compiler and interpreter for the AMOS
+ * shading language. Each stage is compiled by a single-pass recursive
+ * descent parser straight into register code; since programs have no
+ * control flow, registers are assigned with a bump allocator and
+ * uniform/input loads are hoisted to their first use.
+ *
+ * Register components are GCC vectors holding AMOS_SHADER_DSL_LANES
+ * lanes, so each instruction works on a whole batch of fragments with
+ * SIMD arithmetic. Every instruction writes all four components of its
+ * destination (unused ones as zero), which lets componentwise ops run
+ * a fixed four iterations regardless of the value type. Dispatch uses
+ * GCC computed gotos (token-threaded code).
+ */
+
+#include "shader_dsl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <xmmintrin.h>
+
+#define DSL_LANES AMOS_SHADER_DSL_LANES
+
+_Static_assert(DSL_LANES % 4 == 0, "lanes are processed in SSE quads");
+#define DSL_MAX_REGS 48
+#define DSL_MAX_LOCALS 32
+#define DSL_MAX_UNIFORM_FLOATS 256
+#define DSL_MAX_IDENT 32
+
+// Offsets of the vertex attributes in amos_vertex_t, in floats
+#define DSL_INPUT_POSITION 0
+#define DSL_INPUT_NORMAL 3
+#define DSL_INPUT_TEXCOORD 6
+#define DSL_INPUT_COLOR 8
+#define DSL_VERTEX_FLOATS 12
+
+_Static_assert(sizeof(amos_vertex_t) == DSL_VERTEX_FLOATS * sizeof(float),
+               "vertex inputs are read as packed floats");
+
+// Value types (vector types equal their component count)
+typedef enum {
+    DSL_VOID = 0,
+    DSL_FLOAT = 1,
+    DSL_VEC2 = 2,
+    DSL_VEC3 = 3,
+    DSL_VEC4 = 4,
+    DSL_MAT4,
+    DSL_SAMPLER
+} dsl_type_t;
+
+typedef enum {
+    DSL_OP_END,
+    DSL_OP_MOV,
+    DSL_OP_CONST,
+    DSL_OP_UNIFORM,
+    DSL_OP_INPUT,
+    DSL_OP_OUTPUT,
+    DSL_OP_SPLAT,
+    DSL_OP_SWIZZLE,
+    DSL_OP_INSERT,
+    DSL_OP_ADD,
+    DSL_OP_SUB,
+    DSL_OP_MUL,
+    DSL_OP_DIV,
+    DSL_OP_NEG,
+    DSL_OP_MIN,
+    DSL_OP_MAX,
+    DSL_OP_POW,
+    DSL_OP_SQRT,
+    DSL_OP_ABS,
+    DSL_OP_FLOOR,
+    DSL_OP_FRACT,
+    DSL_OP_CLAMP,
+    DSL_OP_MIX,
+    DSL_OP_DOT,
+    DSL_OP_CROSS,
+    DSL_OP_LENGTH,
+    DSL_OP_NORMALIZE,
+    DSL_OP_MAT4_MUL,
+    DSL_OP_TEXTURE,
+    DSL_OP_COUNT
+} dsl_opcode_t;
+
+// Instruction: registers a, b, c feed dst; index is an op-specific
+// constant (pool offset, uniform offset, I/O offset or swizzle)
+typedef struct {
+    uint8_t op;
+    uint8_t width;
+    uint8_t dst;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    uint16_t index;
+} dsl_inst_t;
+
+// Compiled stage
+typedef struct {
+    dsl_inst_t* code;
+    int code_count;
+    int code_capacity;
+    float* constants;
+    int constant_count;     // In floats
+    int constant_capacity;
+    int input_stride;       // Floats per input record
+    int output_stride;      // Floats per output record
+} dsl_stage_t;
+
+struct amos_shader_dsl_t {
+    dsl_stage_t vertex;
+    dsl_stage_t fragment;
+    float uniform_data[DSL_MAX_UNIFORM_FLOATS];
+    const amos_framebuffer_t* samplers[AMOS_SHADER_DSL_MAX_SAMPLERS];
+    int varying_floats;
+};
+
+// One register component across all lanes
+typedef float dsl_lanes_t __attribute__((vector_size(DSL_LANES * sizeof(float))));
+
+// Operations without a generic vector form, applied per SSE half
+#define DSL_HALVES (DSL_LANES / 4)
+
+static inline void dsl_min(dsl_lanes_t* r, const dsl_lanes_t* a, const dsl_lanes_t* b) {
+    for (int h = 0; h < DSL_HALVES; h++) {
+        ((__m128*)r)[h] = _mm_min_ps(((const __m128*)a)[h], ((const __m128*)b)[h]);
+    }
+}
+
+static inline void dsl_max(dsl_lanes_t* r, const dsl_lanes_t* a, const dsl_lanes_t* b) {
+    for (int h = 0; h < DSL_HALVES; h++) {
+        ((__m128*)r)[h] = _mm_max_ps(((const __m128*)a)[h], ((const __m128*)b)[h]);
+    }
+}
+
+static inline void dsl_sqrt(dsl_lanes_t* r, const dsl_lanes_t* a) {
+    for (int h = 0; h < DSL_HALVES; h++) {
+        ((__m128*)r)[h] = _mm_sqrt_ps(((const __m128*)a)[h]);
+    }
+}
+
+static inline void dsl_abs(dsl_lanes_t* r, const dsl_lanes_t* a) {
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    for (int h = 0; h < DSL_HALVES; h++) {
+        ((__m128*)r)[h] = _mm_andnot_ps(sign, ((const __m128*)a)[h]);
+    }
+}
+
+static inline void dsl_broadcast(dsl_lanes_t* r, float value) {
+    for (int h = 0; h < DSL_HALVES; h++) {
+        ((__m128*)r)[h] = _mm_set1_ps(value);
+    }
+}
+
+// 1 / a where a > 0, else 0
+static inline void dsl_safe_reciprocal(dsl_lanes_t* r, const dsl_lanes_t* a) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (int h = 0; h < DSL_HALVES; h++) {
+        __m128 v = ((const __m128*)a)[h];
+        ((__m128*)r)[h] = _mm_and_ps(_mm_cmpgt_ps(v, zero), _mm_div_ps(one, v));
+    }
+}
+
+/*
+ * Interpreter
+ */
+
+// Nearest-neighbour texture lookup with wrapping
+static void dsl_sample(const amos_framebuffer_t* texture, float u, float v, float* rgba) {
+    if (!texture || !texture->buffer || texture->width <= 0 || texture->height <= 0) {
+        rgba[0] = rgba[1] = rgba[2] = rgba[3] = 1.0f;
+        return;
+    }
+
+    u -= floorf(u);
+    v -= floorf(v);
+    int x = (int)(u * (float)texture->width);
+    int y = (int)(v * (float)texture->height);
+    if (x >= texture->width) {
+        x = texture->width - 1;
+    }
+    if (y >= texture->height) {
+        y = texture->height - 1;
+    }
+
+    const uint8_t* p = texture->buffer + (size_t)y * texture->pitch + (size_t)x * texture->bytes_per_pixel;
+    rgba[0] = p[0] * (1.0f / 255.0f);
+    rgba[1] = p[1] * (1.0f / 255.0f);
+    rgba[2] = p[2] * (1.0f / 255.0f);
+    rgba[3] = texture->bytes_per_pixel == 4 ? p[3] * (1.0f / 255.0f) : 1.0f;
+}
+
+#define DSL_LANE_LOOP for (int l = 0; l < DSL_LANES; l++)
+#define DSL_COMPONENT_LOOP for (int c = 0; c < ip->width; c++)
+#define DSL_ALL_COMPONENTS for (int c = 0; c < 4; c++)
+#define DSL_DST regs[ip->dst]
+#define DSL_A regs[ip->a]
+#define DSL_B regs[ip->b]
+#define DSL_C regs[ip->c]
+#define DSL_NEXT() do { ip++; goto *dispatch[ip->op]; } while (0)
+
+// Run one stage over up to DSL_LANES records
+static void dsl_execute(
+    const struct amos_shader_dsl_t* dsl,
+    const dsl_stage_t* stage,
+    const float* inputs,
+    float* outputs,
+    int count
+) {
+    static const void* dispatch[DSL_OP_COUNT] = {
+        [DSL_OP_END] = &&op_end,
+        [DSL_OP_MOV] = &&op_mov,
+        [DSL_OP_CONST] = &&op_const,
+        [DSL_OP_UNIFORM] = &&op_uniform,
+        [DSL_OP_INPUT] = &&op_input,
+        [DSL_OP_OUTPUT] = &&op_output,
+        [DSL_OP_SPLAT] = &&op_splat,
+        [DSL_OP_SWIZZLE] = &&op_swizzle,
+        [DSL_OP_INSERT] = &&op_insert,
+        [DSL_OP_ADD] = &&op_add,
+        [DSL_OP_SUB] = &&op_sub,
+        [DSL_OP_MUL] = &&op_mul,
+        [DSL_OP_DIV] = &&op_div,
+        [DSL_OP_NEG] = &&op_neg,
+        [DSL_OP_MIN] = &&op_min,
+        [DSL_OP_MAX] = &&op_max,
+        [DSL_OP_POW] = &&op_pow,
+        [DSL_OP_SQRT] = &&op_sqrt,
+        [DSL_OP_ABS] = &&op_abs,
+        [DSL_OP_FLOOR] = &&op_floor,
+        [DSL_OP_FRACT] = &&op_fract,
+        [DSL_OP_CLAMP] = &&op_clamp,
+        [DSL_OP_MIX] = &&op_mix,
+        [DSL_OP_DOT] = &&op_dot,
+        [DSL_OP_CROSS] = &&op_cross,
+        [DSL_OP_LENGTH] = &&op_length,
+        [DSL_OP_NORMALIZE] = &&op_normalize,
+        [DSL_OP_MAT4_MUL] = &&op_mat4_mul,
+        [DSL_OP_TEXTURE] = &&op_texture
+    };
+
+    dsl_lanes_t regs[DSL_MAX_REGS][4];
+    const dsl_lanes_t zero = {0};
+    const dsl_inst_t* ip = stage->code;
+    goto *dispatch[ip->op];
+
+op_end:
+    return;
+
+op_mov:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c];
+    DSL_NEXT();
+
+op_const:
+    DSL_ALL_COMPONENTS dsl_broadcast(&DSL_DST[c], stage->constants[ip->index + c]);
+    DSL_NEXT();
+
+op_uniform:
+    DSL_ALL_COMPONENTS dsl_broadcast(&DSL_DST[c], c < ip->width ? dsl->uniform_data[ip->index + c] : 0.0f);
+    DSL_NEXT();
+
+op_input: {
+    // Idle lanes replicate the last record so they stay finite
+    const float* records[DSL_LANES];
+    DSL_LANE_LOOP records[l] = inputs + (size_t)(l < count ? l : count - 1) * stage->input_stride + ip->index;
+    DSL_ALL_COMPONENTS {
+        if (c >= ip->width) {
+            DSL_DST[c] = zero;
+            continue;
+        }
+        for (int h = 0; h < DSL_HALVES; h++) {
+            const float* const* r = records + h * 4;
+            ((__m128*)&DSL_DST[c])[h] = _mm_setr_ps(r[0][c], r[1][c], r[2][c], r[3][c]);
+        }
+    }
+    DSL_NEXT();
+}
+
+op_output:
+    for (int l = 0; l < count; l++) {
+        float* record = outputs + (size_t)l * stage->output_stride;
+        DSL_COMPONENT_LOOP record[ip->index + c] = DSL_A[c][l];
+    }
+    DSL_NEXT();
+
+op_splat:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[0];
+    DSL_NEXT();
+
+op_swizzle: {
+    dsl_lanes_t t[4];
+    DSL_ALL_COMPONENTS t[c] = c < ip->width ? DSL_A[(ip->index >> (c * 2)) & 3] : zero;
+    DSL_ALL_COMPONENTS DSL_DST[c] = t[c];
+    DSL_NEXT();
+}
+
+op_insert:
+    // Constructors insert at offset 0 first; clear the tail there
+    if (ip->index == 0) {
+        for (int c = ip->width; c < 4; c++) {
+            DSL_DST[c] = zero;
+        }
+    }
+    DSL_COMPONENT_LOOP DSL_DST[ip->index + c] = DSL_A[c];
+    DSL_NEXT();
+
+op_add:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c] + DSL_B[c];
+    DSL_NEXT();
+
+op_sub:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c] - DSL_B[c];
+    DSL_NEXT();
+
+op_mul:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c] * DSL_B[c];
+    DSL_NEXT();
+
+op_div:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c] / DSL_B[c];
+    DSL_NEXT();
+
+op_neg:
+    DSL_ALL_COMPONENTS DSL_DST[c] = -DSL_A[c];
+    DSL_NEXT();
+
+op_min:
+    DSL_ALL_COMPONENTS dsl_min(&DSL_DST[c], &DSL_A[c], &DSL_B[c]);
+    DSL_NEXT();
+
+op_max:
+    DSL_ALL_COMPONENTS dsl_max(&DSL_DST[c], &DSL_A[c], &DSL_B[c]);
+    DSL_NEXT();
+
+op_pow:
+    DSL_ALL_COMPONENTS DSL_LANE_LOOP DSL_DST[c][l] = powf(DSL_A[c][l], DSL_B[c][l]);
+    DSL_NEXT();
+
+op_sqrt:
+    DSL_ALL_COMPONENTS dsl_sqrt(&DSL_DST[c], &DSL_A[c]);
+    DSL_NEXT();
+
+op_abs:
+    DSL_ALL_COMPONENTS dsl_abs(&DSL_DST[c], &DSL_A[c]);
+    DSL_NEXT();
+
+op_floor:
+    DSL_ALL_COMPONENTS DSL_LANE_LOOP DSL_DST[c][l] = floorf(DSL_A[c][l]);
+    DSL_NEXT();
+
+op_fract:
+    DSL_ALL_COMPONENTS DSL_LANE_LOOP DSL_DST[c][l] = DSL_A[c][l] - floorf(DSL_A[c][l]);
+    DSL_NEXT();
+
+op_clamp:
+    DSL_ALL_COMPONENTS {
+        dsl_lanes_t t;
+        dsl_max(&t, &DSL_A[c], &DSL_B[c]);
+        dsl_min(&DSL_DST[c], &t, &DSL_C[c]);
+    }
+    DSL_NEXT();
+
+op_mix:
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c] + (DSL_B[c] - DSL_A[c]) * DSL_C[c];
+    DSL_NEXT();
+
+op_dot: {
+    dsl_lanes_t sum = zero;
+    DSL_COMPONENT_LOOP sum += DSL_A[c] * DSL_B[c];
+    DSL_DST[0] = sum;
+    DSL_DST[1] = DSL_DST[2] = DSL_DST[3] = zero;
+    DSL_NEXT();
+}
+
+op_cross: {
+    dsl_lanes_t x = DSL_A[1] * DSL_B[2] - DSL_A[2] * DSL_B[1];
+    dsl_lanes_t y = DSL_A[2] * DSL_B[0] - DSL_A[0] * DSL_B[2];
+    dsl_lanes_t z = DSL_A[0] * DSL_B[1] - DSL_A[1] * DSL_B[0];
+    DSL_DST[0] = x;
+    DSL_DST[1] = y;
+    DSL_DST[2] = z;
+    DSL_DST[3] = zero;
+    DSL_NEXT();
+}
+
+op_length: {
+    dsl_lanes_t sum = zero;
+    DSL_COMPONENT_LOOP sum += DSL_A[c] * DSL_A[c];
+    dsl_sqrt(&DSL_DST[0], &sum);
+    DSL_DST[1] = DSL_DST[2] = DSL_DST[3] = zero;
+    DSL_NEXT();
+}
+
+op_normalize: {
+    dsl_lanes_t sum = zero;
+    DSL_COMPONENT_LOOP sum += DSL_A[c] * DSL_A[c];
+    dsl_lanes_t length, scale;
+    dsl_sqrt(&length, &sum);
+    dsl_safe_reciprocal(&scale, &length);
+    DSL_ALL_COMPONENTS DSL_DST[c] = DSL_A[c] * scale;
+    DSL_NEXT();
+}
+
+op_mat4_mul: {
+    // Row-major matrix in uniform storage times a column vector
+    const float* m = dsl->uniform_data + ip->index;
+    dsl_lanes_t t[4];
+    for (int r = 0; r < 4; r++) {
+        t[r] = m[r * 4 + 0] * DSL_A[0] + m[r * 4 + 1] * DSL_A[1] +
+               m[r * 4 + 2] * DSL_A[2] + m[r * 4 + 3] * DSL_A[3];
+    }
+    for (int r = 0; r < 4; r++) {
+        DSL_DST[r] = t[r];
+    }
+    DSL_NEXT();
+}
+
+op_texture: {
+    const amos_framebuffer_t* texture = dsl->samplers[ip->index];
+    dsl_lanes_t t[4] = {zero, zero, zero, zero};
+    for (int l = 0; l < count; l++) {
+        float rgba[4];
+        dsl_sample(texture, DSL_A[0][l], DSL_A[1][l], rgba);
+        for (int c = 0; c < 4; c++) {
+            t[c][l] = rgba[c];
+        }
+    }
+    for (int c = 0; c < 4; c++) {
+        DSL_DST[c] = t[c];
+    }
+    DSL_NEXT();
+}
+}
+
+#undef DSL_NEXT
+#undef DSL_C
+#undef DSL_B
+#undef DSL_A
+#undef DSL_DST
+#undef DSL_ALL_COMPONENTS
+#undef DSL_COMPONENT_LOOP
+#undef DSL_LANE_LOOP
+
+/*
+ * Compiler
+ */
+
+typedef enum {
+    DSL_TOKEN_EOF,
+    DSL_TOKEN_IDENT,
+    DSL_TOKEN_NUMBER,
+    DSL_TOKEN_PUNCT
+} dsl_token_kind_t;
+
+typedef struct {
+    dsl_token_kind_t kind;
+    char text[DSL_MAX_IDENT];
+    float number;
+    char punct;
+    int line;
+} dsl_token_t;
+
+// Value produced by an expression: a register, or for mat4 and
+// sampler2D the uniform offset / sampler slot
+typedef struct {
+    dsl_type_t type;
+    int reg;
+} dsl_value_t;
+
+typedef struct {
+    char name[DSL_MAX_IDENT];
+    dsl_type_t type;
+    int reg;
+} dsl_local_t;
+
+typedef struct {
+    char name[DSL_MAX_IDENT];
+    dsl_type_t type;
+    int offset;             // Uniform float offset, sampler slot or varying offset
+    int reg;                // Register the value is cached in for the current stage
+} dsl_global_t;
+
+typedef struct {
+    const char* program_name;
+    const char* source;
+    const char* pos;
+    int line;
+    dsl_token_t token;
+    bool failed;
+
+    struct amos_shader_dsl_t* dsl;
+    amos_shader_program_t* program;
+
+    dsl_global_t uniforms[AMOS_MAX_UNIFORMS];
+    int uniform_count;
+    int uniform_floats;
+    int sampler_count;
+    dsl_global_t varyings[AMOS_SHADER_DSL_MAX_VARYING_FLOATS];
+    int varying_count;
+    dsl_global_t attributes[4];
+
+    // Current stage
+    dsl_stage_t* stage;
+    bool vertex_stage;
+    bool wrote_output;
+    dsl_local_t locals[DSL_MAX_LOCALS];
+    int local_count;
+    int next_temp;          // Temporaries grow up from 0
+    int persistent_floor;   // Locals and cached loads grow down from DSL_MAX_REGS
+} dsl_parser_t;
+
+static void dsl_error(dsl_parser_t* p, const char* message, const char* detail) {
+    if (!p->failed) {
+        printf("Shader %s: line %d: %s%s%s\n", p->program_name, p->token.line, message,
+               detail ? " " : "", detail ? detail : "");
+    }
+    p->failed = true;
+}
+
+static void dsl_next_token(dsl_parser_t* p) {
+    dsl_token_t* t = &p->token;
+
+    for (;;) {
+        while (*p->pos == ' ' || *p->pos == '\t' || *p->pos == '\r' || *p->pos == '\n') {
+            if (*p->pos == '\n') {
+                p->line++;
+            }
+            p->pos++;
+        }
+        if (p->pos[0] == '/' && p->pos[1] == '/') {
+            while (*p->pos && *p->pos != '\n') {
+                p->pos++;
+            }
+        } else if (p->pos[0] == '/' && p->pos[1] == '*') {
+            p->pos += 2;
+            while (*p->pos && !(p->pos[0] == '*' && p->pos[1] == '/')) {
+                if (*p->pos == '\n') {
+                    p->line++;
+                }
+                p->pos++;
+            }
+            if (*p->pos) {
+                p->pos += 2;
+            }
+        } else {
+            break;
+        }
+    }
+
+    t->line = p->line;
+    t->text[0] = '\0';
+
+    char ch = *p->pos;
+    if (ch == '\0') {
+        t->kind = DSL_TOKEN_EOF;
+        return;
+    }
+
+    if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_') {
+        int len = 0;
+        bool too_long = false;
+        while ((*p->pos >= 'a' && *p->pos <= 'z') || (*p->pos >= 'A' && *p->pos <= 'Z') ||
+               (*p->pos >= '0' && *p->pos <= '9') || *p->pos == '_') {
+            if (len < DSL_MAX_IDENT - 1) {
+                t->text[len++] = *p->pos;
+            } else {
+                too_long = true;
+            }
+            p->pos++;
+        }
+        t->text[len] = '\0';
+        t->kind = DSL_TOKEN_IDENT;
+
+        // Truncating would let two long names collide
+        if (too_long) {
+            dsl_error(p, "identifier too long:", t->text);
+        }
+        return;
+    }
+
+    if ((ch >= '0' && ch <= '9') || (ch == '.' && p->pos[1] >= '0' && p->pos[1] <= '9')) {
+        char* end;
+        t->number = strtof(p->pos, &end);
+        p->pos = end;
+        if (*p->pos == 'f') {
+            p->pos++;
+        }
+        t->kind = DSL_TOKEN_NUMBER;
+        return;
+    }
+
+    if (strchr("+-*/(){};,.=", ch)) {
+        t->kind = DSL_TOKEN_PUNCT;
+        t->punct = ch;
+        p->pos++;
+        return;
+    }
+
+    char bad[2] = {ch, '\0'};
+    t->kind = DSL_TOKEN_EOF;
+    dsl_error(p, "unexpected character", bad);
+}
+
+static bool dsl_is_punct(const dsl_parser_t* p, char ch) {
+    return p->token.kind == DSL_TOKEN_PUNCT && p->token.punct == ch;
+}
+
+static bool dsl_expect(dsl_parser_t* p, char ch) {
+    if (!dsl_is_punct(p, ch)) {
+        char expected[2] = {ch, '\0'};
+        dsl_error(p, "expected", expected);
+        return false;
+    }
+    dsl_next_token(p);
+    return true;
+}
+
+static dsl_type_t dsl_parse_type_name(const char* name) {
+    if (strcmp(name, "float") == 0) return DSL_FLOAT;
+    if (strcmp(name, "vec2") == 0) return DSL_VEC2;
+    if (strcmp(name, "vec3") == 0) return DSL_VEC3;
+    if (strcmp(name, "vec4") == 0) return DSL_VEC4;
+    if (strcmp(name, "mat4") == 0) return DSL_MAT4;
+    if (strcmp(name, "sampler2D") == 0) return DSL_SAMPLER;
+    return DSL_VOID;
+}
+
+static bool dsl_is_vector(dsl_type_t type) {
+    return type >= DSL_FLOAT && type <= DSL_VEC4;
+}
+
+static void dsl_emit(dsl_parser_t* p, dsl_opcode_t op, int width, int dst, int a, int b, int c, int index) {
+    dsl_stage_t* s = p->stage;
+    if (s->code_count == s->code_capacity) {
+        int capacity = s->code_capacity ? s->code_capacity * 2 : 64;
+        dsl_inst_t* code = (dsl_inst_t*)realloc(s->code, (size_t)capacity * sizeof(dsl_inst_t));
+        if (!code) {
+            dsl_error(p, "out of memory", NULL);
+            return;
+        }
+        s->code = code;
+        s->code_capacity = capacity;
+    }
+
+    dsl_inst_t* inst = &s->code[s->code_count++];
+    inst->op = (uint8_t)op;
+    inst->width = (uint8_t)width;
+    inst->dst = (uint8_t)dst;
+    inst->a = (uint8_t)a;
+    inst->b = (uint8_t)b;
+    inst->c = (uint8_t)c;
+    inst->index = (uint16_t)index;
+}
+
+static int dsl_alloc_temp(dsl_parser_t* p) {
+    if (p->next_temp >= p->persistent_floor) {
+        dsl_error(p, "expression too complex", NULL);
+        return 0;
+    }
+    return p->next_temp++;
+}
+
+static int dsl_alloc_persistent(dsl_parser_t* p) {
+    if (p->persistent_floor <= p->next_temp) {
+        dsl_error(p, "too many live values", NULL);
+        return 0;
+    }
+    return --p->persistent_floor;
+}
+
+static int dsl_add_constant(dsl_parser_t* p, const float* values, int count) {
+    dsl_stage_t* s = p->stage;
+    if (s->constant_count + 4 > s->constant_capacity) {
+        int capacity = s->constant_capacity ? s->constant_capacity * 2 : 64;
+        float* constants = (float*)realloc(s->constants, (size_t)capacity * sizeof(float));
+        if (!constants) {
+            dsl_error(p, "out of memory", NULL);
+            return 0;
+        }
+        s->constants = constants;
+        s->constant_capacity = capacity;
+    }
+
+    int index = s->constant_count;
+    for (int i = 0; i < 4; i++) {
+        s->constants[index + i] = i < count ? values[i] : 0.0f;
+    }
+    s->constant_count += 4;
+    return index;
+}
+
+// Broadcast a float value to a vector width
+static dsl_value_t dsl_splat(dsl_parser_t* p, dsl_value_t value, dsl_type_t type) {
+    if (value.type == type || value.type != DSL_FLOAT) {
+        return value;
+    }
+    dsl_value_t result = {type, dsl_alloc_temp(p)};
+    dsl_emit(p, DSL_OP_SPLAT, (int)type, result.reg, value.reg, 0, 0, 0);
+    return result;
+}
+
+// Bring two operands to a common vector type
+static bool dsl_unify(dsl_parser_t* p, dsl_value_t* a, dsl_value_t* b) {
+    if (!dsl_is_vector(a->type) || !dsl_is_vector(b->type)) {
+        dsl_error(p, "operands must be float or vector", NULL);
+        return false;
+    }
+    if (a->type == b->type) {
+        return true;
+    }
+    if (a->type == DSL_FLOAT) {
+        *a = dsl_splat(p, *a, b->type);
+        return true;
+    }
+    if (b->type == DSL_FLOAT) {
+        *b = dsl_splat(p, *b, a->type);
+        return true;
+    }
+    dsl_error(p, "type mismatch", NULL);
+    return false;
+}
+
+static dsl_value_t dsl_parse_expression(dsl_parser_t* p);
+
+// Resolve an identifier used as a value
+static dsl_value_t dsl_load_identifier(dsl_parser_t* p, const char* name) {
+    dsl_value_t value = {DSL_VOID, 0};
+
+    for (int i = 0; i < p->local_count; i++) {
+        if (strcmp(p->locals[i].name, name) == 0) {
+            value.type = p->locals[i].type;
+            value.reg = p->locals[i].reg;
+            return value;
+        }
+    }
+
+    for (int i = 0; i < p->uniform_count; i++) {
+        dsl_global_t* u = &p->uniforms[i];
+        if (strcmp(u->name, name) != 0) {
+            continue;
+        }
+        value.type = u->type;
+        if (u->type == DSL_MAT4 || u->type == DSL_SAMPLER) {
+            value.reg = u->offset;
+            return value;
+        }
+        if (u->reg < 0) {
+            u->reg = dsl_alloc_persistent(p);
+            dsl_emit(p, DSL_OP_UNIFORM, (int)u->type, u->reg, 0, 0, 0, u->offset);
+        }
+        value.reg = u->reg;
+        return value;
+    }
+
+    dsl_global_t* inputs = p->vertex_stage ? p->attributes : p->varyings;
+    int input_count = p->vertex_stage ? 4 : p->varying_count;
+    for (int i = 0; i < input_count; i++) {
+        dsl_global_t* in = &inputs[i];
+        if (strcmp(in->name, name) != 0) {
+            continue;
+        }
+        if (in->reg < 0) {
+            in->reg = dsl_alloc_persistent(p);
+            dsl_emit(p, DSL_OP_INPUT, (int)in->type, in->reg, 0, 0, 0, in->offset);
+        }
+        value.type = in->type;
+        value.reg = in->reg;
+        return value;
+    }
+
+    dsl_error(p, "unknown identifier", name);
+    return value;
+}
+
+// Compile a built-in function call; the opening parenthesis is consumed
+static dsl_value_t dsl_parse_call(dsl_parser_t* p, const char* name) {
+    dsl_value_t args[4];
+    int arg_count = 0;
+    dsl_value_t result = {DSL_VOID, 0};
+
+    if (!dsl_is_punct(p, ')')) {
+        for (;;) {
+            if (arg_count == 4) {
+                dsl_error(p, "too many arguments to", name);
+                return result;
+            }
+            args[arg_count++] = dsl_parse_expression(p);
+            if (p->failed) {
+                return result;
+            }
+            if (!dsl_is_punct(p, ',')) {
+                break;
+            }
+            dsl_next_token(p);
+        }
+    }
+    if (!dsl_expect(p, ')')) {
+        return result;
+    }
+
+    // Vector constructors
+    dsl_type_t ctor = dsl_parse_type_name(name);
+    if (ctor >= DSL_VEC2 && ctor <= DSL_VEC4) {
+        result.type = ctor;
+        result.reg = dsl_alloc_temp(p);
+        if (arg_count == 1 && args[0].type == DSL_FLOAT) {
+            dsl_emit(p, DSL_OP_SPLAT, (int)ctor, result.reg, args[0].reg, 0, 0, 0);
+            return result;
+        }
+        int offset = 0;
+        for (int i = 0; i < arg_count; i++) {
+            if (!dsl_is_vector(args[i].type) || offset + (int)args[i].type > (int)ctor) {
+                dsl_error(p, "bad arguments to", name);
+                return result;
+            }
+            dsl_emit(p, DSL_OP_INSERT, (int)args[i].type, result.reg, args[i].reg, 0, 0, offset);
+            offset += (int)args[i].type;
+        }
+        if (offset != (int)ctor) {
+            dsl_error(p, "bad arguments to", name);
+        }
+        return result;
+    }
+
+    // Functions of one vector
+    static const struct {
+        const char* name;
+        dsl_opcode_t op;
+        bool scalar_result;
+    } unary[] = {
+        {"normalize", DSL_OP_NORMALIZE, false},
+        {"length", DSL_OP_LENGTH, true},
+        {"sqrt", DSL_OP_SQRT, false},
+        {"abs", DSL_OP_ABS, false},
+        {"floor", DSL_OP_FLOOR, false},
+        {"fract", DSL_OP_FRACT, false}
+    };
+    for (size_t i = 0; i < sizeof(unary) / sizeof(unary[0]); i++) {
+        if (strcmp(name, unary[i].name) != 0) {
+            continue;
+        }
+        if (arg_count != 1 || !dsl_is_vector(args[0].type)) {
+            dsl_error(p, "bad arguments to", name);
+            return result;
+        }
+        result.type = unary[i].scalar_result ? DSL_FLOAT : args[0].type;
+        result.reg = dsl_alloc_temp(p);
+        dsl_emit(p, unary[i].op, (int)args[0].type, result.reg, args[0].reg, 0, 0, 0);
+        return result;
+    }
+
+    // Componentwise functions of two vectors
+    dsl_opcode_t binary_op = DSL_OP_END;
+    if (strcmp(name, "min") == 0) binary_op = DSL_OP_MIN;
+    else if (strcmp(name, "max") == 0) binary_op = DSL_OP_MAX;
+    else if (strcmp(name, "pow") == 0) binary_op = DSL_OP_POW;
+    if (binary_op != DSL_OP_END) {
+        if (arg_count != 2 || !dsl_unify(p, &args[0], &args[1])) {
+            dsl_error(p, "bad arguments to", name);
+            return result;
+        }
+        result.type = args[0].type;
+        result.reg = dsl_alloc_temp(p);
+        dsl_emit(p, binary_op, (int)result.type, result.reg, args[0].reg, args[1].reg, 0, 0);
+        return result;
+    }
+
+    if (strcmp(name, "dot") == 0 || strcmp(name, "cross") == 0) {
+        bool cross = name[0] == 'c';
+        if (arg_count != 2 || args[0].type != args[1].type || !dsl_is_vector(args[0].type) ||
+            (cross && args[0].type != DSL_VEC3)) {
+            dsl_error(p, "bad arguments to", name);
+            return result;
+        }
+        result.type = cross ? DSL_VEC3 : DSL_FLOAT;
+        result.reg = dsl_alloc_temp(p);
+        dsl_emit(p, cross ? DSL_OP_CROSS : DSL_OP_DOT, (int)args[0].type,
+                 result.reg, args[0].reg, args[1].reg, 0, 0);
+        return result;
+    }
+
+    if (strcmp(name, "clamp") == 0 || strcmp(name, "mix") == 0) {
+        if (arg_count != 3 || !dsl_is_vector(args[0].type)) {
+            dsl_error(p, "bad arguments to", name);
+            return result;
+        }
+        if (!dsl_unify(p, &args[0], &args[1])) {
+            return result;
+        }
+        args[2] = dsl_splat(p, args[2], args[0].type);
+        if (args[2].type != args[0].type) {
+            dsl_error(p, "bad arguments to", name);
+            return result;
+        }
+        result.type = args[0].type;
+        result.reg = dsl_alloc_temp(p);
+        dsl_emit(p, name[0] == 'c' ? DSL_OP_CLAMP : DSL_OP_MIX, (int)result.type,
+                 result.reg, args[0].reg, args[1].reg, args[2].reg, 0);
+        return result;
+    }
+
+    if (strcmp(name, "texture") == 0) {
+        if (arg_count != 2 || args[0].type != DSL_SAMPLER || args[1].type != DSL_VEC2) {
+            dsl_error(p, "bad arguments to", name);
+            return result;
+        }
+        result.type = DSL_VEC4;
+        result.reg = dsl_alloc_temp(p);
+        dsl_emit(p, DSL_OP_TEXTURE, 4, result.reg, args[1].reg, 0, 0, args[0].reg);
+        return result;
+    }
+
+    dsl_error(p, "unknown function", name);
+    return result;
+}
+
+static dsl_value_t dsl_parse_primary(dsl_parser_t* p) {
+    dsl_value_t value = {DSL_VOID, 0};
+
+    if (p->token.kind == DSL_TOKEN_NUMBER) {
+        float number = p->token.number;
+        dsl_next_token(p);
+        value.type = DSL_FLOAT;
+        value.reg = dsl_alloc_temp(p);
+        dsl_emit(p, DSL_OP_CONST, 1, value.reg, 0, 0, 0, dsl_add_constant(p, &number, 1));
+        return value;
+    }
+
+    if (p->token.kind == DSL_TOKEN_IDENT) {
+        char name[DSL_MAX_IDENT];
+        strcpy(name, p->token.text);
+        dsl_next_token(p);
+        if (dsl_is_punct(p, '(')) {
+            dsl_next_token(p);
+            return dsl_parse_call(p, name);
+        }
+        return dsl_load_identifier(p, name);
+    }
+
+    if (dsl_is_punct(p, '(')) {
+        dsl_next_token(p);
+        value = dsl_parse_expression(p);
+        dsl_expect(p, ')');
+        return value;
+    }
+
+    dsl_error(p, "expected expression", NULL);
+    return value;
+}
+
+static dsl_value_t dsl_parse_postfix(dsl_parser_t* p) {
+    dsl_value_t value = dsl_parse_primary(p);
+
+    while (!p->failed && dsl_is_punct(p, '.')) {
+        dsl_next_token(p);
+        if (p->token.kind != DSL_TOKEN_IDENT || !dsl_is_vector(value.type)) {
+            dsl_error(p, "bad swizzle", NULL);
+            return value;
+        }
+
+        const char* s = p->token.text;
+        int len = (int)strlen(s);
+        int selector = 0;
+        if (len < 1 || len > 4) {
+            dsl_error(p, "bad swizzle", s);
+            return value;
+        }
+        for (int i = 0; i < len; i++) {
+            const char* hit = strchr("xyzw", s[i]);
+            if (!hit) {
+                hit = strchr("rgba", s[i]);
+                hit = hit ? "xyzw" + (hit - "rgba") : NULL;
+            }
+            int component = hit ? (int)(hit - "xyzw") : 4;
+            if (component >= (int)value.type) {
+                dsl_error(p, "bad swizzle", s);
+                return value;
+            }
+            selector |= component << (i * 2);
+        }
+        dsl_next_token(p);
+
+        dsl_value_t result = {(dsl_type_t)len, dsl_alloc_temp(p)};
+        dsl_emit(p, DSL_OP_SWIZZLE, len, result.reg, value.reg, 0, 0, selector);
+        value = result;
+    }
+
+    return value;
+}
+
+static dsl_value_t dsl_parse_unary(dsl_parser_t* p) {
+    if (dsl_is_punct(p, '-')) {
+        dsl_next_token(p);
+        dsl_value_t operand = dsl_parse_unary(p);
+        if (!dsl_is_vector(operand.type)) {
+            dsl_error(p, "bad operand to unary -", NULL);
+            return operand;
+        }
+        dsl_value_t result = {operand.type, dsl_alloc_temp(p)};
+        dsl_emit(p, DSL_OP_NEG, (int)operand.type, result.reg, operand.reg, 0, 0, 0);
+        return result;
+    }
+    return dsl_parse_postfix(p);
+}
+
+static dsl_value_t dsl_parse_term(dsl_parser_t* p) {
+    dsl_value_t left = dsl_parse_unary(p);
+
+    while (!p->failed && (dsl_is_punct(p, '*') || dsl_is_punct(p, '/'))) {
+        bool multiply = p->token.punct == '*';
+        dsl_next_token(p);
+        dsl_value_t right = dsl_parse_unary(p);
+        if (p->failed) {
+            break;
+        }
+
+        if (multiply && left.type == DSL_MAT4) {
+            if (right.type != DSL_VEC4) {
+                dsl_error(p, "mat4 can only multiply a vec4", NULL);
+                break;
+            }
+            dsl_value_t result = {DSL_VEC4, dsl_alloc_temp(p)};
+            dsl_emit(p, DSL_OP_MAT4_MUL, 4, result.reg, right.reg, 0, 0, left.reg);
+            left = result;
+            continue;
+        }
+
+        if (!dsl_unify(p, &left, &right)) {
+            break;
+        }
+        dsl_value_t result = {left.type, dsl_alloc_temp(p)};
+        dsl_emit(p, multiply ? DSL_OP_MUL : DSL_OP_DIV, (int)left.type, result.reg, left.reg, right.reg, 0, 0);
+        left = result;
+    }
+
+    return left;
+}
+
+static dsl_value_t dsl_parse_expression(dsl_parser_t* p) {
+    dsl_value_t left = dsl_parse_term(p);
+
+    while (!p->failed && (dsl_is_punct(p, '+') || dsl_is_punct(p, '-'))) {
+        bool add = p->token.punct == '+';
+        dsl_next_token(p);
+        dsl_value_t right = dsl_parse_term(p);
+        if (p->failed || !dsl_unify(p, &left, &right)) {
+            break;
+        }
+        dsl_value_t result = {left.type, dsl_alloc_temp(p)};
+        dsl_emit(p, add ? DSL_OP_ADD : DSL_OP_SUB, (int)left.type, result.reg, left.reg, right.reg, 0, 0);
+        left = result;
+    }
+
+    return left;
+}
+
+// Compile an expression and check its type
+static dsl_value_t dsl_parse_typed_expression(dsl_parser_t* p, dsl_type_t type) {
+    dsl_value_t value = dsl_parse_expression(p);
+    if (!p->failed && value.type != type) {
+        value = dsl_splat(p, value, type);
+        if (value.type != type) {
+            dsl_error(p, "type mismatch in assignment", NULL);
+        }
+    }
+    return value;
+}
+
+static void dsl_parse_statement(dsl_parser_t* p) {
+    if (p->token.kind != DSL_TOKEN_IDENT) {
+        dsl_error(p, "expected statement", NULL);
+        return;
+    }
+
+    char name[DSL_MAX_IDENT];
+    strcpy(name, p->token.text);
+    dsl_next_token(p);
+
+    // Local declaration
+    dsl_type_t type = dsl_parse_type_name(name);
+    if (type != DSL_VOID) {
+        if (!dsl_is_vector(type) || p->token.kind != DSL_TOKEN_IDENT) {
+            dsl_error(p, "bad local declaration", NULL);
+            return;
+        }
+        if (p->local_count == DSL_MAX_LOCALS) {
+            dsl_error(p, "too many locals", NULL);
+            return;
+        }
+        dsl_local_t* local = &p->locals[p->local_count];
+        strcpy(local->name, p->token.text);
+        for (int i = 0; i < p->local_count; i++) {
+            if (strcmp(p->locals[i].name, local->name) == 0) {
+                dsl_error(p, "redeclared local", local->name);
+                return;
+            }
+        }
+        dsl_next_token(p);
+        if (!dsl_expect(p, '=')) {
+            return;
+        }
+        dsl_value_t value = dsl_parse_typed_expression(p, type);
+        if (p->failed) {
+            return;
+        }
+        local->type = type;
+        local->reg = dsl_alloc_persistent(p);
+        dsl_emit(p, DSL_OP_MOV, (int)type, local->reg, value.reg, 0, 0, 0);
+        p->local_count++;
+        dsl_expect(p, ';');
+        return;
+    }
+
+    if (!dsl_expect(p, '=')) {
+        return;
+    }
+
+    // Stage outputs
+    if (strcmp(name, p->vertex_stage ? "out_position" : "out_color") == 0) {
+        dsl_value_t value = dsl_parse_typed_expression(p, DSL_VEC4);
+        if (!p->failed) {
+            dsl_emit(p, DSL_OP_OUTPUT, 4, 0, value.reg, 0, 0, 0);
+            p->wrote_output = true;
+        }
+        dsl_expect(p, ';');
+        return;
+    }
+
+    if (p->vertex_stage) {
+        for (int i = 0; i < p->varying_count; i++) {
+            if (strcmp(p->varyings[i].name, name) == 0) {
+                dsl_value_t value = dsl_parse_typed_expression(p, p->varyings[i].type);
+                if (!p->failed) {
+                    dsl_emit(p, DSL_OP_OUTPUT, (int)p->varyings[i].type, 0, value.reg, 0, 0,
+                             4 + p->varyings[i].offset);
+                }
+                dsl_expect(p, ';');
+                return;
+            }
+        }
+    }
+
+    for (int i = 0; i < p->local_count; i++) {
+        if (strcmp(p->locals[i].name, name) == 0) {
+            dsl_value_t value = dsl_parse_typed_expression(p, p->locals[i].type);
+            if (!p->failed) {
+                dsl_emit(p, DSL_OP_MOV, (int)p->locals[i].type, p->locals[i].reg, value.reg, 0, 0, 0);
+            }
+            dsl_expect(p, ';');
+            return;
+        }
+    }
+
+    dsl_error(p, "cannot assign to", name);
+}
+
+// Compile a vertex { } or fragment { } block
+static void dsl_parse_stage(dsl_parser_t* p, bool vertex) {
+    dsl_stage_t* stage = vertex ? &p->dsl->vertex : &p->dsl->fragment;
+    if (stage->code_count > 0) {
+        dsl_error(p, "duplicate stage", vertex ? "vertex" : "fragment");
+        return;
+    }
+
+    p->stage = stage;
+    p->vertex_stage = vertex;
+    p->wrote_output = false;
+    p->local_count = 0;
+    p->next_temp = 0;
+    p->persistent_floor = DSL_MAX_REGS;
+    for (int i = 0; i < p->uniform_count; i++) {
+        p->uniforms[i].reg = -1;
+    }
+    for (int i = 0; i < p->varying_count; i++) {
+        p->varyings[i].reg = -1;
+    }
+    for (int i = 0; i < 4; i++) {
+        p->attributes[i].reg = -1;
+    }
+
+    if (!dsl_expect(p, '{')) {
+        return;
+    }
+    while (!p->failed && !dsl_is_punct(p, '}') && p->token.kind != DSL_TOKEN_EOF) {
+        dsl_parse_statement(p);
+        p->next_temp = 0;
+    }
+    if (!dsl_expect(p, '}')) {
+        return;
+    }
+
+    if (!p->wrote_output) {
+        dsl_error(p, vertex ? "vertex stage never writes out_position" : "fragment stage never writes out_color", NULL);
+        return;
+    }
+    dsl_emit(p, DSL_OP_END, 0, 0, 0, 0, 0, 0);
+}
+
+// Parse a uniform or varying declaration; the keyword is consumed
+static void dsl_parse_declaration(dsl_parser_t* p, bool uniform) {
+    dsl_type_t type = p->token.kind == DSL_TOKEN_IDENT ? dsl_parse_type_name(p->token.text) : DSL_VOID;
+    if (type == DSL_VOID || (!uniform && !dsl_is_vector(type))) {
+        dsl_error(p, "bad declaration type", p->token.text);
+        return;
+    }
+    dsl_next_token(p);
+
+    if (p->token.kind != DSL_TOKEN_IDENT) {
+        dsl_error(p, "expected name", NULL);
+        return;
+    }
+
+    dsl_global_t* global;
+    if (uniform) {
+        if (p->uniform_count == AMOS_MAX_UNIFORMS) {
+            dsl_error(p, "too many uniforms", NULL);
+            return;
+        }
+        global = &p->uniforms[p->uniform_count];
+        strcpy(global->name, p->token.text);
+        global->type = type;
+
+        amos_uniform_type_t uniform_type;
+        void* data;
+        int size;
+        if (type == DSL_SAMPLER) {
+            if (p->sampler_count == AMOS_SHADER_DSL_MAX_SAMPLERS) {
+                dsl_error(p, "too many samplers", NULL);
+                return;
+            }
+            global->offset = p->sampler_count++;
+            uniform_type = AMOS_UNIFORM_SAMPLER2D;
+            data = (void*)&p->dsl->samplers[global->offset];
+            size = (int)sizeof(const amos_framebuffer_t*);
+        } else {
+            int floats = type == DSL_MAT4 ? 16 : (int)type;
+            if (p->uniform_floats + floats > DSL_MAX_UNIFORM_FLOATS) {
+                dsl_error(p, "uniform storage exhausted", NULL);
+                return;
+            }
+            global->offset = p->uniform_floats;
+            p->uniform_floats += floats;
+            static const amos_uniform_type_t types[] = {
+                AMOS_UNIFORM_FLOAT, AMOS_UNIFORM_FLOAT, AMOS_UNIFORM_VEC2,
+                AMOS_UNIFORM_VEC3, AMOS_UNIFORM_VEC4, AMOS_UNIFORM_MAT4
+            };
+            uniform_type = types[type];
+            data = &p->dsl->uniform_data[global->offset];
+            size = floats * (int)sizeof(float);
+        }
+
+        if (!amos_shader_program_add_uniform(p->program, global->name, uniform_type, data, size)) {
+            dsl_error(p, "cannot register uniform", global->name);
+            return;
+        }
+        p->uniform_count++;
+    } else {
+        if (p->dsl->varying_floats + (int)type > AMOS_SHADER_DSL_MAX_VARYING_FLOATS) {
+            dsl_error(p, "too many varyings", NULL);
+            return;
+        }
+        global = &p->varyings[p->varying_count++];
+        strcpy(global->name, p->token.text);
+        global->type = type;
+        global->offset = p->dsl->varying_floats;
+        p->dsl->varying_floats += (int)type;
+    }
+
+    dsl_next_token(p);
+    dsl_expect(p, ';');
+}
+
+static void dsl_free(struct amos_shader_dsl_t* dsl) {
+    if (!dsl) {
+        return;
+    }
+    free(dsl->vertex.code);
+    free(dsl->vertex.constants);
+    free(dsl->fragment.code);
+    free(dsl->fragment.constants);
+    free(dsl);
+}
+
+static void dsl_vertex_shader(
+    const amos_shader_program_t* program,
+    const amos_vertex_t* vertex_in,
+    amos_vec4_t* position_out,
+    void* varying_out
+) {
+    amos_shader_dsl_run_vertices(program, vertex_in, 1, position_out, varying_out);
+}
+
+static void dsl_fragment_shader(
+    const amos_shader_program_t* program,
+    const void* varying_in,
+    amos_vec4_t* color_out
+) {
+    amos_shader_dsl_run_fragments(program, varying_in, 1, color_out);
+}
+
+// Initialize a shader program from source
+bool amos_shader_program_init_source(
+    amos_shader_program_t* program,
+    const char* name,
+    const char* source
+) {
+    if (!program || !name || !source) {
+        return false;
+    }
+
+    struct amos_shader_dsl_t* dsl = (struct amos_shader_dsl_t*)calloc(1, sizeof(struct amos_shader_dsl_t));
+    if (!dsl) {
+        printf("Failed to allocate shader %s\n", name);
+        return false;
+    }
+
+    if (!amos_shader_program_init(program, name, dsl_vertex_shader, dsl_fragment_shader, 0)) {
+        free(dsl);
+        return false;
+    }
+
+    dsl_parser_t* p = (dsl_parser_t*)calloc(1, sizeof(dsl_parser_t));
+    if (!p) {
+        free(dsl);
+        return false;
+    }
+    p->program_name = name;
+    p->source = source;
+    p->pos = source;
+    p->line = 1;
+    p->dsl = dsl;
+    p->program = program;
+
+    static const struct {
+        const char* name;
+        dsl_type_t type;
+        int offset;
+    } attributes[4] = {
+        {"a_position", DSL_VEC3, DSL_INPUT_POSITION},
+        {"a_normal", DSL_VEC3, DSL_INPUT_NORMAL},
+        {"a_texcoord", DSL_VEC2, DSL_INPUT_TEXCOORD},
+        {"a_color", DSL_VEC4, DSL_INPUT_COLOR}
+    };
+    for (int i = 0; i < 4; i++) {
+        strcpy(p->attributes[i].name, attributes[i].name);
+        p->attributes[i].type = attributes[i].type;
+        p->attributes[i].offset = attributes[i].offset;
+    }
+
+    dsl_next_token(p);
+    while (!p->failed && p->token.kind != DSL_TOKEN_EOF) {
+        if (p->token.kind != DSL_TOKEN_IDENT) {
+            dsl_error(p, "expected declaration or stage", NULL);
+            break;
+        }
+        char keyword[DSL_MAX_IDENT];
+        strcpy(keyword, p->token.text);
+        dsl_next_token(p);
+
+        if (strcmp(keyword, "uniform") == 0) {
+            dsl_parse_declaration(p, true);
+        } else if (strcmp(keyword, "varying") == 0) {
+            dsl_parse_declaration(p, false);
+        } else if (strcmp(keyword, "vertex") == 0) {
+            dsl_parse_stage(p, true);
+        } else if (strcmp(keyword, "fragment") == 0) {
+            dsl_parse_stage(p, false);
+        } else {
+            dsl_error(p, "unexpected", keyword);
+        }
+    }
+
+    if (!p->failed && (dsl->vertex.code_count == 0 || dsl->fragment.code_count == 0)) {
+        dsl_error(p, "program needs both a vertex and a fragment stage", NULL);
+    }
+
+    bool ok = !p->failed;
+    free(p);
+
+    if (!ok) {
+        dsl_free(dsl);
+        program->uniform_count = 0;
+        program->vertex_shader = NULL;
+        program->fragment_shader = NULL;
+        return false;
+    }
+
+    dsl->vertex.input_stride = DSL_VERTEX_FLOATS;
+    dsl->vertex.output_stride = 4 + dsl->varying_floats;
+    dsl->fragment.input_stride = dsl->varying_floats;
+    dsl->fragment.output_stride = 4;
+
+    program->varying_size = dsl->varying_floats * (int)sizeof(float);
+    program->compiled = dsl;
+    return true;
+}
+
+// Release the compiled code of a program created from source
+void amos_shader_program_release(amos_shader_program_t* program) {
+    if (!program || !program->compiled) {
+        return;
+    }
+
+    dsl_free(program->compiled);
+    program->compiled = NULL;
+
+    // Uniform storage belonged to the compiled program
+    program->uniform_count = 0;
+    program->vertex_shader = NULL;
+    program->fragment_shader = NULL;
+}
+
+// Run the vertex stage of a compiled program over a batch of vertices
+void amos_shader_dsl_run_vertices(
+    const amos_shader_program_t* program,
+    const amos_vertex_t* vertices,
+    int count,
+    amos_vec4_t* positions,
+    void* varyings
+) {
+    const struct amos_shader_dsl_t* dsl = program->compiled;
+    int varying_floats = dsl->varying_floats;
+    float outputs[DSL_LANES * (4 + AMOS_SHADER_DSL_MAX_VARYING_FLOATS)];
+    int stride = 4 + varying_floats;
+
+    for (int first = 0; first < count; first += DSL_LANES) {
+        int batch = count - first < DSL_LANES ? count - first : DSL_LANES;
+
+        memset(outputs, 0, (size_t)batch * stride * sizeof(float));
+        dsl_execute(dsl, &dsl->vertex, (const float*)(vertices + first), outputs, batch);
+
+        for (int i = 0; i < batch; i++) {
+            const float* record = outputs + (size_t)i * stride;
+            memcpy(&positions[first + i], record, sizeof(amos_vec4_t));
+            if (varying_floats > 0) {
+                memcpy((float*)varyings + (size_t)(first + i) * varying_floats, record + 4,
+                       (size_t)varying_floats * sizeof(float));
+            }
+        }
+    }
+}
+
+// Run the fragment stage of a compiled program over a batch of fragments
+void amos_shader_dsl_run_fragments(
+    const amos_shader_program_t* program,
+    const void* varyings,
+    int count,
+    amos_vec4_t* colors
+) {
+    const struct amos_shader_dsl_t* dsl = program->compiled;
+    const float* inputs = (const float*)varyings;
+
+    for (int first = 0; first < count; first += DSL_LANES) {
+        int batch = count - first < DSL_LANES ? count - first : DSL_LANES;
+        dsl_execute(dsl, &dsl->fragment, inputs + (size_t)first * dsl->varying_floats,
+                    (float*)(colors + first), batch);
+    }
+}
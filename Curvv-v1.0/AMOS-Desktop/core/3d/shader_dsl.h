@@ -0,0 +1,107 @@
+/**
+ * AMOS Desktop OS - Shader Language
+ *
+ * This file defines a small shading language for the AMOS 3D renderer,
+ * so shader programs can be shipped as data instead of being compiled
+ * into the binary. Source is compiled once into threaded code that runs
+ * up to AMOS_SHADER_DSL_LANES vertices or fragments per dispatch.
+ *
+ * A program declares its uniforms and varyings, then one vertex and one
+ * fragment block of straight-line statements:
+ *
+ *     uniform mat4 mvp;
+ *     uniform vec3 light_dir;
+ *     uniform sampler2D albedo;
+ *     varying vec3 v_normal;
+ *     varying vec2 v_uv;
+ *
+ *     vertex {
+ *         v_normal = a_normal;
+ *         v_uv = a_texcoord;
+ *         out_position = mvp * vec4(a_position, 1.0);
+ *     }
+ *
+ *     fragment {
+ *         float d = max(dot(normalize(v_normal), light_dir), 0.0);
+ *         out_color = texture(albedo, v_uv) * d;
+ *     }
+ *
+ * Types are float, vec2, vec3, vec4, mat4 (uniform only, multiplies a
+ * vec4) and sampler2D (uniform only). Vertex inputs are a_position,
+ * a_normal, a_texcoord and a_color; stages write out_position and
+ * out_color. Expressions support + - * / with scalar broadcast,
+ * swizzles (.xyzw / .rgba), vector constructors, and the functions
+ * dot, cross, normalize, length, min, max, clamp, mix, pow, sqrt, abs,
+ * floor, fract and texture. Identifiers are at most 31 characters;
+ * longer ones are a compile error.
+ *
+ * Uniforms are registered on the program, so the regular
+ * amos_shader_program_set_uniform_* calls update them.
+ */
+
+#ifndef AMOS_SHADER_DSL_H
+#define AMOS_SHADER_DSL_H
+
+#include "shaders.h"
+
+// Vertices or fragments processed per dispatch
+#define AMOS_SHADER_DSL_LANES 8
+
+// Limits of a compiled program
+#define AMOS_SHADER_DSL_MAX_VARYING_FLOATS 32
+#define AMOS_SHADER_DSL_MAX_SAMPLERS 4
+
+/**
+ * Initialize a shader program from source
+ *
+ * @param program Pointer to shader program structure
+ * @param name Program name (used in error messages)
+ * @param source Program source
+ * @return true if the source compiled, false otherwise
+ */
+bool amos_shader_program_init_source(
+    amos_shader_program_t* program,
+    const char* name,
+    const char* source
+);
+
+/**
+ * Release the compiled code of a program created from source
+ *
+ * @param program Pointer to shader program
+ */
+void amos_shader_program_release(amos_shader_program_t* program);
+
+/**
+ * Run the vertex stage of a compiled program over a batch of vertices
+ *
+ * @param program Compiled shader program
+ * @param vertices Input vertices
+ * @param count Number of vertices
+ * @param positions Output clip-space positions
+ * @param varyings Output varyings, program->varying_size bytes per vertex
+ */
+void amos_shader_dsl_run_vertices(
+    const amos_shader_program_t* program,
+    const amos_vertex_t* vertices,
+    int count,
+    amos_vec4_t* positions,
+    void* varyings
+);
+
+/**
+ * Run the fragment stage of a compiled program over a batch of fragments
+ *
+ * @param program Compiled shader program
+ * @param varyings Interpolated varyings, program->varying_size bytes per fragment
+ * @param count Number of fragments
+ * @param colors Output colors
+ */
+void amos_shader_dsl_run_fragments(
+    const amos_shader_program_t* program,
+    const void* varyings,
+    int count,
+    amos_vec4_t* colors
+);
+
+#endif /* AMOS_SHADER_DSL_H */
@@ -36,6 +36,10 @@ bool amos_shader_program_init(
     program->uniform_count = 0;
     program->attribute_count = 0;
     
+    program->fragment_x = 0;
+    program->fragment_y = 0;
+    program->compiled = NULL;
+    
     return true;
 }
 
@@ -173,6 +177,22 @@ bool amos_shader_program_set_uniform_float(
     return true;
 }
 
+// Set a vec2 uniform value
+bool amos_shader_program_set_uniform_vec2(
+    amos_shader_program_t* program,
+    const char* name,
+    const amos_vec2_t* value
+) {
+    amos_uniform_t* uniform = amos_shader_program_get_uniform(program, name);
+    
+    if (!uniform || uniform->type != AMOS_UNIFORM_VEC2 || !value) {
+        return false;
+    }
+    
+    memcpy(uniform->data, value, sizeof(amos_vec2_t));
+    return true;
+}
+
 // Set a vec3 uniform value
 bool amos_shader_program_set_uniform_vec3(
     amos_shader_program_t* program,
@@ -237,6 +257,22 @@ bool amos_shader_program_set_uniform_int(
     return true;
 }
 
+// Set a texture uniform value
+bool amos_shader_program_set_uniform_texture(
+    amos_shader_program_t* program,
+    const char* name,
+    const amos_framebuffer_t* texture
+) {
+    amos_uniform_t* uniform = amos_shader_program_get_uniform(program, name);
+    
+    if (!uniform || uniform->type != AMOS_UNIFORM_SAMPLER2D) {
+        return false;
+    }
+    
+    *((const amos_framebuffer_t**)uniform->data) = texture;
+    return true;
+}
+
 // Process a vertex through the vertex shader
 void amos_shader_process_vertex(
     const amos_shader_program_t* program,
@@ -277,19 +313,17 @@ void amos_shader_interpolate_varying(
         return;
     }
     
-    // Cast to byte pointers for byte-by-byte interpolation
-    const unsigned char* b0 = (const unsigned char*)v0;
-    const unsigned char* b1 = (const unsigned char*)v1;
-    const unsigned char* b2 = (const unsigned char*)v2;
-    unsigned char* dst = (unsigned char*)result;
-    
-    // Interpolate each byte
-    for (int i = 0; i < size; i++) {
-        float interpolated = 
-            b0[i] * barycentric->x +
-            b1[i] * barycentric->y +
-            b2[i] * barycentric->z;
-        
-        dst[i] = (unsigned char)interpolated;
+    // Varyings are packed floats
+    const float* f0 = (const float*)v0;
+    const float* f1 = (const float*)v1;
+    const float* f2 = (const float*)v2;
+    float* dst = (float*)result;
+    int count = size / (int)sizeof(float);
+    
+    for (int i = 0; i < count; i++) {
+        dst[i] =
+            f0[i] * barycentric->x +
+            f1[i] * barycentric->y +
+            f2[i] * barycentric->z;
     }
 }
\ No newline at end of file
@@ -90,6 +90,14 @@ struct amos_shader_program_t {
     
     // Varying data size (for passing data between vertex and fragment shaders)
     int varying_size;
+    
+    // Window coordinates of the fragment being shaded, set by the
+    // rasterizer so fragment shaders can look up per-tile data
+    int fragment_x;
+    int fragment_y;
+    
+    // Compiled code for programs created from source (NULL otherwise)
+    struct amos_shader_dsl_t* compiled;
 };
 
 /**
@@ -184,6 +192,20 @@ bool amos_shader_program_set_uniform_float(
     float value
 );
 
+/**
+ * Set a vec2 uniform value
+ * 
+ * @param program Pointer to shader program
+ * @param name Uniform name
+ * @param value Pointer to vec2 value
+ * @return true if successful, false otherwise
+ */
+bool amos_shader_program_set_uniform_vec2(
+    amos_shader_program_t* program,
+    const char* name,
+    const amos_vec2_t* value
+);
+
 /**
  * Set a vec3 uniform value
  * 
@@ -240,6 +262,20 @@ bool amos_shader_program_set_uniform_int(
     int value
 );
 
+/**
+ * Set a texture uniform value
+ * 
+ * @param program Pointer to shader program
+ * @param name Uniform name
+ * @param texture Texture framebuffer (NULL to unbind)
+ * @return true if successful, false otherwise
+ */
+bool amos_shader_program_set_uniform_texture(
+    amos_shader_program_t* program,
+    const char* name,
+    const amos_framebuffer_t* texture
+);
+
 /**
  * Process a vertex through the vertex shader
  * 
@@ -271,6 +307,8 @@ void amos_shader_process_fragment(
 /**
  * Interpolate varying data between three vertices
  * 
+ * Varying data is treated as an array of floats.
+ * 
  * @param v0 Varying data from first vertex
  * @param v1 Varying data from second vertex
  * @param v2 Varying data from third vertex
@@ -0,0 +1,169 @@
+/**
+ * AMOS Desktop OS - Texture Mip Cache Implementation
+ *
+ * This file implements the per-renderer mip cache. Levels are built
+ * with a 2x2 box filter; a chain is reused as long as its source
+ * framebuffer keeps the same generation and size.
+ */
+
+#include "texture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mip chains owned by one renderer
+struct amos_texture_cache_t {
+    amos_texture_mips_t entries[AMOS_TEXTURE_CACHE_SIZE];
+    uint64_t clock;
+};
+
+// Average four RGBA pixels, two channels per 32-bit lane
+static inline uint32_t average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    uint32_t rb = (a & 0x00FF00FFu) + (b & 0x00FF00FFu) + (c & 0x00FF00FFu) + (d & 0x00FF00FFu);
+    uint32_t ga = ((a >> 8) & 0x00FF00FFu) + ((b >> 8) & 0x00FF00FFu) +
+                  ((c >> 8) & 0x00FF00FFu) + ((d >> 8) & 0x00FF00FFu);
+    rb = ((rb + 0x00020002u) >> 2) & 0x00FF00FFu;
+    ga = ((ga + 0x00020002u) >> 2) & 0x00FF00FFu;
+    return rb | (ga << 8);
+}
+
+// Halve one level into the next
+static void downsample(const amos_texture_level_t* src, uint32_t* dst, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        int y0 = y * 2;
+        int y1 = y0 + 1 < src->height ? y0 + 1 : y0;
+        const uint32_t* row0 = src->texels + (size_t)y0 * src->pitch;
+        const uint32_t* row1 = src->texels + (size_t)y1 * src->pitch;
+        uint32_t* out = dst + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            int x0 = x * 2;
+            int x1 = x0 + 1 < src->width ? x0 + 1 : x0;
+            out[x] = average4(row0[x0], row0[x1], row1[x0], row1[x1]);
+        }
+    }
+}
+
+// Build every level of a chain from its source
+static bool build_chain(amos_texture_mips_t* mips, const amos_framebuffer_t* texture) {
+    // Size the levels first so storage is allocated once
+    size_t total = 0;
+    int level_count = 1;
+    int w = texture->width, h = texture->height;
+    while ((w > 1 || h > 1) && level_count < AMOS_TEXTURE_MAX_LEVELS) {
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+        total += (size_t)w * h;
+        level_count++;
+    }
+
+    if (total > mips->storage_capacity) {
+        uint32_t* storage = (uint32_t*)realloc(mips->storage, total * sizeof(uint32_t));
+        if (!storage) {
+            printf("Failed to allocate mip levels for %dx%d texture\n", texture->width, texture->height);
+            return false;
+        }
+        mips->storage = storage;
+        mips->storage_capacity = total;
+    }
+
+    mips->levels[0].texels = (const uint32_t*)texture->buffer;
+    mips->levels[0].width = texture->width;
+    mips->levels[0].height = texture->height;
+    mips->levels[0].pitch = texture->pitch / 4;
+
+    uint32_t* next = mips->storage;
+    for (int i = 1; i < level_count; i++) {
+        const amos_texture_level_t* src = &mips->levels[i - 1];
+        amos_texture_level_t* dst = &mips->levels[i];
+        dst->width = src->width > 1 ? src->width / 2 : 1;
+        dst->height = src->height > 1 ? src->height / 2 : 1;
+        dst->pitch = dst->width;
+        dst->texels = next;
+        downsample(src, next, dst->width, dst->height);
+        next += (size_t)dst->width * dst->height;
+    }
+
+    mips->source = texture;
+    mips->generation = texture->generation;
+    mips->width = texture->width;
+    mips->height = texture->height;
+    mips->level_count = level_count;
+    return true;
+}
+
+// Get the mip chain of a texture, building or refreshing it if needed
+const amos_texture_mips_t* amos_texture_cache_get(
+    amos_renderer3d_t* renderer,
+    const amos_framebuffer_t* texture
+) {
+    if (!renderer || !texture || !texture->buffer || texture->bytes_per_pixel != 4 ||
+        texture->width <= 0 || texture->height <= 0) {
+        return NULL;
+    }
+
+    struct amos_texture_cache_t* cache = renderer->texture_cache;
+    if (!cache) {
+        cache = (struct amos_texture_cache_t*)calloc(1, sizeof(*cache));
+        if (!cache) {
+            printf("Failed to allocate texture cache\n");
+            return NULL;
+        }
+        renderer->texture_cache = cache;
+    }
+    cache->clock++;
+
+    // Find the entry for this texture, or the least recently used one
+    amos_texture_mips_t* victim = &cache->entries[0];
+    for (int i = 0; i < AMOS_TEXTURE_CACHE_SIZE; i++) {
+        amos_texture_mips_t* entry = &cache->entries[i];
+        if (entry->source == texture) {
+            if (entry->generation != texture->generation || entry->width != texture->width ||
+                entry->height != texture->height ||
+                entry->levels[0].texels != (const uint32_t*)texture->buffer) {
+                if (!build_chain(entry, texture)) {
+                    return NULL;
+                }
+            }
+            entry->last_used = cache->clock;
+            return entry;
+        }
+        if (entry->last_used < victim->last_used) {
+            victim = entry;
+        }
+    }
+
+    if (!build_chain(victim, texture)) {
+        victim->source = NULL;
+        return NULL;
+    }
+    victim->last_used = cache->clock;
+    return victim;
+}
+
+// Drop a texture from the cache
+void amos_texture_cache_forget(amos_renderer3d_t* renderer, const amos_framebuffer_t* texture) {
+    if (!renderer || !renderer->texture_cache) {
+        return;
+    }
+
+    for (int i = 0; i < AMOS_TEXTURE_CACHE_SIZE; i++) {
+        amos_texture_mips_t* entry = &renderer->texture_cache->entries[i];
+        if (entry->source == texture) {
+            entry->source = NULL;
+            entry->last_used = 0;
+        }
+    }
+}
+
+// Release every mip chain owned by the renderer
+void amos_texture_cache_release(amos_renderer3d_t* renderer) {
+    if (!renderer || !renderer->texture_cache) {
+        return;
+    }
+
+    for (int i = 0; i < AMOS_TEXTURE_CACHE_SIZE; i++) {
+        free(renderer->texture_cache->entries[i].storage);
+    }
+    free(renderer->texture_cache);
+    renderer->texture_cache = NULL;
+}
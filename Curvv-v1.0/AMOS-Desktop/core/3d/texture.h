@@ -0,0 +1,70 @@
+/**
+ * AMOS Desktop OS - Texture Mip Cache
+ *
+ * This file defines the mip chains the 3D pipeline samples from. Any
+ * 32bpp framebuffer, including a window's backing store, can be used
+ * directly as a material texture: level 0 is the framebuffer itself and
+ * only the smaller levels are stored. Chains are kept in a per-renderer
+ * cache and rebuilt only when the framebuffer's generation changes.
+ */
+
+#ifndef AMOS_TEXTURE_H
+#define AMOS_TEXTURE_H
+
+#include "renderer3d.h"
+
+// Levels down to 1x1 for textures up to 32768 pixels on a side
+#define AMOS_TEXTURE_MAX_LEVELS 16
+
+// Textures tracked per renderer before the least recently used is evicted
+#define AMOS_TEXTURE_CACHE_SIZE 64
+
+// One mip level
+typedef struct {
+    const uint32_t* texels;
+    int width;
+    int height;
+    int pitch;              // Row length in pixels
+} amos_texture_level_t;
+
+// Mip chain of one source framebuffer
+typedef struct {
+    const amos_framebuffer_t* source;
+    uint32_t generation;    // Source generation the chain was built from
+    int width;              // Source size the chain was built for
+    int height;
+    int level_count;
+    amos_texture_level_t levels[AMOS_TEXTURE_MAX_LEVELS];
+    uint32_t* storage;      // Levels 1 and up
+    size_t storage_capacity;
+    uint64_t last_used;
+} amos_texture_mips_t;
+
+/**
+ * Get the mip chain of a texture, building or refreshing it if needed
+ *
+ * @param renderer Pointer to renderer structure
+ * @param texture 32bpp framebuffer used as a texture
+ * @return Mip chain, or NULL if the texture is unusable or memory ran out
+ */
+const amos_texture_mips_t* amos_texture_cache_get(
+    amos_renderer3d_t* renderer,
+    const amos_framebuffer_t* texture
+);
+
+/**
+ * Drop a texture from the cache, e.g. before its framebuffer is freed
+ *
+ * @param renderer Pointer to renderer structure
+ * @param texture Framebuffer to forget
+ */
+void amos_texture_cache_forget(amos_renderer3d_t* renderer, const amos_framebuffer_t* texture);
+
+/**
+ * Release every mip chain owned by the renderer
+ *
+ * @param renderer Pointer to renderer structure
+ */
+void amos_texture_cache_release(amos_renderer3d_t* renderer);
+
+#endif /* AMOS_TEXTURE_H */
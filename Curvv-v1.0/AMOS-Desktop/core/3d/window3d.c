@@ -0,0 +1,229 @@
+/**
+ * AMOS Desktop OS - 3D Window Views Implementation
+ *
+ * This file implements on-demand rendering of 3D scenes into window
+ * framebuffers. Each update walks the registered views, renders the
+ * ones that are dirty or whose animation is due, and adds their client
+ * rects to the caller's damage list.
+ */
+
+#include "window3d.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Get a depth buffer of at least width * height floats
+static float* depth_pool_acquire(amos_depth_pool_t* pool, int width, int height) {
+    size_t needed = (size_t)width * (size_t)height;
+    if (needed > pool->capacity) {
+        float* buffer = (float*)realloc(pool->buffer, needed * sizeof(float));
+        if (!buffer) {
+            printf("Failed to allocate %dx%d depth buffer\n", width, height);
+            return NULL;
+        }
+        pool->buffer = buffer;
+        pool->capacity = needed;
+    }
+    return pool->buffer;
+}
+
+// Initialize the view system
+void amos_window3d_system_init(amos_window3d_system_t* system) {
+    if (system) {
+        memset(system, 0, sizeof(*system));
+    }
+}
+
+// Release the view system's depth pool
+void amos_window3d_system_cleanup(amos_window3d_system_t* system) {
+    if (!system) {
+        return;
+    }
+
+    for (int i = 0; i < system->view_count; i++) {
+        system->views[i]->renderer->depth_buffer = NULL;
+    }
+    free(system->depth_pool.buffer);
+    memset(system, 0, sizeof(*system));
+}
+
+// Bind a renderer to a window and register the view
+bool amos_window3d_bind(
+    amos_window3d_system_t* system,
+    amos_window3d_t* view,
+    amos_window_t* window,
+    amos_renderer3d_t* renderer,
+    amos_window3d_render_fn render,
+    void* user_data
+) {
+    if (!system || !view || !window || !renderer || !render) {
+        return false;
+    }
+
+    if (system->view_count >= AMOS_MAX_WINDOWS) {
+        printf("Too many 3D views\n");
+        return false;
+    }
+
+    memset(view, 0, sizeof(*view));
+    view->window = window;
+    view->renderer = renderer;
+    view->render = render;
+    view->user_data = user_data;
+    view->dirty = true;
+
+    renderer->color_buffer = window->framebuffer;
+    renderer->depth_buffer = NULL;
+
+    system->views[system->view_count++] = view;
+    return true;
+}
+
+// Unregister a view and detach its renderer from the window
+void amos_window3d_unbind(amos_window3d_system_t* system, amos_window3d_t* view) {
+    if (!system || !view) {
+        return;
+    }
+
+    for (int i = 0; i < system->view_count; i++) {
+        if (system->views[i] == view) {
+            memmove(&system->views[i], &system->views[i + 1],
+                    (size_t)(system->view_count - i - 1) * sizeof(system->views[0]));
+            system->view_count--;
+            break;
+        }
+    }
+
+    view->renderer->color_buffer = NULL;
+    view->renderer->depth_buffer = NULL;
+}
+
+// Mark a view's scene as changed
+void amos_window3d_invalidate(amos_window3d_t* view) {
+    if (view) {
+        view->dirty = true;
+    }
+}
+
+// Start or stop a view's animation clock
+void amos_window3d_set_animation(amos_window3d_t* view, double interval_ms, double now_ms) {
+    if (!view) {
+        return;
+    }
+
+    view->frame_interval_ms = interval_ms > 0.0 ? interval_ms : 0.0;
+    view->next_frame_ms = now_ms + view->frame_interval_ms;
+}
+
+// Render one view into its window
+static bool render_view(amos_window3d_system_t* system, amos_window3d_t* view, double now_ms) {
+    amos_framebuffer_t* target = view->window->framebuffer;
+    amos_renderer3d_t* renderer = view->renderer;
+
+    float* depth = depth_pool_acquire(&system->depth_pool, target->width, target->height);
+    if (!depth) {
+        return false;
+    }
+
+    renderer->color_buffer = target;
+    renderer->depth_buffer = depth;
+    renderer->width = target->width;
+    renderer->height = target->height;
+    renderer->camera.aspect = (float)target->width / (float)target->height;
+
+    size_t pixels = (size_t)target->width * (size_t)target->height;
+    for (size_t i = 0; i < pixels; i++) {
+        depth[i] = renderer->camera.far_clip;
+    }
+
+    view->render(view, renderer, now_ms);
+
+    // The pooled buffer belongs to whichever view renders next
+    renderer->depth_buffer = NULL;
+    view->last_width = target->width;
+    view->last_height = target->height;
+    return true;
+}
+
+// Render every view that is dirty or due for an animation frame
+int amos_window3d_system_update(
+    amos_window3d_system_t* system,
+    double now_ms,
+    amos_damage_t* damage
+) {
+    if (!system) {
+        return 0;
+    }
+
+    int rendered = 0;
+    for (int i = 0; i < system->view_count; i++) {
+        amos_window3d_t* view = system->views[i];
+        amos_window_t* window = view->window;
+        amos_framebuffer_t* target = window->framebuffer;
+
+        if (!target || !target->initialized || target->width <= 0 || target->height <= 0) {
+            continue;
+        }
+
+        if (target->width != view->last_width || target->height != view->last_height) {
+            view->dirty = true;
+        }
+
+        bool animation_due = view->frame_interval_ms > 0.0 && now_ms >= view->next_frame_ms;
+        if (!view->dirty && !animation_due) {
+            continue;
+        }
+
+        if (window->flags & (AMOS_WINDOW_FLAG_HIDDEN | AMOS_WINDOW_FLAG_MINIMIZED)) {
+            // Catch up on the next frame after the window is shown
+            view->dirty = true;
+            continue;
+        }
+
+        if (!render_view(system, view, now_ms)) {
+            continue;
+        }
+
+        view->dirty = false;
+        if (view->frame_interval_ms > 0.0) {
+            // Skip missed ticks instead of rendering a burst of frames
+            view->next_frame_ms += view->frame_interval_ms;
+            if (view->next_frame_ms <= now_ms) {
+                view->next_frame_ms = now_ms + view->frame_interval_ms;
+            }
+        }
+
+        if (damage) {
+            amos_rect_t client_rect;
+            amos_window_get_client_rect(window, &client_rect);
+            amos_damage_add(damage, &client_rect);
+        }
+        rendered++;
+    }
+
+    return rendered;
+}
+
+// Time the next view needs rendering
+double amos_window3d_system_next_due(const amos_window3d_system_t* system) {
+    if (!system) {
+        return -1.0;
+    }
+
+    double next = -1.0;
+    for (int i = 0; i < system->view_count; i++) {
+        const amos_window3d_t* view = system->views[i];
+        if (view->window->flags & (AMOS_WINDOW_FLAG_HIDDEN | AMOS_WINDOW_FLAG_MINIMIZED)) {
+            continue;
+        }
+
+        if (view->dirty) {
+            return 0.0;
+        }
+        if (view->frame_interval_ms > 0.0 && (next < 0.0 || view->next_frame_ms < next)) {
+            next = view->next_frame_ms;
+        }
+    }
+
+    return next;
+}
@@ -0,0 +1,150 @@
+/**
+ * AMOS Desktop OS - 3D Window Views
+ *
+ * This file defines how 3D scenes are shown in desktop windows. A view
+ * binds an amos_renderer3d_t to a window so the renderer draws straight
+ * into the window's framebuffer. Views redraw only when their scene is
+ * marked dirty or their animation clock ticks, and report damage for
+ * their client rect alone, so a static 3D window costs nothing per
+ * frame. Views render one after another and share a pooled depth buffer.
+ */
+
+#ifndef AMOS_WINDOW3D_H
+#define AMOS_WINDOW3D_H
+
+#include "renderer3d.h"
+#include "../graphics/window.h"
+#include "../graphics/damage.h"
+
+typedef struct amos_window3d_t amos_window3d_t;
+
+/**
+ * Scene callback; draws the view's scene with its renderer
+ *
+ * The colour target and a cleared depth buffer are bound before the call.
+ *
+ * @param view View being rendered
+ * @param renderer Renderer bound to the view's window
+ * @param time_ms Current time in milliseconds
+ */
+typedef void (*amos_window3d_render_fn)(
+    amos_window3d_t* view,
+    amos_renderer3d_t* renderer,
+    double time_ms
+);
+
+// Depth buffer shared by views that render one after another
+typedef struct {
+    float* buffer;
+    size_t capacity;        // In floats
+} amos_depth_pool_t;
+
+// 3D scene shown in a window
+struct amos_window3d_t {
+    amos_window_t* window;
+    amos_renderer3d_t* renderer;
+    amos_window3d_render_fn render;
+    void* user_data;
+
+    bool dirty;                 // Scene changed since the last render
+    double frame_interval_ms;   // Animation period, 0 when static
+    double next_frame_ms;       // Time the animation is next due
+    int last_width;             // Framebuffer size at the last render
+    int last_height;
+};
+
+// All views on the desktop
+typedef struct amos_window3d_system_t {
+    amos_window3d_t* views[AMOS_MAX_WINDOWS];
+    int view_count;
+    amos_depth_pool_t depth_pool;
+} amos_window3d_system_t;
+
+/**
+ * Initialize the view system
+ *
+ * @param system Pointer to view system structure
+ */
+void amos_window3d_system_init(amos_window3d_system_t* system);
+
+/**
+ * Release the view system's depth pool; views themselves are not freed
+ *
+ * @param system Pointer to view system structure
+ */
+void amos_window3d_system_cleanup(amos_window3d_system_t* system);
+
+/**
+ * Bind a renderer to a window and register the view
+ *
+ * The view starts dirty, so it renders on the next update.
+ *
+ * @param system Pointer to view system structure
+ * @param view View to initialize
+ * @param window Window whose framebuffer becomes the colour target
+ * @param renderer Renderer owned by the caller; its colour buffer and
+ *                 depth buffer are managed by the view from now on
+ * @param render Scene callback
+ * @param user_data User data pointer for the callback
+ * @return true if the view was registered, false otherwise
+ */
+bool amos_window3d_bind(
+    amos_window3d_system_t* system,
+    amos_window3d_t* view,
+    amos_window_t* window,
+    amos_renderer3d_t* renderer,
+    amos_window3d_render_fn render,
+    void* user_data
+);
+
+/**
+ * Unregister a view and detach its renderer from the window
+ *
+ * @param system Pointer to view system structure
+ * @param view View to remove
+ */
+void amos_window3d_unbind(amos_window3d_system_t* system, amos_window3d_t* view);
+
+/**
+ * Mark a view's scene as changed so it renders on the next update
+ *
+ * @param view Pointer to view
+ */
+void amos_window3d_invalidate(amos_window3d_t* view);
+
+/**
+ * Start or stop a view's animation clock
+ *
+ * @param view Pointer to view
+ * @param interval_ms Time between animation frames, or 0 to stop
+ * @param now_ms Current time in milliseconds
+ */
+void amos_window3d_set_animation(amos_window3d_t* view, double interval_ms, double now_ms);
+
+/**
+ * Render every view that is dirty or due for an animation frame
+ *
+ * Hidden and minimized windows are skipped and stay dirty until shown.
+ *
+ * @param system Pointer to view system structure
+ * @param now_ms Current time in milliseconds
+ * @param damage Damage list receiving the client rect of each rendered view (may be NULL)
+ * @return Number of views rendered
+ */
+int amos_window3d_system_update(
+    amos_window3d_system_t* system,
+    double now_ms,
+    amos_damage_t* damage
+);
+
+/**
+ * Time the next view needs rendering, so idle loops know how long to sleep
+ *
+ * Hidden and minimized windows are ignored until they are shown.
+ *
+ * @param system Pointer to view system structure
+ * @return Earliest due time in milliseconds (0 if a view is dirty), or -1 if none is due
+ */
+double amos_window3d_system_next_due(const amos_window3d_system_t* system);
+
+#endif /* AMOS_WINDOW3D_H */
@@ -0,0 +1,213 @@
+/**
+ * AMOS Desktop OS - Software Cursor Implementation
+ *
+ * This file implements the cursor overlay. Restoring and saving are
+ * row copies between the screen and a small buffer; drawing copies
+ * opaque image pixels and blends the rest.
+ */
+
+#include "cursor.h"
+#include <string.h>
+
+// Default arrow: 'X' outline, '.' fill, ' ' transparent
+#define ARROW_WIDTH 12
+#define ARROW_HEIGHT 19
+
+static const char* const arrow_image[ARROW_HEIGHT] = {
+    "X           ",
+    "XX          ",
+    "X.X         ",
+    "X..X        ",
+    "X...X       ",
+    "X....X      ",
+    "X.....X     ",
+    "X......X    ",
+    "X.......X   ",
+    "X........X  ",
+    "X.........X ",
+    "X......XXXXX",
+    "X...X..X    ",
+    "X..XX..X    ",
+    "X.X  X..X   ",
+    "XX   X..X   ",
+    "X     X..X  ",
+    "      X..X  ",
+    "       XX   "
+};
+
+// Initialize a cursor with the default arrow image, hidden at (0, 0)
+void amos_cursor_init(amos_cursor_t* cursor) {
+    if (!cursor) {
+        return;
+    }
+
+    memset(cursor, 0, sizeof(*cursor));
+
+    amos_color_t arrow[ARROW_WIDTH * ARROW_HEIGHT];
+    for (int y = 0; y < ARROW_HEIGHT; y++) {
+        for (int x = 0; x < ARROW_WIDTH; x++) {
+            char c = arrow_image[y][x];
+            arrow[y * ARROW_WIDTH + x] = c == 'X' ? amos_color_rgb(0, 0, 0) :
+                                         c == '.' ? amos_color_rgb(255, 255, 255) :
+                                         amos_color_rgba(0, 0, 0, 0);
+        }
+    }
+    amos_cursor_set_image(cursor, arrow, ARROW_WIDTH, ARROW_HEIGHT, 0, 0);
+}
+
+// Replace the cursor image
+bool amos_cursor_set_image(
+    amos_cursor_t* cursor,
+    const amos_color_t* pixels,
+    int width,
+    int height,
+    int hot_x,
+    int hot_y
+) {
+    if (!cursor || !pixels || width <= 0 || height <= 0 ||
+        width > AMOS_CURSOR_MAX_SIZE || height > AMOS_CURSOR_MAX_SIZE) {
+        return false;
+    }
+
+    memcpy(cursor->image, pixels, (size_t)width * height * sizeof(amos_color_t));
+    cursor->width = width;
+    cursor->height = height;
+    cursor->hot_x = hot_x;
+    cursor->hot_y = hot_y;
+    cursor->changed = true;
+    return true;
+}
+
+// Move the pointer
+void amos_cursor_move(amos_cursor_t* cursor, int x, int y) {
+    if (!cursor) {
+        return;
+    }
+
+    cursor->x = x;
+    cursor->y = y;
+}
+
+// Show or hide the cursor
+void amos_cursor_set_visible(amos_cursor_t* cursor, bool visible) {
+    if (!cursor || cursor->visible == visible) {
+        return;
+    }
+
+    cursor->visible = visible;
+    cursor->changed = true;
+}
+
+// Forget the saved pixels because the screen under the cursor was redrawn
+void amos_cursor_invalidate(amos_cursor_t* cursor) {
+    if (cursor) {
+        cursor->drawn = false;
+    }
+}
+
+// Check whether the cursor on screen is out of date
+bool amos_cursor_needs_present(const amos_cursor_t* cursor) {
+    if (!cursor) {
+        return false;
+    }
+
+    return cursor->changed || cursor->drawn != cursor->visible ||
+           (cursor->visible && (cursor->x != cursor->drawn_x || cursor->y != cursor->drawn_y));
+}
+
+// Screen rectangle the cursor covers at its current position, clipped to the framebuffer
+static amos_rect_t cursor_rect(const amos_cursor_t* cursor, const amos_framebuffer_t* fb) {
+    int x0 = cursor->x - cursor->hot_x;
+    int y0 = cursor->y - cursor->hot_y;
+    int x1 = x0 + cursor->width;
+    int y1 = y0 + cursor->height;
+
+    x0 = x0 > 0 ? x0 : 0;
+    y0 = y0 > 0 ? y0 : 0;
+    x1 = x1 < fb->width ? x1 : fb->width;
+    y1 = y1 < fb->height ? y1 : fb->height;
+
+    amos_rect_t rect = {x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0};
+    return rect;
+}
+
+// Put the saved pixels back where the cursor was
+static void restore_under(amos_cursor_t* cursor, amos_framebuffer_t* fb) {
+    const amos_rect_t* r = &cursor->drawn_rect;
+    for (int row = 0; row < r->height; row++) {
+        uint32_t* dst = (uint32_t*)(fb->buffer + (size_t)(r->y + row) * fb->pitch) + r->x;
+        memcpy(dst, cursor->saved + row * r->width, (size_t)r->width * sizeof(uint32_t));
+    }
+}
+
+// Save the pixels under a rectangle and draw the cursor over them
+static void save_and_draw(amos_cursor_t* cursor, amos_framebuffer_t* fb, const amos_rect_t* r) {
+    int image_x = r->x - (cursor->x - cursor->hot_x);
+    int image_y = r->y - (cursor->y - cursor->hot_y);
+
+    for (int row = 0; row < r->height; row++) {
+        uint32_t* dst = (uint32_t*)(fb->buffer + (size_t)(r->y + row) * fb->pitch) + r->x;
+        memcpy(cursor->saved + row * r->width, dst, (size_t)r->width * sizeof(uint32_t));
+
+        const amos_color_t* src = cursor->image + (image_y + row) * cursor->width + image_x;
+        for (int col = 0; col < r->width; col++) {
+            uint32_t alpha = src[col] >> 24;
+            if (alpha == 255) {
+                dst[col] = src[col];
+            } else if (alpha) {
+                dst[col] = amos_color_blend(src[col], dst[col]);
+            }
+        }
+    }
+}
+
+// Take the cursor off the screen before part of it is redrawn in place
+void amos_cursor_remove(amos_cursor_t* cursor, amos_framebuffer_t* fb, amos_damage_t* damage) {
+    if (!cursor || !cursor->drawn || !fb || !fb->initialized || fb->bytes_per_pixel != 4) {
+        return;
+    }
+
+    restore_under(cursor, fb);
+    if (damage) {
+        amos_damage_add(damage, &cursor->drawn_rect);
+    }
+    cursor->drawn = false;
+}
+
+// Bring the cursor on screen up to date before presenting
+void amos_cursor_present(amos_cursor_t* cursor, amos_framebuffer_t* fb, amos_damage_t* damage) {
+    if (!cursor || !fb || !fb->initialized || fb->bytes_per_pixel != 4) {
+        return;
+    }
+
+    amos_rect_t rect = cursor_rect(cursor, fb);
+    bool show = cursor->visible && rect.width > 0 && rect.height > 0;
+
+    // Unchanged since the last present
+    if (cursor->drawn == show && !cursor->changed &&
+        (!show || (cursor->x == cursor->drawn_x && cursor->y == cursor->drawn_y))) {
+        return;
+    }
+
+    if (cursor->drawn) {
+        restore_under(cursor, fb);
+        if (damage) {
+            amos_damage_add(damage, &cursor->drawn_rect);
+        }
+        cursor->drawn = false;
+    }
+
+    if (show) {
+        save_and_draw(cursor, fb, &rect);
+        cursor->drawn_x = cursor->x;
+        cursor->drawn_y = cursor->y;
+        cursor->drawn_rect = rect;
+        cursor->drawn = true;
+        if (damage) {
+            amos_damage_add(damage, &rect);
+        }
+    }
+
+    cursor->changed = false;
+    amos_fb_mark_changed(fb);
+}
@@ -0,0 +1,131 @@
+/**
+ * AMOS Desktop OS - Software Cursor
+ *
+ * This file defines a cursor overlay drawn on top of the composited
+ * screen just before it is presented. The pixels under the cursor are
+ * saved when it is drawn and put back when it moves, so pointer motion
+ * over an unchanged desktop only touches the old and new cursor
+ * rectangles instead of recompositing the screen.
+ */
+
+#ifndef AMOS_CURSOR_H
+#define AMOS_CURSOR_H
+
+#include "framebuffer.h"
+#include "damage.h"
+#include <stdbool.h>
+
+// Largest cursor image
+#define AMOS_CURSOR_MAX_SIZE 32
+
+// Cursor overlay state
+typedef struct {
+    amos_color_t image[AMOS_CURSOR_MAX_SIZE * AMOS_CURSOR_MAX_SIZE];
+    int width;
+    int height;
+    int hot_x;                  // Hotspot within the image
+    int hot_y;
+
+    int x;                      // Pointer position (hotspot on screen)
+    int y;
+    bool visible;
+    bool changed;               // Image or visibility changed since the cursor was drawn
+
+    // What is currently on screen
+    bool drawn;                 // Whether saved holds the pixels under the cursor
+    int drawn_x;                // Pointer position it was drawn at
+    int drawn_y;
+    amos_rect_t drawn_rect;     // Screen area covered, clipped to the framebuffer
+    amos_color_t saved[AMOS_CURSOR_MAX_SIZE * AMOS_CURSOR_MAX_SIZE];
+} amos_cursor_t;
+
+/**
+ * Initialize a cursor with the default arrow image, hidden at (0, 0)
+ *
+ * @param cursor Pointer to cursor structure
+ */
+void amos_cursor_init(amos_cursor_t* cursor);
+
+/**
+ * Replace the cursor image
+ *
+ * The new image appears at the next amos_cursor_present.
+ *
+ * @param cursor Pointer to cursor structure
+ * @param pixels Image pixels, row-major; alpha 0 is transparent
+ * @param width Image width (at most AMOS_CURSOR_MAX_SIZE)
+ * @param height Image height (at most AMOS_CURSOR_MAX_SIZE)
+ * @param hot_x Hotspot X within the image
+ * @param hot_y Hotspot Y within the image
+ * @return true if the image was set, false if it is too large
+ */
+bool amos_cursor_set_image(
+    amos_cursor_t* cursor,
+    const amos_color_t* pixels,
+    int width,
+    int height,
+    int hot_x,
+    int hot_y
+);
+
+/**
+ * Move the pointer; the screen is updated by amos_cursor_present
+ *
+ * @param cursor Pointer to cursor structure
+ * @param x Pointer X in screen coordinates
+ * @param y Pointer Y in screen coordinates
+ */
+void amos_cursor_move(amos_cursor_t* cursor, int x, int y);
+
+/**
+ * Show or hide the cursor; the screen is updated by amos_cursor_present
+ *
+ * @param cursor Pointer to cursor structure
+ * @param visible Whether the cursor should be shown
+ */
+void amos_cursor_set_visible(amos_cursor_t* cursor, bool visible);
+
+/**
+ * Forget the saved pixels because the screen under the cursor was redrawn
+ *
+ * Call after recompositing; the next present draws the cursor without
+ * restoring the now stale saved pixels.
+ *
+ * @param cursor Pointer to cursor structure
+ */
+void amos_cursor_invalidate(amos_cursor_t* cursor);
+
+/**
+ * Check whether the cursor on screen is out of date
+ *
+ * @param cursor Pointer to cursor structure
+ * @return true if amos_cursor_present would change the screen
+ */
+bool amos_cursor_needs_present(const amos_cursor_t* cursor);
+
+/**
+ * Take the cursor off the screen before part of it is redrawn in place
+ *
+ * Restores the pixels under the cursor and adds its rectangle to the
+ * damage list; the next present draws it over the new pixels.
+ *
+ * @param cursor Pointer to cursor structure
+ * @param fb 32bpp screen framebuffer
+ * @param damage Damage list to add the restored rectangle to (may be NULL)
+ */
+void amos_cursor_remove(amos_cursor_t* cursor, amos_framebuffer_t* fb, amos_damage_t* damage);
+
+/**
+ * Bring the cursor on screen up to date before presenting
+ *
+ * Restores the pixels under the previous cursor position and draws the
+ * cursor at its current position, adding both rectangles to the damage
+ * list. Does nothing if the cursor has not moved since it was drawn.
+ *
+ * @param cursor Pointer to cursor structure
+ * @param fb 32bpp screen framebuffer
+ * @param damage Damage list to add changed rectangles to (may be NULL)
+ */
+void amos_cursor_present(amos_cursor_t* cursor, amos_framebuffer_t* fb, amos_damage_t* damage);
+
+#endif /* AMOS_CURSOR_H */
@@ -0,0 +1,71 @@
+/**
+ * AMOS Desktop OS - Damage Tracking Implementation
+ *
+ * This file implements the damage list used to limit recompositing and
+ * presentation to the regions of the screen that changed.
+ */
+
+#include "damage.h"
+#include <stddef.h>
+
+// Smallest rectangle containing both a and b
+static void rect_union(const amos_rect_t* a, const amos_rect_t* b, amos_rect_t* result) {
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+    int y1 = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+    result->x = x0;
+    result->y = y0;
+    result->width = x1 - x0;
+    result->height = y1 - y0;
+}
+
+// Whether two rectangles overlap or touch
+static bool rect_touches(const amos_rect_t* a, const amos_rect_t* b) {
+    return a->x <= b->x + b->width && b->x <= a->x + a->width &&
+           a->y <= b->y + b->height && b->y <= a->y + a->height;
+}
+
+// Clear a damage list
+void amos_damage_reset(amos_damage_t* damage) {
+    if (damage) {
+        damage->count = 0;
+    }
+}
+
+// Add a rectangle to a damage list
+void amos_damage_add(amos_damage_t* damage, const amos_rect_t* rect) {
+    if (!damage || !rect || rect->width <= 0 || rect->height <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < damage->count; i++) {
+        if (rect_touches(&damage->rects[i], rect)) {
+            rect_union(&damage->rects[i], rect, &damage->rects[i]);
+            return;
+        }
+    }
+
+    if (damage->count == AMOS_MAX_DAMAGE_RECTS) {
+        amos_rect_t bounds;
+        amos_damage_bounds(damage, &bounds);
+        rect_union(&bounds, rect, &damage->rects[0]);
+        damage->count = 1;
+        return;
+    }
+
+    damage->rects[damage->count++] = *rect;
+}
+
+// Get the bounding box of all damaged regions
+bool amos_damage_bounds(const amos_damage_t* damage, amos_rect_t* bounds) {
+    if (!damage || !bounds || damage->count == 0) {
+        return false;
+    }
+
+    *bounds = damage->rects[0];
+    for (int i = 1; i < damage->count; i++) {
+        rect_union(bounds, &damage->rects[i], bounds);
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+/**
+ * AMOS Desktop OS - Damage Tracking
+ *
+ * This file defines a small list of screen rectangles that changed
+ * since the last present, so the desktop can recomposite and flush
+ * only those regions instead of the whole screen.
+ */
+
+#ifndef AMOS_DAMAGE_H
+#define AMOS_DAMAGE_H
+
+#include "framebuffer.h"
+#include <stdbool.h>
+
+// Rectangles kept before the list collapses to its bounding box
+#define AMOS_MAX_DAMAGE_RECTS 16
+
+// Damaged regions in screen coordinates
+typedef struct {
+    amos_rect_t rects[AMOS_MAX_DAMAGE_RECTS];
+    int count;
+} amos_damage_t;
+
+/**
+ * Clear a damage list
+ *
+ * @param damage Pointer to damage list
+ */
+void amos_damage_reset(amos_damage_t* damage);
+
+/**
+ * Add a rectangle to a damage list
+ *
+ * Rectangles overlapping an existing entry are merged into it. When the
+ * list is full, every entry is merged into a single bounding box.
+ *
+ * @param damage Pointer to damage list
+ * @param rect Damaged rectangle (empty rectangles are ignored)
+ */
+void amos_damage_add(amos_damage_t* damage, const amos_rect_t* rect);
+
+/**
+ * Get the bounding box of all damaged regions
+ *
+ * @param damage Pointer to damage list
+ * @param bounds Pointer to store the bounding box
+ * @return true if anything is damaged, false otherwise
+ */
+bool amos_damage_bounds(const amos_damage_t* damage, amos_rect_t* bounds);
+
+#endif /* AMOS_DAMAGE_H */
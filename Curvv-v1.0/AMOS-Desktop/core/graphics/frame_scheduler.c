@@ -0,0 +1,240 @@
+/**
+ * AMOS Desktop OS - Frame Scheduler Implementation
+ *
+ * This file implements frame pacing. A frame is due once it has been
+ * requested and a full refresh interval has passed since the previous
+ * one, so input on an idle desktop is shown at once while a burst of
+ * damage renders at most once per refresh. Linux hosts block in epoll
+ * with a one-shot timerfd for the next slot; elsewhere poll() is used
+ * with a computed timeout.
+ */
+
+#include "frame_scheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
+// Monotonic time in nanoseconds
+static uint64_t scheduler_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Initialize a frame scheduler
+bool amos_frame_scheduler_init(amos_frame_scheduler_t* scheduler, int refresh_hz) {
+    if (!scheduler) {
+        return false;
+    }
+
+    memset(scheduler, 0, sizeof(*scheduler));
+    scheduler->epoll_fd = -1;
+    scheduler->timer_fd = -1;
+    scheduler->interval_ns = 1000000000ull / (uint64_t)(refresh_hz > 0 ? refresh_hz : 60);
+
+#ifdef __linux__
+    scheduler->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    scheduler->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.fd = scheduler->timer_fd;
+    if (scheduler->epoll_fd < 0 || scheduler->timer_fd < 0 ||
+        epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_ADD, scheduler->timer_fd, &event) < 0) {
+        printf("Frame scheduler: epoll/timerfd unavailable (%s), using poll\n", strerror(errno));
+        if (scheduler->epoll_fd >= 0) {
+            close(scheduler->epoll_fd);
+        }
+        if (scheduler->timer_fd >= 0) {
+            close(scheduler->timer_fd);
+        }
+        scheduler->epoll_fd = -1;
+        scheduler->timer_fd = -1;
+    }
+#endif
+
+    return true;
+}
+
+// Release the scheduler's descriptors
+void amos_frame_scheduler_cleanup(amos_frame_scheduler_t* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    if (scheduler->epoll_fd >= 0) {
+        close(scheduler->epoll_fd);
+    }
+    if (scheduler->timer_fd >= 0) {
+        close(scheduler->timer_fd);
+    }
+    scheduler->epoll_fd = -1;
+    scheduler->timer_fd = -1;
+    scheduler->fd_count = 0;
+}
+
+// Wake the scheduler whenever a descriptor becomes readable
+bool amos_frame_scheduler_watch_fd(amos_frame_scheduler_t* scheduler, int fd) {
+    if (!scheduler || fd < 0 || scheduler->fd_count >= AMOS_FRAME_MAX_FDS) {
+        return false;
+    }
+
+#ifdef __linux__
+    if (scheduler->epoll_fd >= 0) {
+        struct epoll_event event = {0};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            printf("Frame scheduler: cannot watch fd %d: %s\n", fd, strerror(errno));
+            return false;
+        }
+    }
+#endif
+
+    scheduler->fds[scheduler->fd_count++] = fd;
+    return true;
+}
+
+// Stop watching a descriptor
+void amos_frame_scheduler_unwatch_fd(amos_frame_scheduler_t* scheduler, int fd) {
+    if (!scheduler) {
+        return;
+    }
+
+    for (int i = 0; i < scheduler->fd_count; i++) {
+        if (scheduler->fds[i] == fd) {
+#ifdef __linux__
+            if (scheduler->epoll_fd >= 0) {
+                epoll_ctl(scheduler->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+            }
+#endif
+            scheduler->fds[i] = scheduler->fds[--scheduler->fd_count];
+            return;
+        }
+    }
+}
+
+// Ask for a frame
+void amos_frame_scheduler_request_frame(amos_frame_scheduler_t* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    scheduler->frame_requested = true;
+    scheduler->requests++;
+}
+
+// Start of the refresh slot the next frame may be rendered in
+static uint64_t next_slot_ns(const amos_frame_scheduler_t* scheduler) {
+    return scheduler->last_frame_ns + scheduler->interval_ns;
+}
+
+// Check whether a requested frame may be rendered now
+bool amos_frame_scheduler_frame_due(const amos_frame_scheduler_t* scheduler) {
+    return scheduler && scheduler->frame_requested && scheduler_now_ns() >= next_slot_ns(scheduler);
+}
+
+#ifdef __linux__
+// Arm or disarm the one-shot frame timer
+static void set_frame_timer(amos_frame_scheduler_t* scheduler, uint64_t deadline_ns) {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t)(deadline_ns / 1000000000ull);
+    spec.it_value.tv_nsec = (long)(deadline_ns % 1000000000ull);
+    timerfd_settime(scheduler->timer_fd, deadline_ns ? TFD_TIMER_ABSTIME : 0, &spec, NULL);
+    scheduler->timer_armed = deadline_ns != 0;
+}
+#endif
+
+// Block until input arrives, a requested frame is due or the timeout expires
+int amos_frame_scheduler_wait(amos_frame_scheduler_t* scheduler, int timeout_ms) {
+    if (!scheduler) {
+        return 0;
+    }
+
+    scheduler->wakeups++;
+    int wake = 0;
+
+    // A due frame only waits for input that is already pending
+    uint64_t now = scheduler_now_ns();
+    bool due = scheduler->frame_requested && now >= next_slot_ns(scheduler);
+    if (due) {
+        timeout_ms = 0;
+    }
+
+#ifdef __linux__
+    if (scheduler->epoll_fd >= 0) {
+        if (scheduler->frame_requested && !due && !scheduler->timer_armed) {
+            set_frame_timer(scheduler, next_slot_ns(scheduler));
+        }
+
+        struct epoll_event events[AMOS_FRAME_MAX_FDS + 1];
+        int count = epoll_wait(scheduler->epoll_fd, events, AMOS_FRAME_MAX_FDS + 1, timeout_ms);
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == scheduler->timer_fd) {
+                uint64_t expirations;
+                if (read(scheduler->timer_fd, &expirations, sizeof(expirations)) > 0) {
+                    scheduler->timer_armed = false;
+                }
+            } else {
+                wake |= AMOS_FRAME_WAKE_INPUT;
+            }
+        }
+        if (count == 0 && timeout_ms != 0) {
+            wake |= AMOS_FRAME_WAKE_TIMEOUT;
+        }
+    } else
+#endif
+    {
+        // Portable path: the frame slot shortens the poll timeout
+        if (scheduler->frame_requested && !due) {
+            uint64_t slot_ms = (next_slot_ns(scheduler) - now + 999999) / 1000000;
+            if (timeout_ms < 0 || (uint64_t)timeout_ms > slot_ms) {
+                timeout_ms = (int)slot_ms;
+            }
+        }
+
+        struct pollfd fds[AMOS_FRAME_MAX_FDS];
+        for (int i = 0; i < scheduler->fd_count; i++) {
+            fds[i].fd = scheduler->fds[i];
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        int count = poll(fds, (nfds_t)scheduler->fd_count, timeout_ms);
+        if (count > 0) {
+            wake |= AMOS_FRAME_WAKE_INPUT;
+        } else if (count == 0 && timeout_ms != 0 && !amos_frame_scheduler_frame_due(scheduler)) {
+            wake |= AMOS_FRAME_WAKE_TIMEOUT;
+        }
+    }
+
+    if (amos_frame_scheduler_frame_due(scheduler)) {
+        wake |= AMOS_FRAME_WAKE_RENDER;
+    }
+    return wake;
+}
+
+// Record that the requested frame was rendered
+void amos_frame_scheduler_frame_done(amos_frame_scheduler_t* scheduler) {
+    if (!scheduler) {
+        return;
+    }
+
+    scheduler->last_frame_ns = scheduler_now_ns();
+    scheduler->frame_requested = false;
+    scheduler->frames++;
+
+#ifdef __linux__
+    if (scheduler->timer_armed) {
+        set_frame_timer(scheduler, 0);
+    }
+#endif
+}
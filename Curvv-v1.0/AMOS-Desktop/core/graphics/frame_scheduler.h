@@ -0,0 +1,111 @@
+/**
+ * AMOS Desktop OS - Frame Scheduler
+ *
+ * This file defines the scheduler that drives the desktop main loops.
+ * Instead of rendering on a fixed sleep, a loop blocks until input
+ * arrives, a timeout expires or a requested frame becomes due. Damage
+ * reported in between is coalesced into a single frame, at most one
+ * frame is rendered per refresh interval, and nothing is rendered when
+ * nothing changed. On Linux the wait is an epoll set holding the input
+ * descriptors and a timerfd armed for the next frame slot.
+ */
+
+#ifndef AMOS_FRAME_SCHEDULER_H
+#define AMOS_FRAME_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Input descriptors that can be watched
+#define AMOS_FRAME_MAX_FDS 16
+
+// Reasons amos_frame_scheduler_wait returned
+#define AMOS_FRAME_WAKE_INPUT   0x01    // A watched descriptor is readable
+#define AMOS_FRAME_WAKE_RENDER  0x02    // A requested frame is due
+#define AMOS_FRAME_WAKE_TIMEOUT 0x04    // The caller's timeout expired
+
+// Scheduler state
+typedef struct {
+    int epoll_fd;               // -1 when the portable poll() fallback is used
+    int timer_fd;
+    int fds[AMOS_FRAME_MAX_FDS];
+    int fd_count;
+
+    uint64_t interval_ns;       // Refresh interval
+    uint64_t last_frame_ns;     // When the last frame was rendered
+    bool frame_requested;       // Damage is waiting for the next frame slot
+    bool timer_armed;
+
+    // Counters for diagnostics
+    uint64_t frames;            // Frames rendered
+    uint64_t requests;          // Frame requests, including coalesced ones
+    uint64_t wakeups;           // Returns from amos_frame_scheduler_wait
+} amos_frame_scheduler_t;
+
+/**
+ * Initialize a frame scheduler
+ *
+ * @param scheduler Pointer to scheduler structure
+ * @param refresh_hz Target refresh rate (60 if not positive)
+ * @return true if initialization was successful, false otherwise
+ */
+bool amos_frame_scheduler_init(amos_frame_scheduler_t* scheduler, int refresh_hz);
+
+/**
+ * Release the scheduler's descriptors (watched descriptors are not closed)
+ *
+ * @param scheduler Pointer to scheduler structure
+ */
+void amos_frame_scheduler_cleanup(amos_frame_scheduler_t* scheduler);
+
+/**
+ * Wake the scheduler whenever a descriptor becomes readable
+ *
+ * @param scheduler Pointer to scheduler structure
+ * @param fd Descriptor to watch, e.g. an input device
+ * @return true if the descriptor is now watched, false otherwise
+ */
+bool amos_frame_scheduler_watch_fd(amos_frame_scheduler_t* scheduler, int fd);
+
+/**
+ * Stop watching a descriptor, e.g. before closing it
+ *
+ * @param scheduler Pointer to scheduler structure
+ * @param fd Descriptor to stop watching
+ */
+void amos_frame_scheduler_unwatch_fd(amos_frame_scheduler_t* scheduler, int fd);
+
+/**
+ * Ask for a frame; requests before the frame is rendered are coalesced
+ *
+ * @param scheduler Pointer to scheduler structure
+ */
+void amos_frame_scheduler_request_frame(amos_frame_scheduler_t* scheduler);
+
+/**
+ * Block until input arrives, a requested frame is due or the timeout expires
+ *
+ * Returns at once if a requested frame is already due.
+ *
+ * @param scheduler Pointer to scheduler structure
+ * @param timeout_ms Longest time to block, or -1 to wait indefinitely
+ * @return Bitmask of AMOS_FRAME_WAKE_* reasons
+ */
+int amos_frame_scheduler_wait(amos_frame_scheduler_t* scheduler, int timeout_ms);
+
+/**
+ * Check whether a requested frame may be rendered now
+ *
+ * @param scheduler Pointer to scheduler structure
+ * @return true if a frame was requested and its refresh slot has started
+ */
+bool amos_frame_scheduler_frame_due(const amos_frame_scheduler_t* scheduler);
+
+/**
+ * Record that the requested frame was rendered
+ *
+ * @param scheduler Pointer to scheduler structure
+ */
+void amos_frame_scheduler_frame_done(amos_frame_scheduler_t* scheduler);
+
+#endif /* AMOS_FRAME_SCHEDULER_H */
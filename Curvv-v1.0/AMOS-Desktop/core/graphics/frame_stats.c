@@ -0,0 +1,232 @@
+/**
+ * AMOS Desktop OS - Frame Statistics Implementation
+ *
+ * This file implements the stage histograms. A value's bucket is its
+ * power of two plus the next three bits below the leading one, so the
+ * buckets cover 0 ns to several seconds in 256 counters.
+ */
+
+#include "frame_stats.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+// Names used in reports, in amos_frame_stage_t order
+static const char* const stage_names[AMOS_FRAME_STAGE_COUNT] = {
+    "input", "clear", "icons", "windows", "taskbar", "cursor", "flush", "total"
+};
+
+// Bucket holding a value
+static int bucket_index(uint64_t value) {
+    if (value < 8) {
+        return (int)value;
+    }
+
+    int exponent = 63 - __builtin_clzll(value);
+    int index = (exponent - 2) * 8 + (int)((value >> (exponent - 3)) & 7);
+    return index < AMOS_HISTOGRAM_BUCKETS ? index : AMOS_HISTOGRAM_BUCKETS - 1;
+}
+
+// Smallest value that falls in a bucket
+static uint64_t bucket_lower(int index) {
+    if (index < 8) {
+        return (uint64_t)index;
+    }
+
+    int exponent = index / 8 + 2;
+    return (uint64_t)(8 + index % 8) << (exponent - 3);
+}
+
+// Record a value in a histogram
+void amos_histogram_record(amos_histogram_t* histogram, uint64_t value) {
+    histogram->buckets[bucket_index(value)]++;
+    histogram->count++;
+    histogram->sum += value;
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+}
+
+// Read a percentile back from a histogram
+uint64_t amos_histogram_percentile(const amos_histogram_t* histogram, double percentile) {
+    if (!histogram || histogram->count == 0) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(histogram->count * percentile / 100.0 + 0.999999);
+    if (target < 1) {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < AMOS_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= target) {
+            uint64_t upper = i + 1 < AMOS_HISTOGRAM_BUCKETS ? bucket_lower(i + 1) - 1 : histogram->max;
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+// Reset all statistics
+void amos_frame_stats_reset(amos_frame_stats_t* stats) {
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+// Monotonic timestamp for stage timing
+uint64_t amos_frame_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Record the time spent in a stage
+void amos_frame_stats_record(amos_frame_stats_t* stats, amos_frame_stage_t stage, uint64_t start_ns) {
+    if (!stats || stage < 0 || stage >= AMOS_FRAME_STAGE_COUNT) {
+        return;
+    }
+
+    amos_histogram_record(&stats->stages[stage], amos_frame_stats_now() - start_ns);
+}
+
+// Entry for a window, replacing the least recently drawn one when full
+static amos_window_stats_t* window_entry(amos_frame_stats_t* stats, const void* key) {
+    amos_window_stats_t* oldest = NULL;
+    for (int i = 0; i < stats->window_count; i++) {
+        amos_window_stats_t* entry = &stats->windows[i];
+        if (entry->key == key) {
+            return entry;
+        }
+        if (!oldest || entry->last_frame < oldest->last_frame) {
+            oldest = entry;
+        }
+    }
+
+    amos_window_stats_t* entry = stats->window_count < AMOS_FRAME_STATS_MAX_WINDOWS ?
+                                 &stats->windows[stats->window_count++] : oldest;
+    memset(entry, 0, sizeof(*entry));
+    entry->key = key;
+    return entry;
+}
+
+// Record the composite cost of one window in the current frame
+void amos_frame_stats_record_window(
+    amos_frame_stats_t* stats,
+    const void* key,
+    int window_id,
+    const char* title,
+    uint64_t start_ns,
+    uint64_t pixels
+) {
+    if (!stats) {
+        return;
+    }
+
+    uint64_t elapsed = amos_frame_stats_now() - start_ns;
+    amos_window_stats_t* entry = window_entry(stats, key);
+    entry->window_id = window_id;
+    if (title && strncmp(entry->title, title, sizeof(entry->title) - 1) != 0) {
+        strncpy(entry->title, title, sizeof(entry->title) - 1);
+        entry->title[sizeof(entry->title) - 1] = '\0';
+    }
+    entry->last_frame = stats->frames;
+    entry->pixels += pixels;
+    amos_histogram_record(&entry->composite_ns, elapsed);
+}
+
+// Finish a frame
+void amos_frame_stats_end_frame(amos_frame_stats_t* stats, uint64_t pixels) {
+    if (!stats) {
+        return;
+    }
+
+    amos_histogram_record(&stats->pixels, pixels);
+    stats->frames++;
+}
+
+// Append to a report, truncating at the end of the buffer
+static void report_append(char* buffer, size_t size, size_t* used, const char* format, ...) {
+    if (*used >= size) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + *used, size - *used, format, args);
+    va_end(args);
+
+    if (written > 0) {
+        *used += (size_t)written;
+    }
+}
+
+// Append one histogram row without its line break
+static void report_row(char* buffer, size_t size, size_t* used, const char* name,
+                       const amos_histogram_t* histogram, double scale) {
+    report_append(buffer, size, used, "%-24s %8llu %9.1f %9.1f %9.1f %9.1f",
+                  name,
+                  (unsigned long long)histogram->count,
+                  amos_histogram_percentile(histogram, 50.0) * scale,
+                  amos_histogram_percentile(histogram, 95.0) * scale,
+                  amos_histogram_percentile(histogram, 99.0) * scale,
+                  histogram->max * scale);
+}
+
+// Format a report as text
+bool amos_frame_stats_format(
+    const amos_frame_stats_t* stats,
+    const char* report,
+    char* buffer,
+    size_t size
+) {
+    if (!stats || !report || !buffer || size == 0) {
+        return false;
+    }
+
+    size_t used = 0;
+    buffer[0] = '\0';
+
+    if (strcmp(report, "frame") == 0) {
+        report_append(buffer, size, &used, "frames %llu\n", (unsigned long long)stats->frames);
+        report_append(buffer, size, &used, "%-24s %8s %9s %9s %9s %9s\n",
+                      "stage (us)", "count", "p50", "p95", "p99", "max");
+        for (int i = 0; i < AMOS_FRAME_STAGE_COUNT; i++) {
+            report_row(buffer, size, &used, stage_names[i], &stats->stages[i], 0.001);
+            report_append(buffer, size, &used, "\n");
+        }
+        report_row(buffer, size, &used, "damaged pixels", &stats->pixels, 1.0);
+        report_append(buffer, size, &used, "\n");
+        return true;
+    }
+
+    if (strcmp(report, "windows") == 0) {
+        report_append(buffer, size, &used, "%-24s %8s %9s %9s %9s %9s %12s\n",
+                      "window (us)", "count", "p50", "p95", "p99", "max", "pixels");
+
+        // Most expensive windows first
+        bool listed[AMOS_FRAME_STATS_MAX_WINDOWS] = {false};
+        for (int n = 0; n < stats->window_count; n++) {
+            int best = -1;
+            for (int i = 0; i < stats->window_count; i++) {
+                if (!listed[i] && (best < 0 ||
+                    stats->windows[i].composite_ns.sum > stats->windows[best].composite_ns.sum)) {
+                    best = i;
+                }
+            }
+            listed[best] = true;
+
+            const amos_window_stats_t* entry = &stats->windows[best];
+            char name[48];
+            snprintf(name, sizeof(name), "%d %s", entry->window_id, entry->title);
+            report_row(buffer, size, &used, name, &entry->composite_ns, 0.001);
+            report_append(buffer, size, &used, " %12llu\n", (unsigned long long)entry->pixels);
+        }
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,148 @@
+/**
+ * AMOS Desktop OS - Frame Statistics
+ *
+ * This file defines always-on frame instrumentation. Each desktop stage
+ * (input, clear, icons, windows, taskbar, cursor, flush) and each
+ * window's composite is timed with the monotonic clock and recorded in
+ * a fixed-bucket log histogram, so recording costs a bucket increment
+ * and no allocation. Percentiles are read back from the buckets with
+ * at most 12.5% error.
+ */
+
+#ifndef AMOS_FRAME_STATS_H
+#define AMOS_FRAME_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Histogram buckets: 8 linear sub-buckets per power of two
+#define AMOS_HISTOGRAM_BUCKETS 256
+
+// Windows tracked individually; the least recently drawn is replaced
+#define AMOS_FRAME_STATS_MAX_WINDOWS 64
+
+// Log-scale histogram of non-negative values
+typedef struct {
+    uint32_t buckets[AMOS_HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+} amos_histogram_t;
+
+// Timed desktop stages
+typedef enum {
+    AMOS_FRAME_STAGE_INPUT,     // Event processing
+    AMOS_FRAME_STAGE_CLEAR,     // Background clear
+    AMOS_FRAME_STAGE_ICONS,     // Desktop icons
+    AMOS_FRAME_STAGE_WINDOWS,   // Window composite
+    AMOS_FRAME_STAGE_TASKBAR,   // Taskbar
+    AMOS_FRAME_STAGE_CURSOR,    // Cursor overlay
+    AMOS_FRAME_STAGE_FLUSH,     // Present of damaged regions
+    AMOS_FRAME_STAGE_TOTAL,     // Whole render call
+    AMOS_FRAME_STAGE_COUNT
+} amos_frame_stage_t;
+
+// Composite cost of one window
+typedef struct {
+    const void* key;            // Window the entry belongs to
+    int window_id;
+    char title[32];
+    uint64_t last_frame;        // Frame the window was last drawn in
+    uint64_t pixels;            // Pixels composited, all frames
+    amos_histogram_t composite_ns;
+} amos_window_stats_t;
+
+// Desktop frame statistics
+typedef struct {
+    uint64_t frames;                                    // Frames rendered
+    amos_histogram_t stages[AMOS_FRAME_STAGE_COUNT];    // Stage times in nanoseconds
+    amos_histogram_t pixels;                            // Damaged pixels presented per frame
+    amos_window_stats_t windows[AMOS_FRAME_STATS_MAX_WINDOWS];
+    int window_count;
+} amos_frame_stats_t;
+
+/**
+ * Record a value in a histogram
+ *
+ * @param histogram Pointer to histogram
+ * @param value Value to record
+ */
+void amos_histogram_record(amos_histogram_t* histogram, uint64_t value);
+
+/**
+ * Read a percentile back from a histogram
+ *
+ * @param histogram Pointer to histogram
+ * @param percentile Percentile between 0 and 100
+ * @return Upper bound of the bucket holding the percentile, 0 if empty
+ */
+uint64_t amos_histogram_percentile(const amos_histogram_t* histogram, double percentile);
+
+/**
+ * Reset all statistics
+ *
+ * @param stats Pointer to statistics structure
+ */
+void amos_frame_stats_reset(amos_frame_stats_t* stats);
+
+/**
+ * Monotonic timestamp for stage timing
+ *
+ * @return Time in nanoseconds
+ */
+uint64_t amos_frame_stats_now(void);
+
+/**
+ * Record the time spent in a stage
+ *
+ * @param stats Pointer to statistics structure (may be NULL)
+ * @param stage Stage that ran
+ * @param start_ns Timestamp taken with amos_frame_stats_now when the stage began
+ */
+void amos_frame_stats_record(amos_frame_stats_t* stats, amos_frame_stage_t stage, uint64_t start_ns);
+
+/**
+ * Record the composite cost of one window in the current frame
+ *
+ * @param stats Pointer to statistics structure (may be NULL)
+ * @param key Identity of the window, e.g. its pointer
+ * @param window_id Window ID shown in reports
+ * @param title Window title shown in reports
+ * @param start_ns Timestamp taken when the window's composite began
+ * @param pixels Pixels the window covered on screen
+ */
+void amos_frame_stats_record_window(
+    amos_frame_stats_t* stats,
+    const void* key,
+    int window_id,
+    const char* title,
+    uint64_t start_ns,
+    uint64_t pixels
+);
+
+/**
+ * Finish a frame
+ *
+ * @param stats Pointer to statistics structure (may be NULL)
+ * @param pixels Damaged pixels presented in the frame
+ */
+void amos_frame_stats_end_frame(amos_frame_stats_t* stats, uint64_t pixels);
+
+/**
+ * Format a report as text
+ *
+ * @param stats Pointer to statistics structure
+ * @param report "frame" for stage percentiles, "windows" for per-window cost
+ * @param buffer Destination for the report
+ * @param size Size of buffer in bytes
+ * @return true if the report name is known, false otherwise
+ */
+bool amos_frame_stats_format(
+    const amos_frame_stats_t* stats,
+    const char* report,
+    char* buffer,
+    size_t size
+);
+
+#endif /* AMOS_FRAME_STATS_H */
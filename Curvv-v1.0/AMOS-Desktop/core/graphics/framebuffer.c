@@ -21,6 +21,7 @@ bool amos_fb_init(amos_framebuffer_t* fb, int width, int height, int bpp) {
     
     // Align pitch to 4-byte boundary for better performance
     fb->pitch = (fb->pitch + 3) & ~3;
+    fb->generation = 0;
     
     // Allocate the buffer
     size_t buffer_size = fb->pitch * fb->height;
@@ -44,10 +45,17 @@ void amos_fb_cleanup(amos_framebuffer_t* fb) {
     }
 }
 
+void amos_fb_mark_changed(amos_framebuffer_t* fb) {
+    if (fb) {
+        fb->generation++;
+    }
+}
+
 void amos_fb_clear(amos_framebuffer_t* fb, amos_color_t color) {
     if (!fb || !fb->initialized || !fb->buffer) {
         return;
     }
+    fb->generation++;
     
     // For 32-bit (4 bytes per pixel), we can optimize by filling 32 bits at a time
     if (fb->bytes_per_pixel == 4) {
@@ -84,6 +92,7 @@ void amos_fb_set_pixel(amos_framebuffer_t* fb, int x, int y, amos_color_t color)
         x < 0 || x >= fb->width || y < 0 || y >= fb->height) {
         return;
     }
+    fb->generation++;
     
     uint8_t* pixel = fb->buffer + y * fb->pitch + x * fb->bytes_per_pixel;
     
@@ -328,4 +337,21 @@ amos_color_t amos_color_blend(amos_color_t src, amos_color_t dst) {
     uint8_t out_a = (uint8_t)(src_a + dst_a * inv_src_alpha);
     
     return amos_color_rgba(out_r, out_g, out_b, out_a);
-}
\ No newline at end of file
+}
+
+// Hash the visible pixels of a framebuffer
+uint64_t amos_fb_hash(const amos_framebuffer_t* fb) {
+    if (!fb || !fb->initialized || !fb->buffer) {
+        return 0;
+    }
+    
+    uint64_t hash = 0xcbf29ce484222325ull;
+    size_t row_bytes = (size_t)fb->width * fb->bytes_per_pixel;
+    for (int y = 0; y < fb->height; y++) {
+        const uint8_t* row = fb->buffer + (size_t)y * fb->pitch;
+        for (size_t i = 0; i < row_bytes; i++) {
+            hash = (hash ^ row[i]) * 0x100000001b3ull;
+        }
+    }
+    return hash;
+}
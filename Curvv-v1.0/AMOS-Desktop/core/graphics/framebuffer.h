@@ -23,13 +23,14 @@ typedef struct {
 } amos_rect_t;
 
 // Framebuffer structure
-typedef struct {
+typedef struct amos_framebuffer_t {
     uint8_t* buffer;         // Pixel data buffer
     int width;               // Width in pixels
     int height;              // Height in pixels
     int bytes_per_pixel;     // Bytes per pixel (3 for RGB, 4 for RGBA)
     int pitch;               // Bytes per row (may include padding)
     bool initialized;        // Whether the framebuffer is initialized
+    uint32_t generation;     // Bumped whenever the pixel contents change
 } amos_framebuffer_t;
 
 /**
@@ -50,6 +51,17 @@ bool amos_fb_init(amos_framebuffer_t* fb, int width, int height, int bpp);
  */
 void amos_fb_cleanup(amos_framebuffer_t* fb);
 
+/**
+ * Record that the pixel contents changed through direct buffer writes
+ * 
+ * The drawing functions below do this themselves; code writing to
+ * fb->buffer directly must call it so cached copies (such as texture
+ * mip levels) are refreshed.
+ * 
+ * @param fb Pointer to framebuffer structure
+ */
+void amos_fb_mark_changed(amos_framebuffer_t* fb);
+
 /**
  * Clear framebuffer to a specific color
  * 
@@ -193,4 +205,14 @@ void amos_color_get_rgba(amos_color_t color, uint8_t* r, uint8_t* g, uint8_t* b,
  */
 amos_color_t amos_color_blend(amos_color_t src, amos_color_t dst);
 
+/**
+ * Hash the visible pixels of a framebuffer (FNV-1a, row padding excluded)
+ * 
+ * Lets scripted runs compare final screens without storing images.
+ * 
+ * @param fb Pointer to framebuffer structure
+ * @return 64-bit hash, 0 if the framebuffer is not initialized
+ */
+uint64_t amos_fb_hash(const amos_framebuffer_t* fb);
+
 #endif /* AMOS_FRAMEBUFFER_H */
\ No newline at end of file
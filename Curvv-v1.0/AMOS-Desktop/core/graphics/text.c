@@ -0,0 +1,486 @@
+/**
+ * AMOS Desktop OS - Text Rendering Implementation
+ *
+ * This file implements glyph atlases, the layout cache and the coverage
+ * blits. Glyphs come from a built-in 5x7 bitmap font; each atlas scales
+ * it to the requested size with an area filter, so every pixel holds the
+ * fraction of it covered by ink and text stays smooth at any size.
+ */
+
+#include "text.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Source glyph cell: 5 ink columns and a gap, 2 rows above the ink and 1 below
+#define SOURCE_WIDTH 6
+#define SOURCE_HEIGHT 10
+#define SOURCE_TOP 2
+#define SOURCE_INK_ROWS 7
+
+// Columns of each printable ASCII glyph, least significant bit at the top
+static const uint8_t font_5x7[AMOS_TEXT_GLYPH_COUNT][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08}
+};
+
+static bool face_is_bold(amos_font_face_t face) {
+    return face == AMOS_FONT_SANS_BOLD || face == AMOS_FONT_MONO_BOLD;
+}
+
+static bool face_is_mono(amos_font_face_t face) {
+    return face == AMOS_FONT_MONO || face == AMOS_FONT_MONO_BOLD;
+}
+
+// Initialize a text renderer with empty caches
+bool amos_text_init(amos_text_t* text) {
+    if (!text) {
+        return false;
+    }
+
+    memset(text, 0, sizeof(*text));
+    return true;
+}
+
+// Release every glyph atlas
+void amos_text_cleanup(amos_text_t* text) {
+    if (!text) {
+        return;
+    }
+
+    for (int i = 0; i < AMOS_TEXT_MAX_ATLASES; i++) {
+        free(text->atlases[i].coverage);
+        free(text->atlases[i].spans);
+    }
+    memset(text, 0, sizeof(*text));
+}
+
+// Case-insensitive substring test
+static bool name_contains(const char* name, const char* word) {
+    size_t length = strlen(word);
+    for (; *name; name++) {
+        size_t i = 0;
+        while (i < length && name[i] && tolower((unsigned char)name[i]) == word[i]) {
+            i++;
+        }
+        if (i == length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Map a font name onto a built-in face
+amos_font_face_t amos_text_find_face(const char* font_name) {
+    if (!font_name) {
+        return AMOS_FONT_SANS;
+    }
+
+    bool bold = name_contains(font_name, "bold");
+    if (name_contains(font_name, "mono") || name_contains(font_name, "fixed") ||
+        name_contains(font_name, "courier") || name_contains(font_name, "terminal")) {
+        return bold ? AMOS_FONT_MONO_BOLD : AMOS_FONT_MONO;
+    }
+    return bold ? AMOS_FONT_SANS_BOLD : AMOS_FONT_SANS;
+}
+
+// Ink of one source glyph as SOURCE_WIDTH column masks; returns the inked column range
+static void source_glyph(amos_font_face_t face, int glyph, uint8_t columns[SOURCE_WIDTH],
+                         int* first, int* last) {
+    memset(columns, 0, SOURCE_WIDTH);
+    for (int c = 0; c < 5; c++) {
+        columns[c] = font_5x7[glyph][c];
+    }
+
+    // Bold smears every column one to the right, into the gap column
+    if (face_is_bold(face)) {
+        for (int c = SOURCE_WIDTH - 1; c > 0; c--) {
+            columns[c] |= columns[c - 1];
+        }
+    }
+
+    *first = SOURCE_WIDTH;
+    *last = -1;
+    for (int c = 0; c < SOURCE_WIDTH; c++) {
+        if (columns[c]) {
+            if (*first == SOURCE_WIDTH) {
+                *first = c;
+            }
+            *last = c;
+        }
+    }
+}
+
+// Length of the overlap of [a0, a1) and [b0, b1)
+static float overlap(float a0, float a1, float b0, float b1) {
+    float lo = a0 > b0 ? a0 : b0;
+    float hi = a1 < b1 ? a1 : b1;
+    return hi > lo ? hi - lo : 0.0f;
+}
+
+// Rasterize one glyph into its atlas cell with an area filter
+static void rasterize_glyph(amos_glyph_atlas_t* atlas, int glyph) {
+    uint8_t columns[SOURCE_WIDTH];
+    int first, last;
+    source_glyph(atlas->face, glyph, columns, &first, &last);
+
+    int width = atlas->cell_width;
+    int height = atlas->cell_height;
+    float step_x = (float)SOURCE_WIDTH / width;
+    float step_y = (float)SOURCE_HEIGHT / height;
+    float scale = 255.0f / (step_x * step_y);
+
+    // Proportional glyphs are shifted so their ink starts at column 0
+    int shift = (face_is_mono(atlas->face) || last < 0) ? 0 : first;
+    int source_advance;
+    if (face_is_mono(atlas->face)) {
+        source_advance = SOURCE_WIDTH;
+    } else if (last < 0) {
+        source_advance = 3;
+    } else {
+        source_advance = last - first + 2;
+    }
+    atlas->advance[glyph] = (int16_t)((source_advance * width + SOURCE_WIDTH / 2) / SOURCE_WIDTH);
+
+    uint8_t* cell = atlas->coverage + (size_t)glyph * width * height;
+    uint8_t* spans = atlas->spans + (size_t)glyph * height * 2;
+    for (int y = 0; y < height; y++) {
+        float y0 = y * step_y, y1 = y0 + step_y;
+        int span_first = width, span_last = 0;
+
+        for (int x = 0; x < width; x++) {
+            float x0 = x * step_x + shift, x1 = x0 + step_x;
+            float area = 0.0f;
+
+            for (int c = (int)x0; c < SOURCE_WIDTH && c < x1; c++) {
+                float cover_x = overlap(x0, x1, (float)c, (float)(c + 1));
+                if (cover_x <= 0.0f || !columns[c]) {
+                    continue;
+                }
+                for (int r = (int)y0; r < SOURCE_HEIGHT && r < y1; r++) {
+                    int ink_row = r - SOURCE_TOP;
+                    if (ink_row >= 0 && ink_row < SOURCE_INK_ROWS && (columns[c] >> ink_row) & 1) {
+                        area += cover_x * overlap(y0, y1, (float)r, (float)(r + 1));
+                    }
+                }
+            }
+
+            int value = (int)(area * scale + 0.5f);
+            cell[y * width + x] = (uint8_t)(value > 255 ? 255 : value);
+            if (value > 0) {
+                if (x < span_first) {
+                    span_first = x;
+                }
+                span_last = x + 1;
+            }
+        }
+
+        spans[y * 2] = (uint8_t)(span_first < span_last ? span_first : 0);
+        spans[y * 2 + 1] = (uint8_t)span_last;
+    }
+}
+
+// Get the glyph atlas of a face at a size, rasterizing it if needed
+const amos_glyph_atlas_t* amos_text_get_atlas(amos_text_t* text, amos_font_face_t face, int size) {
+    if (!text || face < 0 || face >= AMOS_FONT_FACE_COUNT) {
+        return NULL;
+    }
+    if (size < AMOS_TEXT_MIN_SIZE) {
+        size = AMOS_TEXT_MIN_SIZE;
+    } else if (size > AMOS_TEXT_MAX_SIZE) {
+        size = AMOS_TEXT_MAX_SIZE;
+    }
+    text->clock++;
+
+    // Find the atlas, or the least recently used slot
+    amos_glyph_atlas_t* victim = &text->atlases[0];
+    for (int i = 0; i < AMOS_TEXT_MAX_ATLASES; i++) {
+        amos_glyph_atlas_t* atlas = &text->atlases[i];
+        if (atlas->size == size && atlas->face == face) {
+            atlas->last_used = text->clock;
+            return atlas;
+        }
+        if (atlas->last_used < victim->last_used) {
+            victim = atlas;
+        }
+    }
+
+    int width = (size * SOURCE_WIDTH + SOURCE_HEIGHT - 1) / SOURCE_HEIGHT;
+    uint8_t* coverage = (uint8_t*)malloc((size_t)AMOS_TEXT_GLYPH_COUNT * width * size);
+    uint8_t* spans = (uint8_t*)malloc((size_t)AMOS_TEXT_GLYPH_COUNT * size * 2);
+    if (!coverage || !spans) {
+        printf("Failed to allocate glyph atlas for size %d\n", size);
+        free(coverage);
+        free(spans);
+        return NULL;
+    }
+
+    free(victim->coverage);
+    free(victim->spans);
+    victim->face = face;
+    victim->size = size;
+    victim->cell_width = width;
+    victim->cell_height = size;
+    victim->baseline = ((SOURCE_TOP + SOURCE_INK_ROWS) * size + SOURCE_HEIGHT / 2) / SOURCE_HEIGHT;
+    victim->coverage = coverage;
+    victim->spans = spans;
+    victim->last_used = text->clock;
+
+    for (int glyph = 0; glyph < AMOS_TEXT_GLYPH_COUNT; glyph++) {
+        rasterize_glyph(victim, glyph);
+    }
+
+    return victim;
+}
+
+// FNV-1a over the text, face and size
+static uint32_t layout_hash(const char* string, int length, amos_font_face_t face, int size) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)string[i]) * 16777619u;
+    }
+    hash = (hash ^ (uint32_t)face) * 16777619u;
+    hash = (hash ^ (uint32_t)size) * 16777619u;
+    return hash;
+}
+
+// Lay out a single line of text, reusing a cached layout if there is one
+const amos_text_layout_t* amos_text_layout(
+    amos_text_t* text,
+    amos_font_face_t face,
+    int size,
+    const char* string
+) {
+    if (!text || !string) {
+        return NULL;
+    }
+
+    const amos_glyph_atlas_t* atlas = amos_text_get_atlas(text, face, size);
+    if (!atlas) {
+        return NULL;
+    }
+
+    int length = 0;
+    while (length < AMOS_TEXT_MAX_LAYOUT_LENGTH && string[length]) {
+        length++;
+    }
+
+    uint32_t hash = layout_hash(string, length, face, atlas->size);
+    amos_text_layout_t* layout = &text->layouts[hash % AMOS_TEXT_LAYOUT_SLOTS];
+    if (layout->size == atlas->size && layout->hash == hash && layout->face == face &&
+        layout->length == length && memcmp(layout->text, string, (size_t)length) == 0) {
+        return layout;
+    }
+
+    // Miss: lay the string out into this slot
+    layout->hash = hash;
+    layout->face = face;
+    layout->size = atlas->size;
+    layout->length = length;
+    memcpy(layout->text, string, (size_t)length);
+    layout->text[length] = '\0';
+
+    int pen = 0;
+    for (int i = 0; i < length; i++) {
+        int c = (unsigned char)string[i];
+        if (c < AMOS_TEXT_FIRST_GLYPH || c >= AMOS_TEXT_FIRST_GLYPH + AMOS_TEXT_GLYPH_COUNT) {
+            c = '?';
+        }
+        int glyph = c - AMOS_TEXT_FIRST_GLYPH;
+        layout->glyphs[i] = (uint8_t)glyph;
+        layout->x[i] = (int16_t)pen;
+        pen += atlas->advance[glyph];
+    }
+    layout->width = pen;
+    layout->height = atlas->cell_height;
+    return layout;
+}
+
+// Measure the width of a single line of text
+int amos_text_measure(amos_text_t* text, amos_font_face_t face, int size, const char* string) {
+    const amos_text_layout_t* layout = amos_text_layout(text, face, size, string);
+    return layout ? layout->width : 0;
+}
+
+// Blend a color over one pixel by an 8-bit coverage
+static inline uint32_t blend_pixel(uint32_t dst, uint32_t color, uint32_t coverage) {
+    uint32_t inverse = 255 - coverage;
+    uint32_t rb = (color & 0x00FF00FFu) * coverage + (dst & 0x00FF00FFu) * inverse + 0x00800080u;
+    uint32_t ga = ((color >> 8) & 0x00FF00FFu) * coverage + ((dst >> 8) & 0x00FF00FFu) * inverse + 0x00800080u;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    ga = ((ga + ((ga >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    return rb | (ga << 8);
+}
+
+// Blend a color over a run of 32bpp pixels through a coverage mask
+static void blend_span(uint32_t* dst, const uint8_t* coverage, int count, uint32_t color) {
+    int i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i solid = _mm_set1_epi32((int)color);
+    const __m128i color16 = _mm_unpacklo_epi8(solid, zero);
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i bias = _mm_set1_epi16(128);
+
+    for (; i + 4 <= count; i += 4) {
+        uint32_t mask;
+        memcpy(&mask, coverage + i, sizeof(mask));
+        if (mask == 0) {
+            continue;
+        }
+        if (mask == 0xFFFFFFFFu) {
+            _mm_storeu_si128((__m128i*)(dst + i), solid);
+            continue;
+        }
+
+        // Spread each pixel's coverage over its four channels
+        __m128i cov = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)mask), zero);
+        cov = _mm_unpacklo_epi16(cov, cov);
+        __m128i cov_lo = _mm_unpacklo_epi32(cov, cov);
+        __m128i cov_hi = _mm_unpackhi_epi32(cov, cov);
+
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i d_lo = _mm_unpacklo_epi8(d, zero);
+        __m128i d_hi = _mm_unpackhi_epi8(d, zero);
+
+        // color * c + dst * (255 - c), divided by 255 with rounding
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(color16, cov_lo),
+                                   _mm_mullo_epi16(d_lo, _mm_sub_epi16(full, cov_lo)));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(color16, cov_hi),
+                                   _mm_mullo_epi16(d_hi, _mm_sub_epi16(full, cov_hi)));
+        lo = _mm_add_epi16(lo, bias);
+        hi = _mm_add_epi16(hi, bias);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < count; i++) {
+        uint32_t c = coverage[i];
+        if (c == 255) {
+            dst[i] = color;
+        } else if (c) {
+            dst[i] = blend_pixel(dst[i], color, c);
+        }
+    }
+}
+
+// Draw a single line of text
+int amos_text_draw(
+    amos_text_t* text,
+    amos_framebuffer_t* fb,
+    amos_font_face_t face,
+    int size,
+    const char* string,
+    int x,
+    int y,
+    amos_color_t color,
+    const amos_rect_t* clip
+) {
+    if (!fb || !fb->initialized || !fb->buffer) {
+        return 0;
+    }
+
+    const amos_text_layout_t* layout = amos_text_layout(text, face, size, string);
+    const amos_glyph_atlas_t* atlas = layout ? amos_text_get_atlas(text, face, layout->size) : NULL;
+    if (!atlas) {
+        return 0;
+    }
+
+    // Visible area: the clip rectangle within the framebuffer
+    int left = 0, top = 0, right = fb->width, bottom = fb->height;
+    if (clip) {
+        left = clip->x > left ? clip->x : left;
+        top = clip->y > top ? clip->y : top;
+        right = clip->x + clip->width < right ? clip->x + clip->width : right;
+        bottom = clip->y + clip->height < bottom ? clip->y + clip->height : bottom;
+    }
+
+    int row_first = top - y > 0 ? top - y : 0;
+    int row_end = bottom - y < atlas->cell_height ? bottom - y : atlas->cell_height;
+    if (row_first >= row_end || x >= right || x + layout->width <= left) {
+        return layout->width;
+    }
+
+    int width = atlas->cell_width;
+    size_t cell_size = (size_t)width * atlas->cell_height;
+
+    for (int i = 0; i < layout->length; i++) {
+        int gx = x + layout->x[i];
+        if (gx >= right) {
+            break;
+        }
+        if (gx + width <= left) {
+            continue;
+        }
+
+        int glyph = layout->glyphs[i];
+        const uint8_t* cell = atlas->coverage + glyph * cell_size;
+        const uint8_t* spans = atlas->spans + (size_t)glyph * atlas->cell_height * 2;
+
+        for (int row = row_first; row < row_end; row++) {
+            int x0 = gx + spans[row * 2];
+            int x1 = gx + spans[row * 2 + 1];
+            x0 = x0 > left ? x0 : left;
+            x1 = x1 < right ? x1 : right;
+            if (x0 >= x1) {
+                continue;
+            }
+
+            const uint8_t* coverage = cell + (size_t)row * width + (x0 - gx);
+            int dy = y + row;
+            if (fb->bytes_per_pixel == 4) {
+                uint32_t* dst = (uint32_t*)(fb->buffer + (size_t)dy * fb->pitch) + x0;
+                blend_span(dst, coverage, x1 - x0, color);
+            } else {
+                for (int dx = x0; dx < x1; dx++) {
+                    uint32_t c = coverage[dx - x0];
+                    if (c) {
+                        amos_fb_set_pixel(fb, dx, dy, blend_pixel(amos_fb_get_pixel(fb, dx, dy), color, c));
+                    }
+                }
+            }
+        }
+    }
+
+    amos_fb_mark_changed(fb);
+    return layout->width;
+}
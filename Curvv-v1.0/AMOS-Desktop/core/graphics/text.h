@@ -0,0 +1,165 @@
+/**
+ * AMOS Desktop OS - Text Rendering
+ *
+ * This file defines the text renderer used for window titles, tab labels,
+ * the taskbar and terminal-style content. Glyphs are rasterized once per
+ * (font, size) into an atlas of 8-bit coverage masks, and strings are laid
+ * out once per (text, font, size); drawing a cached string only blends the
+ * inked span of each glyph row into the framebuffer.
+ */
+
+#ifndef AMOS_TEXT_H
+#define AMOS_TEXT_H
+
+#include "framebuffer.h"
+
+// Printable ASCII is rasterized; other characters draw as '?'
+#define AMOS_TEXT_FIRST_GLYPH 32
+#define AMOS_TEXT_GLYPH_COUNT 95
+
+// Supported pixel sizes (line height)
+#define AMOS_TEXT_MIN_SIZE 6
+#define AMOS_TEXT_MAX_SIZE 96
+
+// Atlases kept before the least recently used one is rebuilt
+#define AMOS_TEXT_MAX_ATLASES 8
+
+// Laid-out strings kept, and the longest string that is cached
+#define AMOS_TEXT_LAYOUT_SLOTS 256
+#define AMOS_TEXT_MAX_LAYOUT_LENGTH 127
+
+// Built-in faces; font names are mapped onto these
+typedef enum {
+    AMOS_FONT_SANS,         // Proportional
+    AMOS_FONT_SANS_BOLD,
+    AMOS_FONT_MONO,         // Fixed advance, for terminals
+    AMOS_FONT_MONO_BOLD,
+    AMOS_FONT_FACE_COUNT
+} amos_font_face_t;
+
+// Coverage masks of every glyph of one face at one size
+typedef struct {
+    amos_font_face_t face;
+    int size;                   // 0 when the slot is unused
+    int cell_width;             // Glyph cell in pixels
+    int cell_height;            // Equal to size
+    int baseline;               // Rows from the cell top to the baseline
+    uint8_t* coverage;          // Cells stacked vertically, cell_width bytes per row
+    uint8_t* spans;             // Per glyph row: first and one-past-last inked column
+    int16_t advance[AMOS_TEXT_GLYPH_COUNT];  // Pen advance in pixels
+    uint64_t last_used;
+} amos_glyph_atlas_t;
+
+// A string laid out for one face and size
+typedef struct {
+    uint32_t hash;
+    amos_font_face_t face;
+    int size;                   // 0 when the slot is unused
+    int length;
+    char text[AMOS_TEXT_MAX_LAYOUT_LENGTH + 1];
+    uint8_t glyphs[AMOS_TEXT_MAX_LAYOUT_LENGTH];  // Atlas indices
+    int16_t x[AMOS_TEXT_MAX_LAYOUT_LENGTH];       // Cell origin of each glyph
+    int width;                  // Pen advance of the whole string
+    int height;
+} amos_text_layout_t;
+
+// Glyph atlases and laid-out strings
+typedef struct amos_text_t {
+    amos_glyph_atlas_t atlases[AMOS_TEXT_MAX_ATLASES];
+    amos_text_layout_t layouts[AMOS_TEXT_LAYOUT_SLOTS];
+    uint64_t clock;
+} amos_text_t;
+
+/**
+ * Initialize a text renderer with empty caches
+ *
+ * @param text Pointer to text renderer structure
+ * @return true if initialization was successful, false otherwise
+ */
+bool amos_text_init(amos_text_t* text);
+
+/**
+ * Release every glyph atlas
+ *
+ * @param text Pointer to text renderer structure
+ */
+void amos_text_cleanup(amos_text_t* text);
+
+/**
+ * Map a font name onto a built-in face
+ *
+ * Names containing "mono", "fixed", "courier" or "terminal" select the
+ * fixed-advance face, names containing "bold" the bold variant; anything
+ * else, including NULL, selects the proportional face.
+ *
+ * @param font_name Font name, e.g. from the desktop configuration
+ * @return Built-in face
+ */
+amos_font_face_t amos_text_find_face(const char* font_name);
+
+/**
+ * Get the glyph atlas of a face at a size, rasterizing it if needed
+ *
+ * @param text Pointer to text renderer structure
+ * @param face Built-in face
+ * @param size Line height in pixels, clamped to the supported range
+ * @return Atlas, or NULL if memory ran out
+ */
+const amos_glyph_atlas_t* amos_text_get_atlas(amos_text_t* text, amos_font_face_t face, int size);
+
+/**
+ * Lay out a single line of text, reusing a cached layout if there is one
+ *
+ * Strings longer than AMOS_TEXT_MAX_LAYOUT_LENGTH are truncated.
+ *
+ * @param text Pointer to text renderer structure
+ * @param face Built-in face
+ * @param size Line height in pixels
+ * @param string NUL-terminated text
+ * @return Layout, valid until the next call into the text renderer, or NULL on failure
+ */
+const amos_text_layout_t* amos_text_layout(
+    amos_text_t* text,
+    amos_font_face_t face,
+    int size,
+    const char* string
+);
+
+/**
+ * Measure the width of a single line of text
+ *
+ * @param text Pointer to text renderer structure
+ * @param face Built-in face
+ * @param size Line height in pixels
+ * @param string NUL-terminated text
+ * @return Width in pixels, or 0 on failure
+ */
+int amos_text_measure(amos_text_t* text, amos_font_face_t face, int size, const char* string);
+
+/**
+ * Draw a single line of text
+ *
+ * @param text Pointer to text renderer structure
+ * @param fb Framebuffer to draw into
+ * @param face Built-in face
+ * @param size Line height in pixels
+ * @param string NUL-terminated text
+ * @param x Left edge of the line box
+ * @param y Top edge of the line box
+ * @param color Text color
+ * @param clip Rectangle to clip to, or NULL for the whole framebuffer
+ * @return Width of the drawn text in pixels
+ */
+int amos_text_draw(
+    amos_text_t* text,
+    amos_framebuffer_t* fb,
+    amos_font_face_t face,
+    int size,
+    const char* string,
+    int x,
+    int y,
+    amos_color_t color,
+    const amos_rect_t* clip
+);
+
+#endif /* AMOS_TEXT_H */
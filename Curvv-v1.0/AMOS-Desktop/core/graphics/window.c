@@ -42,9 +42,9 @@ void amos_window_system_cleanup(amos_window_system_t* system) {
         return;
     }
     
-    // Destroy all windows
-    for (int i = 0; i < system->window_count; i++) {
-        amos_window_destroy(system, system->windows[i]);
+    // Destroy all windows; each destroy removes its window from the array
+    while (system->window_count > 0) {
+        amos_window_destroy(system, system->windows[system->window_count - 1]);
     }
     
     // Reset state
@@ -355,6 +355,15 @@ void amos_window_activate(amos_window_system_t* system, amos_window_t* window) {
     }
 }
 
+// Pixels of a rectangle that land on the framebuffer
+static uint64_t visible_pixels(const amos_rect_t* rect, const amos_framebuffer_t* fb) {
+    int x0 = rect->x > 0 ? rect->x : 0;
+    int y0 = rect->y > 0 ? rect->y : 0;
+    int x1 = rect->x + rect->width < fb->width ? rect->x + rect->width : fb->width;
+    int y1 = rect->y + rect->height < fb->height ? rect->y + rect->height : fb->height;
+    return (x1 > x0 && y1 > y0) ? (uint64_t)(x1 - x0) * (uint64_t)(y1 - y0) : 0;
+}
+
 // Draw all windows in the window system to a framebuffer
 void amos_window_system_draw(amos_window_system_t* system, amos_framebuffer_t* target_fb) {
     if (!system || !target_fb) {
@@ -371,6 +380,8 @@ void amos_window_system_draw(amos_window_system_t* system, amos_framebuffer_t* t
             continue;
         }
         
+        uint64_t window_start = system->stats ? amos_frame_stats_now() : 0;
+        
         // Draw window border
         amos_rect_t border_rect = window->rect;
         amos_color_t border_color = window->active ? 
@@ -388,7 +399,7 @@ void amos_window_system_draw(amos_window_system_t* system, amos_framebuffer_t* t
         amos_fb_fill_rect(target_fb, &title_bar_rect, title_bar_color);
         
         // Draw window title
-        // Simplified text rendering here - would need proper font rendering
+        amos_window_draw_titles(system, target_fb, window);
         
         // Draw window buttons (close, maximize, minimize)
         amos_rect_t close_btn_rect, max_btn_rect, min_btn_rect;
@@ -425,6 +436,81 @@ void amos_window_system_draw(amos_window_system_t* system, amos_framebuffer_t* t
         if (window->draw_callback) {
             window->draw_callback(window, target_fb);
         }
+        
+        if (system->stats) {
+            amos_frame_stats_record_window(system->stats, window, window->id, window->title,
+                                           window_start, visible_pixels(&window->rect, target_fb));
+        }
+    }
+}
+
+// Copy a window's content where no window above covers it
+void amos_window_system_draw_content(
+    amos_window_system_t* system,
+    amos_window_t* window,
+    amos_framebuffer_t* target_fb,
+    const amos_rect_t* clip
+) {
+    if (!system || !window || !target_fb || !clip || !window->framebuffer ||
+        !window->framebuffer->initialized ||
+        (window->flags & (AMOS_WINDOW_FLAG_HIDDEN | AMOS_WINDOW_FLAG_MINIMIZED))) {
+        return;
+    }
+    
+    // Windows after this one in the array are drawn over it
+    int index = 0;
+    while (index < system->window_count && system->windows[index] != window) {
+        index++;
+    }
+    if (index == system->window_count) {
+        return;
+    }
+    
+    // The same area amos_window_system_draw blits the content to
+    amos_rect_t client_rect;
+    amos_window_get_client_rect(window, &client_rect);
+    int x0 = client_rect.x > clip->x ? client_rect.x : clip->x;
+    int y0 = client_rect.y > clip->y ? client_rect.y : clip->y;
+    int x1 = client_rect.x + window->framebuffer->width;
+    int y1 = client_rect.y + window->framebuffer->height;
+    x1 = x1 < clip->x + clip->width ? x1 : clip->x + clip->width;
+    y1 = y1 < clip->y + clip->height ? y1 : clip->y + clip->height;
+    x0 = x0 > 0 ? x0 : 0;
+    y0 = y0 > 0 ? y0 : 0;
+    x1 = x1 < target_fb->width ? x1 : target_fb->width;
+    y1 = y1 < target_fb->height ? y1 : target_fb->height;
+    
+    for (int y = y0; y < y1; y++) {
+        int x = x0;
+        while (x < x1) {
+            // Find how far windows above cover this pixel, or where the
+            // next one starts if none does
+            int covered_to = x;
+            int span_end = x1;
+            for (int i = index + 1; i < system->window_count; i++) {
+                const amos_window_t* above = system->windows[i];
+                const amos_rect_t* r = &above->rect;
+                if ((above->flags & (AMOS_WINDOW_FLAG_HIDDEN | AMOS_WINDOW_FLAG_MINIMIZED)) ||
+                    y < r->y || y >= r->y + r->height || r->x + r->width <= x) {
+                    continue;
+                }
+                if (r->x <= x) {
+                    covered_to = r->x + r->width > covered_to ? r->x + r->width : covered_to;
+                } else if (r->x < span_end) {
+                    span_end = r->x;
+                }
+            }
+            
+            if (covered_to > x) {
+                x = covered_to;
+                continue;
+            }
+            
+            for (; x < span_end; x++) {
+                amos_color_t pixel = amos_fb_get_pixel(window->framebuffer, x - client_rect.x, y - client_rect.y);
+                amos_fb_set_pixel(target_fb, x, y, pixel);
+            }
+        }
     }
 }
 
@@ -904,10 +990,54 @@ void amos_window_draw_tabs(amos_framebuffer_t* fb, const amos_window_t* window)
             // Draw tab border
             amos_fb_draw_rect(fb, &tab_rect, amos_color_rgb(100, 100, 100));
             
-            // In a real implementation, draw tab title here
-            // ...
+            // Tab titles are drawn by amos_window_draw_titles, which has the text renderer
         }
         
         tab = tab->next_tab;
     }
+}
+
+// Draw a window's title and, for tabbed windows, its tab labels
+void amos_window_draw_titles(amos_window_system_t* system, amos_framebuffer_t* fb, const amos_window_t* window) {
+    if (!system || !system->text || !fb || !window) {
+        return;
+    }
+    
+    int size = system->font_size;
+    
+    // Title text runs from the left edge up to the window buttons
+    amos_rect_t title_bar_rect, min_btn_rect;
+    amos_window_get_titlebar_rect(window, &title_bar_rect);
+    amos_window_get_minimize_button_rect(window, &min_btn_rect);
+    
+    amos_rect_t title_clip = {
+        title_bar_rect.x + BUTTON_MARGIN,
+        title_bar_rect.y,
+        min_btn_rect.x - BUTTON_MARGIN - (title_bar_rect.x + BUTTON_MARGIN),
+        title_bar_rect.height
+    };
+    if (title_clip.width > 0) {
+        amos_text_draw(system->text, fb, system->font_face, size, window->title,
+                       title_clip.x, title_bar_rect.y + (title_bar_rect.height - size) / 2,
+                       system->text_color, &title_clip);
+    }
+    
+    if (!(window->flags & AMOS_WINDOW_FLAG_TABBABLE) || window->tab_count == 0) {
+        return;
+    }
+    
+    // Tab labels are centred and clipped to their tab
+    for (amos_window_t* tab = window->tab_group; tab; tab = tab->next_tab) {
+        amos_rect_t tab_rect;
+        if (!amos_window_get_tab_rect(window, tab->tab_index, &tab_rect)) {
+            continue;
+        }
+        
+        amos_rect_t label_clip = {tab_rect.x + 4, tab_rect.y, tab_rect.width - 8, tab_rect.height};
+        int width = amos_text_measure(system->text, system->font_face, size, tab->title);
+        int x = width < label_clip.width ? tab_rect.x + (tab_rect.width - width) / 2 : label_clip.x;
+        amos_text_draw(system->text, fb, system->font_face, size, tab->title,
+                       x, tab_rect.y + (tab_rect.height - size) / 2,
+                       amos_color_rgb(40, 40, 40), &label_clip);
+    }
 }
\ No newline at end of file
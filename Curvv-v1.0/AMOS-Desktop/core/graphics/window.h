@@ -9,6 +9,8 @@
 #define AMOS_WINDOW_H
 
 #include "framebuffer.h"
+#include "text.h"
+#include "frame_stats.h"
 #include <stdbool.h>
 
 // Maximum number of windows that can be managed simultaneously
@@ -85,7 +87,7 @@ struct amos_window_t {
 };
 
 // Window system structure
-typedef struct {
+typedef struct amos_window_system_t {
     amos_window_t* windows[AMOS_MAX_WINDOWS];  // Window array
     int window_count;                          // Current number of windows
     amos_window_t* active_window;              // Currently active/focused window
@@ -104,6 +106,14 @@ typedef struct {
     amos_color_t text_color;            // Text color
     amos_color_t button_color;          // Window buttons color
     amos_color_t button_hover_color;    // Button hover color
+    
+    // Title and tab label text; nothing is drawn while text is NULL
+    amos_text_t* text;                  // Shared glyph and layout caches (not owned)
+    amos_font_face_t font_face;
+    int font_size;
+    
+    // Per-window composite timing; nothing is recorded while stats is NULL
+    amos_frame_stats_t* stats;          // Not owned
 } amos_window_system_t;
 
 /**
@@ -260,6 +270,26 @@ void amos_window_activate(amos_window_system_t* system, amos_window_t* window);
  */
 void amos_window_system_draw(amos_window_system_t* system, amos_framebuffer_t* target_fb);
 
+/**
+ * Copy a window's content to a framebuffer without recompositing
+ * 
+ * For windows whose content changed but whose frame did not, such as a
+ * 3D view that rendered a frame. Only the parts of the content inside
+ * the clip rectangle that no window above covers are copied; the draw
+ * callback is not run.
+ * 
+ * @param system Pointer to window system structure
+ * @param window Window whose content changed
+ * @param target_fb Framebuffer to draw to
+ * @param clip Rectangle to limit the copy to
+ */
+void amos_window_system_draw_content(
+    amos_window_system_t* system,
+    amos_window_t* window,
+    amos_framebuffer_t* target_fb,
+    const amos_rect_t* clip
+);
+
 /**
  * Handle mouse move events
  * 
@@ -411,4 +441,15 @@ bool amos_window_get_tab_rect(const amos_window_t* window, int tab_index, amos_r
  */
 void amos_window_draw_tabs(amos_framebuffer_t* fb, const amos_window_t* window);
 
+/**
+ * Draw a window's title and, for tabbed windows, its tab labels
+ * 
+ * Does nothing until the window system has been given a text renderer.
+ * 
+ * @param system Pointer to window system
+ * @param fb Target framebuffer
+ * @param window Pointer to window
+ */
+void amos_window_draw_titles(amos_window_system_t* system, amos_framebuffer_t* fb, const amos_window_t* window);
+
 #endif /* AMOS_WINDOW_H */
\ No newline at end of file
@@ -0,0 +1,427 @@
+/**
+ * AMOS Desktop OS - X11 Presentation Backend Implementation
+ *
+ * This file implements presentation through MIT-SHM. The segment is
+ * marked for removal as soon as both sides have attached, so it cannot
+ * outlive the process. Only the last XShmPutImage of a present asks for
+ * a completion event: requests are processed in order, so once it
+ * arrives the server has read every rectangle.
+ */
+
+#include "x11_present.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/Xutil.h>
+
+// Set by the error handler while attaching the segment
+static bool present_attach_failed;
+
+// Error handler used while attaching; remote displays refuse shared memory
+static int present_attach_error(Display* display, XErrorEvent* event) {
+    (void)display;
+    (void)event;
+    present_attach_failed = true;
+    return 0;
+}
+
+// Whether this machine stores the low byte of a uint32_t first
+static bool host_lsb_first(void) {
+    uint32_t one = 1;
+    return *(const uint8_t*)&one == 1;
+}
+
+// Bits per pixel the server uses for images of a depth, 0 if unsupported
+static int depth_bits_per_pixel(Display* display, int depth) {
+    int count = 0;
+    int bits = 0;
+    XPixmapFormatValues* formats = XListPixmapFormats(display, &count);
+    for (int i = 0; i < count; i++) {
+        if (formats[i].depth == depth) {
+            bits = formats[i].bits_per_pixel;
+        }
+    }
+    if (formats) {
+        XFree(formats);
+    }
+    return bits;
+}
+
+// Find a visual whose pixel values are amos_color_t values
+static bool find_direct_visual(Display* display, int screen, Visual** visual, int* depth) {
+    if ((ImageByteOrder(display) == LSBFirst) != host_lsb_first()) {
+        return false;
+    }
+
+    XVisualInfo template;
+    template.screen = screen;
+    template.class = TrueColor;
+    template.red_mask = 0x0000FF;
+    template.green_mask = 0x00FF00;
+    template.blue_mask = 0xFF0000;
+
+    int count = 0;
+    XVisualInfo* infos = XGetVisualInfo(display,
+        VisualScreenMask | VisualClassMask | VisualRedMaskMask |
+        VisualGreenMaskMask | VisualBlueMaskMask, &template, &count);
+
+    bool found = false;
+    for (int i = 0; i < count && !found; i++) {
+        if ((infos[i].depth == 24 || infos[i].depth == 32) &&
+            depth_bits_per_pixel(display, infos[i].depth) == 32) {
+            *visual = infos[i].visual;
+            *depth = infos[i].depth;
+            found = true;
+        }
+    }
+    if (infos) {
+        XFree(infos);
+    }
+    return found;
+}
+
+// Find the Render format that reads amos_color_t values
+static XRenderPictFormat* find_color_format(Display* display) {
+    XRenderPictFormat template;
+    memset(&template, 0, sizeof(template));
+    template.type = PictTypeDirect;
+    template.depth = 32;
+    template.direct.red = 0;
+    template.direct.redMask = 0xFF;
+    template.direct.green = 8;
+    template.direct.greenMask = 0xFF;
+    template.direct.blue = 16;
+    template.direct.blueMask = 0xFF;
+    template.direct.alpha = 24;
+    template.direct.alphaMask = 0xFF;
+
+    return XRenderFindFormat(display,
+        PictFormatType | PictFormatDepth |
+        PictFormatRed | PictFormatRedMask |
+        PictFormatGreen | PictFormatGreenMask |
+        PictFormatBlue | PictFormatBlueMask |
+        PictFormatAlpha | PictFormatAlphaMask, &template, 0);
+}
+
+// Create the shared segment and the image describing it
+static bool present_create_image(amos_x11_present_t* present, Visual* visual, int depth) {
+    present->image = XShmCreateImage(present->display, visual, depth, ZPixmap, NULL,
+                                     &present->shm, present->width, present->height);
+    if (!present->image || present->image->bits_per_pixel != 32) {
+        printf("X11 present: no 32-bit image format for depth %d\n", depth);
+        return false;
+    }
+
+    size_t size = (size_t)present->image->bytes_per_line * present->height;
+    present->shm.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (present->shm.shmid < 0) {
+        printf("X11 present: shmget of %zu bytes failed\n", size);
+        return false;
+    }
+    present->shm.shmaddr = (char*)shmat(present->shm.shmid, NULL, 0);
+    if (present->shm.shmaddr == (char*)-1) {
+        printf("X11 present: shmat failed\n");
+        shmctl(present->shm.shmid, IPC_RMID, NULL);
+        present->shm.shmid = -1;
+        return false;
+    }
+    present->shm.readOnly = True;
+    present->image->data = present->shm.shmaddr;
+
+    XSync(present->display, False);
+    present_attach_failed = false;
+    XErrorHandler previous_handler = XSetErrorHandler(present_attach_error);
+    XShmAttach(present->display, &present->shm);
+    XSync(present->display, False);
+    XSetErrorHandler(previous_handler);
+
+    // Both sides are attached (or the server never will be); the segment
+    // goes away with the last detach
+    shmctl(present->shm.shmid, IPC_RMID, NULL);
+
+    if (present_attach_failed) {
+        printf("X11 present: the server cannot attach shared memory\n");
+        shmdt(present->shm.shmaddr);
+        present->shm.shmaddr = (char*)-1;
+        present->image->data = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Open a window and back a framebuffer with shared memory shown in it
+bool amos_x11_present_init(
+    amos_x11_present_t* present,
+    amos_framebuffer_t* fb,
+    const char* display_name,
+    int width,
+    int height,
+    const char* title
+) {
+    if (!present || !fb || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    memset(present, 0, sizeof(*present));
+    present->shm.shmid = -1;
+    present->shm.shmaddr = (char*)-1;
+    present->width = width;
+    present->height = height;
+
+    present->display = XOpenDisplay(display_name);
+    if (!present->display) {
+        printf("X11 present: cannot open display %s\n", XDisplayName(display_name));
+        return false;
+    }
+    Display* display = present->display;
+    int screen = DefaultScreen(display);
+    Window root = RootWindow(display, screen);
+
+    if (!XShmQueryExtension(display)) {
+        printf("X11 present: MIT-SHM not available\n");
+        amos_x11_present_cleanup(present, fb);
+        return false;
+    }
+    present->completion_type = XShmGetEventBase(display) + ShmCompletion;
+
+    // Prefer a visual that takes our pixels as they are; otherwise let
+    // Render convert them
+    Visual* visual = DefaultVisual(display, screen);
+    int depth = DefaultDepth(display, screen);
+    XRenderPictFormat* color_format = NULL;
+    int event_base, error_base;
+    present->direct = find_direct_visual(display, screen, &visual, &depth);
+    if (!present->direct) {
+        if (!XRenderQueryExtension(display, &event_base, &error_base) ||
+            depth_bits_per_pixel(display, 32) != 32 ||
+            !(color_format = find_color_format(display))) {
+            printf("X11 present: no visual or Render format matches the framebuffer\n");
+            amos_x11_present_cleanup(present, fb);
+            return false;
+        }
+    }
+
+    if (!present_create_image(present, visual, present->direct ? depth : 32)) {
+        amos_x11_present_cleanup(present, fb);
+        return false;
+    }
+
+    // Exposures are repaired from the framebuffer, so the window never
+    // needs a background of its own
+    XSetWindowAttributes attributes;
+    unsigned long mask = CWBackPixmap | CWBorderPixel | CWEventMask;
+    attributes.background_pixmap = None;
+    attributes.border_pixel = 0;
+    attributes.event_mask = ExposureMask | StructureNotifyMask | KeyPressMask | KeyReleaseMask |
+                            ButtonPressMask | ButtonReleaseMask | PointerMotionMask;
+    if (visual != DefaultVisual(display, screen)) {
+        present->colormap = XCreateColormap(display, root, visual, AllocNone);
+        attributes.colormap = present->colormap;
+        mask |= CWColormap;
+    }
+    present->window = XCreateWindow(display, root, 0, 0, width, height, 0,
+                                    present->direct ? depth : DefaultDepth(display, screen),
+                                    InputOutput, visual, mask, &attributes);
+
+    // The framebuffer has a fixed size
+    XSizeHints* hints = XAllocSizeHints();
+    if (hints) {
+        hints->flags = PMinSize | PMaxSize;
+        hints->min_width = hints->max_width = width;
+        hints->min_height = hints->max_height = height;
+        XSetWMNormalHints(display, present->window, hints);
+        XFree(hints);
+    }
+    XStoreName(display, present->window, title ? title : "AMOS");
+    present->wm_delete_window = XInternAtom(display, "WM_DELETE_WINDOW", False);
+    XSetWMProtocols(display, present->window, &present->wm_delete_window, 1);
+
+    if (present->direct) {
+        present->gc = XCreateGC(display, present->window, 0, NULL);
+    } else {
+        present->staging = XCreatePixmap(display, present->window, width, height, 32);
+        present->gc = XCreateGC(display, present->staging, 0, NULL);
+        present->staging_picture = XRenderCreatePicture(display, present->staging,
+                                                        color_format, 0, NULL);
+        present->window_picture = XRenderCreatePicture(display, present->window,
+            XRenderFindVisualFormat(display, visual), 0, NULL);
+    }
+    XMapWindow(display, present->window);
+    XFlush(display);
+
+    // The framebuffer is the shared segment
+    fb->buffer = (uint8_t*)present->shm.shmaddr;
+    fb->width = width;
+    fb->height = height;
+    fb->bytes_per_pixel = 4;
+    fb->pitch = present->image->bytes_per_line;
+    fb->generation = 0;
+    fb->initialized = true;
+    memset(fb->buffer, 0, (size_t)fb->pitch * height);
+
+    printf("X11 present: %dx%d %s\n", width, height,
+           present->direct ? "direct" : "through Render");
+    return true;
+}
+
+// Close the window and release the framebuffer's shared memory
+void amos_x11_present_cleanup(amos_x11_present_t* present, amos_framebuffer_t* fb) {
+    if (!present || !present->display) {
+        return;
+    }
+    Display* display = present->display;
+
+    if (present->image && present->image->data) {
+        amos_x11_present_wait(present);
+        XShmDetach(display, &present->shm);
+        XSync(display, False);
+    }
+    if (present->image) {
+        // The data is the segment, which XDestroyImage must not free
+        present->image->data = NULL;
+        XDestroyImage(present->image);
+        present->image = NULL;
+    }
+    if (present->shm.shmaddr != (char*)-1) {
+        shmdt(present->shm.shmaddr);
+        present->shm.shmaddr = (char*)-1;
+    }
+
+    if (present->window_picture) {
+        XRenderFreePicture(display, present->window_picture);
+    }
+    if (present->staging_picture) {
+        XRenderFreePicture(display, present->staging_picture);
+    }
+    if (present->staging) {
+        XFreePixmap(display, present->staging);
+    }
+    if (present->gc) {
+        XFreeGC(display, present->gc);
+    }
+    if (present->window) {
+        XDestroyWindow(display, present->window);
+    }
+    if (present->colormap) {
+        XFreeColormap(display, present->colormap);
+    }
+    XCloseDisplay(display);
+    present->display = NULL;
+
+    if (fb) {
+        fb->buffer = NULL;
+        fb->initialized = false;
+    }
+}
+
+// Get the X connection's descriptor
+int amos_x11_present_fd(const amos_x11_present_t* present) {
+    if (!present || !present->display) {
+        return -1;
+    }
+    return ConnectionNumber(present->display);
+}
+
+// Send the damaged rectangles of the framebuffer to the window
+bool amos_x11_present_damage(amos_x11_present_t* present, const amos_damage_t* damage) {
+    if (!present || !present->display || !damage) {
+        return false;
+    }
+    if (present->pending) {
+        return false;
+    }
+
+    // Clip first, so the last rectangle actually sent can ask for the completion
+    amos_rect_t rects[AMOS_MAX_DAMAGE_RECTS];
+    int count = 0;
+    for (int i = 0; i < damage->count; i++) {
+        const amos_rect_t* r = &damage->rects[i];
+        int x0 = r->x < 0 ? 0 : r->x;
+        int y0 = r->y < 0 ? 0 : r->y;
+        int x1 = r->x + r->width > present->width ? present->width : r->x + r->width;
+        int y1 = r->y + r->height > present->height ? present->height : r->y + r->height;
+        if (x1 > x0 && y1 > y0) {
+            amos_rect_t clipped = {x0, y0, x1 - x0, y1 - y0};
+            rects[count++] = clipped;
+        }
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    Drawable target = present->direct ? present->window : present->staging;
+    for (int i = 0; i < count; i++) {
+        const amos_rect_t* r = &rects[i];
+        XShmPutImage(present->display, target, present->gc, present->image,
+                     r->x, r->y, r->x, r->y, r->width, r->height, i == count - 1);
+        if (!present->direct) {
+            XRenderComposite(present->display, PictOpSrc, present->staging_picture, None,
+                             present->window_picture, r->x, r->y, 0, 0,
+                             r->x, r->y, r->width, r->height);
+        }
+        present->pixels += (uint64_t)r->width * r->height;
+    }
+    XFlush(present->display);
+
+    present->pending = true;
+    present->presents++;
+    present->rects += count;
+    return true;
+}
+
+// Match the completion event for a present's segment
+static Bool is_present_completion(Display* display, XEvent* event, XPointer arg) {
+    (void)display;
+    const amos_x11_present_t* present = (const amos_x11_present_t*)arg;
+    return event->type == present->completion_type &&
+           ((XShmCompletionEvent*)event)->shmseg == present->shm.shmseg;
+}
+
+// Block until the server has finished reading the last present
+void amos_x11_present_wait(amos_x11_present_t* present) {
+    if (!present || !present->display || !present->pending) {
+        return;
+    }
+
+    XEvent event;
+    XIfEvent(present->display, &event, is_present_completion, (XPointer)present);
+    present->pending = false;
+}
+
+// Handle an event that belongs to the presentation backend
+bool amos_x11_present_handle_event(amos_x11_present_t* present, const XEvent* event, amos_damage_t* damage) {
+    if (!present || !event) {
+        return false;
+    }
+
+    if (is_present_completion(present->display, (XEvent*)event, (XPointer)present)) {
+        present->pending = false;
+        return true;
+    }
+
+    if (event->xany.window != present->window) {
+        return false;
+    }
+
+    switch (event->type) {
+        case Expose:
+            if (damage) {
+                amos_rect_t exposed = {event->xexpose.x, event->xexpose.y,
+                                       event->xexpose.width, event->xexpose.height};
+                amos_damage_add(damage, &exposed);
+            }
+            return true;
+        case ClientMessage:
+            if ((Atom)event->xclient.data.l[0] == present->wm_delete_window) {
+                present->closed = true;
+            }
+            return true;
+        case ConfigureNotify:
+        case MapNotify:
+        case UnmapNotify:
+        case ReparentNotify:
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,134 @@
+/**
+ * AMOS Desktop OS - X11 Presentation Backend
+ *
+ * This file defines a backend that shows a framebuffer in an X11
+ * window, for running the desktop nested in an X session or in Xvfb.
+ * The framebuffer's pixels live in an MIT-SHM segment the X server
+ * reads directly, so the desktop renders straight into memory the
+ * server presents from. Damaged rectangles are sent with XShmPutImage,
+ * and the completion event for the last one says when the segment may
+ * be written again.
+ *
+ * When the window's visual stores pixels in amos_color_t order the
+ * rectangles go straight to the window. Otherwise they go to a depth-32
+ * staging pixmap that Render converts from, which costs the server a
+ * second blit but still no copies on our side.
+ */
+
+#ifndef AMOS_X11_PRESENT_H
+#define AMOS_X11_PRESENT_H
+
+#include "framebuffer.h"
+#include "damage.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/Xrender.h>
+
+// Presentation state
+typedef struct {
+    Display* display;
+    Window window;
+    Colormap colormap;          // None unless the window needed its own visual
+    GC gc;
+    int width;
+    int height;
+
+    XShmSegmentInfo shm;        // Segment holding the framebuffer's pixels
+    XImage* image;              // Describes the segment to the server
+    int completion_type;        // Event type of ShmCompletion
+    Atom wm_delete_window;
+
+    bool direct;                // The window stores pixels as amos_color_t
+    Pixmap staging;             // Otherwise: depth-32 copy of the damage
+    Picture staging_picture;
+    Picture window_picture;
+
+    bool pending;               // The server may still be reading the segment
+    bool closed;                // The window was closed by the user
+
+    // Counters for diagnostics
+    uint64_t presents;          // Presents sent
+    uint64_t rects;             // Rectangles sent
+    uint64_t pixels;            // Pixels sent
+} amos_x11_present_t;
+
+/**
+ * Open a window and back a framebuffer with shared memory shown in it
+ *
+ * The framebuffer is initialized by this call (4 bytes per pixel) and
+ * must be released with amos_x11_present_cleanup, not amos_fb_cleanup.
+ *
+ * @param present Pointer to presentation state
+ * @param fb Framebuffer to initialize over the shared segment
+ * @param display_name X display to open, or NULL for $DISPLAY
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param title Window title
+ * @return true if initialization was successful, false otherwise
+ */
+bool amos_x11_present_init(
+    amos_x11_present_t* present,
+    amos_framebuffer_t* fb,
+    const char* display_name,
+    int width,
+    int height,
+    const char* title
+);
+
+/**
+ * Close the window and release the framebuffer's shared memory
+ *
+ * @param present Pointer to presentation state
+ * @param fb Framebuffer passed to amos_x11_present_init
+ */
+void amos_x11_present_cleanup(amos_x11_present_t* present, amos_framebuffer_t* fb);
+
+/**
+ * Get the X connection's descriptor, to wake a frame scheduler on events
+ *
+ * Events Xlib has already read are not signalled on the descriptor, so
+ * drain the queue with XPending before blocking on it.
+ *
+ * @param present Pointer to presentation state
+ * @return Connection descriptor, -1 if not initialized
+ */
+int amos_x11_present_fd(const amos_x11_present_t* present);
+
+/**
+ * Send the damaged rectangles of the framebuffer to the window
+ *
+ * The framebuffer must not be written until the present completes;
+ * call amos_x11_present_wait before rendering the next frame.
+ *
+ * @param present Pointer to presentation state
+ * @param damage Damaged regions in framebuffer coordinates
+ * @return true if the rectangles were sent, false if a present is still pending
+ */
+bool amos_x11_present_damage(amos_x11_present_t* present, const amos_damage_t* damage);
+
+/**
+ * Block until the server has finished reading the last present
+ *
+ * Other events stay queued. Returns at once if nothing is pending.
+ *
+ * @param present Pointer to presentation state
+ */
+void amos_x11_present_wait(amos_x11_present_t* present);
+
+/**
+ * Handle an event that belongs to the presentation backend
+ *
+ * Completions clear the pending flag, exposures add the exposed area to
+ * the damage list and a close request sets the closed flag. Input and
+ * other events are left to the caller.
+ *
+ * @param present Pointer to presentation state
+ * @param event Event read from the presentation display
+ * @param damage Damage list exposures are added to (may be NULL)
+ * @return true if the event was handled, false otherwise
+ */
+bool amos_x11_present_handle_event(amos_x11_present_t* present, const XEvent* event, amos_damage_t* damage);
+
+#endif /* AMOS_X11_PRESENT_H */
@@ -0,0 +1,123 @@
+/**
+ * AMOS Desktop OS - Cursor Benchmark
+ *
+ * Moves the default arrow cursor over a patterned screen and reports the
+ * cost of amos_cursor_present per pointer event, then checks that:
+ *
+ *   damage:   each move damages only the old and new cursor rectangles
+ *   idle:     presenting without a move changes nothing
+ *   hide:     hiding the cursor restores the screen byte for byte
+ *
+ * Usage: cursor_bench [moves] [width height]
+ */
+
+#include "../core/graphics/cursor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Fill the screen with a pattern, so restored pixels are checked against something
+static void fill_screen(amos_framebuffer_t* fb) {
+    for (int y = 0; y < fb->height; y++) {
+        uint32_t* row = (uint32_t*)(fb->buffer + (size_t)y * fb->pitch);
+        for (int x = 0; x < fb->width; x++) {
+            row[x] = 0xFF000000u | (uint32_t)(x * 7) << 16 | (uint32_t)(y * 13) << 8 | (uint32_t)(x ^ y);
+        }
+    }
+}
+
+// Damaged pixels of a list
+static uint64_t damage_pixels(const amos_damage_t* damage) {
+    uint64_t pixels = 0;
+    for (int i = 0; i < damage->count; i++) {
+        pixels += (uint64_t)damage->rects[i].width * damage->rects[i].height;
+    }
+    return pixels;
+}
+
+int main(int argc, char** argv) {
+    int moves = argc > 1 ? atoi(argv[1]) : 1000000;
+    int width = argc > 3 ? atoi(argv[2]) : 1280;
+    int height = argc > 3 ? atoi(argv[3]) : 720;
+    if (moves <= 0 || width < 64 || height < 64) {
+        fprintf(stderr, "Usage: %s [moves] [width height]\n", argv[0]);
+        return 1;
+    }
+
+    amos_framebuffer_t screen;
+    static amos_cursor_t cursor;
+    if (!amos_fb_init(&screen, width, height, 4)) {
+        fprintf(stderr, "Initialization failed\n");
+        return 1;
+    }
+    fill_screen(&screen);
+
+    size_t screen_bytes = (size_t)screen.pitch * screen.height;
+    uint8_t* original = (uint8_t*)malloc(screen_bytes);
+    if (!original) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    memcpy(original, screen.buffer, screen_bytes);
+
+    amos_cursor_init(&cursor);
+    amos_cursor_set_visible(&cursor, true);
+    amos_cursor_move(&cursor, width / 2, height / 2);
+
+    amos_damage_t damage;
+    amos_damage_reset(&damage);
+    amos_cursor_present(&cursor, &screen, &damage);
+
+    // Sweep diagonally across the screen, bouncing off the edges
+    uint64_t max_damage = 0;
+    int x = width / 2, y = height / 2, dx = 3, dy = 2;
+    double start = now_us();
+    for (int i = 0; i < moves; i++) {
+        x += dx;
+        y += dy;
+        if (x < 0 || x >= width) {
+            dx = -dx;
+            x += 2 * dx;
+        }
+        if (y < 0 || y >= height) {
+            dy = -dy;
+            y += 2 * dy;
+        }
+        amos_damage_reset(&damage);
+        amos_cursor_move(&cursor, x, y);
+        amos_cursor_present(&cursor, &screen, &damage);
+
+        uint64_t pixels = damage_pixels(&damage);
+        max_damage = pixels > max_damage ? pixels : max_damage;
+    }
+    double move_us = (now_us() - start) / moves;
+
+    // The old and new rectangles of the largest cursor, at most
+    bool damage_ok = max_damage <= 2ull * AMOS_CURSOR_MAX_SIZE * AMOS_CURSOR_MAX_SIZE;
+
+    amos_damage_reset(&damage);
+    amos_cursor_present(&cursor, &screen, &damage);
+    bool idle_ok = damage.count == 0;
+
+    amos_cursor_set_visible(&cursor, false);
+    amos_cursor_present(&cursor, &screen, NULL);
+    bool hide_ok = memcmp(original, screen.buffer, screen_bytes) == 0;
+
+    printf("%dx%d, %d moves\n", width, height, moves);
+    printf("move:    %.3f us per event\n", move_us);
+    printf("damage:  at most %llu pixels per move  %s\n", (unsigned long long)max_damage,
+           damage_ok ? "ok" : "FAILED");
+    printf("idle:    %d rectangles damaged without a move  %s\n", damage.count, idle_ok ? "ok" : "FAILED");
+    printf("hide:    screen restored byte for byte  %s\n", hide_ok ? "ok" : "FAILED");
+
+    free(original);
+    amos_fb_cleanup(&screen);
+    return damage_ok && idle_ok && hide_ok ? 0 : 1;
+}
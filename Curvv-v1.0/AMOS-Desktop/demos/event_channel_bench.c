@@ -0,0 +1,155 @@
+/**
+ * AMOS Desktop OS - Event Channel Benchmark
+ *
+ * Runs the kernel-to-desktop event channel with a producer thread
+ * standing in for the interrupt handlers: it posts numbered key events
+ * interleaved with pointer motion and button changes while the main
+ * thread drains in batches: as fast as possible, paced like a 60 Hz
+ * frame loop, and one event at a time. Checks that queued events arrive
+ * in order, that the latest pointer position is never lost, and reports
+ * throughput, ring-full retries and coalesced motion.
+ *
+ * Usage: event_channel_bench [events]
+ */
+
+#include "../desktop/integration/event_channel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <sched.h>
+
+static amos_event_channel_t channel;
+static int producer_events;
+static int producer_pace_us;
+static volatile int producer_done;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Interrupt side: one key event, one motion update and the occasional button change per step
+static void* producer(void* arg) {
+    (void)arg;
+    for (int i = 0; i < producer_events; i++) {
+        amos_event_t key = {AMOS_EVENT_KEY, (uint16_t)i, 0, 0, (uint32_t)i};
+        while (!amos_event_channel_push(&channel, &key)) {
+            // The bench retries so ordering can be checked; interrupts would drop
+            sched_yield();
+        }
+        amos_event_channel_post_mouse(&channel, i, -i, (uint32_t)((i / 1000) & 1));
+
+        if (producer_pace_us > 0) {
+            struct timespec ts = {0, producer_pace_us * 1000L};
+            nanosleep(&ts, NULL);
+        }
+    }
+    __atomic_store_n(&producer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Drain until the producer finishes; returns false if ordering was violated
+static bool run(const char* name, int events, int pace_us, int frame_us, int batch_size) {
+    amos_event_channel_init(&channel);
+    producer_events = events;
+    producer_pace_us = pace_us;
+    producer_done = 0;
+
+    static amos_event_t batch[AMOS_EVENT_RING_SIZE + 1];
+    long next_key = 0;
+    int last_x = -1;
+    int buttons_seen = 0;
+    long drains = 0;
+    int max_batch = 0;
+    bool ok = true;
+
+    pthread_t thread;
+    double start = now_ms();
+    pthread_create(&thread, NULL, producer, NULL);
+
+    for (;;) {
+        int done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+        int count = amos_event_channel_drain(&channel, batch, batch_size);
+        drains++;
+        max_batch = count > max_batch ? count : max_batch;
+
+        for (int i = 0; i < count; i++) {
+            if (batch[i].type == AMOS_EVENT_KEY) {
+                if ((long)batch[i].value != next_key) {
+                    printf("  %s: key %u arrived, expected %ld\n", name, batch[i].value, next_key);
+                    ok = false;
+                }
+                next_key = (long)batch[i].value + 1;
+            } else if (batch[i].type == AMOS_EVENT_MOUSE) {
+                if (batch[i].y != -batch[i].x || batch[i].x < last_x) {
+                    printf("  %s: torn or stale pointer (%d, %d)\n", name, batch[i].x, batch[i].y);
+                    ok = false;
+                }
+                last_x = batch[i].x;
+                if (i + 1 < count) {
+                    buttons_seen++;
+                }
+            }
+        }
+
+        if (done && count == 0) {
+            break;
+        }
+        if (frame_us > 0) {
+            struct timespec ts = {0, frame_us * 1000L};
+            nanosleep(&ts, NULL);
+        } else if (count == 0) {
+            sched_yield();
+        }
+    }
+
+    pthread_join(thread, NULL);
+    double elapsed = now_ms() - start;
+
+    if (next_key != events || last_x != events - 1) {
+        printf("  %s: lost events (last key %ld, last x %d)\n", name, next_key - 1, last_x);
+        ok = false;
+    }
+
+    printf("%-8s %9d events %8.1f ms %7.2f Mevents/s  drains %7ld  max batch %4d  "
+           "full %6u  coalesced %8u  button events %d  %s\n",
+           name, events, elapsed, events / elapsed / 1000.0, drains, max_batch,
+           channel.dropped, channel.coalesced, buttons_seen, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// Drain one event at a time with motion pending behind queued events
+static bool check_single_slot(void) {
+    amos_event_channel_init(&channel);
+    for (int i = 0; i < 3; i++) {
+        amos_event_t key = {AMOS_EVENT_KEY, (uint16_t)i, 0, 0, (uint32_t)i};
+        amos_event_channel_push(&channel, &key);
+    }
+    amos_event_channel_post_mouse(&channel, 10, 20, 0);
+
+    // The keys in order, then the motion, then nothing
+    amos_event_t event;
+    bool ok = true;
+    for (int i = 0; i < 4; i++) {
+        int count = amos_event_channel_drain(&channel, &event, 1);
+        bool want_key = i < 3;
+        ok &= count == 1 && event.type == (want_key ? AMOS_EVENT_KEY : AMOS_EVENT_MOUSE) &&
+              (!want_key || event.value == (uint32_t)i);
+    }
+    ok &= amos_event_channel_drain(&channel, &event, 1) == 0;
+
+    printf("%-8s 3 keys and a motion through a one-event batch  %s\n", "single", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int events = argc > 1 ? atoi(argv[1]) : 2000000;
+
+    bool ok = check_single_slot();
+    ok = run("flood", events, 0, 0, AMOS_EVENT_RING_SIZE + 1) && ok;
+    ok = run("paced", events / 1000, 500, 16666, AMOS_EVENT_RING_SIZE + 1) && ok;
+    ok = run("one", events / 100, 0, 0, 1) && ok;
+    return ok ? 0 : 1;
+}
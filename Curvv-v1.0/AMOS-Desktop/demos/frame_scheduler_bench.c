@@ -0,0 +1,105 @@
+/**
+ * AMOS Desktop OS - Frame Scheduler Benchmark
+ *
+ * Drives a frame scheduler the way amos_desktop_run does and checks:
+ *
+ *   idle:   a wait with nothing to do blocks for its whole timeout and
+ *           uses almost no CPU
+ *   input:  a readable watched descriptor wakes the wait at once
+ *   first:  a frame requested on an idle desktop is due at once
+ *   flood:  requesting a frame on every wakeup renders at most one frame
+ *           per refresh interval
+ *
+ * Usage: frame_scheduler_bench [refresh_hz] [flood_ms]
+ */
+
+#include "../core/graphics/frame_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define IDLE_WAIT_MS 300
+
+static double clock_ms(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+int main(int argc, char** argv) {
+    int refresh_hz = argc > 1 ? atoi(argv[1]) : 60;
+    int flood_ms = argc > 2 ? atoi(argv[2]) : 500;
+    if (refresh_hz <= 0 || flood_ms <= 0) {
+        fprintf(stderr, "Usage: %s [refresh_hz] [flood_ms]\n", argv[0]);
+        return 1;
+    }
+
+    amos_frame_scheduler_t scheduler;
+    int input[2];
+    if (!amos_frame_scheduler_init(&scheduler, refresh_hz) || pipe(input) != 0 ||
+        !amos_frame_scheduler_watch_fd(&scheduler, input[0])) {
+        fprintf(stderr, "Initialization failed\n");
+        return 1;
+    }
+
+    // Idle: nothing requested, nothing readable
+    double wall = clock_ms(CLOCK_MONOTONIC);
+    double cpu = clock_ms(CLOCK_PROCESS_CPUTIME_ID);
+    int wake = amos_frame_scheduler_wait(&scheduler, IDLE_WAIT_MS);
+    wall = clock_ms(CLOCK_MONOTONIC) - wall;
+    cpu = clock_ms(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+    bool idle_ok = wake == AMOS_FRAME_WAKE_TIMEOUT && wall >= IDLE_WAIT_MS - 1 && cpu < 3.0;
+    printf("idle:   %d ms wait took %.1f ms, %.3f ms CPU  %s\n", IDLE_WAIT_MS, wall, cpu,
+           idle_ok ? "ok" : "FAILED");
+
+    // Input: the descriptor is readable before the wait starts
+    char byte = 0;
+    if (write(input[1], &byte, 1) != 1) {
+        fprintf(stderr, "Failed to write to the input pipe\n");
+        return 1;
+    }
+    wall = clock_ms(CLOCK_MONOTONIC);
+    wake = amos_frame_scheduler_wait(&scheduler, 1000);
+    wall = clock_ms(CLOCK_MONOTONIC) - wall;
+    bool input_ok = (wake & AMOS_FRAME_WAKE_INPUT) && wall < 5.0;
+    printf("input:  woke after %.3f ms  %s\n", wall, input_ok ? "ok" : "FAILED");
+    if (read(input[0], &byte, 1) != 1) {
+        fprintf(stderr, "Failed to read the input pipe\n");
+        return 1;
+    }
+
+    // First frame after idling renders without waiting for a slot
+    wall = clock_ms(CLOCK_MONOTONIC);
+    amos_frame_scheduler_request_frame(&scheduler);
+    wake = amos_frame_scheduler_wait(&scheduler, 1000);
+    bool first_due = amos_frame_scheduler_frame_due(&scheduler);
+    wall = clock_ms(CLOCK_MONOTONIC) - wall;
+    bool first_ok = (wake & AMOS_FRAME_WAKE_RENDER) && first_due && wall < 5.0;
+    printf("first:  due after %.3f ms  %s\n", wall, first_ok ? "ok" : "FAILED");
+    amos_frame_scheduler_frame_done(&scheduler);
+
+    // Flood: damage on every wakeup, as a busy desktop reports it
+    int frames = 0;
+    uint64_t requests = scheduler.requests;
+    double start = clock_ms(CLOCK_MONOTONIC);
+    while (clock_ms(CLOCK_MONOTONIC) - start < flood_ms) {
+        amos_frame_scheduler_request_frame(&scheduler);
+        amos_frame_scheduler_request_frame(&scheduler);
+        amos_frame_scheduler_wait(&scheduler, -1);
+        if (amos_frame_scheduler_frame_due(&scheduler)) {
+            amos_frame_scheduler_frame_done(&scheduler);
+            frames++;
+        }
+    }
+    int expected = (int)((double)flood_ms * refresh_hz / 1000.0);
+    bool flood_ok = frames >= expected - 1 && frames <= expected + 1;
+    printf("flood:  %d frames from %llu requests in %d ms at %d Hz, want %d  %s\n", frames,
+           (unsigned long long)(scheduler.requests - requests), flood_ms, refresh_hz, expected,
+           flood_ok ? "ok" : "FAILED");
+
+    amos_frame_scheduler_cleanup(&scheduler);
+    close(input[0]);
+    close(input[1]);
+    return idle_ok && input_ok && first_ok && flood_ok ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+/**
+ * AMOS Desktop OS - Frame Statistics Benchmark
+ *
+ * Measures what the always-on instrumentation adds to a frame and checks
+ * what it reports:
+ *
+ *   stage:       a timestamp plus amos_frame_stats_record, as each stage
+ *                of amos_desktop_render does
+ *   window:      a timestamp plus amos_frame_stats_record_window, once
+ *                per composited window
+ *   percentile:  percentiles read back from the histogram are within
+ *                12.5% above the exact values
+ *
+ * Usage: frame_stats_bench [records]
+ */
+
+#include "../core/graphics/frame_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define WINDOWS 30
+#define SAMPLES 100000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Ascending order for qsort
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Check the histogram's percentiles against exact ones from sorted samples
+static bool check_percentiles(void) {
+    static amos_histogram_t histogram;
+    static uint64_t samples[SAMPLES];
+
+    // Log-normal-ish frame times between 50 us and 50 ms
+    srand(7);
+    for (int i = 0; i < SAMPLES; i++) {
+        double u = (double)rand() / RAND_MAX;
+        samples[i] = (uint64_t)(50000.0 * (1.0 + 999.0 * u * u * u));
+        amos_histogram_record(&histogram, samples[i]);
+    }
+    qsort(samples, SAMPLES, sizeof(samples[0]), compare_u64);
+
+    static const double percentiles[] = {50.0, 95.0, 99.0, 100.0};
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        int rank = (int)(percentiles[i] / 100.0 * SAMPLES + 0.5);
+        uint64_t exact = samples[rank > 0 ? rank - 1 : 0];
+        uint64_t reported = amos_histogram_percentile(&histogram, percentiles[i]);
+        double error = ((double)reported - (double)exact) / (double)exact;
+        bool within = error >= 0.0 && error <= 0.125;
+        printf("percentile: p%-5g exact %8llu ns, reported %8llu ns (%+.1f%%)  %s\n", percentiles[i],
+               (unsigned long long)exact, (unsigned long long)reported, error * 100.0,
+               within ? "ok" : "FAILED");
+        ok &= within;
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int records = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (records <= 0) {
+        fprintf(stderr, "Usage: %s [records]\n", argv[0]);
+        return 1;
+    }
+
+    static amos_frame_stats_t stats;
+    amos_frame_stats_reset(&stats);
+
+    double start = now_ns();
+    for (int i = 0; i < records; i++) {
+        uint64_t stage_start = amos_frame_stats_now();
+        amos_frame_stats_record(&stats, (amos_frame_stage_t)(i % AMOS_FRAME_STAGE_COUNT), stage_start);
+    }
+    double stage_ns = (now_ns() - start) / records;
+
+    static int window_keys[WINDOWS];
+    start = now_ns();
+    for (int i = 0; i < records; i++) {
+        if (i % WINDOWS == 0) {
+            amos_frame_stats_end_frame(&stats, 0);
+        }
+        uint64_t window_start = amos_frame_stats_now();
+        amos_frame_stats_record_window(&stats, &window_keys[i % WINDOWS], i % WINDOWS, "bench",
+                                       window_start, 640 * 480);
+    }
+    double window_ns = (now_ns() - start) / records;
+
+    uint64_t recorded = 0;
+    for (int s = 0; s < AMOS_FRAME_STAGE_COUNT; s++) {
+        recorded += stats.stages[s].count;
+    }
+    bool counts_ok = recorded == (uint64_t)records && stats.window_count == WINDOWS;
+
+    printf("%d records\n", records);
+    printf("stage:      %.1f ns per record  %s\n", stage_ns, counts_ok ? "ok" : "FAILED");
+    printf("window:     %.1f ns per record, %d windows tracked\n", window_ns, stats.window_count);
+    bool percentiles_ok = check_percentiles();
+
+    return counts_ok && percentiles_ok ? 0 : 1;
+}
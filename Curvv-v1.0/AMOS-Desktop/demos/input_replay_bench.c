@@ -0,0 +1,195 @@
+/**
+ * AMOS Desktop OS - Input Replay Benchmark
+ *
+ * Replays an input trace through the desktop's own replay path,
+ * amos_desktop_replay_trace, and reports its frame-time percentiles,
+ * per-window composite cost and a hash of the final screen. One of the
+ * windows shows an animated 3D view, so the hash covers animation as
+ * well as the taskbar clock. The trace is replayed twice at maximum
+ * speed and once in real time, each on a freshly initialized desktop;
+ * all three must produce the same hash, so the bench doubles as a
+ * regression check for scripted interaction.
+ *
+ * Without a trace file (or when the file does not exist yet) it
+ * generates the drag scenario: 50 cascaded windows, each dragged along
+ * an arc by a 1 kHz mouse, and saves it to the given path.
+ *
+ * Usage: input_replay_bench [trace.amit] [width height]
+ */
+
+#include "../desktop/integration/desktop_init.h"
+#include "../desktop/integration/input_trace.h"
+#include "../core/3d/window3d.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#define DRAG_WINDOWS 50
+#define DRAG_STEPS 60
+
+#define VIEW_WINDOW 10           // Window showing the 3D view
+#define VIEW_INTERVAL_MS 33.0
+
+// Stand-in scene: bands that scroll with time, so every animation frame differs
+static void render_scene(amos_window3d_t* view, amos_renderer3d_t* renderer, double time_ms) {
+    (void)view;
+    amos_framebuffer_t* fb = renderer->color_buffer;
+    int offset = (int)(time_ms / 4.0);
+    for (int y = 0; y < fb->height; y++) {
+        uint32_t* row = (uint32_t*)(fb->buffer + (size_t)y * fb->pitch);
+        for (int x = 0; x < fb->width; x++) {
+            row[x] = 0xFF000000u | (uint32_t)(((x + y + offset) / 8) & 7) * 0x1F1F1Fu;
+        }
+    }
+    amos_fb_mark_changed(fb);
+}
+
+// Append a mouse record to a generated trace
+static void add_mouse(amos_input_trace_t* trace, uint32_t time_us, int x, int y, int buttons) {
+    amos_input_record_t* record = &trace->records[trace->count++];
+    record->time_us = time_us;
+    record->event.type = AMOS_EVENT_MOUSE;
+    record->event.code = 0;
+    record->event.x = x;
+    record->event.y = y;
+    record->event.value = (uint32_t)buttons;
+}
+
+// Drag every window by its title bar along an arc, one mouse report per millisecond
+static void generate_drag_scenario(amos_input_trace_t* trace, int width, int height) {
+    memset(trace, 0, sizeof(*trace));
+    trace->width = width;
+    trace->height = height;
+    trace->records = (amos_input_record_t*)malloc(DRAG_WINDOWS * (DRAG_STEPS + 12) * sizeof(amos_input_record_t));
+
+    uint32_t t = 0;
+    for (int k = 0; k < DRAG_WINDOWS; k++) {
+        int x = 20 + k * 16 + 6;
+        int y = 20 + k * 12 + 6;
+
+        add_mouse(trace, t += 5000, x, y, 0);
+        add_mouse(trace, t += 1000, x, y, 1);
+        for (int step = 1; step <= DRAG_STEPS; step++) {
+            float a = step * 3.14159265f / DRAG_STEPS;
+            int dx = (int)(sinf(a) * width * 0.3f);
+            int dy = (int)((1.0f - cosf(a)) * height * 0.15f);
+            add_mouse(trace, t += 1000, x + dx, y + dy, 1);
+        }
+        add_mouse(trace, t += 1000, trace->records[trace->count - 1].event.x,
+                  trace->records[trace->count - 1].event.y, 0);
+    }
+}
+
+// Replay the trace on a freshly initialized desktop; returns the final screen's hash
+static uint64_t replay(const char* path, int width, int height, bool max_speed, bool* ok) {
+    amos_desktop_config_t config = {
+        .screen_width = width,
+        .screen_height = height,
+        .background_color = 0x1E90FF,
+        .enable_3d = true,
+        .enable_browser = false,
+        .theme_name = "default",
+        .font_name = "Liberation Sans",
+        .font_size = 12
+    };
+    if (!amos_desktop_init(&config)) {
+        *ok = false;
+        return 0;
+    }
+    amos_desktop_state_t* state = amos_desktop_get_state();
+
+    // The same cascade the drag scenario expects
+    amos_window_t* view_window = NULL;
+    for (int k = 0; k < DRAG_WINDOWS; k++) {
+        char title[32];
+        snprintf(title, sizeof(title), "Window %d", k);
+        amos_window_t* window = amos_window_create(state->window_system, title, 20 + k * 16, 20 + k * 12,
+                                                   320, 240, AMOS_WINDOW_STYLE_NORMAL,
+                                                   AMOS_WINDOW_FLAG_MOVABLE | AMOS_WINDOW_FLAG_RESIZABLE);
+        if (window && window->framebuffer) {
+            amos_fb_clear(window->framebuffer, amos_color_rgb((uint8_t)(k * 5), 200, (uint8_t)(255 - k * 5)));
+        }
+        if (k == VIEW_WINDOW) {
+            view_window = window;
+        }
+    }
+
+    static amos_renderer3d_t renderer;
+    static amos_window3d_t view;
+    bool bound = view_window && state->views3d && amos_renderer3d_init(&renderer, 64, 64) &&
+                 amos_window3d_bind(state->views3d, &view, view_window, &renderer, render_scene, NULL);
+    if (bound) {
+        amos_window3d_set_animation(&view, VIEW_INTERVAL_MS, 0.0);
+    } else {
+        printf("Failed to bind the 3D view\n");
+        *ok = false;
+    }
+
+    printf("--- %s replay ---\n", max_speed ? "fast" : "real-time");
+    if (!amos_desktop_replay_trace(path, max_speed)) {
+        *ok = false;
+    }
+    amos_desktop_controller_handle_command("stats windows");
+    uint64_t hash = amos_fb_hash(state->fb);
+
+    if (bound) {
+        amos_window3d_unbind(state->views3d, &view);
+        amos_renderer3d_cleanup(&renderer);
+    }
+    amos_desktop_cleanup();
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : NULL;
+    int width = argc > 3 ? atoi(argv[2]) : 1280;
+    int height = argc > 3 ? atoi(argv[3]) : 720;
+
+    // The desktop replays from a file; keep a generated scenario in a temporary one
+    char temp_path[] = "/tmp/input_replay_XXXXXX";
+    amos_input_trace_t trace;
+    FILE* existing = path ? fopen(path, "rb") : NULL;
+    if (existing) {
+        fclose(existing);
+        if (!amos_input_trace_load(&trace, path)) {
+            return 1;
+        }
+        width = trace.width;
+        height = trace.height;
+        amos_input_trace_free(&trace);
+    } else {
+        generate_drag_scenario(&trace, width, height);
+        if (!path) {
+            int fd = mkstemp(temp_path);
+            if (fd < 0) {
+                fprintf(stderr, "Failed to create a temporary trace file\n");
+                return 1;
+            }
+            close(fd);
+        }
+        if (!amos_input_trace_save(&trace, path ? path : temp_path)) {
+            return 1;
+        }
+        if (path) {
+            printf("Saved drag scenario to %s\n", path);
+        }
+        amos_input_trace_free(&trace);
+    }
+
+    const char* replay_path = path ? path : temp_path;
+    bool ok = true;
+    uint64_t fast = replay(replay_path, width, height, true, &ok);
+    uint64_t again = replay(replay_path, width, height, true, &ok);
+    uint64_t real_time = replay(replay_path, width, height, false, &ok);
+    if (!path) {
+        unlink(temp_path);
+    }
+
+    ok &= fast == again && fast == real_time;
+    printf("hashes: fast %016llx, fast again %016llx, real time %016llx  %s\n",
+           (unsigned long long)fast, (unsigned long long)again, (unsigned long long)real_time,
+           ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/**
+ * AMOS Desktop OS - Light Culling Benchmark
+ * 
+ * Shades a lit floor plane with an increasing number of small point
+ * lights, once looping over every light per pixel and once with the
+ * tiled light lists, and reports frame time for each light count.
+ * The depth buffer and surface positions come from an analytic
+ * ray/plane intersection so only lighting cost is measured.
+ *
+ * Lights are added with amos_renderer3d_add_light as the count grows.
+ * Exits non-zero unless the light array grew by doubling up to
+ * AMOS_MAX_LIGHTS and refused the light after that.
+ *
+ * Usage: light_culling_bench [width height]
+ */
+
+#include "../core/3d/light_culling.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define FLOOR_SIZE 40.0f
+#define LIGHT_RANGE 2.5f
+#define SHININESS 32.0f
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Per-pixel surface data for the floor
+typedef struct {
+    amos_vec3_t position;
+    amos_vec3_t view_dir;
+    bool hit;
+} surface_t;
+
+// Intersect a camera ray per pixel with the y = 0 plane
+static void build_surface(amos_renderer3d_t* renderer, surface_t* surface) {
+    const amos_camera_t* cam = &renderer->camera;
+    amos_vec3_t forward, right, up;
+    amos_vec3_subtract(&cam->target, &cam->position, &forward);
+    amos_vec3_normalize(&forward, &forward);
+    amos_vec3_cross(&forward, &cam->up, &right);
+    amos_vec3_normalize(&right, &right);
+    amos_vec3_cross(&right, &forward, &up);
+
+    float tan_half = tanf(cam->fov * 0.5f * 3.14159265f / 180.0f);
+
+    for (int y = 0; y < renderer->height; y++) {
+        for (int x = 0; x < renderer->width; x++) {
+            float ndc_x = ((x + 0.5f) / renderer->width) * 2.0f - 1.0f;
+            float ndc_y = 1.0f - ((y + 0.5f) / renderer->height) * 2.0f;
+            amos_vec3_t dir = {
+                forward.x + right.x * ndc_x * tan_half * cam->aspect + up.x * ndc_y * tan_half,
+                forward.y + right.y * ndc_x * tan_half * cam->aspect + up.y * ndc_y * tan_half,
+                forward.z + right.z * ndc_x * tan_half * cam->aspect + up.z * ndc_y * tan_half
+            };
+
+            size_t i = (size_t)y * renderer->width + x;
+            surface_t* s = &surface[i];
+            renderer->depth_buffer[i] = cam->far_clip;
+            s->hit = false;
+
+            if (dir.y >= -1e-4f) {
+                continue;
+            }
+
+            float t = -cam->position.y / dir.y;
+            s->position.x = cam->position.x + dir.x * t;
+            s->position.y = 0.0f;
+            s->position.z = cam->position.z + dir.z * t;
+
+            // View depth is the distance along the forward axis
+            float depth = t * amos_vec3_dot(&dir, &forward);
+            if (depth >= cam->far_clip || fabsf(s->position.x) > FLOOR_SIZE || fabsf(s->position.z) > FLOOR_SIZE) {
+                continue;
+            }
+
+            renderer->depth_buffer[i] = depth;
+            amos_vec3_subtract(&cam->position, &s->position, &s->view_dir);
+            amos_vec3_normalize(&s->view_dir, &s->view_dir);
+            s->hit = true;
+        }
+    }
+}
+
+// Shade every pixel against every light
+static double shade_brute_force(const amos_renderer3d_t* renderer, const surface_t* surface, float* checksum) {
+    const amos_vec3_t normal = {0.0f, 1.0f, 0.0f};
+    double start = now_ms();
+    float sum = 0.0f;
+
+    for (int i = 0; i < renderer->width * renderer->height; i++) {
+        if (!surface[i].hit) {
+            continue;
+        }
+        amos_vec3_t diffuse = {0, 0, 0}, specular = {0, 0, 0};
+        for (int l = 0; l < renderer->light_count; l++) {
+            amos_light_accumulate(&renderer->lights[l], &surface[i].position, &normal,
+                                  &surface[i].view_dir, SHININESS, &diffuse, &specular);
+        }
+        sum += diffuse.x + specular.x;
+    }
+
+    *checksum = sum;
+    return now_ms() - start;
+}
+
+// Build the light grid and shade every pixel against its tile's lights
+static double shade_tiled(const amos_renderer3d_t* renderer, amos_light_grid_t* grid,
+                          const surface_t* surface, float* checksum, double* cull_ms) {
+    const amos_vec3_t normal = {0.0f, 1.0f, 0.0f};
+    double start = now_ms();
+
+    amos_light_grid_build(grid, renderer);
+    *cull_ms = now_ms() - start;
+
+    float sum = 0.0f;
+    for (int y = 0; y < renderer->height; y++) {
+        for (int x = 0; x < renderer->width; x++) {
+            const surface_t* s = &surface[(size_t)y * renderer->width + x];
+            if (!s->hit) {
+                continue;
+            }
+            amos_vec3_t diffuse, specular;
+            amos_light_grid_shade(grid, renderer->lights, x, y, &s->position, &normal,
+                                  &s->view_dir, SHININESS, &diffuse, &specular);
+            sum += diffuse.x + specular.x;
+        }
+    }
+
+    *checksum = sum;
+    return now_ms() - start;
+}
+
+// Add point lights through the public API until there are count of them,
+// checking that the light array grows geometrically and stops at the limit
+static bool add_lights(amos_renderer3d_t* renderer, int count, int* grows) {
+    while (renderer->light_count < count) {
+        amos_vec3_t position = {((float)rand() / RAND_MAX * 2.0f - 1.0f) * FLOOR_SIZE, 0.5f,
+                                ((float)rand() / RAND_MAX * 2.0f - 1.0f) * FLOOR_SIZE};
+        amos_vec3_t direction = {0.0f, -1.0f, 0.0f};
+        amos_vec4_t color = {(float)rand() / RAND_MAX, (float)rand() / RAND_MAX,
+                             (float)rand() / RAND_MAX, 1.0f};
+
+        int capacity = renderer->light_capacity;
+        int index = amos_renderer3d_add_light(renderer, AMOS_LIGHT_POINT, &position, &direction,
+                                              &color, 1.0f, LIGHT_RANGE, 0.0f);
+        if (index != renderer->light_count - 1 || renderer->light_capacity < renderer->light_count) {
+            return false;
+        }
+        if (renderer->light_capacity != capacity) {
+            (*grows)++;
+        }
+    }
+
+    return renderer->light_count < AMOS_MAX_LIGHTS ||
+           amos_renderer3d_add_light(renderer, AMOS_LIGHT_DIRECTIONAL, NULL, NULL,
+                                     &(amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f}, 1.0f, 0.0f, 0.0f) == -1;
+}
+
+int main(int argc, char** argv) {
+    int width = argc > 2 ? atoi(argv[1]) : 640;
+    int height = argc > 2 ? atoi(argv[2]) : 480;
+
+    amos_renderer3d_t renderer;
+    if (!amos_renderer3d_init(&renderer, width, height)) {
+        fprintf(stderr, "Usage: %s [width height]\n", argv[0]);
+        return 1;
+    }
+
+    amos_vec3_t position = {0.0f, 8.0f, 30.0f};
+    amos_vec3_t target = {0.0f, 0.0f, 0.0f};
+    amos_vec3_t up = {0.0f, 1.0f, 0.0f};
+    amos_renderer3d_set_camera(&renderer, &position, &target, &up, 60.0f,
+                               (float)width / (float)height, 0.1f, 200.0f);
+
+    surface_t* surface = (surface_t*)malloc((size_t)width * height * sizeof(surface_t));
+
+    amos_light_grid_t grid;
+    if (!surface || !amos_light_grid_init(&grid, width, height)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    build_surface(&renderer, surface);
+
+    printf("%dx%d, %d tiles\n", width, height, grid.tiles_x * grid.tiles_y);
+    printf("%8s %12s %12s %10s %14s %10s\n",
+           "lights", "brute ms", "tiled ms", "cull ms", "lights/tile", "rel diff");
+
+    // Scatter small coloured point lights just above the floor, adding
+    // more for every row
+    srand(1234);
+    int grows = 0;
+    bool added = true;
+    for (int count = 8; count <= AMOS_MAX_LIGHTS; count *= 2) {
+        if (!add_lights(&renderer, count, &grows)) {
+            added = false;
+            break;
+        }
+
+        float brute_sum, tiled_sum;
+        double cull_ms;
+        double brute_ms = shade_brute_force(&renderer, surface, &brute_sum);
+        double tiled_ms = shade_tiled(&renderer, &grid, surface, &tiled_sum, &cull_ms);
+
+        int tiles = grid.tiles_x * grid.tiles_y;
+        double per_tile = (double)grid.tile_offsets[tiles] / tiles;
+
+        printf("%8d %12.2f %12.2f %10.3f %14.2f %10.4f\n",
+               count, brute_ms, tiled_ms, cull_ms, per_tile,
+               fabsf(brute_sum - tiled_sum) / (brute_sum > 0.0f ? brute_sum : 1.0f));
+    }
+
+    // 8 lights, then doubling up to the limit
+    int expected_grows = 8;
+    bool grew = added && renderer.light_count == AMOS_MAX_LIGHTS && grows == expected_grows;
+    printf("add_light: %d lights, %d reallocations, capacity %d, limit %s  %s\n",
+           renderer.light_count, grows, renderer.light_capacity, added ? "enforced" : "not enforced",
+           grew ? "ok" : "FAILED");
+
+    amos_light_grid_cleanup(&grid);
+    free(surface);
+    amos_renderer3d_cleanup(&renderer);
+    return grew ? 0 : 1;
+}
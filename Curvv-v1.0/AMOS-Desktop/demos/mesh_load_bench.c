@@ -0,0 +1,317 @@
+/**
+ * AMOS Desktop OS - Mesh Load Benchmark
+ * 
+ * Compares building a sphere procedurally (sin/cos per vertex plus
+ * malloc, as the demos do today) with mapping the same mesh from an
+ * AMOS mesh file. Both paths finish with a pass over the index buffer
+ * so the mapped pages are actually faulted in.
+ *
+ * It then builds a LOD chain for a smaller sphere and checks level
+ * selection: two instances of the chain at different distances must
+ * keep their own levels, a level must never exceed the pixel error,
+ * and walking an instance out and back in must switch levels further
+ * out on the way out than on the way in (hysteresis). A failed check
+ * makes the bench exit with status 1.
+ *
+ * Usage: mesh_load_bench [mesh.amesh] [iterations]
+ */
+
+#include "../core/3d/mesh_format.h"
+#include "../core/3d/mesh_lod.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define DEFAULT_SLICES 1024
+#define DEFAULT_STACKS 1024
+#define DEFAULT_ITERATIONS 10
+#define LOD_SLICES 256
+#define LOD_STACKS 128
+#define LOD_STEPS 2000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Build a UV sphere into interleaved vertices, like create_sphere in shader_demo.c
+static amos_mesh_t* build_sphere(int slices, int stacks) {
+    int vertex_count = (slices + 1) * (stacks + 1);
+    int index_count = slices * stacks * 6;
+
+    amos_mesh_t* mesh = (amos_mesh_t*)calloc(1, sizeof(amos_mesh_t));
+    if (!mesh) {
+        return NULL;
+    }
+    mesh->vertices = (amos_vertex_t*)malloc(vertex_count * sizeof(amos_vertex_t));
+    mesh->indices = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+    if (!mesh->vertices || !mesh->indices) {
+        free(mesh->vertices);
+        free(mesh->indices);
+        free(mesh);
+        return NULL;
+    }
+
+    int v = 0;
+    for (int i = 0; i <= stacks; i++) {
+        float phi = 3.14159265f * i / stacks;
+        for (int j = 0; j <= slices; j++) {
+            float theta = 2.0f * 3.14159265f * j / slices;
+            amos_vertex_t* vert = &mesh->vertices[v++];
+            vert->normal.x = sinf(phi) * cosf(theta);
+            vert->normal.y = cosf(phi);
+            vert->normal.z = sinf(phi) * sinf(theta);
+            vert->position = vert->normal;
+            vert->texcoord.x = (float)j / slices;
+            vert->texcoord.y = (float)i / stacks;
+            vert->color = (amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f};
+        }
+    }
+
+    int n = 0;
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            uint32_t a = i * (slices + 1) + j;
+            uint32_t b = a + slices + 1;
+            mesh->indices[n++] = a;
+            mesh->indices[n++] = b;
+            mesh->indices[n++] = a + 1;
+            mesh->indices[n++] = b;
+            mesh->indices[n++] = b + 1;
+            mesh->indices[n++] = a + 1;
+        }
+    }
+
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = index_count;
+    return mesh;
+}
+
+static void free_sphere(amos_mesh_t* mesh) {
+    free(mesh->vertices);
+    free(mesh->indices);
+    free(mesh);
+}
+
+// Write the procedural sphere out as a mesh file
+static bool write_sphere_file(const char* path) {
+    amos_mesh_t* sphere = build_sphere(DEFAULT_SLICES, DEFAULT_STACKS);
+    if (!sphere) {
+        return false;
+    }
+
+    amos_vec3_t* positions = (amos_vec3_t*)malloc(sphere->vertex_count * sizeof(amos_vec3_t));
+    amos_vec3_t* normals = (amos_vec3_t*)malloc(sphere->vertex_count * sizeof(amos_vec3_t));
+    amos_vec2_t* texcoords = (amos_vec2_t*)malloc(sphere->vertex_count * sizeof(amos_vec2_t));
+    bool ok = positions && normals && texcoords;
+
+    if (ok) {
+        for (int i = 0; i < sphere->vertex_count; i++) {
+            positions[i] = sphere->vertices[i].position;
+            normals[i] = sphere->vertices[i].normal;
+            texcoords[i] = sphere->vertices[i].texcoord;
+        }
+
+        amos_mesh_file_data_t data = {
+            .positions = positions,
+            .normals = normals,
+            .texcoords = texcoords,
+            .colors = NULL,
+            .indices = sphere->indices,
+            .vertex_count = (uint32_t)sphere->vertex_count,
+            .index_count = (uint32_t)sphere->index_count,
+            .build_meshlets = true
+        };
+        ok = amos_mesh_file_write(path, &data);
+    }
+
+    free(positions);
+    free(normals);
+    free(texcoords);
+    free_sphere(sphere);
+    return ok;
+}
+
+// Touch every index so both paths pay for the data they produce
+static uint64_t touch_indices(const amos_mesh_t* mesh) {
+    uint64_t sum = 0;
+    for (int i = 0; i < mesh->index_count; i++) {
+        sum += mesh->indices[i];
+    }
+    return sum;
+}
+
+// Select a level for an instance of the chain at a distance in front of the camera
+static int select_at(const amos_mesh_lod_chain_t* chain, const amos_renderer3d_t* renderer,
+                     float distance, int current_level) {
+    amos_mat4_t model;
+    amos_mat4_identity(&model);
+    amos_mat4_translate(&model, 0.0f, 0.0f, -distance);
+    return amos_mesh_lod_select(chain, renderer, &model, AMOS_MESH_LOD_PIXEL_ERROR, current_level);
+}
+
+// Projected error of a level at a distance, as amos_mesh_lod_select computes it
+static float projected_error(const amos_mesh_lod_chain_t* chain, const amos_renderer3d_t* renderer,
+                             int level, float distance) {
+    float surface = distance - chain->bounds.radius;
+    float half_fov = renderer->camera.fov * 0.5f * 3.14159265f / 180.0f;
+    return chain->errors[level] * renderer->height / (2.0f * surface * tanf(half_fov));
+}
+
+// Check LOD selection and hysteresis; returns the number of failed checks
+static int check_lod_selection(void) {
+    amos_mesh_t* sphere = build_sphere(LOD_SLICES, LOD_STACKS);
+    if (!sphere) {
+        return 1;
+    }
+
+    amos_mesh_lod_chain_t chain;
+    double start = now_ms();
+    if (!amos_mesh_lod_build(&chain, sphere, AMOS_MESH_LOD_MAX_LEVELS)) {
+        printf("lod:        build failed\n");
+        free_sphere(sphere);
+        return 1;
+    }
+    double build_ms = now_ms() - start;
+
+    amos_renderer3d_t renderer;
+    memset(&renderer, 0, sizeof(renderer));
+    renderer.width = 1280;
+    renderer.height = 720;
+    renderer.camera.fov = 60.0f;
+    renderer.camera.near_clip = 0.1f;
+
+    int failures = 0;
+
+    float min_distance = 2.0f;
+    float max_distance = 500.0f;
+
+    // Find a distance inside a hysteresis band, where an instance coming
+    // from the coarsest level stays coarser than one coming from level 0
+    float band_distance = 0.0f;
+    for (int i = 0; i < LOD_STEPS && band_distance == 0.0f; i++) {
+        float distance = min_distance + (max_distance - min_distance) * i / (LOD_STEPS - 1);
+        if (select_at(&chain, &renderer, distance, chain.level_count - 1) !=
+            select_at(&chain, &renderer, distance, 0)) {
+            band_distance = distance;
+        }
+    }
+
+    // Two instances of one chain: a near one drawn in between must not
+    // reset the level the band instance holds
+    int band_level = select_at(&chain, &renderer, band_distance, chain.level_count - 1);
+    int held_level = band_level;
+    int near_level = 0;
+    for (int frame = 0; frame < 4; frame++) {
+        near_level = select_at(&chain, &renderer, min_distance, near_level);
+        held_level = select_at(&chain, &renderer, band_distance, held_level);
+    }
+    if (band_distance == 0.0f || near_level != 0 || held_level != band_level) {
+        printf("lod:        instances near %d band %d at %.1f, expected 0 and %d\n",
+               near_level, held_level, band_distance, band_level);
+        failures++;
+    }
+
+    // Walk one instance out and back in along the same distances
+    int out_levels[LOD_STEPS];
+    int level = 0;
+    for (int i = 0; i < LOD_STEPS; i++) {
+        float distance = min_distance + (max_distance - min_distance) * i / (LOD_STEPS - 1);
+        level = select_at(&chain, &renderer, distance, level);
+        out_levels[i] = level;
+        if (projected_error(&chain, &renderer, level, distance) > AMOS_MESH_LOD_PIXEL_ERROR) {
+            failures++;
+        }
+    }
+
+    int lagging_steps = 0;
+    for (int i = LOD_STEPS - 1; i >= 0; i--) {
+        float distance = min_distance + (max_distance - min_distance) * i / (LOD_STEPS - 1);
+        level = select_at(&chain, &renderer, distance, level);
+        if (projected_error(&chain, &renderer, level, distance) > AMOS_MESH_LOD_PIXEL_ERROR) {
+            failures++;
+        }
+        if (level < out_levels[i]) {
+            // Refining on the way in must happen no later than coarsening did on the way out
+            failures++;
+        } else if (level > out_levels[i]) {
+            lagging_steps++;
+        }
+    }
+
+    // Without hysteresis both walks would pick identical levels
+    if (lagging_steps == 0) {
+        printf("lod:        no hysteresis band between levels\n");
+        failures++;
+    }
+
+    printf("lod:        %d levels (%d -> %d triangles), built in %.1f ms, %d hysteresis steps, %s\n",
+           chain.level_count, chain.triangle_counts[0], chain.triangle_counts[chain.level_count - 1],
+           build_ms, lagging_steps, failures ? "FAIL" : "ok");
+
+    amos_mesh_lod_destroy(&chain);
+    free_sphere(sphere);
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "/tmp/amos_bench_sphere.amesh";
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = DEFAULT_ITERATIONS;
+    }
+
+    if (argc <= 1 && !write_sphere_file(path)) {
+        fprintf(stderr, "Failed to create %s\n", path);
+        return 1;
+    }
+
+    uint64_t checksum = 0;
+
+    // Procedural generation
+    double procedural_ms = 0.0;
+    int procedural_triangles = 0;
+    if (argc <= 1) {
+        for (int i = 0; i < iterations; i++) {
+            double start = now_ms();
+            amos_mesh_t* sphere = build_sphere(DEFAULT_SLICES, DEFAULT_STACKS);
+            if (!sphere) {
+                return 1;
+            }
+            checksum += touch_indices(sphere);
+            procedural_ms += now_ms() - start;
+            procedural_triangles = sphere->index_count / 3;
+            free_sphere(sphere);
+        }
+    }
+
+    // Zero-copy mapping
+    double mapped_ms = 0.0;
+    amos_mesh_t mesh;
+    int mapped_triangles = 0;
+    int meshlets = 0;
+    for (int i = 0; i < iterations; i++) {
+        double start = now_ms();
+        if (!amos_mesh_file_map(path, &mesh)) {
+            return 1;
+        }
+        checksum += touch_indices(&mesh);
+        mapped_ms += now_ms() - start;
+        mapped_triangles = mesh.index_count / 3;
+        meshlets = mesh.meshlet_count;
+        amos_mesh_file_unmap(&mesh);
+    }
+
+    if (procedural_triangles > 0) {
+        printf("procedural: %d triangles, %.2f ms/load\n",
+               procedural_triangles, procedural_ms / iterations);
+    }
+    printf("mapped:     %d triangles, %d meshlets, %.2f ms/load\n",
+           mapped_triangles, meshlets, mapped_ms / iterations);
+    printf("checksum:   %llu\n", (unsigned long long)checksum);
+
+    return check_lod_selection() ? 1 : 0;
+}
@@ -0,0 +1,632 @@
+/**
+ * AMOS Desktop OS - Renderer Benchmark
+ *
+ * Headless, deterministic benchmark for the 3D pipeline. Renders a
+ * fixed set of scenes for a number of frames with a fixed timestep,
+ * reports throughput and per-stage timing for each, and compares one
+ * frame of every scene against a golden image. The compared frame is
+ * always the one at GOLDEN_TIME, whatever the number of frames timed.
+ *
+ * Scenes cover the shader_demo cube and sphere, a high-poly mesh,
+ * heavy overdraw, many lights, texture minification, wireframe mode
+ * and a program written in the shader language.
+ *
+ * Usage: renderer_bench [frames] [golden_dir] [--update]
+ *
+ * With --update the compared frames are written to golden_dir instead
+ * of being compared. They are also rendered again with light culling
+ * off and must match the culled frames exactly. Exits
+ * non-zero if any scene differs from its golden image by more than the
+ * tolerance or culled and unculled lighting differ, or if a program
+ * with over-long identifiers compiles.
+ */
+
+#include "../core/3d/pipeline.h"
+#include "../core/3d/shader_dsl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define BENCH_WIDTH 320
+#define BENCH_HEIGHT 240
+#define DEFAULT_FRAMES 60
+#define DEFAULT_GOLDEN_DIR "demos/golden"
+#define TIMESTEP (1.0f / 60.0f)
+// Scene time of the frame compared with the golden images
+#define GOLDEN_TIME ((DEFAULT_FRAMES - 1) * TIMESTEP)
+#define MAX_BENCH_LIGHTS 64
+
+// A pixel differs when any channel is off by more than this
+#define GOLDEN_CHANNEL_TOLERANCE 8
+// A frame fails when more than this fraction of pixels differ
+#define GOLDEN_PIXEL_TOLERANCE 0.002
+
+#define PI 3.14159265f
+
+// Shared state for every scene
+typedef struct {
+    amos_renderer3d_t renderer;
+    amos_framebuffer_t target;
+    amos_framebuffer_t checker;
+    amos_light_t lights[MAX_BENCH_LIGHTS];
+
+    amos_mesh_t* cube;
+    amos_mesh_t* sphere;
+    amos_mesh_t* dense_sphere;
+    amos_mesh_t* quad;
+
+    amos_material_t material;
+    amos_shader_program_t program;
+} bench_t;
+
+// One benchmark scene
+typedef struct {
+    const char* name;
+    void (*setup)(bench_t* bench);
+    void (*draw)(bench_t* bench, float time);
+} scene_t;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Fill in a vertex
+static void set_vertex(amos_vertex_t* v, float px, float py, float pz,
+                       float nx, float ny, float nz, float u, float t) {
+    v->position = (amos_vec3_t){px, py, pz};
+    v->normal = (amos_vec3_t){nx, ny, nz};
+    v->texcoord = (amos_vec2_t){u, t};
+    v->color = (amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f};
+}
+
+// Allocate an empty mesh
+static amos_mesh_t* alloc_mesh(int vertex_count, int index_count) {
+    amos_mesh_t* mesh = (amos_mesh_t*)calloc(1, sizeof(amos_mesh_t));
+    if (!mesh) {
+        return NULL;
+    }
+    mesh->vertices = (amos_vertex_t*)calloc(vertex_count, sizeof(amos_vertex_t));
+    mesh->indices = (uint32_t*)malloc(index_count * sizeof(uint32_t));
+    if (!mesh->vertices || !mesh->indices) {
+        free(mesh->vertices);
+        free(mesh->indices);
+        free(mesh);
+        return NULL;
+    }
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = index_count;
+    return mesh;
+}
+
+static void free_mesh(amos_mesh_t* mesh) {
+    if (mesh) {
+        free(mesh->vertices);
+        free(mesh->indices);
+        free(mesh);
+    }
+}
+
+// Unit cube with per-face normals, counter-clockwise faces
+static amos_mesh_t* build_cube(void) {
+    static const float faces[6][3] = {
+        {0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}
+    };
+
+    amos_mesh_t* mesh = alloc_mesh(24, 36);
+    if (!mesh) {
+        return NULL;
+    }
+
+    for (int f = 0; f < 6; f++) {
+        amos_vec3_t n = {faces[f][0], faces[f][1], faces[f][2]};
+        // Two axes spanning the face, with u x v == n
+        amos_vec3_t u = fabsf(n.y) > 0.5f ? (amos_vec3_t){1, 0, 0} : (amos_vec3_t){0, 1, 0};
+        amos_vec3_t v;
+        amos_vec3_cross(&n, &u, &v);
+        amos_vec3_cross(&v, &n, &u);
+
+        static const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+        for (int c = 0; c < 4; c++) {
+            float a = corners[c][0], b = corners[c][1];
+            set_vertex(&mesh->vertices[f * 4 + c],
+                       n.x + u.x * a + v.x * b, n.y + u.y * a + v.y * b, n.z + u.z * a + v.z * b,
+                       n.x, n.y, n.z, (a + 1.0f) * 0.5f, (b + 1.0f) * 0.5f);
+        }
+
+        uint32_t base = (uint32_t)f * 4;
+        uint32_t* idx = mesh->indices + f * 6;
+        idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+        idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+    }
+    return mesh;
+}
+
+// UV sphere of unit radius, counter-clockwise from outside
+static amos_mesh_t* build_sphere(int slices, int stacks) {
+    amos_mesh_t* mesh = alloc_mesh((slices + 1) * (stacks + 1), slices * stacks * 6);
+    if (!mesh) {
+        return NULL;
+    }
+
+    int v = 0;
+    for (int i = 0; i <= stacks; i++) {
+        float phi = PI * i / stacks;
+        for (int j = 0; j <= slices; j++) {
+            float theta = 2.0f * PI * j / slices;
+            float x = sinf(phi) * cosf(theta);
+            float y = cosf(phi);
+            float z = sinf(phi) * sinf(theta);
+            set_vertex(&mesh->vertices[v++], x, y, z, x, y, z, (float)j / slices, (float)i / stacks);
+        }
+    }
+
+    int n = 0;
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            uint32_t a = i * (slices + 1) + j;
+            uint32_t b = a + slices + 1;
+            mesh->indices[n++] = a;
+            mesh->indices[n++] = a + 1;
+            mesh->indices[n++] = b;
+            mesh->indices[n++] = b;
+            mesh->indices[n++] = a + 1;
+            mesh->indices[n++] = b + 1;
+        }
+    }
+    return mesh;
+}
+
+// Quad in the XZ plane facing +Y, texture repeated `repeat` times
+static amos_mesh_t* build_quad(float repeat) {
+    amos_mesh_t* mesh = alloc_mesh(4, 6);
+    if (!mesh) {
+        return NULL;
+    }
+    set_vertex(&mesh->vertices[0], -1, 0, 1, 0, 1, 0, 0, 0);
+    set_vertex(&mesh->vertices[1], 1, 0, 1, 0, 1, 0, repeat, 0);
+    set_vertex(&mesh->vertices[2], 1, 0, -1, 0, 1, 0, repeat, repeat);
+    set_vertex(&mesh->vertices[3], -1, 0, -1, 0, 1, 0, 0, repeat);
+    static const uint32_t indices[6] = {0, 1, 2, 0, 2, 3};
+    memcpy(mesh->indices, indices, sizeof(indices));
+    return mesh;
+}
+
+// Checkerboard with a one-texel grid so minification aliases visibly
+static void fill_checker(amos_framebuffer_t* fb) {
+    for (int y = 0; y < fb->height; y++) {
+        uint32_t* row = (uint32_t*)(fb->buffer + (size_t)y * fb->pitch);
+        for (int x = 0; x < fb->width; x++) {
+            bool light = ((x >> 3) ^ (y >> 3)) & 1;
+            bool line = (x & 31) == 0 || (y & 31) == 0;
+            row[x] = line ? 0xFF2020E0u : light ? 0xFFD0D0D0u : 0xFF303030u;
+        }
+    }
+}
+
+// Point light helper
+static void set_light(amos_light_t* light, float x, float y, float z,
+                      float r, float g, float b, float intensity, float range) {
+    light->type = AMOS_LIGHT_POINT;
+    light->position = (amos_vec3_t){x, y, z};
+    light->direction = (amos_vec3_t){0.0f, -1.0f, 0.0f};
+    light->color = (amos_vec4_t){r, g, b, 1.0f};
+    light->intensity = intensity;
+    light->range = range;
+    light->spot_angle = 0.0f;
+}
+
+// Reset renderer state shared by the scenes
+static void reset_scene(bench_t* bench, amos_shading_model_t shading) {
+    amos_renderer3d_t* r = &bench->renderer;
+    r->camera.position = (amos_vec3_t){0.0f, 0.0f, 4.0f};
+    r->camera.target = (amos_vec3_t){0.0f, 0.0f, 0.0f};
+    r->camera.up = (amos_vec3_t){0.0f, 1.0f, 0.0f};
+    r->camera.fov = 60.0f;
+    r->camera.aspect = (float)BENCH_WIDTH / (float)BENCH_HEIGHT;
+    r->camera.near_clip = 0.1f;
+    r->camera.far_clip = 100.0f;
+    r->depth_test_enabled = true;
+    r->backface_culling_enabled = true;
+    r->wireframe_mode = false;
+    r->current_shader = NULL;
+
+    set_light(&bench->lights[0], 3.0f, 3.0f, 4.0f, 1.0f, 1.0f, 1.0f, 1.5f, 20.0f);
+    r->lights = bench->lights;
+    r->light_count = 1;
+
+    amos_material_t* m = &bench->material;
+    m->ambient = (amos_vec4_t){0.1f, 0.1f, 0.1f, 1.0f};
+    m->diffuse = (amos_vec4_t){0.8f, 0.5f, 0.3f, 1.0f};
+    m->specular = (amos_vec4_t){0.6f, 0.6f, 0.6f, 1.0f};
+    m->shininess = 32.0f;
+    m->diffuse_texture = NULL;
+    m->shader = NULL;
+    m->shading_model = shading;
+}
+
+// Model matrix: translation * rotate_y(yaw) * rotate_x(pitch) * uniform scale
+static void set_model(bench_t* bench, float tx, float ty, float tz, float yaw, float pitch, float scale) {
+    float cy = cosf(yaw), sy = sinf(yaw), cp = cosf(pitch), sp = sinf(pitch);
+    amos_mat4_t* m = &bench->renderer.model_matrix;
+    amos_mat4_identity(m);
+    m->m[0][0] = cy * scale;  m->m[0][1] = sy * sp * scale; m->m[0][2] = sy * cp * scale;  m->m[0][3] = tx;
+    m->m[1][0] = 0.0f;        m->m[1][1] = cp * scale;      m->m[1][2] = -sp * scale;      m->m[1][3] = ty;
+    m->m[2][0] = -sy * scale; m->m[2][1] = cy * sp * scale; m->m[2][2] = cy * cp * scale;  m->m[2][3] = tz;
+}
+
+static void draw(bench_t* bench, amos_mesh_t* mesh) {
+    mesh->material = &bench->material;
+    amos_renderer3d_draw_mesh(&bench->renderer, mesh);
+}
+
+// Scene: shader_demo cube, Phong with one light
+static void setup_cube(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_PHONG);
+}
+
+static void draw_cube(bench_t* bench, float time) {
+    set_model(bench, 0.0f, 0.0f, 0.0f, time, time * 0.7f, 1.0f);
+    draw(bench, bench->cube);
+}
+
+// Scene: shader_demo sphere, Gouraud with two lights
+static void setup_sphere(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_GOURAUD);
+    set_light(&bench->lights[1], -4.0f, 1.0f, 2.0f, 0.3f, 0.4f, 1.0f, 1.0f, 20.0f);
+    bench->renderer.light_count = 2;
+}
+
+static void draw_sphere(bench_t* bench, float time) {
+    set_model(bench, 0.0f, 0.0f, 0.0f, time * 0.5f, 0.3f, 1.5f);
+    draw(bench, bench->sphere);
+}
+
+// Scene: dense mesh where most triangles cover a pixel or less
+static void setup_high_poly(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_PHONG);
+}
+
+static void draw_high_poly(bench_t* bench, float time) {
+    set_model(bench, 0.0f, 0.0f, 0.0f, time * 0.3f, 0.2f, 1.6f);
+    draw(bench, bench->dense_sphere);
+}
+
+// Scene: full-screen quads drawn back to front, every layer passes depth
+#define OVERDRAW_LAYERS 16
+
+static void setup_overdraw(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_FLAT);
+    bench->renderer.camera.position = (amos_vec3_t){0.0f, 0.0f, 1.0f};
+}
+
+static void draw_overdraw(bench_t* bench, float time) {
+    for (int layer = 0; layer < OVERDRAW_LAYERS; layer++) {
+        float z = -4.0f + layer * 0.2f;
+        // Quad lies in XZ; pitch it to face the camera
+        set_model(bench, sinf(time + layer) * 0.2f, 0.0f, z, 0.0f, PI * 0.5f, 4.0f);
+        bench->material.diffuse.x = (float)layer / OVERDRAW_LAYERS;
+        draw(bench, bench->quad);
+    }
+}
+
+// Scene: Phong sphere lit by many short-range point lights close to its
+// surface, so each light covers only part of the screen
+static void setup_many_lights(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_PHONG);
+    srand(1234);
+    for (int i = 0; i < MAX_BENCH_LIGHTS; i++) {
+        float theta = 2.0f * PI * i / MAX_BENCH_LIGHTS;
+        set_light(&bench->lights[i], cosf(theta) * 1.7f, ((i % 8) - 3.5f) * 0.4f, sinf(theta) * 1.7f,
+                  (float)rand() / RAND_MAX, (float)rand() / RAND_MAX, (float)rand() / RAND_MAX,
+                  1.5f, 0.8f);
+    }
+    bench->renderer.light_count = MAX_BENCH_LIGHTS;
+}
+
+static void draw_many_lights(bench_t* bench, float time) {
+    set_model(bench, 0.0f, 0.0f, 0.0f, time * 0.5f, 0.0f, 1.5f);
+    draw(bench, bench->sphere);
+}
+
+// Scene: large textured floor receding to the horizon
+static void setup_minify(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_GOURAUD);
+    bench->renderer.camera.position = (amos_vec3_t){0.0f, 1.0f, 0.0f};
+    bench->renderer.camera.target = (amos_vec3_t){0.0f, 0.5f, -10.0f};
+    bench->material.diffuse = (amos_vec4_t){1.0f, 1.0f, 1.0f, 1.0f};
+    bench->material.ambient = (amos_vec4_t){0.6f, 0.6f, 0.6f, 1.0f};
+    bench->material.diffuse_texture = &bench->checker;
+    set_light(&bench->lights[0], 0.0f, 10.0f, -20.0f, 1.0f, 1.0f, 1.0f, 0.5f, 100.0f);
+}
+
+static void draw_minify(bench_t* bench, float time) {
+    set_model(bench, 0.0f, 0.0f, -42.0f, time * 0.05f, 0.0f, 40.0f);
+    draw(bench, bench->quad);
+}
+
+// Scene: the Gouraud sphere in wireframe mode
+static void setup_wireframe(bench_t* bench) {
+    setup_sphere(bench);
+    bench->renderer.wireframe_mode = true;
+}
+
+// Scene: the Phong sphere written in the shader language
+static const char* dsl_source =
+    "uniform mat4 mvp;\n"
+    "uniform mat4 model;\n"
+    "uniform vec3 light_dir;\n"
+    "uniform vec3 albedo;\n"
+    "varying vec3 v_normal;\n"
+    "varying vec2 v_uv;\n"
+    "\n"
+    "vertex {\n"
+    "    v_normal = (model * vec4(a_normal, 0.0)).xyz;\n"
+    "    v_uv = a_texcoord;\n"
+    "    out_position = mvp * vec4(a_position, 1.0);\n"
+    "}\n"
+    "\n"
+    "fragment {\n"
+    "    vec3 n = normalize(v_normal);\n"
+    "    float d = max(dot(n, light_dir), 0.0);\n"
+    "    float s = pow(max(n.z, 0.0), 16.0) * 0.4;\n"
+    "    float stripe = floor(fract(v_uv.x * 8.0) * 2.0) * 0.2 + 0.8;\n"
+    "    out_color = vec4(albedo * (d * 0.9 + 0.1) * stripe + vec3(s), 1.0);\n"
+    "}\n";
+
+// Two varyings that agree in their first 31 characters; the compiler
+// must reject them rather than truncate them into one name
+static const char* dsl_long_names_source =
+    "varying vec3 v_surface_normal_in_world_space_a;\n"
+    "varying vec3 v_surface_normal_in_world_space_b;\n"
+    "vertex {\n"
+    "    v_surface_normal_in_world_space_a = a_normal;\n"
+    "    v_surface_normal_in_world_space_b = -a_normal;\n"
+    "    out_position = vec4(a_position, 1.0);\n"
+    "}\n"
+    "fragment {\n"
+    "    out_color = vec4(v_surface_normal_in_world_space_a, 1.0);\n"
+    "}\n";
+
+static void setup_dsl(bench_t* bench) {
+    reset_scene(bench, AMOS_SHADING_PHONG);
+    amos_vec3_t light_dir = {0.577f, 0.577f, 0.577f};
+    amos_vec3_t albedo = {0.3f, 0.7f, 0.9f};
+    amos_shader_program_set_uniform_vec3(&bench->program, "light_dir", &light_dir);
+    amos_shader_program_set_uniform_vec3(&bench->program, "albedo", &albedo);
+    bench->material.shader = &bench->program;
+}
+
+static void draw_dsl(bench_t* bench, float time) {
+    amos_renderer3d_t* r = &bench->renderer;
+    set_model(bench, 0.0f, 0.0f, 0.0f, time * 0.5f, 0.3f, 1.5f);
+
+    amos_mat4_t view, projection, view_projection, mvp;
+    amos_mat4_look_at(&view, &r->camera.position, &r->camera.target, &r->camera.up);
+    amos_mat4_perspective(&projection, r->camera.fov * PI / 180.0f, r->camera.aspect,
+                          r->camera.near_clip, r->camera.far_clip);
+    amos_mat4_multiply(&projection, &view, &view_projection);
+    amos_mat4_multiply(&view_projection, &r->model_matrix, &mvp);
+    amos_shader_program_set_uniform_mat4(&bench->program, "mvp", &mvp);
+    amos_shader_program_set_uniform_mat4(&bench->program, "model", &r->model_matrix);
+
+    draw(bench, bench->sphere);
+}
+
+static const scene_t scenes[] = {
+    {"cube", setup_cube, draw_cube},
+    {"sphere", setup_sphere, draw_sphere},
+    {"high_poly", setup_high_poly, draw_high_poly},
+    {"overdraw", setup_overdraw, draw_overdraw},
+    {"many_lights", setup_many_lights, draw_many_lights},
+    {"minify", setup_minify, draw_minify},
+    {"wireframe", setup_wireframe, draw_sphere},
+    {"shader_dsl", setup_dsl, draw_dsl}
+};
+
+// Clear colour and depth
+static void clear_frame(bench_t* bench) {
+    uint32_t* pixels = (uint32_t*)bench->target.buffer;
+    for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++) {
+        pixels[i] = 0xFF281010u;
+        bench->renderer.depth_buffer[i] = bench->renderer.camera.far_clip;
+    }
+}
+
+// Write the frame as a binary PPM
+static bool write_ppm(const char* path, const amos_framebuffer_t* fb) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", fb->width, fb->height);
+    for (int y = 0; y < fb->height; y++) {
+        const uint32_t* row = (const uint32_t*)(fb->buffer + (size_t)y * fb->pitch);
+        for (int x = 0; x < fb->width; x++) {
+            uint8_t rgb[3] = {row[x] & 0xFF, (row[x] >> 8) & 0xFF, (row[x] >> 16) & 0xFF};
+            fwrite(rgb, 1, 3, file);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// Compare the frame with a PPM; returns the fraction of differing pixels or -1 on error
+static double compare_ppm(const char* path, const amos_framebuffer_t* fb, int* max_diff) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return -1.0;
+    }
+
+    int width, height, maxval;
+    if (fscanf(file, "P6 %d %d %d", &width, &height, &maxval) != 3 ||
+        width != fb->width || height != fb->height || maxval != 255) {
+        fclose(file);
+        return -1.0;
+    }
+    fgetc(file);
+
+    size_t differing = 0;
+    *max_diff = 0;
+    for (int y = 0; y < height; y++) {
+        const uint32_t* row = (const uint32_t*)(fb->buffer + (size_t)y * fb->pitch);
+        for (int x = 0; x < width; x++) {
+            uint8_t rgb[3];
+            if (fread(rgb, 1, 3, file) != 3) {
+                fclose(file);
+                return -1.0;
+            }
+            int worst = 0;
+            for (int c = 0; c < 3; c++) {
+                int diff = abs((int)((row[x] >> (c * 8)) & 0xFF) - rgb[c]);
+                worst = diff > worst ? diff : worst;
+            }
+            *max_diff = worst > *max_diff ? worst : *max_diff;
+            differing += worst > GOLDEN_CHANNEL_TOLERANCE;
+        }
+    }
+
+    fclose(file);
+    return (double)differing / ((double)width * height);
+}
+
+int main(int argc, char** argv) {
+    int frames = DEFAULT_FRAMES;
+    const char* golden_dir = DEFAULT_GOLDEN_DIR;
+    bool update = false;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (positional++ == 0) {
+            frames = atoi(argv[i]);
+        } else {
+            golden_dir = argv[i];
+        }
+    }
+    if (frames < 1) {
+        frames = 1;
+    }
+
+    bench_t bench;
+    memset(&bench, 0, sizeof(bench));
+    if (!amos_fb_init(&bench.target, BENCH_WIDTH, BENCH_HEIGHT, 4) ||
+        !amos_fb_init(&bench.checker, 1024, 1024, 4)) {
+        fprintf(stderr, "Failed to allocate framebuffers\n");
+        return 1;
+    }
+    fill_checker(&bench.checker);
+
+    bench.renderer.width = BENCH_WIDTH;
+    bench.renderer.height = BENCH_HEIGHT;
+    bench.renderer.color_buffer = &bench.target;
+    bench.renderer.depth_buffer = (float*)malloc(BENCH_WIDTH * BENCH_HEIGHT * sizeof(float));
+    bench.renderer.stage_timing_enabled = true;
+    bench.renderer.light_culling_enabled = true;
+
+    bench.cube = build_cube();
+    bench.sphere = build_sphere(48, 32);
+    bench.dense_sphere = build_sphere(512, 256);
+    bench.quad = build_quad(8.0f);
+    uint32_t* unculled = (uint32_t*)malloc(BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint32_t));
+    if (!unculled || !bench.renderer.depth_buffer || !bench.cube || !bench.sphere || !bench.dense_sphere || !bench.quad) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    if (!amos_shader_program_init_source(&bench.program, "bench", dsl_source)) {
+        return 1;
+    }
+
+    amos_shader_program_t rejected;
+    if (amos_shader_program_init_source(&rejected, "long_names", dsl_long_names_source)) {
+        fprintf(stderr, "FAIL: identifiers longer than 31 characters compiled\n");
+        amos_shader_program_release(&rejected);
+        return 1;
+    }
+
+    printf("%dx%d, %d frames per scene, dt %.4f\n", BENCH_WIDTH, BENCH_HEIGHT, frames, TIMESTEP);
+    printf("%-12s %8s %9s %9s %8s %10s %8s %8s %8s  %s\n",
+           "scene", "ms/frame", "Mtri/s", "Mfrag/s", "Mpix/s",
+           "transform", "bin", "raster", "shade", "golden");
+
+    int failures = 0;
+    for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++) {
+        const scene_t* scene = &scenes[s];
+        scene->setup(&bench);
+        amos_renderer3d_reset_stats(&bench.renderer);
+
+        double start = now_ms();
+        for (int frame = 0; frame < frames; frame++) {
+            clear_frame(&bench);
+            scene->draw(&bench, frame * TIMESTEP);
+        }
+        double elapsed = now_ms() - start;
+        amos_render_stats_t scene_stats = bench.renderer.stats;
+        const amos_render_stats_t* stats = &scene_stats;
+
+        // Render the compared frame visiting every light, then with culled
+        // lighting, which must match pixel for pixel
+        bench.renderer.light_culling_enabled = false;
+        clear_frame(&bench);
+        scene->draw(&bench, GOLDEN_TIME);
+        memcpy(unculled, bench.target.buffer, BENCH_WIDTH * BENCH_HEIGHT * sizeof(uint32_t));
+        bench.renderer.light_culling_enabled = true;
+        clear_frame(&bench);
+        scene->draw(&bench, GOLDEN_TIME);
+        int cull_mismatches = 0;
+        for (int i = 0; i < BENCH_WIDTH * BENCH_HEIGHT; i++) {
+            cull_mismatches += unculled[i] != ((const uint32_t*)bench.target.buffer)[i];
+        }
+        double seconds = elapsed / 1000.0;
+        double ns_per_frame = 1000000.0 * frames;
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s.ppm", golden_dir, scene->name);
+        char verdict[64];
+        if (cull_mismatches) {
+            snprintf(verdict, sizeof(verdict), "FAIL culling changed %d pixels", cull_mismatches);
+            failures++;
+        } else if (update) {
+            snprintf(verdict, sizeof(verdict), write_ppm(path, &bench.target) ? "written" : "write failed");
+        } else {
+            int max_diff;
+            double differing = compare_ppm(path, &bench.target, &max_diff);
+            if (differing < 0.0) {
+                snprintf(verdict, sizeof(verdict), "missing");
+                failures++;
+            } else if (differing > GOLDEN_PIXEL_TOLERANCE) {
+                snprintf(verdict, sizeof(verdict), "FAIL %.2f%% max %d", differing * 100.0, max_diff);
+                failures++;
+            } else {
+                snprintf(verdict, sizeof(verdict), "ok max %d", max_diff);
+            }
+        }
+
+        printf("%-12s %8.2f %9.2f %9.2f %8.2f %10.2f %8.2f %8.2f %8.2f  %s\n",
+               scene->name, elapsed / frames,
+               stats->triangles_drawn / seconds / 1e6,
+               stats->fragments_shaded / seconds / 1e6,
+               (double)BENCH_WIDTH * BENCH_HEIGHT * frames / seconds / 1e6,
+               stats->transform_ns / ns_per_frame, stats->bin_ns / ns_per_frame,
+               stats->raster_ns / ns_per_frame, stats->shade_ns / ns_per_frame,
+               verdict);
+    }
+    printf("Stage columns are ms/frame; specialized pipelines shade inside raster.\n");
+
+    amos_shader_program_release(&bench.program);
+    amos_pipeline_release(&bench.renderer);
+    free_mesh(bench.cube);
+    free_mesh(bench.sphere);
+    free_mesh(bench.dense_sphere);
+    free_mesh(bench.quad);
+    free(bench.renderer.depth_buffer);
+    free(unculled);
+    amos_fb_cleanup(&bench.target);
+    amos_fb_cleanup(&bench.checker);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * AMOS Desktop OS - Text Benchmark
+ *
+ * Draws window titles onto title bars the way amos_window_draw_titles
+ * does and reports the cost per title:
+ *
+ *   cold:      the first draw, which rasterizes the glyph atlas
+ *   cached:    the same title again, from the cached atlas and layout
+ *   uncached:  a different title every time, so each one is laid out
+ *              again (more titles than the layout cache holds)
+ *
+ * It also checks that the cached and uncached paths draw the same
+ * pixels for the same title.
+ *
+ * Usage: text_bench [titles] [size]
+ */
+
+#include "../core/graphics/text.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TITLE_BAR_WIDTH 400
+#define TITLE_BAR_HEIGHT 30
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Draw a title centred vertically on a cleared title bar
+static void draw_title(amos_text_t* text, amos_framebuffer_t* fb, int size, const char* title) {
+    amos_rect_t bar = {0, 0, fb->width, fb->height};
+    amos_text_draw(text, fb, AMOS_FONT_SANS, size, title, 8, (TITLE_BAR_HEIGHT - size) / 2,
+                   amos_color_rgb(255, 255, 255), &bar);
+}
+
+int main(int argc, char** argv) {
+    int titles = argc > 1 ? atoi(argv[1]) : 200000;
+    int size = argc > 2 ? atoi(argv[2]) : 14;
+    if (titles <= 0 || size < AMOS_TEXT_MIN_SIZE || size > AMOS_TEXT_MAX_SIZE) {
+        fprintf(stderr, "Usage: %s [titles] [size]\n", argv[0]);
+        return 1;
+    }
+
+    static amos_text_t text;
+    amos_framebuffer_t fb;
+    if (!amos_text_init(&text) || !amos_fb_init(&fb, TITLE_BAR_WIDTH, TITLE_BAR_HEIGHT, 4)) {
+        fprintf(stderr, "Initialization failed\n");
+        return 1;
+    }
+
+    // 15 characters, a typical window title
+    const char* title = "Terminal - bash";
+    amos_color_t bar_color = amos_color_rgb(45, 52, 54);
+
+    amos_fb_clear(&fb, bar_color);
+    double start = now_us();
+    draw_title(&text, &fb, size, title);
+    double cold_us = now_us() - start;
+    uint64_t cold_hash = amos_fb_hash(&fb);
+
+    start = now_us();
+    for (int i = 0; i < titles; i++) {
+        draw_title(&text, &fb, size, title);
+    }
+    double cached_us = (now_us() - start) / titles;
+
+    // Titles differ in their last characters, so every draw misses the layout cache
+    char name[32];
+    start = now_us();
+    for (int i = 0; i < titles; i++) {
+        snprintf(name, sizeof(name), "Terminal - %04d", i % 10000);
+        draw_title(&text, &fb, size, name);
+    }
+    double uncached_us = (now_us() - start) / titles;
+
+    // Redraw the title after its layout was evicted
+    for (int i = 0; i < AMOS_TEXT_LAYOUT_SLOTS * 2; i++) {
+        snprintf(name, sizeof(name), "Evict %d", i);
+        amos_text_layout(&text, AMOS_FONT_SANS, size, name);
+    }
+    amos_fb_clear(&fb, bar_color);
+    draw_title(&text, &fb, size, title);
+    bool same = amos_fb_hash(&fb) == cold_hash;
+
+    printf("\"%s\" (%d characters) at %dpx, %d titles\n", title, (int)strlen(title), size, titles);
+    printf("%-10s %10s\n", "draw", "us/title");
+    printf("%-10s %10.2f\n", "cold", cold_us);
+    printf("%-10s %10.2f\n", "cached", cached_us);
+    printf("%-10s %10.2f\n", "uncached", uncached_us);
+    printf("relayout: same pixels as the first draw  %s\n", same ? "ok" : "FAILED");
+
+    amos_text_cleanup(&text);
+    amos_fb_cleanup(&fb);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+/**
+ * AMOS Desktop OS - 3D View Present Benchmark
+ *
+ * Animates a 3D view in a window that other windows overlap and brings
+ * the screen up to date two ways each frame: by recompositing the whole
+ * desktop, and by copying only the view's damaged client rect with
+ * amos_window_system_draw_content. Reports the time per frame of each
+ * and checks that the copied screen matches the recomposited one after
+ * every frame.
+ *
+ * Usage: view_present_bench [frames] [width height]
+ */
+
+#include "../core/3d/window3d.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BACKGROUND_COLOR 0xFF2D3436u
+#define FRAME_INTERVAL_MS 16.0
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Fill a window with a pattern unique to it
+static void fill_window(amos_framebuffer_t* fb, int seed) {
+    for (int y = 0; y < fb->height; y++) {
+        uint32_t* row = (uint32_t*)(fb->buffer + (size_t)y * fb->pitch);
+        for (int x = 0; x < fb->width; x++) {
+            uint32_t band = (uint32_t)((x + y + seed * 37) / 16) & 7;
+            row[x] = 0xFF000000u | (band * 30u) << ((seed % 3) * 8) | 0x00202020u;
+        }
+    }
+    amos_fb_mark_changed(fb);
+}
+
+// Stand-in scene: bands that scroll with time, so every frame differs
+static void render_scene(amos_window3d_t* view, amos_renderer3d_t* renderer, double time_ms) {
+    (void)view;
+    fill_window(renderer->color_buffer, (int)(time_ms / FRAME_INTERVAL_MS));
+}
+
+// Recomposite the whole desktop
+static void composite(amos_window_system_t* system, amos_framebuffer_t* fb) {
+    amos_fb_clear(fb, BACKGROUND_COLOR);
+    amos_window_system_draw(system, fb);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 300;
+    int width = argc > 3 ? atoi(argv[2]) : 1280;
+    int height = argc > 3 ? atoi(argv[3]) : 720;
+    if (frames <= 0 || width < 640 || height < 480) {
+        fprintf(stderr, "Usage: %s [frames] [width height]\n", argv[0]);
+        return 1;
+    }
+
+    amos_window_system_t system;
+    amos_window3d_system_t views;
+    amos_renderer3d_t renderer;
+    amos_window3d_t view;
+    amos_framebuffer_t screen, reference;
+
+    if (!amos_window_system_init(&system) || !amos_renderer3d_init(&renderer, 64, 64) ||
+        !amos_fb_init(&screen, width, height, 4) || !amos_fb_init(&reference, width, height, 4)) {
+        fprintf(stderr, "Initialization failed\n");
+        return 1;
+    }
+    amos_window3d_system_init(&views);
+
+    // Two windows under the view, three over it: one across its title bar,
+    // one across a corner of its content and one inside it
+    static const amos_rect_t layout[] = {
+        {20, 20, 500, 400},
+        {400, 150, 500, 300},
+        {200, 100, 560, 400},    // The 3D view
+        {180, 80, 200, 60},
+        {650, 380, 300, 200},
+        {400, 250, 120, 90}
+    };
+    const int view_index = 2;
+    const int window_count = (int)(sizeof(layout) / sizeof(layout[0]));
+
+    for (int i = 0; i < window_count; i++) {
+        amos_window_t* window = amos_window_create(&system, "bench", layout[i].x, layout[i].y,
+                                                   layout[i].width, layout[i].height,
+                                                   AMOS_WINDOW_STYLE_NORMAL, AMOS_WINDOW_FLAG_MOVABLE);
+        if (!window) {
+            fprintf(stderr, "Failed to create window %d\n", i);
+            return 1;
+        }
+        fill_window(window->framebuffer, i);
+
+        if (i == view_index &&
+            !amos_window3d_bind(&views, &view, window, &renderer, render_scene, NULL)) {
+            fprintf(stderr, "Failed to bind the 3D view\n");
+            return 1;
+        }
+    }
+    amos_window3d_set_animation(&view, FRAME_INTERVAL_MS, 0.0);
+
+    amos_window3d_system_update(&views, 0.0, NULL);
+    composite(&system, &screen);
+
+    double full_ms = 0.0, content_ms = 0.0;
+    uint64_t damaged_pixels = 0;
+    int mismatches = 0;
+    for (int frame = 1; frame <= frames; frame++) {
+        amos_damage_t damage;
+        amos_damage_reset(&damage);
+        amos_window3d_system_update(&views, frame * FRAME_INTERVAL_MS, &damage);
+
+        double start = now_ms();
+        for (int i = 0; i < damage.count; i++) {
+            amos_window_system_draw_content(&system, view.window, &screen, &damage.rects[i]);
+            damaged_pixels += (uint64_t)damage.rects[i].width * damage.rects[i].height;
+        }
+        content_ms += now_ms() - start;
+
+        start = now_ms();
+        composite(&system, &reference);
+        full_ms += now_ms() - start;
+
+        if (memcmp(screen.buffer, reference.buffer, (size_t)screen.pitch * screen.height) != 0) {
+            mismatches++;
+        }
+    }
+
+    printf("%dx%d, %d windows, %d frames\n", width, height, window_count, frames);
+    printf("%-20s %10s %14s\n", "present", "ms/frame", "pixels/frame");
+    printf("%-20s %10.3f %14d\n", "full recomposite", full_ms / frames, width * height);
+    printf("%-20s %10.3f %14llu\n", "damaged content", content_ms / frames,
+           (unsigned long long)(damaged_pixels / (uint64_t)frames));
+    printf("content: %d of %d frames differ from a full recomposite  %s\n", mismatches, frames,
+           mismatches == 0 ? "ok" : "FAILED");
+
+    amos_window3d_unbind(&views, &view);
+    amos_window3d_system_cleanup(&views);
+    amos_renderer3d_cleanup(&renderer);
+    amos_window_system_cleanup(&system);
+    amos_fb_cleanup(&screen);
+    amos_fb_cleanup(&reference);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/**
+ * AMOS Desktop OS - Window Manager Input Benchmark
+ *
+ * Feeds raw input_event records through a pipe into the window manager's
+ * evdev input stage, the way a 1 kHz mouse and a keyboard would between
+ * two frames. Checks that each frame's motion arrives as a single move,
+ * that button presses and releases are reported at the position they
+ * happened at, that modifiers are tracked, and reports how many records
+ * the stage handles per second.
+ *
+ * Afterwards it checks recovery: keys held across a SYN_DROPPED whose
+ * releases were lost must be released when the device resyncs, and
+ * closing the writer must close the device, release what it held and
+ * stop the frame scheduler from waking on it.
+ *
+ * Usage: wm_input_bench [frames]
+ */
+
+#include "../desktop/wm/input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+
+#define MOTION_PER_FRAME 16
+
+typedef struct {
+    int moves;
+    int presses;
+    int releases;
+    int keys;
+    int key_releases;
+    int shifted_keys;
+    int press_x, press_y;
+    int last_x, last_y;
+} bench_counts_t;
+
+static struct input_event records[256];
+static int record_count;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void add(unsigned short type, unsigned short code, int value) {
+    struct input_event* ev = &records[record_count++];
+    memset(ev, 0, sizeof(*ev));
+    ev->type = type;
+    ev->code = code;
+    ev->value = value;
+}
+
+static void on_event(wm_event_t* event, void* user_data) {
+    bench_counts_t* counts = (bench_counts_t*)user_data;
+    switch (event->type) {
+        case WM_EVENT_MOUSE_MOVE:
+            counts->moves++;
+            break;
+        case WM_EVENT_MOUSE_PRESS:
+            counts->presses++;
+            counts->press_x = event->x;
+            counts->press_y = event->y;
+            break;
+        case WM_EVENT_MOUSE_RELEASE:
+            counts->releases++;
+            break;
+        case WM_EVENT_KEY_PRESS:
+            counts->keys++;
+            if (event->key == KEY_A && (event->state & WM_MOD_SHIFT)) {
+                counts->shifted_keys++;
+            }
+            break;
+        case WM_EVENT_KEY_RELEASE:
+            counts->key_releases++;
+            break;
+        default:
+            break;
+    }
+    counts->last_x = event->x;
+    counts->last_y = event->y;
+}
+
+// Write the pending records and process them
+static bool feed(struct wm_input* input, int fd, bench_counts_t* counts) {
+    ssize_t size = (ssize_t)(record_count * sizeof(struct input_event));
+    if (record_count > 0 && write(fd, records, size) != size) {
+        perror("write");
+        return false;
+    }
+    record_count = 0;
+    memset(counts, 0, sizeof(*counts));
+    wm_input_process(input, on_event, counts);
+    return true;
+}
+
+// Check SYN_DROPPED resync and device removal; closes write_fd
+static bool check_recovery(struct wm_input* input, int write_fd, amos_frame_scheduler_t* scheduler) {
+    bench_counts_t counts;
+    bool ok = true;
+
+    // Start with nothing held
+    record_count = 0;
+    add(EV_KEY, BTN_LEFT, 0);
+    add(EV_SYN, SYN_REPORT, 0);
+    if (!feed(input, write_fd, &counts)) {
+        return false;
+    }
+
+    // Hold B and the right button, then lose their releases in a drop
+    add(EV_KEY, KEY_B, 1);
+    add(EV_KEY, BTN_RIGHT, 1);
+    add(EV_SYN, SYN_REPORT, 0);
+    add(EV_SYN, SYN_DROPPED, 0);
+    add(EV_KEY, KEY_B, 0);
+    add(EV_KEY, BTN_RIGHT, 0);
+    add(EV_SYN, SYN_REPORT, 0);
+    unsigned long released = input->released;
+    if (!feed(input, write_fd, &counts)) {
+        return false;
+    }
+    if (counts.keys != 1 || counts.key_releases != 1 || counts.presses != 1 || counts.releases != 1 ||
+        input->buttons != 0 || input->released - released != 2) {
+        printf("  SYN_DROPPED: %d/%d key press/release, %d/%d button press/release, buttons %#x\n",
+               counts.keys, counts.key_releases, counts.presses, counts.releases, input->buttons);
+        ok = false;
+    }
+
+    // Hold shift and C, then unplug the device
+    add(EV_KEY, KEY_LEFTSHIFT, 1);
+    add(EV_KEY, KEY_C, 1);
+    add(EV_SYN, SYN_REPORT, 0);
+    if (!feed(input, write_fd, &counts)) {
+        return false;
+    }
+    close(write_fd);
+    if (!feed(input, write_fd, &counts)) {
+        return false;
+    }
+    bool woken = (amos_frame_scheduler_wait(scheduler, 0) & AMOS_FRAME_WAKE_INPUT) != 0;
+    if (counts.key_releases != 2 || input->modifiers != 0 || input->lost != 1 ||
+        input->devices[0].fd != -1 || scheduler->fd_count != 0 || woken) {
+        printf("  removal: %d key releases, modifiers %#x, %lu lost, fd %d, %d watched%s\n",
+               counts.key_releases, input->modifiers, input->lost, input->devices[0].fd,
+               scheduler->fd_count, woken ? ", still woken" : "");
+        ok = false;
+    }
+
+    printf("recovery: %lu drops, %lu releases posted, %lu devices lost  %s\n",
+           input->dropped, input->released, input->lost, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 20000;
+    int width = 1920;
+    int height = 1080;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    amos_frame_scheduler_t scheduler;
+    amos_frame_scheduler_init(&scheduler, 60);
+
+    struct wm_input input;
+    wm_input_init(&input, width, height);
+    wm_input_set_scheduler(&input, &scheduler);
+    wm_input_add_fd(&input, fds[0], WM_INPUT_KEYBOARD | WM_INPUT_POINTER);
+
+    bool ok = true;
+    int expected_x = width / 2;
+    int expected_y = height / 2;
+    int expected_presses = 0;
+    int expected_shifted = 0;
+    int presses = 0;
+    int shifted = 0;
+    long events = 0;
+    long written = 0;
+    double process_ms = 0.0;
+
+    for (int frame = 0; frame < frames; frame++) {
+        record_count = 0;
+        int press_at = -1;
+
+        // A 1 kHz mouse reports about 16 times per 60 Hz frame
+        for (int i = 0; i < MOTION_PER_FRAME; i++) {
+            // Sweeps stay clear of the screen edges so every frame moves
+            int dx = (frame / 40) % 2 ? -1 : 1;
+            int dy = (frame / 30) % 2 ? -1 : 1;
+            add(EV_REL, REL_X, dx);
+            add(EV_REL, REL_Y, dy);
+            expected_x += dx;
+            expected_y += dy;
+            expected_x = expected_x < 0 ? 0 : (expected_x >= width ? width - 1 : expected_x);
+            expected_y = expected_y < 0 ? 0 : (expected_y >= height ? height - 1 : expected_y);
+
+            // Click mid-frame every tenth frame, in the same packet as motion
+            if (frame % 10 == 0 && i == MOTION_PER_FRAME / 2) {
+                add(EV_KEY, BTN_LEFT, 1);
+                press_at = expected_x * 10000 + expected_y;
+                expected_presses++;
+            }
+            if (frame % 10 == 5 && i == 0) {
+                add(EV_KEY, BTN_LEFT, 0);
+            }
+            add(EV_SYN, SYN_REPORT, 0);
+        }
+
+        // Shift-A every seventh frame
+        if (frame % 7 == 0) {
+            add(EV_KEY, KEY_LEFTSHIFT, 1);
+            add(EV_SYN, SYN_REPORT, 0);
+            add(EV_KEY, KEY_A, 1);
+            add(EV_SYN, SYN_REPORT, 0);
+            add(EV_KEY, KEY_A, 0);
+            add(EV_KEY, KEY_LEFTSHIFT, 0);
+            add(EV_SYN, SYN_REPORT, 0);
+            expected_shifted++;
+        }
+
+        if (write(fds[1], records, record_count * sizeof(struct input_event)) !=
+            (ssize_t)(record_count * sizeof(struct input_event))) {
+            perror("write");
+            return 1;
+        }
+        written += record_count;
+
+        bench_counts_t counts;
+        memset(&counts, 0, sizeof(counts));
+        double start = now_ms();
+        events += wm_input_process(&input, on_event, &counts);
+        process_ms += now_ms() - start;
+
+        // Motion is split only at button transitions
+        int max_moves = 1 + counts.presses + counts.releases;
+        if (counts.moves == 0 || counts.moves > max_moves) {
+            printf("  frame %d: %d move events\n", frame, counts.moves);
+            ok = false;
+        }
+        if (press_at >= 0 && counts.press_x * 10000 + counts.press_y != press_at) {
+            printf("  frame %d: press at (%d, %d)\n", frame, counts.press_x, counts.press_y);
+            ok = false;
+        }
+        if (counts.last_x != expected_x || counts.last_y != expected_y) {
+            printf("  frame %d: pointer at (%d, %d), expected (%d, %d)\n",
+                   frame, counts.last_x, counts.last_y, expected_x, expected_y);
+            ok = false;
+        }
+        if (frame % 7 == 0 && counts.shifted_keys != 1) {
+            printf("  frame %d: shift not applied\n", frame);
+            ok = false;
+        }
+        presses += counts.presses;
+        shifted += counts.shifted_keys;
+        if (!ok) {
+            break;
+        }
+    }
+
+    if (ok && (presses != expected_presses || shifted != expected_shifted)) {
+        printf("  %d presses, %d shifted keys; expected %d, %d\n",
+               presses, shifted, expected_presses, expected_shifted);
+        ok = false;
+    }
+
+    printf("%d frames, %ld records, %ld events delivered, %lu packets, %lu coalesced\n",
+           frames, written, events, input.reports, input.coalesced);
+    printf("process: %.1f ms total, %.2f us/frame, %.1f Mrecords/s  %s\n",
+           process_ms, process_ms * 1000.0 / frames, written / process_ms / 1000.0,
+           ok ? "ok" : "FAILED");
+
+    if (!check_recovery(&input, fds[1], &scheduler)) {
+        ok = false;
+    }
+
+    wm_input_close(&input);
+    amos_frame_scheduler_cleanup(&scheduler);
+    return ok ? 0 : 1;
+}
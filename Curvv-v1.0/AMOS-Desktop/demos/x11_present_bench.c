@@ -0,0 +1,135 @@
+/**
+ * AMOS Desktop OS - X11 Presentation Benchmark
+ *
+ * Presents a framebuffer in an X11 window through MIT-SHM, moving a box
+ * across it so each frame damages two small rectangles, and reports the
+ * frame rate, how long each frame waited for the previous present to
+ * complete and how many pixels were sent. At the end a pixel under the
+ * box is read back from the window and compared with the framebuffer,
+ * so running it under Xvfb checks both presentation paths.
+ *
+ * Usage: x11_present_bench [frames] [width height]
+ */
+
+#include "../core/graphics/x11_present.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <X11/Xutil.h>
+
+#define BOX_SIZE 64
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Extract an 8-bit channel from a pixel value
+static int channel(unsigned long pixel, unsigned long mask) {
+    if (!mask) {
+        return 0;
+    }
+    int shift = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        shift++;
+    }
+    return (int)(((pixel >> shift) & mask) * 255 / mask);
+}
+
+// Read one pixel back from the window and compare it with the framebuffer
+static bool check_readback(amos_x11_present_t* present, const amos_framebuffer_t* fb, int x, int y) {
+    XImage* image = XGetImage(present->display, present->window, x, y, 1, 1, AllPlanes, ZPixmap);
+    if (!image) {
+        printf("Readback failed\n");
+        return false;
+    }
+    unsigned long pixel = XGetPixel(image, 0, 0);
+    int r = channel(pixel, image->red_mask);
+    int g = channel(pixel, image->green_mask);
+    int b = channel(pixel, image->blue_mask);
+    XDestroyImage(image);
+
+    uint8_t er, eg, eb;
+    amos_color_get_rgba(amos_fb_get_pixel(fb, x, y), &er, &eg, &eb, NULL);
+    bool match = r == er && g == eg && b == eb;
+    printf("Readback at (%d, %d): %02x%02x%02x, expected %02x%02x%02x %s\n",
+           x, y, r, g, b, er, eg, eb, match ? "ok" : "MISMATCH");
+    return match;
+}
+
+// Handle everything queued on the display
+static void drain_events(amos_x11_present_t* present, amos_damage_t* damage) {
+    while (XPending(present->display)) {
+        XEvent event;
+        XNextEvent(present->display, &event);
+        amos_x11_present_handle_event(present, &event, damage);
+    }
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 600;
+    int width = argc > 3 ? atoi(argv[2]) : 1024;
+    int height = argc > 3 ? atoi(argv[3]) : 768;
+    if (frames <= 0 || width < BOX_SIZE || height < BOX_SIZE) {
+        printf("Usage: %s [frames] [width height]\n", argv[0]);
+        return 1;
+    }
+
+    amos_x11_present_t present;
+    amos_framebuffer_t fb;
+    if (!amos_x11_present_init(&present, &fb, NULL, width, height, "AMOS present bench")) {
+        return 1;
+    }
+    printf("Framebuffer is the shared segment: %s\n",
+           fb.buffer == (uint8_t*)present.shm.shmaddr ? "yes" : "no");
+
+    amos_color_t background = amos_color_rgb(30, 144, 255);
+    amos_color_t box_color = amos_color_rgb(255, 193, 7);
+    amos_damage_t damage;
+
+    // First frame: the whole screen
+    amos_fb_clear(&fb, background);
+    amos_damage_reset(&damage);
+    amos_rect_t screen = {0, 0, width, height};
+    amos_damage_add(&damage, &screen);
+    amos_x11_present_damage(&present, &damage);
+    amos_x11_present_wait(&present);
+
+    amos_rect_t box = {0, 0, BOX_SIZE, BOX_SIZE};
+    double wait_total = 0.0;
+    double start = now_ms();
+    for (int i = 0; i < frames; i++) {
+        // The segment is ours again once the previous present completed
+        double wait_start = now_ms();
+        amos_x11_present_wait(&present);
+        wait_total += now_ms() - wait_start;
+
+        amos_damage_reset(&damage);
+        drain_events(&present, &damage);
+
+        // Move the box along a diagonal that wraps at the screen edges
+        amos_fb_fill_rect(&fb, &box, background);
+        amos_damage_add(&damage, &box);
+        box.x = (i * 7) % (width - BOX_SIZE);
+        box.y = (i * 5) % (height - BOX_SIZE);
+        amos_fb_fill_rect(&fb, &box, box_color);
+        amos_damage_add(&damage, &box);
+
+        amos_x11_present_damage(&present, &damage);
+    }
+    amos_x11_present_wait(&present);
+    double elapsed = now_ms() - start;
+
+    printf("%d frames in %.1f ms (%.0f fps), %.3f ms average completion wait\n",
+           frames, elapsed, frames * 1000.0 / elapsed, wait_total / frames);
+    printf("%llu presents, %llu rectangles, %.1f Mpixels sent\n",
+           (unsigned long long)present.presents, (unsigned long long)present.rects,
+           present.pixels / 1000000.0);
+
+    bool ok = check_readback(&present, &fb, box.x + BOX_SIZE / 2, box.y + BOX_SIZE / 2);
+    amos_x11_present_cleanup(&present, &fb);
+    return ok ? 0 : 1;
+}
@@ -9,13 +9,113 @@
 #include "../../core/graphics/framebuffer.h"
 #include "../../core/graphics/window.h"
 #include "../../core/3d/renderer3d.h"
+#include "../../core/3d/window3d.h"
+#include "../../core/graphics/damage.h"
+#include "../../core/graphics/text.h"
+#include "../../core/graphics/cursor.h"
+#include "../../core/graphics/frame_scheduler.h"
+#include "../../core/graphics/frame_stats.h"
+#include "event_channel.h"
+#include "input_trace.h"
+#ifdef AMOS_X11
+#include "../../core/graphics/x11_present.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
+#include <errno.h>
 
 // Desktop environment global state
 static amos_desktop_state_t desktop_state;
 
+// Screen regions changed since the last flush
+static amos_damage_t desktop_damage;
+
+// Client rects of 3D views that rendered since the last frame
+static amos_damage_t desktop_views_damage;
+
+// Pointer overlay, drawn over the composited screen before each flush
+static amos_cursor_t desktop_cursor;
+
+// Minute shown by the taskbar clock
+static long desktop_clock_minute = -1;
+
+// Paces the main loop: blocks while idle, renders at most once per refresh
+static amos_frame_scheduler_t desktop_scheduler;
+
+// Stage and per-window timing, queried with the "stats" controller command
+static amos_frame_stats_t desktop_stats;
+
+// Events queued by the kernel's interrupt handlers
+static amos_event_channel_t desktop_events;
+
+// Input being recorded with the "trace record:" controller command
+static amos_input_trace_t desktop_trace;
+
+#ifdef AMOS_X11
+// X11 window the framebuffer is shown in when running nested
+static amos_x11_present_t desktop_x11;
+static bool desktop_x11_active = false;
+#endif
+
+// Pointer state as of the last event processed
+static int desktop_mouse_x = 0;
+static int desktop_mouse_y = 0;
+static int desktop_mouse_buttons = 0;
+
+// While a trace replays, desktop time is trace time counted from zero,
+// so the final frame does not depend on when or how fast it ran
+static bool desktop_clock_pinned = false;
+static double desktop_pinned_ms = 0.0;
+
+// Time driving 3D animation in milliseconds: monotonic, or trace time
+static double desktop_now_ms(void) {
+    if (desktop_clock_pinned) {
+        return desktop_pinned_ms;
+    }
+    
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Time shown by the taskbar clock: wall clock, or trace time
+static time_t desktop_clock_time(void) {
+    return desktop_clock_pinned ? (time_t)(desktop_pinned_ms / 1000.0) : time(NULL);
+}
+
+// Release whatever amos_desktop_init set up before a step failed
+static void desktop_init_unwind(void) {
+    if (desktop_state.views3d) {
+        amos_window3d_system_cleanup(desktop_state.views3d);
+        free(desktop_state.views3d);
+        desktop_state.views3d = NULL;
+    }
+    if (desktop_state.renderer) {
+        amos_renderer3d_cleanup(desktop_state.renderer);
+        free(desktop_state.renderer);
+        desktop_state.renderer = NULL;
+    }
+    if (desktop_state.window_system) {
+        desktop_state.window_system->text = NULL;
+        amos_window_system_cleanup(desktop_state.window_system);
+        free(desktop_state.window_system);
+        desktop_state.window_system = NULL;
+    }
+    if (desktop_state.text) {
+        amos_text_cleanup(desktop_state.text);
+        free(desktop_state.text);
+        desktop_state.text = NULL;
+    }
+    if (desktop_state.fb) {
+        amos_fb_cleanup(desktop_state.fb);
+        free(desktop_state.fb);
+        desktop_state.fb = NULL;
+    }
+    amos_frame_scheduler_cleanup(&desktop_scheduler);
+}
+
 // Initialize the desktop environment
 bool amos_desktop_init(const amos_desktop_config_t* config) {
     printf("AMOS Desktop Environment Initialization\n");
@@ -30,10 +130,14 @@ bool amos_desktop_init(const amos_desktop_config_t* config) {
     desktop_state.config = *config;
     desktop_state.running = false;
     
+    // First, so every failure below can release it
+    amos_frame_scheduler_init(&desktop_scheduler, 60);
+    
     // Initialize system framebuffer
     desktop_state.fb = (amos_framebuffer_t*)malloc(sizeof(amos_framebuffer_t));
     if (!desktop_state.fb) {
         printf("Error: Failed to allocate framebuffer memory\n");
+        desktop_init_unwind();
         return false;
     }
     
@@ -41,6 +145,7 @@ bool amos_desktop_init(const amos_desktop_config_t* config) {
         printf("Error: Failed to initialize framebuffer\n");
         free(desktop_state.fb);
         desktop_state.fb = NULL;
+        desktop_init_unwind();
         return false;
     }
     
@@ -51,9 +156,7 @@ bool amos_desktop_init(const amos_desktop_config_t* config) {
     desktop_state.window_system = (amos_window_system_t*)malloc(sizeof(amos_window_system_t));
     if (!desktop_state.window_system) {
         printf("Error: Failed to allocate window system memory\n");
-        amos_fb_cleanup(desktop_state.fb);
-        free(desktop_state.fb);
-        desktop_state.fb = NULL;
+        desktop_init_unwind();
         return false;
     }
     
@@ -61,77 +164,75 @@ bool amos_desktop_init(const amos_desktop_config_t* config) {
         printf("Error: Failed to initialize window system\n");
         free(desktop_state.window_system);
         desktop_state.window_system = NULL;
-        amos_fb_cleanup(desktop_state.fb);
-        free(desktop_state.fb);
-        desktop_state.fb = NULL;
+        desktop_init_unwind();
         return false;
     }
     
+    // Text is optional; without it titles and labels are simply not drawn
+    desktop_state.text = (amos_text_t*)malloc(sizeof(amos_text_t));
+    if (desktop_state.text && amos_text_init(desktop_state.text)) {
+        desktop_state.window_system->text = desktop_state.text;
+        desktop_state.window_system->font_face = amos_text_find_face(config->font_name);
+        desktop_state.window_system->font_size = config->font_size > 0 ? config->font_size : 12;
+    } else {
+        printf("Warning: Failed to allocate text renderer\n");
+        free(desktop_state.text);
+        desktop_state.text = NULL;
+    }
+    
+    amos_frame_stats_reset(&desktop_stats);
+    desktop_state.window_system->stats = &desktop_stats;
+    amos_event_channel_init(&desktop_events);
+    amos_damage_reset(&desktop_damage);
+    amos_damage_reset(&desktop_views_damage);
+    
     // Initialize 3D renderer if enabled
     if (config->enable_3d) {
         desktop_state.renderer = (amos_renderer3d_t*)malloc(sizeof(amos_renderer3d_t));
         if (!desktop_state.renderer) {
             printf("Error: Failed to allocate 3D renderer memory\n");
-            amos_window_system_cleanup(desktop_state.window_system);
-            free(desktop_state.window_system);
-            desktop_state.window_system = NULL;
-            amos_fb_cleanup(desktop_state.fb);
-            free(desktop_state.fb);
-            desktop_state.fb = NULL;
+            desktop_init_unwind();
             return false;
         }
         
-        if (!amos_renderer3d_init(desktop_state.renderer, desktop_state.fb, 
-                                  config->screen_width, config->screen_height)) {
+        if (!amos_renderer3d_init(desktop_state.renderer, config->screen_width, config->screen_height)) {
             printf("Error: Failed to initialize 3D renderer\n");
             free(desktop_state.renderer);
             desktop_state.renderer = NULL;
-            amos_window_system_cleanup(desktop_state.window_system);
-            free(desktop_state.window_system);
-            desktop_state.window_system = NULL;
-            amos_fb_cleanup(desktop_state.fb);
-            free(desktop_state.fb);
-            desktop_state.fb = NULL;
+            desktop_init_unwind();
             return false;
         }
+        
+        // 3D views are optional; windows simply show no 3D content without them
+        desktop_state.views3d = (amos_window3d_system_t*)malloc(sizeof(amos_window3d_system_t));
+        if (desktop_state.views3d) {
+            amos_window3d_system_init(desktop_state.views3d);
+        } else {
+            printf("Warning: Failed to allocate 3D view system\n");
+        }
     }
     
     // Initialize taskbar
     if (!amos_desktop_init_taskbar()) {
         printf("Error: Failed to initialize taskbar\n");
-        if (desktop_state.renderer) {
-            amos_renderer3d_cleanup(desktop_state.renderer);
-            free(desktop_state.renderer);
-            desktop_state.renderer = NULL;
-        }
-        amos_window_system_cleanup(desktop_state.window_system);
-        free(desktop_state.window_system);
-        desktop_state.window_system = NULL;
-        amos_fb_cleanup(desktop_state.fb);
-        free(desktop_state.fb);
-        desktop_state.fb = NULL;
+        desktop_init_unwind();
         return false;
     }
     
     // Initialize desktop icons
     if (!amos_desktop_init_icons()) {
         printf("Error: Failed to initialize desktop icons\n");
-        if (desktop_state.renderer) {
-            amos_renderer3d_cleanup(desktop_state.renderer);
-            free(desktop_state.renderer);
-            desktop_state.renderer = NULL;
-        }
-        amos_window_system_cleanup(desktop_state.window_system);
-        free(desktop_state.window_system);
-        desktop_state.window_system = NULL;
-        amos_fb_cleanup(desktop_state.fb);
-        free(desktop_state.fb);
-        desktop_state.fb = NULL;
+        amos_desktop_cleanup_taskbar();
+        desktop_init_unwind();
         return false;
     }
     
+    amos_cursor_init(&desktop_cursor);
+    amos_cursor_set_visible(&desktop_cursor, true);
+    
     // Set running flag
     desktop_state.running = true;
+    desktop_state.needs_redraw = true;
     
     printf("AMOS Desktop Environment initialized successfully\n");
     return true;
@@ -150,6 +251,13 @@ void amos_desktop_cleanup() {
     // Clean up taskbar
     amos_desktop_cleanup_taskbar();
     
+    // Clean up 3D views
+    if (desktop_state.views3d) {
+        amos_window3d_system_cleanup(desktop_state.views3d);
+        free(desktop_state.views3d);
+        desktop_state.views3d = NULL;
+    }
+    
     // Clean up 3D renderer
     if (desktop_state.renderer) {
         amos_renderer3d_cleanup(desktop_state.renderer);
@@ -159,18 +267,36 @@ void amos_desktop_cleanup() {
     
     // Clean up window system
     if (desktop_state.window_system) {
+        desktop_state.window_system->text = NULL;
         amos_window_system_cleanup(desktop_state.window_system);
         free(desktop_state.window_system);
         desktop_state.window_system = NULL;
     }
     
+    // Clean up text renderer
+    if (desktop_state.text) {
+        amos_text_cleanup(desktop_state.text);
+        free(desktop_state.text);
+        desktop_state.text = NULL;
+    }
+    
     // Clean up framebuffer
     if (desktop_state.fb) {
+#ifdef AMOS_X11
+        if (desktop_x11_active) {
+            amos_frame_scheduler_unwatch_fd(&desktop_scheduler, amos_x11_present_fd(&desktop_x11));
+            amos_x11_present_cleanup(&desktop_x11, desktop_state.fb);
+            desktop_x11_active = false;
+        }
+#endif
         amos_fb_cleanup(desktop_state.fb);
         free(desktop_state.fb);
         desktop_state.fb = NULL;
     }
     
+    amos_frame_scheduler_cleanup(&desktop_scheduler);
+    amos_input_trace_stop(&desktop_trace);
+    
     printf("AMOS Desktop Environment cleanup complete\n");
 }
 
@@ -183,40 +309,65 @@ void amos_desktop_run() {
     
     // Main desktop loop
     while (desktop_state.running) {
+        // Sleep until input, a due frame, the next 3D animation tick or the
+        // next clock minute; without an input descriptor, poll once per refresh
+        int timeout_ms = (int)(60 - time(NULL) % 60) * 1000;
+        if (desktop_scheduler.fd_count == 0) {
+            timeout_ms = (int)(desktop_scheduler.interval_ns / 1000000);
+        }
+        double next_3d = desktop_state.views3d ?
+                         amos_window3d_system_next_due(desktop_state.views3d) : -1.0;
+        if (next_3d >= 0.0) {
+            double until = next_3d - desktop_now_ms();
+            int until_ms = until > 0.0 ? (int)until + 1 : 0;
+            if (until_ms < timeout_ms) {
+                timeout_ms = until_ms;
+            }
+        }
+#ifdef AMOS_X11
+        // Events Xlib already read would not wake the scheduler
+        if (desktop_x11_active && XQLength(desktop_x11.display) > 0) {
+            timeout_ms = 0;
+        }
+#endif
+        amos_frame_scheduler_wait(&desktop_scheduler, timeout_ms);
+        
         // Handle input events from kernel
         amos_desktop_process_events();
         
         // Update desktop state
         amos_desktop_update();
         
-        // Render desktop
-        amos_desktop_render();
+        // Coalesce everything that changed into the next frame; damage
+        // alone, such as an exposed X11 window, only needs presenting
+        if (desktop_state.needs_redraw || desktop_damage.count > 0 || desktop_views_damage.count > 0 ||
+            amos_cursor_needs_present(&desktop_cursor)) {
+            amos_frame_scheduler_request_frame(&desktop_scheduler);
+        }
         
-        // Wait for next frame (would be synchronized with system timer)
-        // For now, just simulate a simple delay
-        amos_desktop_sleep(16);  // ~60 FPS
+        // Render desktop once its refresh slot starts
+        if (amos_frame_scheduler_frame_due(&desktop_scheduler)) {
+            amos_desktop_render();
+            amos_frame_scheduler_frame_done(&desktop_scheduler);
+        }
     }
     
     printf("AMOS Desktop Environment main loop exited\n");
 }
 
-// Process input events from the kernel
-void amos_desktop_process_events() {
-    // In a real implementation, this would read events from a kernel-provided queue
-    // Here we just simulate some basic events for demonstration
-    
-    // Example: process mouse events
-    int mouse_x = 0, mouse_y = 0, mouse_buttons = 0;
-    
-    // Get mouse state from kernel (simulated here)
-    amos_desktop_get_mouse_state(&mouse_x, &mouse_y, &mouse_buttons);
-    
-    // Process mouse movement
-    amos_window_system_handle_mouse_move(desktop_state.window_system, mouse_x, mouse_y);
+// Apply one pointer update from the kernel
+static void desktop_handle_pointer(int mouse_x, int mouse_y, int mouse_buttons) {
+    // Process mouse movement; plain pointer motion only moves the cursor overlay
+    amos_cursor_move(&desktop_cursor, mouse_x, mouse_y);
+    if (amos_window_system_handle_mouse_move(desktop_state.window_system, mouse_x, mouse_y)) {
+        desktop_state.needs_redraw = true;
+    }
     
     // Process mouse buttons
-    static int prev_buttons = 0;
-    int changed_buttons = mouse_buttons ^ prev_buttons;
+    int changed_buttons = mouse_buttons ^ desktop_mouse_buttons;
+    if (changed_buttons) {
+        desktop_state.needs_redraw = true;
+    }
     
     // Check for button down events
     if (changed_buttons & 1 && (mouse_buttons & 1)) {  // Left button down
@@ -240,34 +391,226 @@ void amos_desktop_process_events() {
         amos_window_system_handle_mouse_up(desktop_state.window_system, mouse_x, mouse_y, 2);
     }
     
-    prev_buttons = mouse_buttons;
+    desktop_mouse_x = mouse_x;
+    desktop_mouse_y = mouse_y;
+    desktop_mouse_buttons = mouse_buttons;
+}
+
+#ifdef AMOS_X11
+// Map X's button state to the event channel's mask, which is left,
+// right, middle where X numbers them left, middle, right
+static int desktop_x11_buttons(unsigned int state) {
+    return ((state & Button1Mask) ? 1 : 0) |
+           ((state & Button3Mask) ? 2 : 0) |
+           ((state & Button2Mask) ? 4 : 0);
+}
+
+// Post input from the X11 window to the event channel, as the kernel's
+// interrupt handlers would, so it is traced and replayed the same way
+static void desktop_poll_x11() {
+    while (XPending(desktop_x11.display)) {
+        XEvent event;
+        XNextEvent(desktop_x11.display, &event);
+        if (amos_x11_present_handle_event(&desktop_x11, &event, &desktop_damage)) {
+            continue;
+        }
+        
+        switch (event.type) {
+            case MotionNotify:
+                amos_event_channel_post_mouse(&desktop_events, event.xmotion.x, event.xmotion.y,
+                                              (uint32_t)desktop_x11_buttons(event.xmotion.state));
+                break;
+            case ButtonPress:
+            case ButtonRelease: {
+                // The state is from before the event; events still in the
+                // channel have not reached desktop_mouse_buttons yet
+                int bit = event.xbutton.button == Button1 ? 1 :
+                          event.xbutton.button == Button3 ? 2 :
+                          event.xbutton.button == Button2 ? 4 : 0;
+                int buttons = desktop_x11_buttons(event.xbutton.state);
+                buttons = event.type == ButtonPress ? buttons | bit : buttons & ~bit;
+                amos_event_channel_post_mouse(&desktop_events, event.xbutton.x, event.xbutton.y,
+                                              (uint32_t)buttons);
+                break;
+            }
+            case KeyPress:
+            case KeyRelease:
+                // X keycodes are evdev codes offset by 8
+                amos_event_channel_post_key(&desktop_events, (uint16_t)(event.xkey.keycode - 8),
+                                            event.type == KeyPress);
+                break;
+        }
+    }
     
-    // Example: process keyboard events
-    // ...
+    if (desktop_x11.closed) {
+        desktop_state.running = false;
+    }
+}
+#endif
+
+// Process input events from the kernel
+void amos_desktop_process_events() {
+    uint64_t input_start = amos_frame_stats_now();
+
+#ifdef AMOS_X11
+    if (desktop_x11_active) {
+        desktop_poll_x11();
+    }
+#endif
+    
+    // Take everything the interrupt handlers queued since the last frame
+    static amos_event_t events[AMOS_EVENT_RING_SIZE + 1];
+    int count = amos_event_channel_drain(&desktop_events, events, AMOS_EVENT_RING_SIZE + 1);
+    
+    for (int i = 0; i < count; i++) {
+        const amos_event_t* event = &events[i];
+        amos_input_trace_write(&desktop_trace, event);
+        
+        switch (event->type) {
+            case AMOS_EVENT_MOUSE:
+                desktop_handle_pointer(event->x, event->y, (int)event->value);
+                break;
+            case AMOS_EVENT_KEY:
+                // Keyboard input is not routed to windows yet
+                break;
+            case AMOS_EVENT_TIMER:
+                // The clock and animations are driven by amos_desktop_update
+                break;
+            case AMOS_EVENT_WINDOW:
+                desktop_state.needs_redraw = true;
+                break;
+        }
+    }
+    
+    amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_INPUT, input_start);
 }
 
 // Update desktop state
 void amos_desktop_update() {
-    // Update any active animations, timers, etc.
+    // Redraw 3D windows whose scene changed or whose animation is due;
+    // only their client rects need presenting
+    if (desktop_state.views3d) {
+        amos_window3d_system_update(desktop_state.views3d, desktop_now_ms(), &desktop_views_damage);
+    }
+    
+    // Redraw the taskbar clock when the minute changes
+    long minute = (long)(desktop_clock_time() / 60);
+    if (minute != desktop_clock_minute) {
+        desktop_clock_minute = minute;
+        desktop_state.needs_redraw = true;
+    }
+    
+    // Update any other active animations, timers, etc.
     // ...
 }
 
+// Copy the content of 3D views that rendered to the screen, leaving the
+// rest of the desktop as it is; false if a full recomposite is needed
+static bool desktop_present_views(void) {
+    amos_window3d_system_t* views = desktop_state.views3d;
+    amos_framebuffer_t* fb = desktop_state.fb;
+    
+    // Draw callbacks paint over the content and only run in a full recomposite
+    for (int i = 0; i < views->view_count; i++) {
+        if (views->views[i]->window->draw_callback) {
+            return false;
+        }
+    }
+    
+    amos_cursor_remove(&desktop_cursor, fb, &desktop_damage);
+    
+    // The taskbar is drawn over the windows
+    amos_rect_t work_area = {0, 0, fb->width, fb->height - AMOS_TASKBAR_HEIGHT};
+    for (int i = 0; i < desktop_views_damage.count; i++) {
+        const amos_rect_t* rect = &desktop_views_damage.rects[i];
+        int x0 = rect->x > work_area.x ? rect->x : work_area.x;
+        int y0 = rect->y > work_area.y ? rect->y : work_area.y;
+        int x1 = rect->x + rect->width < work_area.width ? rect->x + rect->width : work_area.width;
+        int y1 = rect->y + rect->height < work_area.height ? rect->y + rect->height : work_area.height;
+        if (x1 <= x0 || y1 <= y0) {
+            continue;
+        }
+        
+        amos_rect_t clip = {x0, y0, x1 - x0, y1 - y0};
+        for (int j = 0; j < views->view_count; j++) {
+            amos_window_system_draw_content(desktop_state.window_system, views->views[j]->window, fb, &clip);
+        }
+        amos_damage_add(&desktop_damage, &clip);
+    }
+    return true;
+}
+
 // Render the desktop environment
 void amos_desktop_render() {
-    // Clear framebuffer with desktop background color
-    amos_fb_clear(desktop_state.fb, desktop_state.config.background_color);
-    
-    // Draw desktop icons
-    amos_desktop_draw_icons(desktop_state.fb);
+    uint64_t render_start = amos_frame_stats_now();
+    uint64_t stage_start = render_start;
+
+#ifdef AMOS_X11
+    // The server may still be reading the last frame from the framebuffer;
+    // paced to the refresh rate, its completion has normally arrived already
+    if (desktop_x11_active) {
+        amos_x11_present_wait(&desktop_x11);
+    }
+#endif
     
-    // Draw all windows
-    amos_window_system_draw(desktop_state.window_system, desktop_state.fb);
+    // A 3D view that rendered a frame only needs its content copied
+    if (!desktop_state.needs_redraw && desktop_views_damage.count > 0) {
+        stage_start = amos_frame_stats_now();
+        if (!desktop_present_views()) {
+            desktop_state.needs_redraw = true;
+        }
+        amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_WINDOWS, stage_start);
+    }
+    amos_damage_reset(&desktop_views_damage);
+    
+    // Recomposite only when windows or the desktop changed; pointer
+    // motion alone is handled by the cursor overlay below
+    if (desktop_state.needs_redraw) {
+        // Clear framebuffer with desktop background color
+        amos_fb_clear(desktop_state.fb, desktop_state.config.background_color);
+        amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_CLEAR, stage_start);
+        
+        // Draw desktop icons
+        stage_start = amos_frame_stats_now();
+        amos_desktop_draw_icons(desktop_state.fb);
+        amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_ICONS, stage_start);
+        
+        // Draw all windows
+        stage_start = amos_frame_stats_now();
+        amos_window_system_draw(desktop_state.window_system, desktop_state.fb);
+        amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_WINDOWS, stage_start);
+        
+        // Draw taskbar
+        stage_start = amos_frame_stats_now();
+        amos_desktop_draw_taskbar(desktop_state.fb);
+        amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_TASKBAR, stage_start);
+        
+        amos_rect_t screen = {0, 0, desktop_state.config.screen_width, desktop_state.config.screen_height};
+        amos_damage_add(&desktop_damage, &screen);
+        amos_cursor_invalidate(&desktop_cursor);
+        desktop_state.needs_redraw = false;
+    }
     
-    // Draw taskbar
-    amos_desktop_draw_taskbar(desktop_state.fb);
+    // Restore the pixels under the old cursor position and draw the new one
+    stage_start = amos_frame_stats_now();
+    amos_cursor_present(&desktop_cursor, desktop_state.fb, &desktop_damage);
+    amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_CURSOR, stage_start);
+    
+    // Flush the damaged regions to screen
+    uint64_t damaged_pixels = 0;
+    if (desktop_damage.count > 0) {
+        stage_start = amos_frame_stats_now();
+        amos_desktop_flush_framebuffer();
+        amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_FLUSH, stage_start);
+        
+        for (int i = 0; i < desktop_damage.count; i++) {
+            damaged_pixels += (uint64_t)desktop_damage.rects[i].width * desktop_damage.rects[i].height;
+        }
+    }
+    amos_damage_reset(&desktop_damage);
     
-    // Flush framebuffer to screen
-    amos_desktop_flush_framebuffer();
+    amos_frame_stats_record(&desktop_stats, AMOS_FRAME_STAGE_TOTAL, render_start);
+    amos_frame_stats_end_frame(&desktop_stats, damaged_pixels);
 }
 
 // Create default desktop applications
@@ -360,6 +703,19 @@ void amos_desktop_cleanup_taskbar() {
     // In a real implementation, this would clean up taskbar resources
 }
 
+// Draw a label centred in a rectangle, clipped to it
+static void desktop_draw_label(amos_framebuffer_t* fb, const amos_rect_t* rect, const char* label, amos_color_t color) {
+    if (!desktop_state.text) {
+        return;
+    }
+    
+    amos_font_face_t face = desktop_state.window_system->font_face;
+    int size = desktop_state.window_system->font_size;
+    int width = amos_text_measure(desktop_state.text, face, size, label);
+    int x = width < rect->width ? rect->x + (rect->width - width) / 2 : rect->x;
+    amos_text_draw(desktop_state.text, fb, face, size, label, x, rect->y + (rect->height - size) / 2, color, rect);
+}
+
 // Draw the desktop taskbar
 void amos_desktop_draw_taskbar(amos_framebuffer_t* fb) {
     if (!fb) {
@@ -385,6 +741,7 @@ void amos_desktop_draw_taskbar(amos_framebuffer_t* fb) {
     };
     
     amos_fb_fill_rect(fb, &start_button_rect, amos_color_rgb(0, 123, 255));  // Blue
+    desktop_draw_label(fb, &start_button_rect, "AMOS", amos_color_rgb(255, 255, 255));
     
     // Draw window buttons for each open window
     int button_x = 50;
@@ -409,6 +766,14 @@ void amos_desktop_draw_taskbar(amos_framebuffer_t* fb) {
         
         amos_fb_fill_rect(fb, &window_button_rect, button_color);
         
+        amos_rect_t label_rect = {
+            window_button_rect.x + 6,
+            window_button_rect.y,
+            window_button_rect.width - 12,
+            window_button_rect.height
+        };
+        desktop_draw_label(fb, &label_rect, window->title, amos_color_rgb(255, 255, 255));
+        
         button_x += 125;  // Move to next button position
     }
     
@@ -424,7 +789,13 @@ void amos_desktop_draw_taskbar(amos_framebuffer_t* fb) {
     amos_fb_fill_rect(fb, &tray_rect, amos_color_rgb(52, 58, 64));  // Dark gray
     
     // Draw clock
-    // ...
+    char clock_text[16];
+    // Trace time starts at midnight UTC, whatever the host's time zone
+    time_t now = desktop_clock_time();
+    struct tm* local = desktop_clock_pinned ? gmtime(&now) : localtime(&now);
+    if (local && strftime(clock_text, sizeof(clock_text), "%H:%M", local) > 0) {
+        desktop_draw_label(fb, &tray_rect, clock_text, amos_color_rgb(255, 255, 255));
+    }
 }
 
 // Initialize desktop icons
@@ -462,49 +833,181 @@ void amos_desktop_draw_icons(amos_framebuffer_t* fb) {
     // Draw Terminal icon
     amos_rect_t terminal_icon_rect = {x, y, icon_size, icon_size};
     amos_fb_fill_rect(fb, &terminal_icon_rect, amos_color_rgb(0, 0, 0));  // Black
+    amos_rect_t terminal_label_rect = {x - icon_spacing / 2, y + icon_size, icon_size + icon_spacing, total_height - icon_size};
+    desktop_draw_label(fb, &terminal_label_rect, "Terminal", amos_color_rgb(255, 255, 255));
     
     // Draw File Manager icon
     x += icon_size + icon_spacing;
     amos_rect_t file_manager_icon_rect = {x, y, icon_size, icon_size};
     amos_fb_fill_rect(fb, &file_manager_icon_rect, amos_color_rgb(52, 58, 64));  // Dark gray
+    amos_rect_t file_manager_label_rect = {x - icon_spacing / 2, y + icon_size, icon_size + icon_spacing, total_height - icon_size};
+    desktop_draw_label(fb, &file_manager_label_rect, "Files", amos_color_rgb(255, 255, 255));
     
     // Draw Web Browser icon (if enabled)
     if (desktop_state.config.enable_browser) {
         x += icon_size + icon_spacing;
         amos_rect_t browser_icon_rect = {x, y, icon_size, icon_size};
         amos_fb_fill_rect(fb, &browser_icon_rect, amos_color_rgb(0, 123, 255));  // Blue
+        amos_rect_t browser_label_rect = {x - icon_spacing / 2, y + icon_size, icon_size + icon_spacing, total_height - icon_size};
+        desktop_draw_label(fb, &browser_label_rect, "Browser", amos_color_rgb(255, 255, 255));
     }
     
     // Draw Settings icon
     x += icon_size + icon_spacing;
     amos_rect_t settings_icon_rect = {x, y, icon_size, icon_size};
     amos_fb_fill_rect(fb, &settings_icon_rect, amos_color_rgb(255, 193, 7));  // Yellow
-    
-    // In a real implementation, icon text would be rendered here
+    amos_rect_t settings_label_rect = {x - icon_spacing / 2, y + icon_size, icon_size + icon_spacing, total_height - icon_size};
+    desktop_draw_label(fb, &settings_label_rect, "Settings", amos_color_rgb(255, 255, 255));
 }
 
 // Flush framebuffer to screen
 void amos_desktop_flush_framebuffer() {
-    // In a real implementation, this would copy the framebuffer to the screen
-    // or signal the kernel to do so
+#ifdef AMOS_X11
+    if (desktop_x11_active) {
+        amos_x11_present_damage(&desktop_x11, &desktop_damage);
+        return;
+    }
+#endif
+    
+    // In a real implementation, this would copy the rectangles in
+    // desktop_damage to the screen or signal the kernel to do so
     // ...
 }
 
 // Get mouse state from kernel
 void amos_desktop_get_mouse_state(int* x, int* y, int* buttons) {
-    // In a real implementation, this would get mouse state from the kernel
-    // For now, just simulate static position and no buttons
-    if (x) *x = 400;
-    if (y) *y = 300;
-    if (buttons) *buttons = 0;
+    // State as of the last batch drained from the event channel
+    if (x) *x = desktop_mouse_x;
+    if (y) *y = desktop_mouse_y;
+    if (buttons) *buttons = desktop_mouse_buttons;
+}
+
+// Channel kernel interrupt handlers post input to
+amos_event_channel_t* amos_desktop_get_event_channel() {
+    return &desktop_events;
+}
+
+// Restart the 3D animation clocks from a new time
+static void desktop_restart_animations(double now_ms) {
+    if (!desktop_state.views3d) {
+        return;
+    }
+    
+    for (int i = 0; i < desktop_state.views3d->view_count; i++) {
+        amos_window3d_t* view = desktop_state.views3d->views[i];
+        if (view->frame_interval_ms > 0.0) {
+            amos_window3d_set_animation(view, view->frame_interval_ms, now_ms);
+        }
+    }
+}
+
+// One replayed frame: the body of the main loop without the wait
+static void desktop_replay_frame(void* user_data, double time_ms) {
+    (void)user_data;
+    
+    desktop_pinned_ms = time_ms;
+    amos_desktop_process_events();
+    amos_desktop_update();
+    if (desktop_state.needs_redraw || desktop_damage.count > 0 || desktop_views_damage.count > 0 ||
+        amos_cursor_needs_present(&desktop_cursor)) {
+        amos_desktop_render();
+    }
+}
+
+// Replay a recorded input trace and report frame timing
+bool amos_desktop_replay_trace(const char* path, bool max_speed) {
+    amos_input_trace_t trace;
+    if (!amos_input_trace_load(&trace, path)) {
+        return false;
+    }
+    
+    if (trace.width != desktop_state.config.screen_width ||
+        trace.height != desktop_state.config.screen_height) {
+        printf("Warning: Trace was recorded at %dx%d, screen is %dx%d\n",
+               trace.width, trace.height,
+               desktop_state.config.screen_width, desktop_state.config.screen_height);
+    }
+    
+    // Start from a full frame at trace time zero
+    desktop_clock_pinned = true;
+    desktop_pinned_ms = 0.0;
+    desktop_restart_animations(0.0);
+    desktop_state.needs_redraw = true;
+    
+    amos_frame_stats_reset(&desktop_stats);
+    uint64_t start = amos_frame_stats_now();
+    int frames = amos_input_trace_replay(&trace, &desktop_events, 1000.0 / 60.0, max_speed,
+                                         desktop_replay_frame, NULL);
+    double elapsed = (double)(amos_frame_stats_now() - start) / 1000000.0;
+    
+    static char report[8192];
+    amos_frame_stats_format(&desktop_stats, "frame", report, sizeof(report));
+    
+    // Which frames rendered a 3D view depends on the replay speed; render
+    // every view at the final trace time so the last frame does not
+    if (desktop_state.views3d) {
+        for (int i = 0; i < desktop_state.views3d->view_count; i++) {
+            amos_window3d_invalidate(desktop_state.views3d->views[i]);
+        }
+        desktop_replay_frame(NULL, desktop_pinned_ms);
+    }
+    
+    printf("Replayed %zu events in %d frames (%.1f ms)\n%s", trace.count, frames, elapsed, report);
+    printf("Framebuffer hash: %016llx\n", (unsigned long long)amos_fb_hash(desktop_state.fb));
+    
+    desktop_clock_pinned = false;
+    desktop_restart_animations(desktop_now_ms());
+    desktop_state.needs_redraw = true;
+    
+    amos_input_trace_free(&trace);
+    return true;
 }
 
 // Sleep for specified milliseconds
 void amos_desktop_sleep(int ms) {
-    // In a real implementation, this would use a kernel-provided sleep function
-    // For now, just simulate no delay (immediate return)
+    if (ms <= 0) {
+        return;
+    }
+    
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+        // Interrupted by a signal; sleep for the remainder
+    }
+}
+
+// Wake the main loop when a kernel input descriptor becomes readable
+bool amos_desktop_watch_input_fd(int fd) {
+    return amos_frame_scheduler_watch_fd(&desktop_scheduler, fd);
 }
 
+#ifdef AMOS_X11
+// Show the desktop in an X11 window instead of the kernel framebuffer
+bool amos_desktop_present_x11(const char* display_name) {
+    if (!desktop_state.fb || desktop_x11_active) {
+        return false;
+    }
+    
+    // Render straight into memory the X server reads from
+    int width = desktop_state.config.screen_width;
+    int height = desktop_state.config.screen_height;
+    amos_fb_cleanup(desktop_state.fb);
+    if (!amos_x11_present_init(&desktop_x11, desktop_state.fb, display_name,
+                               width, height, "AMOS Desktop")) {
+        if (!amos_fb_init(desktop_state.fb, width, height, 4)) {
+            printf("Error: Failed to reinitialize framebuffer\n");
+        }
+        return false;
+    }
+    desktop_x11_active = true;
+    amos_frame_scheduler_watch_fd(&desktop_scheduler, amos_x11_present_fd(&desktop_x11));
+    
+    // The host draws the pointer over the window
+    amos_cursor_set_visible(&desktop_cursor, false);
+    desktop_state.needs_redraw = true;
+    return true;
+}
+#endif
+
 // Get desktop environment state
 amos_desktop_state_t* amos_desktop_get_state() {
     return &desktop_state;
@@ -550,6 +1053,32 @@ bool amos_desktop_controller_handle_command(const char* command) {
         // Launch application
         const char* app_name = command + 7;
         return amos_desktop_launch_application(app_name);
+    } else if (strncmp(command, "trace record:", 13) == 0) {
+        // Record drained input to a trace file
+        amos_input_trace_stop(&desktop_trace);
+        return amos_input_trace_start(&desktop_trace, command + 13,
+                                      desktop_state.config.screen_width,
+                                      desktop_state.config.screen_height);
+    } else if (strcmp(command, "trace stop") == 0) {
+        return amos_input_trace_stop(&desktop_trace);
+    } else if (strncmp(command, "trace replay:", 13) == 0) {
+        // Replay in real time
+        return amos_desktop_replay_trace(command + 13, false);
+    } else if (strncmp(command, "trace replay-fast:", 18) == 0) {
+        // Replay with frames back to back
+        return amos_desktop_replay_trace(command + 18, true);
+    } else if (strcmp(command, "stats reset") == 0) {
+        // Start a new measurement window
+        amos_frame_stats_reset(&desktop_stats);
+        return true;
+    } else if (strncmp(command, "stats ", 6) == 0) {
+        // Print frame timing: "stats frame" or "stats windows"
+        static char report[8192];
+        if (!amos_frame_stats_format(&desktop_stats, command + 6, report, sizeof(report))) {
+            return false;
+        }
+        printf("%s", report);
+        return true;
     }
     
     return false;
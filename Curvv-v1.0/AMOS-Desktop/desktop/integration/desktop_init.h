@@ -15,6 +15,9 @@ typedef struct amos_framebuffer_t amos_framebuffer_t;
 typedef struct amos_window_system_t amos_window_system_t;
 typedef struct amos_renderer3d_t amos_renderer3d_t;
 typedef struct amos_window_t amos_window_t;
+typedef struct amos_window3d_system_t amos_window3d_system_t;
+typedef struct amos_text_t amos_text_t;
+typedef struct amos_event_channel_t amos_event_channel_t;
 
 // Taskbar height
 #define AMOS_TASKBAR_HEIGHT 35
@@ -41,8 +44,11 @@ typedef struct {
     amos_framebuffer_t* fb;           // System framebuffer
     amos_window_system_t* window_system;  // Window management system
     amos_renderer3d_t* renderer;      // 3D renderer (optional)
+    amos_window3d_system_t* views3d;  // 3D scenes shown in windows (optional)
+    amos_text_t* text;                // Glyph and layout caches for all desktop text
     amos_window_t* controller;        // Desktop controller window
     bool running;                     // Whether the desktop is running
+    bool needs_redraw;                // Whether the screen must be recomposited
 } amos_desktop_state_t;
 
 /**
@@ -135,6 +141,28 @@ void amos_desktop_flush_framebuffer();
  */
 void amos_desktop_get_mouse_state(int* x, int* y, int* buttons);
 
+/**
+ * Get the channel kernel interrupt handlers post input to
+ * 
+ * @return Pointer to the desktop's event channel
+ */
+amos_event_channel_t* amos_desktop_get_event_channel();
+
+/**
+ * Replay a recorded input trace and report frame timing
+ * 
+ * Prints the "stats frame" report and a hash of the final framebuffer,
+ * so scripted runs can compare both against a baseline. Until it
+ * returns, 3D animation and the taskbar clock follow trace time from
+ * zero instead of the host clocks, so the hash depends only on the
+ * desktop's state and the trace, not on when or how fast it ran.
+ * 
+ * @param path Trace file recorded with "trace record:<path>"
+ * @param max_speed Run frames back to back instead of in real time
+ * @return true if the trace was replayed, false otherwise
+ */
+bool amos_desktop_replay_trace(const char* path, bool max_speed);
+
 /**
  * Sleep for specified milliseconds
  * 
@@ -142,6 +170,30 @@ void amos_desktop_get_mouse_state(int* x, int* y, int* buttons);
  */
 void amos_desktop_sleep(int ms);
 
+/**
+ * Wake the main loop when a kernel input descriptor becomes readable
+ * 
+ * Without a registered descriptor the loop polls input once per refresh.
+ * 
+ * @param fd Readable descriptor delivering input events
+ * @return true if the descriptor is now watched, false otherwise
+ */
+bool amos_desktop_watch_input_fd(int fd);
+
+#ifdef AMOS_X11
+/**
+ * Show the desktop in an X11 window instead of the kernel framebuffer
+ * 
+ * The framebuffer is moved into shared memory the X server presents
+ * from, and input from the window is posted to the event channel.
+ * Call after amos_desktop_init.
+ * 
+ * @param display_name X display to open, or NULL for $DISPLAY
+ * @return true if the desktop is now presented in X11, false otherwise
+ */
+bool amos_desktop_present_x11(const char* display_name);
+#endif
+
 /**
  * Get desktop environment state
  * 
@@ -157,6 +209,11 @@ void amos_desktop_create_controller();
 /**
  * Handle desktop controller commands
  * 
+ * "stats frame" and "stats windows" print stage and per-window timing
+ * percentiles; "stats reset" clears them. "trace record:<path>" and
+ * "trace stop" record input; "trace replay:<path>" and
+ * "trace replay-fast:<path>" replay it.
+ * 
  * @param command Command string
  * @return true if command was handled, false otherwise
  */
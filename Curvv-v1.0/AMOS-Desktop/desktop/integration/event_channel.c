@@ -0,0 +1,154 @@
+/**
+ * AMOS Desktop OS - Kernel to Desktop Event Channel Implementation
+ *
+ * This file implements the event ring and the pointer register. The
+ * ring publishes records with a release store of head and frees them
+ * with a release store of tail. The pointer register is a sequence
+ * lock: the counter is odd while the producer writes, and the consumer
+ * retries a read that overlapped a write.
+ */
+
+#include "event_channel.h"
+
+#define RING_MASK (AMOS_EVENT_RING_SIZE - 1)
+
+// Attempts to read a consistent pointer state before leaving it for the next drain
+#define MOUSE_READ_RETRIES 4
+
+// Initialize an empty channel
+void amos_event_channel_init(amos_event_channel_t* channel) {
+    if (!channel) {
+        return;
+    }
+
+    // Cleared field by field so the kernel side needs no libc
+    channel->head = 0;
+    channel->tail = 0;
+    channel->mouse_seq = 0;
+    channel->mouse_x = 0;
+    channel->mouse_y = 0;
+    channel->mouse_buttons = 0;
+    channel->last_buttons = 0;
+    channel->dropped = 0;
+    channel->coalesced = 0;
+    channel->consumed_mouse_seq = 0;
+}
+
+// Queue an event (producer side, never blocks)
+bool amos_event_channel_push(amos_event_channel_t* channel, const amos_event_t* event) {
+    uint32_t head = __atomic_load_n(&channel->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&channel->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail >= AMOS_EVENT_RING_SIZE) {
+        channel->dropped++;
+        return false;
+    }
+
+    channel->events[head & RING_MASK] = *event;
+    __atomic_store_n(&channel->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Queue a key press or release
+bool amos_event_channel_post_key(amos_event_channel_t* channel, uint16_t scancode, bool pressed) {
+    amos_event_t event = {AMOS_EVENT_KEY, scancode, 0, 0, pressed ? 1u : 0u};
+    return amos_event_channel_push(channel, &event);
+}
+
+// Report the pointer state
+bool amos_event_channel_post_mouse(amos_event_channel_t* channel, int32_t x, int32_t y, uint32_t buttons) {
+    // Overwrite the position register; an unread update is simply replaced
+    uint32_t seq = __atomic_load_n(&channel->mouse_seq, __ATOMIC_RELAXED);
+    if (seq != __atomic_load_n(&channel->consumed_mouse_seq, __ATOMIC_RELAXED)) {
+        channel->coalesced++;
+    }
+
+    __atomic_store_n(&channel->mouse_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&channel->mouse_x, x, __ATOMIC_RELAXED);
+    __atomic_store_n(&channel->mouse_y, y, __ATOMIC_RELAXED);
+    __atomic_store_n(&channel->mouse_buttons, buttons, __ATOMIC_RELAXED);
+    __atomic_store_n(&channel->mouse_seq, seq + 2, __ATOMIC_RELEASE);
+
+    // Button changes must not be lost to coalescing, so they are also
+    // queued; queuing after the register update keeps them in order
+    // with the coalesced motion (see snapshot)
+    if (buttons == channel->last_buttons) {
+        return true;
+    }
+
+    amos_event_t event = {AMOS_EVENT_MOUSE, 0, x, y, buttons};
+    if (!amos_event_channel_push(channel, &event)) {
+        return false;
+    }
+    channel->last_buttons = buttons;
+    return true;
+}
+
+// Queue a timer tick
+bool amos_event_channel_post_timer(amos_event_channel_t* channel, uint32_t tick) {
+    amos_event_t event = {AMOS_EVENT_TIMER, 0, 0, 0, tick};
+    return amos_event_channel_push(channel, &event);
+}
+
+// Snapshot the ring head together with a consistent pointer state
+//
+// The producer updates the register before queuing a button change, so
+// a head read while the register is unchanged covers every queued event
+// whose position is at or before the register's, and the motion event
+// can safely go after them.
+static uint32_t snapshot(amos_event_channel_t* channel, amos_event_t* mouse, uint32_t* mouse_seq) {
+    for (int attempt = 0; attempt < MOUSE_READ_RETRIES; attempt++) {
+        uint32_t seq = __atomic_load_n(&channel->mouse_seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;   // Write in progress
+        }
+
+        uint32_t head = __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE);
+        mouse->type = AMOS_EVENT_MOUSE;
+        mouse->code = 0;
+        mouse->x = __atomic_load_n(&channel->mouse_x, __ATOMIC_RELAXED);
+        mouse->y = __atomic_load_n(&channel->mouse_y, __ATOMIC_RELAXED);
+        mouse->value = __atomic_load_n(&channel->mouse_buttons, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&channel->mouse_seq, __ATOMIC_RELAXED) == seq) {
+            *mouse_seq = seq;
+            return head;
+        }
+    }
+
+    // Still being written; the next drain picks the motion up
+    *mouse_seq = channel->consumed_mouse_seq;
+    return __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE);
+}
+
+// Take every queued event in one batch
+int amos_event_channel_drain(amos_event_channel_t* channel, amos_event_t* events, int max_events) {
+    if (!channel || !events || max_events <= 0) {
+        return 0;
+    }
+
+    amos_event_t mouse;
+    uint32_t mouse_seq;
+    uint32_t tail = __atomic_load_n(&channel->tail, __ATOMIC_RELAXED);
+    uint32_t head = snapshot(channel, &mouse, &mouse_seq);
+    bool mouse_valid = mouse_seq != channel->consumed_mouse_seq;
+
+    uint32_t available = head - tail;
+    uint32_t count = available < (uint32_t)max_events ? available : (uint32_t)max_events;
+
+    for (uint32_t i = 0; i < count; i++) {
+        events[i] = channel->events[(tail + i) & RING_MASK];
+    }
+    __atomic_store_n(&channel->tail, tail + count, __ATOMIC_RELEASE);
+
+    int written = (int)count;
+    // The motion goes after every older queued event; if they did not all
+    // fit, or fill the batch, it is reported after them next time
+    if (mouse_valid && count == available && written < max_events) {
+        events[written++] = mouse;
+        __atomic_store_n(&channel->consumed_mouse_seq, mouse_seq, __ATOMIC_RELAXED);
+    }
+    return written;
+}
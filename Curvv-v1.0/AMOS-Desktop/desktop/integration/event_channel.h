@@ -0,0 +1,130 @@
+/**
+ * AMOS Desktop OS - Kernel to Desktop Event Channel
+ *
+ * This file defines the channel interrupt handlers use to hand input to
+ * the desktop loop. Key, button, timer and window events go through a
+ * single-producer/single-consumer ring of fixed-size records; the
+ * producer never blocks and drops events when the ring is full. Pointer
+ * motion bypasses the ring: the producer overwrites a single position
+ * register, so any number of motion interrupts between two frames
+ * arrive as one motion event. The desktop drains everything in one
+ * batch per frame.
+ *
+ * Only compiler atomics are used, so the producer side is safe to call
+ * from interrupt context in the freestanding kernel.
+ */
+
+#ifndef AMOS_EVENT_CHANNEL_H
+#define AMOS_EVENT_CHANNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Ring capacity in events (power of two)
+#define AMOS_EVENT_RING_SIZE 256
+
+// Event types
+typedef enum {
+    AMOS_EVENT_KEY = 1,         // code = scancode, value = 1 pressed / 0 released
+    AMOS_EVENT_MOUSE,           // x, y = pointer position, value = button mask
+    AMOS_EVENT_TIMER,           // value = tick count
+    AMOS_EVENT_WINDOW           // code = window ID, value = request
+} amos_event_type_t;
+
+// Fixed-size event record
+typedef struct {
+    uint16_t type;              // amos_event_type_t
+    uint16_t code;
+    int32_t x;
+    int32_t y;
+    uint32_t value;
+} amos_event_t;
+
+// Channel between one producer (interrupt side) and one consumer (desktop loop)
+typedef struct amos_event_channel_t {
+    amos_event_t events[AMOS_EVENT_RING_SIZE];
+
+    // Ring indices on separate cache lines; head is written by the
+    // producer only, tail by the consumer only
+    uint32_t head __attribute__((aligned(64)));
+    uint32_t tail __attribute__((aligned(64)));
+
+    // Latest pointer state, published with a sequence counter
+    uint32_t mouse_seq __attribute__((aligned(64)));
+    int32_t mouse_x;
+    int32_t mouse_y;
+    uint32_t mouse_buttons;
+
+    // Producer-private state
+    uint32_t last_buttons __attribute__((aligned(64)));
+    uint32_t dropped;           // Events lost to a full ring
+    uint32_t coalesced;         // Motion updates merged into a later one
+
+    // Consumer-private state
+    uint32_t consumed_mouse_seq __attribute__((aligned(64)));
+} amos_event_channel_t;
+
+/**
+ * Initialize an empty channel
+ *
+ * @param channel Pointer to channel structure
+ */
+void amos_event_channel_init(amos_event_channel_t* channel);
+
+/**
+ * Queue an event (producer side, never blocks)
+ *
+ * @param channel Pointer to channel structure
+ * @param event Event to queue
+ * @return true if queued, false if the ring was full and the event was dropped
+ */
+bool amos_event_channel_push(amos_event_channel_t* channel, const amos_event_t* event);
+
+/**
+ * Queue a key press or release (producer side)
+ *
+ * @param channel Pointer to channel structure
+ * @param scancode Key scancode
+ * @param pressed Whether the key went down
+ * @return true if queued, false if dropped
+ */
+bool amos_event_channel_post_key(amos_event_channel_t* channel, uint16_t scancode, bool pressed);
+
+/**
+ * Report the pointer state (producer side)
+ *
+ * Motion only updates the position register and is coalesced; a
+ * change in the button mask is also queued in order with other events.
+ *
+ * @param channel Pointer to channel structure
+ * @param x Pointer X in screen coordinates
+ * @param y Pointer Y in screen coordinates
+ * @param buttons Button mask (bit 0 left, bit 1 right, bit 2 middle)
+ * @return true unless a button change had to be dropped
+ */
+bool amos_event_channel_post_mouse(amos_event_channel_t* channel, int32_t x, int32_t y, uint32_t buttons);
+
+/**
+ * Queue a timer tick (producer side)
+ *
+ * @param channel Pointer to channel structure
+ * @param tick Current tick count
+ * @return true if queued, false if dropped
+ */
+bool amos_event_channel_post_timer(amos_event_channel_t* channel, uint32_t tick);
+
+/**
+ * Take every queued event in one batch (consumer side)
+ *
+ * Pending pointer motion is returned last as a single AMOS_EVENT_MOUSE
+ * with the latest position. If queued events fill the batch first, the
+ * motion follows them on a later drain.
+ *
+ * @param channel Pointer to channel structure
+ * @param events Destination array
+ * @param max_events Capacity of events (at least 1)
+ * @return Number of events written
+ */
+int amos_event_channel_drain(amos_event_channel_t* channel, amos_event_t* events, int max_events);
+
+#endif /* AMOS_EVENT_CHANNEL_H */
@@ -0,0 +1,269 @@
+/**
+ * AMOS Desktop OS - Input Trace Implementation
+ *
+ * This file implements trace files and replay. Records are packed
+ * field by field so the format does not depend on structure padding or
+ * host byte order.
+ */
+
+#include "input_trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HEADER_SIZE 16
+#define RECORD_SIZE 20
+
+// Monotonic time in microseconds
+static uint64_t trace_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000ull;
+}
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Write the file header
+static bool write_header(FILE* file, int width, int height) {
+    uint8_t header[HEADER_SIZE];
+    put_u32(header, AMOS_INPUT_TRACE_MAGIC);
+    put_u32(header + 4, AMOS_INPUT_TRACE_VERSION);
+    put_u32(header + 8, (uint32_t)width);
+    put_u32(header + 12, (uint32_t)height);
+    return fwrite(header, HEADER_SIZE, 1, file) == 1;
+}
+
+// Write one record
+static bool write_record(FILE* file, const amos_input_record_t* record) {
+    uint8_t data[RECORD_SIZE];
+    put_u32(data, record->time_us);
+    put_u16(data + 4, record->event.type);
+    put_u16(data + 6, record->event.code);
+    put_u32(data + 8, (uint32_t)record->event.x);
+    put_u32(data + 12, (uint32_t)record->event.y);
+    put_u32(data + 16, record->event.value);
+    return fwrite(data, RECORD_SIZE, 1, file) == 1;
+}
+
+// Start recording to a file
+bool amos_input_trace_start(amos_input_trace_t* trace, const char* path, int width, int height) {
+    if (!trace || !path) {
+        return false;
+    }
+
+    memset(trace, 0, sizeof(*trace));
+    trace->file = fopen(path, "wb");
+    if (!trace->file) {
+        printf("Error: Cannot create input trace %s\n", path);
+        return false;
+    }
+
+    if (!write_header(trace->file, width, height)) {
+        printf("Error: Cannot write input trace %s\n", path);
+        fclose(trace->file);
+        trace->file = NULL;
+        return false;
+    }
+
+    trace->width = width;
+    trace->height = height;
+    trace->start_us = trace_now_us();
+    return true;
+}
+
+// Append an event to the trace being recorded
+void amos_input_trace_write(amos_input_trace_t* trace, const amos_event_t* event) {
+    if (!trace || !trace->file || !event) {
+        return;
+    }
+
+    amos_input_record_t record;
+    record.time_us = (uint32_t)(trace_now_us() - trace->start_us);
+    record.event = *event;
+    write_record(trace->file, &record);
+    trace->count++;
+}
+
+// Check whether a trace is being recorded
+bool amos_input_trace_recording(const amos_input_trace_t* trace) {
+    return trace && trace->file;
+}
+
+// Finish recording and close the file
+bool amos_input_trace_stop(amos_input_trace_t* trace) {
+    if (!trace || !trace->file) {
+        return false;
+    }
+
+    bool ok = !ferror(trace->file);
+    ok = fclose(trace->file) == 0 && ok;
+    trace->file = NULL;
+    return ok;
+}
+
+// Load a recorded trace for replay
+bool amos_input_trace_load(amos_input_trace_t* trace, const char* path) {
+    if (!trace || !path) {
+        return false;
+    }
+
+    memset(trace, 0, sizeof(*trace));
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("Error: Cannot open input trace %s\n", path);
+        return false;
+    }
+
+    uint8_t header[HEADER_SIZE];
+    if (fread(header, HEADER_SIZE, 1, file) != 1 ||
+        get_u32(header) != AMOS_INPUT_TRACE_MAGIC ||
+        get_u32(header + 4) != AMOS_INPUT_TRACE_VERSION) {
+        printf("Error: %s is not an input trace\n", path);
+        fclose(file);
+        return false;
+    }
+    trace->width = (int)get_u32(header + 8);
+    trace->height = (int)get_u32(header + 12);
+
+    // Size the record array from the file length
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, HEADER_SIZE, SEEK_SET);
+    size_t capacity = length > HEADER_SIZE ? (size_t)(length - HEADER_SIZE) / RECORD_SIZE : 0;
+
+    if (capacity > 0) {
+        trace->records = (amos_input_record_t*)malloc(capacity * sizeof(amos_input_record_t));
+        if (!trace->records) {
+            printf("Error: Failed to allocate input trace records\n");
+            fclose(file);
+            return false;
+        }
+    }
+
+    uint8_t data[RECORD_SIZE];
+    while (trace->count < capacity && fread(data, RECORD_SIZE, 1, file) == 1) {
+        amos_input_record_t* record = &trace->records[trace->count++];
+        record->time_us = get_u32(data);
+        record->event.type = get_u16(data + 4);
+        record->event.code = get_u16(data + 6);
+        record->event.x = (int32_t)get_u32(data + 8);
+        record->event.y = (int32_t)get_u32(data + 12);
+        record->event.value = get_u32(data + 16);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Save in-memory records as a trace file
+bool amos_input_trace_save(const amos_input_trace_t* trace, const char* path) {
+    if (!trace || !path) {
+        return false;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("Error: Cannot create input trace %s\n", path);
+        return false;
+    }
+
+    bool ok = write_header(file, trace->width, trace->height);
+    for (size_t i = 0; ok && i < trace->count; i++) {
+        ok = write_record(file, &trace->records[i]);
+    }
+    ok = fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Release loaded records
+void amos_input_trace_free(amos_input_trace_t* trace) {
+    if (!trace) {
+        return;
+    }
+
+    if (trace->file) {
+        amos_input_trace_stop(trace);
+    }
+    free(trace->records);
+    trace->records = NULL;
+    trace->count = 0;
+}
+
+// Post one record the way an interrupt handler would
+static bool post_record(amos_event_channel_t* channel, const amos_event_t* event) {
+    if (event->type == AMOS_EVENT_MOUSE) {
+        return amos_event_channel_post_mouse(channel, event->x, event->y, event->value);
+    }
+    return amos_event_channel_push(channel, event);
+}
+
+// Replay a loaded trace
+int amos_input_trace_replay(
+    const amos_input_trace_t* trace,
+    amos_event_channel_t* channel,
+    double frame_ms,
+    bool max_speed,
+    amos_input_frame_fn frame,
+    void* user_data
+) {
+    if (!trace || !channel || !frame || frame_ms <= 0.0) {
+        return 0;
+    }
+
+    uint64_t frame_us = (uint64_t)(frame_ms * 1000.0);
+    uint64_t start_us = trace_now_us();
+    uint64_t frame_end_us = frame_us;
+    int frames = 0;
+    size_t next = 0;
+
+    while (next < trace->count) {
+        // Post everything that happened during this frame interval
+        while (next < trace->count && trace->records[next].time_us < frame_end_us) {
+            if (!post_record(channel, &trace->records[next].event)) {
+                // Ring full: let the desktop drain it, as it would live
+                frame(user_data, frame_end_us / 1000.0);
+                frames++;
+                continue;
+            }
+            next++;
+        }
+
+        if (!max_speed) {
+            uint64_t now = trace_now_us() - start_us;
+            if (now < frame_end_us) {
+                uint64_t wait = frame_end_us - now;
+                struct timespec ts = {(time_t)(wait / 1000000ull), (long)(wait % 1000000ull) * 1000L};
+                nanosleep(&ts, NULL);
+            }
+        }
+
+        frame(user_data, frame_end_us / 1000.0);
+        frames++;
+        frame_end_us += frame_us;
+
+        // Flat out, idle stretches of the trace are skipped
+        if (max_speed && next < trace->count && trace->records[next].time_us >= frame_end_us) {
+            frame_end_us = (trace->records[next].time_us / frame_us + 1) * frame_us;
+        }
+    }
+
+    return frames;
+}
@@ -0,0 +1,132 @@
+/**
+ * AMOS Desktop OS - Input Trace Recording and Replay
+ *
+ * This file defines a compact binary trace of desktop input so that
+ * interactive performance problems (dragging, resizing, tab switching)
+ * can be reproduced exactly. The recorder stores every event the
+ * desktop drains from its event channel with a microsecond timestamp;
+ * the replayer posts the events back into an event channel and runs
+ * one frame per frame interval of trace time, either in real time or
+ * as fast as frames can be rendered.
+ *
+ * File layout (little-endian): a 16-byte header ("AMIT", version,
+ * screen width and height) followed by 20-byte records: a uint32 time
+ * in microseconds since the start of the trace and an amos_event_t.
+ */
+
+#ifndef AMOS_INPUT_TRACE_H
+#define AMOS_INPUT_TRACE_H
+
+#include "event_channel.h"
+#include <stdio.h>
+#include <stddef.h>
+
+// File identification
+#define AMOS_INPUT_TRACE_MAGIC 0x54494D41u     // "AMIT"
+#define AMOS_INPUT_TRACE_VERSION 1
+
+// One recorded event
+typedef struct {
+    uint32_t time_us;           // Microseconds since the trace started
+    amos_event_t event;
+} amos_input_record_t;
+
+// Trace being recorded or loaded for replay
+typedef struct {
+    FILE* file;                 // Open while recording
+    uint64_t start_us;          // Recording start (monotonic)
+    int width;                  // Screen size the trace was recorded at
+    int height;
+
+    amos_input_record_t* records;   // Loaded records, in time order
+    size_t count;
+} amos_input_trace_t;
+
+// Called once per replayed frame, after that frame's events were posted;
+// time_ms is the end of the frame interval in trace time
+typedef void (*amos_input_frame_fn)(void* user_data, double time_ms);
+
+/**
+ * Start recording to a file
+ *
+ * @param trace Pointer to trace structure
+ * @param path File to create
+ * @param width Screen width
+ * @param height Screen height
+ * @return true if recording started, false otherwise
+ */
+bool amos_input_trace_start(amos_input_trace_t* trace, const char* path, int width, int height);
+
+/**
+ * Append an event to the trace being recorded, stamped with the current time
+ *
+ * @param trace Pointer to trace structure (ignored if not recording)
+ * @param event Event the desktop processed
+ */
+void amos_input_trace_write(amos_input_trace_t* trace, const amos_event_t* event);
+
+/**
+ * Check whether a trace is being recorded
+ *
+ * @param trace Pointer to trace structure
+ * @return true while recording
+ */
+bool amos_input_trace_recording(const amos_input_trace_t* trace);
+
+/**
+ * Finish recording and close the file
+ *
+ * @param trace Pointer to trace structure
+ * @return true if every record reached the file, false otherwise
+ */
+bool amos_input_trace_stop(amos_input_trace_t* trace);
+
+/**
+ * Load a recorded trace for replay
+ *
+ * @param trace Pointer to trace structure
+ * @param path Trace file
+ * @return true if the trace was loaded, false otherwise
+ */
+bool amos_input_trace_load(amos_input_trace_t* trace, const char* path);
+
+/**
+ * Save in-memory records (e.g. a generated scenario) as a trace file
+ *
+ * @param trace Pointer to trace structure holding records
+ * @param path File to create
+ * @return true if the file was written, false otherwise
+ */
+bool amos_input_trace_save(const amos_input_trace_t* trace, const char* path);
+
+/**
+ * Release loaded records
+ *
+ * @param trace Pointer to trace structure
+ */
+void amos_input_trace_free(amos_input_trace_t* trace);
+
+/**
+ * Replay a loaded trace
+ *
+ * Events are posted to the channel the way the interrupt handlers would
+ * post them, so pointer motion is coalesced per frame as in a live run.
+ *
+ * @param trace Pointer to loaded trace
+ * @param channel Channel the desktop drains
+ * @param frame_ms Frame interval in trace time
+ * @param max_speed Run frames back to back instead of in real time
+ * @param frame Called once per frame to process, update and render
+ * @param user_data Passed to frame
+ * @return Number of frames run
+ */
+int amos_input_trace_replay(
+    const amos_input_trace_t* trace,
+    amos_event_channel_t* channel,
+    double frame_ms,
+    bool max_speed,
+    amos_input_frame_fn frame,
+    void* user_data
+);
+
+#endif /* AMOS_INPUT_TRACE_H */
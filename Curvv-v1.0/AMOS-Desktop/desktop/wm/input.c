@@ -0,0 +1,553 @@
+/*
+ * input.c - Evdev input stage implementation
+ *
+ * This file implements device discovery, bulk reading, SYN_REPORT packet
+ * assembly, motion coalescing and recovery from dropped records and
+ * vanished devices for the window manager.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+
+#include "input.h"
+
+/* Test a bit in an EVIOCGBIT bitmap */
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define NLONGS(n) (((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define TEST_BIT(bit, array) (((array)[(bit) / BITS_PER_LONG] >> ((bit) % BITS_PER_LONG)) & 1)
+
+/* Modifier keys, one held_keys bit each */
+static const struct {
+    unsigned short code;
+    unsigned int modifier;
+} modifier_keys[] = {
+    { KEY_LEFTSHIFT,  WM_MOD_SHIFT },
+    { KEY_RIGHTSHIFT, WM_MOD_SHIFT },
+    { KEY_LEFTCTRL,   WM_MOD_CTRL },
+    { KEY_RIGHTCTRL,  WM_MOD_CTRL },
+    { KEY_LEFTALT,    WM_MOD_ALT },
+    { KEY_RIGHTALT,   WM_MOD_ALT },
+    { KEY_LEFTMETA,   WM_MOD_META },
+    { KEY_RIGHTMETA,  WM_MOD_META },
+};
+
+#define MODIFIER_KEY_COUNT (int)(sizeof(modifier_keys) / sizeof(modifier_keys[0]))
+
+/*
+ * Initialize the input stage with no devices
+ */
+void wm_input_init(struct wm_input* input, int width, int height) {
+    memset(input, 0, sizeof(struct wm_input));
+    input->width = width;
+    input->height = height;
+    input->mouse_x = width / 2;
+    input->mouse_y = height / 2;
+}
+
+/*
+ * Query a device's capabilities
+ * Returns a WM_INPUT_* mask, 0 if the device is of no use to the window manager
+ */
+static int wm_input_query_caps(int fd) {
+    unsigned long ev_bits[NLONGS(EV_MAX + 1)];
+    unsigned long key_bits[NLONGS(KEY_MAX + 1)];
+    unsigned long rel_bits[NLONGS(REL_MAX + 1)];
+    unsigned long abs_bits[NLONGS(ABS_MAX + 1)];
+    int caps = 0;
+
+    memset(ev_bits, 0, sizeof(ev_bits));
+    memset(key_bits, 0, sizeof(key_bits));
+    memset(rel_bits, 0, sizeof(rel_bits));
+    memset(abs_bits, 0, sizeof(abs_bits));
+
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0) {
+        return 0;
+    }
+    if (TEST_BIT(EV_KEY, ev_bits)) {
+        ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+    }
+    if (TEST_BIT(EV_REL, ev_bits)) {
+        ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel_bits)), rel_bits);
+    }
+    if (TEST_BIT(EV_ABS, ev_bits)) {
+        ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+    }
+
+    /* A keyboard has letters; power buttons and lid switches do not */
+    if (TEST_BIT(KEY_A, key_bits) && TEST_BIT(KEY_Z, key_bits) && TEST_BIT(KEY_ENTER, key_bits)) {
+        caps |= WM_INPUT_KEYBOARD;
+    }
+
+    if (TEST_BIT(REL_X, rel_bits) && TEST_BIT(REL_Y, rel_bits) && TEST_BIT(BTN_LEFT, key_bits)) {
+        caps |= WM_INPUT_POINTER;
+    }
+
+    if (TEST_BIT(ABS_X, abs_bits) && TEST_BIT(ABS_Y, abs_bits) &&
+        (TEST_BIT(BTN_LEFT, key_bits) || TEST_BIT(BTN_TOUCH, key_bits))) {
+        caps |= WM_INPUT_ABSOLUTE;
+    }
+
+    return caps;
+}
+
+/*
+ * Watch every device descriptor with a frame scheduler
+ */
+void wm_input_set_scheduler(struct wm_input* input, amos_frame_scheduler_t* scheduler) {
+    input->scheduler = scheduler;
+    if (scheduler == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < input->device_count; i++) {
+        if (input->devices[i].fd != -1) {
+            amos_frame_scheduler_watch_fd(scheduler, input->devices[i].fd);
+        }
+    }
+}
+
+/*
+ * Add an already open, non-blocking descriptor as a device
+ */
+int wm_input_add_fd(struct wm_input* input, int fd, int caps) {
+    /* Reuse the slot of a device that went away */
+    struct wm_input_device* device = NULL;
+    for (int i = 0; i < input->device_count; i++) {
+        if (input->devices[i].fd == -1) {
+            device = &input->devices[i];
+            break;
+        }
+    }
+    if (device == NULL) {
+        if (input->device_count >= WM_INPUT_MAX_DEVICES) {
+            fprintf(stderr, "Too many input devices\n");
+            return -1;
+        }
+        device = &input->devices[input->device_count++];
+    }
+
+    memset(device, 0, sizeof(struct wm_input_device));
+    device->fd = fd;
+    device->caps = caps;
+
+    /* Absolute axes map onto the screen; without ranges they are screen coordinates */
+    device->abs_min_x = 0;
+    device->abs_max_x = input->width - 1;
+    device->abs_min_y = 0;
+    device->abs_max_y = input->height - 1;
+
+    if (caps & WM_INPUT_ABSOLUTE) {
+        struct input_absinfo info;
+        if (ioctl(fd, EVIOCGABS(ABS_X), &info) == 0 && info.maximum > info.minimum) {
+            device->abs_min_x = info.minimum;
+            device->abs_max_x = info.maximum;
+        }
+        if (ioctl(fd, EVIOCGABS(ABS_Y), &info) == 0 && info.maximum > info.minimum) {
+            device->abs_min_y = info.minimum;
+            device->abs_max_y = info.maximum;
+        }
+    }
+
+    if (input->scheduler != NULL) {
+        amos_frame_scheduler_watch_fd(input->scheduler, fd);
+    }
+    return 0;
+}
+
+/*
+ * Open every /dev/input/event* device with useful capabilities
+ */
+int wm_input_open_devices(struct wm_input* input) {
+    DIR* dir = opendir("/dev/input");
+    if (dir == NULL) {
+        perror("Failed to open /dev/input");
+        return 0;
+    }
+
+    int opened = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "event", 5) != 0) {
+            continue;
+        }
+
+        char path[300];
+        snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
+
+        int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd == -1) {
+            continue;
+        }
+
+        int caps = wm_input_query_caps(fd);
+        if (caps == 0 || wm_input_add_fd(input, fd, caps) != 0) {
+            close(fd);
+            continue;
+        }
+
+        printf("Input device %s:%s%s%s\n", path,
+               (caps & WM_INPUT_KEYBOARD) ? " keyboard" : "",
+               (caps & WM_INPUT_POINTER) ? " pointer" : "",
+               (caps & WM_INPUT_ABSOLUTE) ? " absolute" : "");
+        opened++;
+    }
+
+    closedir(dir);
+    return opened;
+}
+
+/*
+ * Deliver one event with the current modifier state
+ */
+static void wm_input_emit(struct wm_input* input, wm_event_type_t type, unsigned int key,
+                          wm_input_handler_t handler, void* user_data, int* delivered) {
+    wm_event_t event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.window = NULL;
+    event.x = input->mouse_x;
+    event.y = input->mouse_y;
+    event.key = key;
+    event.state = input->modifiers;
+
+    handler(&event, user_data);
+    (*delivered)++;
+}
+
+/*
+ * Emit the coalesced motion, if any
+ */
+static void wm_input_flush_motion(struct wm_input* input, wm_input_handler_t handler,
+                                  void* user_data, int* delivered) {
+    if (input->motion_pending) {
+        input->motion_pending = false;
+        wm_input_emit(input, WM_EVENT_MOUSE_MOVE, input->buttons, handler, user_data, delivered);
+    }
+}
+
+/*
+ * Update the modifier state for a key record
+ * Returns true if the key was a modifier
+ */
+static bool wm_input_update_modifiers(struct wm_input* input, const struct input_event* ev) {
+    if (ev->code == KEY_CAPSLOCK) {
+        if (ev->value == 1) {
+            input->modifiers ^= WM_MOD_CAPS_LOCK;
+        }
+        return true;
+    }
+
+    for (int i = 0; i < MODIFIER_KEY_COUNT; i++) {
+        if (modifier_keys[i].code != ev->code) {
+            continue;
+        }
+
+        if (ev->value) {
+            input->held_keys |= 1u << i;
+        } else {
+            input->held_keys &= ~(1u << i);
+        }
+
+        /* A modifier stays set while either of its keys is held */
+        input->modifiers &= WM_MOD_CAPS_LOCK;
+        for (int j = 0; j < MODIFIER_KEY_COUNT; j++) {
+            if (input->held_keys & (1u << j)) {
+                input->modifiers |= modifier_keys[j].modifier;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/*
+ * Map a button code to a WM_BUTTON_* bit, 0 for keyboard keys
+ */
+static unsigned int wm_input_button_bit(unsigned short code) {
+    switch (code) {
+        case BTN_LEFT:
+        case BTN_TOUCH:
+            return WM_BUTTON_LEFT;
+        case BTN_RIGHT:
+            return WM_BUTTON_RIGHT;
+        case BTN_MIDDLE:
+            return WM_BUTTON_MIDDLE;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Apply one key or button record and remember whether it is held
+ */
+static void wm_input_apply_key(struct wm_input* input, struct wm_input_device* device,
+                               const struct input_event* ev, wm_input_handler_t handler,
+                               void* user_data, int* delivered) {
+    unsigned int button = wm_input_button_bit(ev->code);
+    if (button == 0 && ev->code >= BTN_MISC && ev->code < KEY_OK) {
+        return;
+    }
+
+    if (ev->value) {
+        device->key_down[ev->code / BITS_PER_LONG] |= 1ul << (ev->code % BITS_PER_LONG);
+    } else {
+        device->key_down[ev->code / BITS_PER_LONG] &= ~(1ul << (ev->code % BITS_PER_LONG));
+    }
+
+    if (button != 0) {
+        bool pressed = ev->value != 0;
+        if (pressed == ((input->buttons & button) != 0)) {
+            return;
+        }
+
+        /* Deliver the position the transition happened at before the transition */
+        wm_input_flush_motion(input, handler, user_data, delivered);
+        if (pressed) {
+            input->buttons |= button;
+        } else {
+            input->buttons &= ~button;
+        }
+        wm_input_emit(input, pressed ? WM_EVENT_MOUSE_PRESS : WM_EVENT_MOUSE_RELEASE,
+                      button, handler, user_data, delivered);
+    } else {
+        wm_input_update_modifiers(input, ev);
+
+        /* Auto-repeat (value 2) is delivered as another press */
+        wm_input_emit(input, ev->value ? WM_EVENT_KEY_PRESS : WM_EVENT_KEY_RELEASE,
+                      ev->code, handler, user_data, delivered);
+    }
+}
+
+/*
+ * Post a release for every key the device holds that is not down in key_state
+ * key_state: EVIOCGKEY bitmap, NULL to release everything
+ */
+static void wm_input_release_keys(struct wm_input* input, struct wm_input_device* device,
+                                  const unsigned long* key_state, wm_input_handler_t handler,
+                                  void* user_data, int* delivered) {
+    for (size_t i = 0; i < WM_INPUT_KEY_LONGS; i++) {
+        unsigned long released = device->key_down[i] & ~(key_state ? key_state[i] : 0);
+        for (size_t bit = 0; released != 0; bit++, released >>= 1) {
+            if ((released & 1) == 0) {
+                continue;
+            }
+
+            struct input_event ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.type = EV_KEY;
+            ev.code = (unsigned short)(i * BITS_PER_LONG + bit);
+            ev.value = 0;
+            wm_input_apply_key(input, device, &ev, handler, user_data, delivered);
+            input->released++;
+        }
+    }
+}
+
+/*
+ * Forget a device's partial packet
+ */
+static void wm_input_reset_packet(struct wm_input_device* device) {
+    device->rel_x = 0;
+    device->rel_y = 0;
+    device->has_abs_x = false;
+    device->has_abs_y = false;
+    device->key_count = 0;
+}
+
+/*
+ * Bring the held keys back in line with the device after SYN_DROPPED
+ * Releases lost in the drop are posted; presses lost in it are not
+ */
+static void wm_input_resync(struct wm_input* input, struct wm_input_device* device,
+                            wm_input_handler_t handler, void* user_data, int* delivered) {
+    unsigned long key_state[WM_INPUT_KEY_LONGS];
+
+    /* Without key state (e.g. a pipe) assume everything was released */
+    if (ioctl(device->fd, EVIOCGKEY(sizeof(key_state)), key_state) < 0) {
+        memset(key_state, 0, sizeof(key_state));
+    }
+    wm_input_release_keys(input, device, key_state, handler, user_data, delivered);
+}
+
+/*
+ * Close a device that reported EOF or an error and release what it held
+ */
+static void wm_input_remove_device(struct wm_input* input, struct wm_input_device* device,
+                                   wm_input_handler_t handler, void* user_data, int* delivered) {
+    /* Unwatch first: a dead descriptor stays readable and would wake the loop forever */
+    if (input->scheduler != NULL) {
+        amos_frame_scheduler_unwatch_fd(input->scheduler, device->fd);
+    }
+    close(device->fd);
+    device->fd = -1;
+    input->lost++;
+
+    wm_input_reset_packet(device);
+    device->dropping = false;
+    wm_input_release_keys(input, device, NULL, handler, user_data, delivered);
+}
+
+/*
+ * Apply a completed packet: motion first, then keys in order
+ */
+static void wm_input_commit(struct wm_input* input, struct wm_input_device* device,
+                            wm_input_handler_t handler, void* user_data, int* delivered) {
+    int x = input->mouse_x + device->rel_x;
+    int y = input->mouse_y + device->rel_y;
+
+    if (device->has_abs_x) {
+        x = (int)((long)(device->abs_x - device->abs_min_x) * (input->width - 1) /
+                  (device->abs_max_x - device->abs_min_x));
+    }
+    if (device->has_abs_y) {
+        y = (int)((long)(device->abs_y - device->abs_min_y) * (input->height - 1) /
+                  (device->abs_max_y - device->abs_min_y));
+    }
+
+    x = x < 0 ? 0 : (x >= input->width ? input->width - 1 : x);
+    y = y < 0 ? 0 : (y >= input->height ? input->height - 1 : y);
+
+    if (x != input->mouse_x || y != input->mouse_y) {
+        if (input->motion_pending) {
+            input->coalesced++;
+        }
+        input->mouse_x = x;
+        input->mouse_y = y;
+        input->motion_pending = true;
+    }
+
+    for (int i = 0; i < device->key_count; i++) {
+        wm_input_apply_key(input, device, &device->keys[i], handler, user_data, delivered);
+    }
+
+    input->reports++;
+    wm_input_reset_packet(device);
+}
+
+/*
+ * Add one raw record to a device's packet
+ */
+static void wm_input_handle_record(struct wm_input* input, struct wm_input_device* device,
+                                   const struct input_event* ev, wm_input_handler_t handler,
+                                   void* user_data, int* delivered) {
+    if (ev->type == EV_SYN) {
+        if (ev->code == SYN_DROPPED) {
+            /* The kernel buffer overflowed: drop everything up to the next report */
+            device->dropping = true;
+            input->dropped++;
+        } else if (ev->code == SYN_REPORT) {
+            if (device->dropping) {
+                /* Releases may have been lost with the dropped records */
+                device->dropping = false;
+                wm_input_reset_packet(device);
+                wm_input_resync(input, device, handler, user_data, delivered);
+            } else {
+                wm_input_commit(input, device, handler, user_data, delivered);
+            }
+        }
+        return;
+    }
+
+    if (device->dropping) {
+        return;
+    }
+
+    switch (ev->type) {
+        case EV_REL:
+            if (ev->code == REL_X) {
+                device->rel_x += ev->value;
+            } else if (ev->code == REL_Y) {
+                device->rel_y += ev->value;
+            }
+            break;
+
+        case EV_ABS:
+            if (ev->code == ABS_X) {
+                device->abs_x = ev->value;
+                device->has_abs_x = true;
+            } else if (ev->code == ABS_Y) {
+                device->abs_y = ev->value;
+                device->has_abs_y = true;
+            }
+            break;
+
+        case EV_KEY:
+            /* Commit early rather than lose keys from an oversized packet */
+            if (device->key_count == WM_INPUT_PACKET_KEYS) {
+                wm_input_commit(input, device, handler, user_data, delivered);
+            }
+            device->keys[device->key_count++] = *ev;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/*
+ * Read every device until it would block and deliver the resulting events
+ */
+int wm_input_process(struct wm_input* input, wm_input_handler_t handler, void* user_data) {
+    struct input_event batch[WM_INPUT_READ_BATCH];
+    int delivered = 0;
+
+    for (int i = 0; i < input->device_count; i++) {
+        struct wm_input_device* device = &input->devices[i];
+        if (device->fd == -1) {
+            continue;
+        }
+
+        for (;;) {
+            ssize_t bytes_read = read(device->fd, batch, sizeof(batch));
+            if (bytes_read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (bytes_read <= 0) {
+                /* EOF or ENODEV: the device is gone */
+                wm_input_remove_device(input, device, handler, user_data, &delivered);
+                break;
+            }
+
+            /* evdev returns whole records; a pipe may split one, which is dropped */
+            int count = (int)(bytes_read / sizeof(struct input_event));
+            input->records += count;
+            for (int j = 0; j < count; j++) {
+                wm_input_handle_record(input, device, &batch[j], handler, user_data, &delivered);
+            }
+
+            if (bytes_read < (ssize_t)sizeof(batch)) {
+                break;
+            }
+        }
+    }
+
+    /* All motion read this frame becomes one move event */
+    wm_input_flush_motion(input, handler, user_data, &delivered);
+    return delivered;
+}
+
+/*
+ * Close every device
+ */
+void wm_input_close(struct wm_input* input) {
+    for (int i = 0; i < input->device_count; i++) {
+        if (input->devices[i].fd != -1) {
+            if (input->scheduler != NULL) {
+                amos_frame_scheduler_unwatch_fd(input->scheduler, input->devices[i].fd);
+            }
+            close(input->devices[i].fd);
+            input->devices[i].fd = -1;
+        }
+    }
+    input->device_count = 0;
+}
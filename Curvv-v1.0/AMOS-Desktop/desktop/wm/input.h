@@ -0,0 +1,142 @@
+/*
+ * input.h - Evdev input stage for the window manager
+ *
+ * This header defines the input stage that turns raw evdev records into
+ * window manager events. Devices are discovered by capability, read in
+ * bulk and assembled into SYN_REPORT packets. Relative motion from any
+ * number of packets in one frame is merged into a single move event,
+ * but a move is always emitted before a button transition so presses
+ * and releases land at the right position. Keyboard modifiers are
+ * tracked and reported in every event's state field.
+ *
+ * Keys and buttons held on each device are remembered. When the kernel
+ * drops records (SYN_DROPPED) the device's key state is read back and a
+ * release is posted for every key that went up unseen; when a device
+ * disappears its descriptor is closed and all of its keys are released.
+ *
+ * Any file descriptor that yields struct input_event records can be
+ * added as a device, so a pipe or socketpair can stand in for hardware.
+ */
+
+#ifndef AMOS_WM_INPUT_H
+#define AMOS_WM_INPUT_H
+
+#include <stdbool.h>
+#include <linux/input.h>
+
+#include "window_manager.h"
+#include "../../core/graphics/frame_scheduler.h"
+
+/* Maximum number of input devices */
+#define WM_INPUT_MAX_DEVICES 16
+
+/* Records read per read() call */
+#define WM_INPUT_READ_BATCH 64
+
+/* Key and button records buffered per SYN_REPORT packet */
+#define WM_INPUT_PACKET_KEYS 16
+
+/* Longs in a key bitmap, as EVIOCGKEY fills it */
+#define WM_INPUT_KEY_LONGS ((KEY_MAX + 1 + sizeof(unsigned long) * 8 - 1) / (sizeof(unsigned long) * 8))
+
+/* Device capabilities */
+#define WM_INPUT_KEYBOARD   0x01    /* Letter keys */
+#define WM_INPUT_POINTER    0x02    /* Relative motion and buttons */
+#define WM_INPUT_ABSOLUTE   0x04    /* Absolute position (tablet, touchscreen) */
+
+/* Modifier state bits */
+#define WM_MOD_SHIFT        0x01
+#define WM_MOD_CTRL         0x02
+#define WM_MOD_ALT          0x04
+#define WM_MOD_META         0x08
+#define WM_MOD_CAPS_LOCK    0x10
+
+/* Mouse button bits (event key field and button state) */
+#define WM_BUTTON_LEFT      0x01
+#define WM_BUTTON_RIGHT     0x02
+#define WM_BUTTON_MIDDLE    0x04
+
+/* One open input device */
+struct wm_input_device {
+    int fd;                     /* Device file descriptor, -1 once the device is gone */
+    int caps;                   /* WM_INPUT_* capabilities */
+    int abs_min_x, abs_max_x;   /* Absolute axis ranges */
+    int abs_min_y, abs_max_y;
+
+    /* Packet being assembled until the next SYN_REPORT */
+    int rel_x, rel_y;
+    int abs_x, abs_y;
+    bool has_abs_x, has_abs_y;
+    struct input_event keys[WM_INPUT_PACKET_KEYS];
+    int key_count;
+    bool dropping;              /* Discarding after SYN_DROPPED */
+
+    unsigned long key_down[WM_INPUT_KEY_LONGS];  /* Keys and buttons reported held */
+};
+
+/* Input stage state */
+struct wm_input {
+    struct wm_input_device devices[WM_INPUT_MAX_DEVICES];
+    int device_count;
+
+    int width, height;          /* Screen size the pointer is clamped to */
+    int mouse_x, mouse_y;       /* Current pointer position */
+    unsigned int buttons;       /* WM_BUTTON_* state */
+    unsigned int modifiers;     /* WM_MOD_* state */
+    unsigned int held_keys;     /* Modifier keys held, one bit per left/right key */
+    bool motion_pending;        /* Position changed since the last move event */
+    amos_frame_scheduler_t* scheduler;  /* Watches device descriptors, NULL if none */
+
+    /* Statistics */
+    unsigned long records;      /* Raw records read */
+    unsigned long reports;      /* SYN_REPORT packets committed */
+    unsigned long coalesced;    /* Motion packets merged into a later one */
+    unsigned long dropped;      /* Packets discarded after SYN_DROPPED */
+    unsigned long released;     /* Releases posted for keys that went up unseen */
+    unsigned long lost;         /* Devices closed after EOF or a read error */
+};
+
+/* Input event callback */
+typedef void (*wm_input_handler_t)(wm_event_t* event, void* user_data);
+
+/*
+ * Initialize the input stage with no devices
+ * width, height: Screen size; the pointer starts at the centre
+ */
+void wm_input_init(struct wm_input* input, int width, int height);
+
+/*
+ * Open every /dev/input/event* device with keyboard, pointer or
+ * absolute capabilities
+ * Returns the number of devices opened
+ */
+int wm_input_open_devices(struct wm_input* input);
+
+/*
+ * Watch every device descriptor, present and future, with a frame scheduler
+ * Descriptors of devices that disappear are unwatched before they are closed
+ */
+void wm_input_set_scheduler(struct wm_input* input, amos_frame_scheduler_t* scheduler);
+
+/*
+ * Add an already open, non-blocking descriptor as a device
+ * caps: WM_INPUT_* capabilities the records will use
+ * Returns 0 on success, -1 if the device table is full
+ */
+int wm_input_add_fd(struct wm_input* input, int fd, int caps);
+
+/*
+ * Read every device until it would block and deliver the resulting events
+ * Pending motion is flushed as one move event at the end. A device that
+ * reports EOF or an error (e.g. ENODEV after unplugging) is closed and
+ * its held keys and buttons are released.
+ * Returns the number of events delivered
+ */
+int wm_input_process(struct wm_input* input, wm_input_handler_t handler, void* user_data);
+
+/*
+ * Close every device
+ */
+void wm_input_close(struct wm_input* input);
+
+#endif /* AMOS_WM_INPUT_H */
@@ -9,14 +9,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <sys/time.h>
-#include <linux/input.h>
 
 #include "window_manager.h"
+#include "input.h"
 #include "../ui/ui_toolkit.h"
 #include "../state/state_manager.h"
+#include "../../core/graphics/frame_scheduler.h"
 
 /* Maximum number of windows the window manager can handle */
 #define MAX_WINDOWS 64
@@ -64,11 +62,11 @@ struct window_manager {
     int window_count;                     /* Number of windows */
     struct window* active_window;         /* Currently active window */
     
-    /* Input devices */
-    int kbd_fd;                 /* Keyboard device file descriptor */
-    int mouse_fd;               /* Mouse device file descriptor */
-    int mouse_x, mouse_y;       /* Current mouse position */
-    int mouse_buttons;          /* Current mouse button state */
+    /* Input devices, pointer and modifier state */
+    struct wm_input input;
+    
+    /* Frame pacing: the loop sleeps until input or damage */
+    amos_frame_scheduler_t scheduler;
 };
 
 /* Global window manager instance */
@@ -76,10 +74,12 @@ static struct window_manager* wm = NULL;
 
 /* Forward declarations for internal functions */
 static void wm_process_input(void);
+static void wm_handle_input_event(wm_event_t* event, void* user_data);
 static void wm_render(void);
 static bool wm_dispatch_event(wm_event_t* event);
 static struct window* wm_find_window_at(int x, int y);
 static void wm_activate_window(struct window* window);
+static void wm_request_render(void);
 
 /*
  * Initialize the window manager
@@ -103,44 +103,53 @@ int window_manager_init(char* fb_mem, int width, int height, int depth) {
     wm->window_count = 0;
     wm->active_window = NULL;
     
-    /* Open input devices */
-    wm->kbd_fd = open("/dev/input/event0", O_RDONLY | O_NONBLOCK);
-    if (wm->kbd_fd == -1) {
-        perror("Failed to open keyboard device");
-        /* Not fatal, continue without keyboard */
+    /* Open every keyboard and pointer device */
+    wm_input_init(&wm->input, width, height);
+    if (wm_input_open_devices(&wm->input) == 0) {
+        fprintf(stderr, "No input devices found\n");
+        /* Not fatal, continue without input */
     }
     
-    wm->mouse_fd = open("/dev/input/event1", O_RDONLY | O_NONBLOCK);
-    if (wm->mouse_fd == -1) {
-        perror("Failed to open mouse device");
-        /* Not fatal, continue without mouse */
-    }
+    /* Wake the main loop on input instead of polling */
+    amos_frame_scheduler_init(&wm->scheduler, 60);
+    wm_input_set_scheduler(&wm->input, &wm->scheduler);
+    
+    /* Draw the empty desktop once */
+    amos_frame_scheduler_request_frame(&wm->scheduler);
     
     printf("Window manager initialized: %dx%d, %d bpp\n", width, height, depth);
     return 0;
 }
 
+/*
+ * Add an input source such as a pipe carrying raw input_event records
+ */
+int window_manager_add_input_fd(int fd, int caps) {
+    /* The input stage watches the descriptor with the scheduler */
+    return wm_input_add_fd(&wm->input, fd, caps);
+}
+
 /*
  * Start the window manager main loop
  */
 void window_manager_run(void) {
-    struct timeval tv;
     wm->running = true;
     
     printf("Window manager started\n");
     
     /* Main loop */
     while (wm->running) {
+        /* Block until input arrives or a requested frame is due */
+        amos_frame_scheduler_wait(&wm->scheduler, -1);
+        
         /* Process input events */
         wm_process_input();
         
-        /* Render windows */
-        wm_render();
-        
-        /* Sleep for a short time to avoid using 100% CPU */
-        tv.tv_sec = 0;
-        tv.tv_usec = 16666; /* ~60 FPS */
-        select(0, NULL, NULL, NULL, &tv);
+        /* Render windows at most once per refresh, and only after damage */
+        if (amos_frame_scheduler_frame_due(&wm->scheduler)) {
+            wm_render();
+            amos_frame_scheduler_frame_done(&wm->scheduler);
+        }
     }
     
     printf("Window manager stopped\n");
@@ -161,14 +170,10 @@ void window_manager_cleanup(void) {
         return;
     }
     
-    /* Close input devices */
-    if (wm->kbd_fd != -1) {
-        close(wm->kbd_fd);
-    }
+    /* Close input devices while the scheduler still watches them */
+    wm_input_close(&wm->input);
     
-    if (wm->mouse_fd != -1) {
-        close(wm->mouse_fd);
-    }
+    amos_frame_scheduler_cleanup(&wm->scheduler);
     
     /* Destroy all windows */
     for (int i = 0; i < wm->window_count; i++) {
@@ -246,6 +251,8 @@ struct window* window_create(int x, int y, int width, int height, const char* ti
     /* Activate new window */
     wm_activate_window(window);
     
+    wm_request_render();
+    
     printf("Window created: %s (%d,%d,%d,%d)\n", window->title, x, y, width, height);
     return window;
 }
@@ -296,6 +303,7 @@ void window_destroy(struct window* window) {
     }
     
     free(window);
+    wm_request_render();
     
     printf("Window destroyed\n");
 }
@@ -323,6 +331,7 @@ void window_set_visible(struct window* window, bool visible) {
     } else {
         window->flags &= ~WINDOW_FLAG_VISIBLE;
     }
+    wm_request_render();
 }
 
 /*
@@ -335,6 +344,7 @@ void window_move(struct window* window, int x, int y) {
     
     window->x = x;
     window->y = y;
+    wm_request_render();
 }
 
 /*
@@ -394,6 +404,7 @@ void window_resize(struct window* window, int width, int height) {
     window->buffer = new_buffer;
     window->width = width;
     window->height = height;
+    wm_request_render();
     
     /* Dispatch resize event */
     wm_event_t event;
@@ -417,6 +428,7 @@ void window_set_title(struct window* window, const char* title) {
     }
     
     window->title = strdup(title);
+    wm_request_render();
 }
 
 /*
@@ -501,6 +513,7 @@ void window_minimize(struct window* window) {
     
     /* Set minimized flag */
     window->flags |= WINDOW_FLAG_MINIMIZED;
+    wm_request_render();
     
     /* If this is active window, activate another */
     if (wm->active_window == window) {
@@ -554,6 +567,7 @@ void window_restore(struct window* window) {
     if (window->flags & WINDOW_FLAG_MINIMIZED) {
         /* Clear minimized flag */
         window->flags &= ~WINDOW_FLAG_MINIMIZED;
+        wm_request_render();
         
         /* Activate window */
         wm_activate_window(window);
@@ -583,27 +597,40 @@ bool window_is_visible(struct window* window) {
  * Process input events from keyboard and mouse
  */
 static void wm_process_input(void) {
-    struct input_event event;
-    ssize_t bytes_read;
-    
-    /* Process keyboard input */
-    if (wm->kbd_fd != -1) {
-        while ((bytes_read = read(wm->kbd_fd, &event, sizeof(event))) > 0) {
-            if (bytes_read == sizeof(event)) {
-                /* Process key event... */
-                /* TODO: Implement keyboard input handling */
-            }
-        }
+    /* Reads every device in bulk; motion since the last frame arrives as one move */
+    wm_input_process(&wm->input, wm_handle_input_event, NULL);
+}
+
+/*
+ * Route one input event to the window it belongs to
+ */
+static void wm_handle_input_event(wm_event_t* event, void* user_data) {
+    (void)user_data;
+    
+    switch (event->type) {
+        case WM_EVENT_MOUSE_MOVE:
+            event->window = wm_find_window_at(event->x, event->y);
+            break;
+            
+        case WM_EVENT_MOUSE_PRESS:
+            /* Clicking a window raises and focuses it */
+            event->window = wm_find_window_at(event->x, event->y);
+            wm_activate_window(event->window);
+            break;
+            
+        case WM_EVENT_MOUSE_RELEASE:
+        case WM_EVENT_KEY_PRESS:
+        case WM_EVENT_KEY_RELEASE:
+            /* The focused window keeps releases and keys */
+            event->window = wm->active_window;
+            break;
+            
+        default:
+            return;
     }
     
-    /* Process mouse input */
-    if (wm->mouse_fd != -1) {
-        while ((bytes_read = read(wm->mouse_fd, &event, sizeof(event))) > 0) {
-            if (bytes_read == sizeof(event)) {
-                /* Process mouse event... */
-                /* TODO: Implement mouse input handling */
-            }
-        }
+    if (event->window != NULL && wm_dispatch_event(event)) {
+        wm_request_render();
     }
 }
 
@@ -719,6 +746,7 @@ static void wm_activate_window(struct window* window) {
     /* Set new active window */
     wm->active_window = window;
     window->flags |= WINDOW_FLAG_FOCUSED;
+    wm_request_render();
     
     /* Reorder windows to bring active to front */
     for (int i = 0; i < wm->window_count; i++) {
@@ -737,4 +765,13 @@ static void wm_activate_window(struct window* window) {
     event.type = WM_EVENT_WINDOW_FOCUS;
     event.window = window;
     wm_dispatch_event(&event);
-}
\ No newline at end of file
+}
+
+/*
+ * Schedule a redraw; several requests before the next frame share it
+ */
+static void wm_request_render(void) {
+    if (wm != NULL) {
+        amos_frame_scheduler_request_frame(&wm->scheduler);
+    }
+}
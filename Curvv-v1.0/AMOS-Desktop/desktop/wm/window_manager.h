@@ -54,6 +54,15 @@ typedef bool (*window_event_handler_t)(struct window* window, wm_event_t* event,
  */
 int window_manager_init(char* fb_mem, int width, int height, int depth);
 
+/*
+ * Add an input source alongside the discovered devices
+ * fd: Non-blocking descriptor yielding struct input_event records
+ *     (e.g. one end of a pipe or socketpair)
+ * caps: WM_INPUT_* capabilities from input.h
+ * Returns 0 on success, -1 on failure
+ */
+int window_manager_add_input_fd(int fd, int caps);
+
 /*
  * Start the window manager main loop
  * This function doesn't return until window_manager_exit is called
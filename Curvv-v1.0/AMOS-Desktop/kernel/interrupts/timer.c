@@ -1,6 +1,7 @@
 #include "timer.h"
 #include "../utils.h"
 #include "../../desktop/integration/desktop_init.h"
+#include "../../desktop/integration/event_channel.h"
 
 // Variables for timer management
 static uint32_t tick = 0;
@@ -10,13 +11,10 @@ static uint32_t frequency = 0;
 void timer_callback() {
     tick++;
     
-    // Every 10 ticks, trigger a timer event in the desktop environment
+    // Every 10 ticks, queue a timer event for the desktop loop; this runs
+    // in interrupt context, so it must not call into the desktop directly
     if (tick % 10 == 0) {
-        // Create timer event data
-        void* event_data = (void*)(uint64_t)tick;  // Pass tick count as event data
-        
-        // Pass timer event to desktop environment
-        desktop_handle_event(3, event_data);
+        amos_event_channel_post_timer(amos_desktop_get_event_channel(), tick);
     }
 }
 
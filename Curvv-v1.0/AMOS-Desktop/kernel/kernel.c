@@ -65,6 +65,13 @@ int main() {
         printf("Failed to initialize desktop environment\n");
         return 1;
     }
+
+#ifdef AMOS_X11
+    // Hosted builds run nested in X when a display is available
+    if (getenv("DISPLAY") && !amos_desktop_present_x11(NULL)) {
+        printf("Could not present in X11, continuing without it\n");
+    }
+#endif
     
     // Run desktop main loop
     amos_desktop_run();
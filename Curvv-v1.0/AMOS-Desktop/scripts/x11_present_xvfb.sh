@@ -0,0 +1,29 @@
+#!/bin/bash
+# x11_present_xvfb.sh - Run the X11 presentation benchmark under Xvfb
+#
+# Runs build/demos/x11_present_bench (built by build_native.sh) on a
+# private Xvfb server at depth 24 and depth 16. The benchmark reads a
+# pixel back from the window and exits non-zero if it does not match the
+# framebuffer, which covers both the direct MIT-SHM path and the
+# Render-converted path.
+#
+# Usage: scripts/x11_present_xvfb.sh [frames]
+
+FRAMES=${1:-600}
+BENCH=${BENCH:-build/demos/x11_present_bench}
+
+if ! command -v xvfb-run >/dev/null; then
+    echo "xvfb-run not found"
+    exit 1
+fi
+if [ ! -x "$BENCH" ]; then
+    echo "$BENCH not found; run build_native.sh first"
+    exit 1
+fi
+
+STATUS=0
+for DEPTH in 24 16; do
+    echo "Depth $DEPTH:"
+    xvfb-run -a -s "-screen 0 1024x768x$DEPTH" "$BENCH" "$FRAMES" 1024 768 || STATUS=1
+done
+exit $STATUS
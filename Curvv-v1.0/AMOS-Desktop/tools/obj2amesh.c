@@ -0,0 +1,302 @@
+/**
+ * AMOS Desktop OS - OBJ to AMOS Mesh Converter
+ * 
+ * Offline tool that converts Wavefront OBJ models into the binary
+ * AMOS mesh format. Vertices are deduplicated on their
+ * position/texcoord/normal tuple, polygons are fan-triangulated,
+ * missing normals are generated and meshlets are built.
+ *
+ * Usage: obj2amesh input.obj output.amesh
+ */
+
+#include "../core/3d/mesh_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Growable array helper
+typedef struct {
+    void* data;
+    size_t count;
+    size_t capacity;
+    size_t element_size;
+} array_t;
+
+static void* array_push(array_t* array) {
+    if (array->count == array->capacity) {
+        size_t capacity = array->capacity ? array->capacity * 2 : 1024;
+        void* data = realloc(array->data, capacity * array->element_size);
+        if (!data) {
+            fprintf(stderr, "obj2amesh: out of memory\n");
+            exit(1);
+        }
+        array->data = data;
+        array->capacity = capacity;
+    }
+    return (uint8_t*)array->data + array->count++ * array->element_size;
+}
+
+// OBJ face corner (1-based OBJ indices resolved to 0-based, -1 if absent)
+typedef struct {
+    int v, vt, vn;
+} corner_t;
+
+// Hash table mapping corners to output vertices
+typedef struct {
+    corner_t key;
+    uint32_t value;
+    bool used;
+} corner_slot_t;
+
+typedef struct {
+    corner_slot_t* slots;
+    size_t capacity;
+    size_t count;
+} corner_map_t;
+
+static size_t corner_hash(const corner_t* c) {
+    size_t h = (size_t)c->v * 73856093u;
+    h ^= (size_t)(c->vt + 1) * 19349663u;
+    h ^= (size_t)(c->vn + 1) * 83492791u;
+    return h;
+}
+
+static void corner_map_grow(corner_map_t* map);
+
+static void corner_map_find_or_insert(corner_map_t* map, const corner_t* key, uint32_t* value, bool* inserted) {
+    if ((map->count + 1) * 2 > map->capacity) {
+        corner_map_grow(map);
+    }
+
+    size_t mask = map->capacity - 1;
+    size_t i = corner_hash(key) & mask;
+    while (map->slots[i].used) {
+        corner_t* k = &map->slots[i].key;
+        if (k->v == key->v && k->vt == key->vt && k->vn == key->vn) {
+            *value = map->slots[i].value;
+            *inserted = false;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    map->slots[i].used = true;
+    map->slots[i].key = *key;
+    map->slots[i].value = *value;
+    map->count++;
+    *inserted = true;
+}
+
+static void corner_map_grow(corner_map_t* map) {
+    size_t capacity = map->capacity ? map->capacity * 2 : 4096;
+    corner_slot_t* old = map->slots;
+    size_t old_capacity = map->capacity;
+
+    map->slots = (corner_slot_t*)calloc(capacity, sizeof(corner_slot_t));
+    if (!map->slots) {
+        fprintf(stderr, "obj2amesh: out of memory\n");
+        exit(1);
+    }
+    map->capacity = capacity;
+    map->count = 0;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].used) {
+            uint32_t value = old[i].value;
+            bool inserted;
+            corner_map_find_or_insert(map, &old[i].key, &value, &inserted);
+        }
+    }
+    free(old);
+}
+
+// Resolve an OBJ index (1-based, negative = relative to end)
+static int resolve_index(long index, size_t count) {
+    if (index > 0) {
+        return (size_t)index <= count ? (int)(index - 1) : -1;
+    }
+    if (index < 0) {
+        return (size_t)(-index) <= count ? (int)(count + index) : -1;
+    }
+    return -1;
+}
+
+static bool parse_corner(char* token, size_t v_count, size_t vt_count, size_t vn_count, corner_t* corner) {
+    char* end;
+    corner->vt = -1;
+    corner->vn = -1;
+
+    corner->v = resolve_index(strtol(token, &end, 10), v_count);
+    if (corner->v < 0) {
+        return false;
+    }
+
+    if (*end == '/') {
+        token = end + 1;
+        if (*token != '/') {
+            corner->vt = resolve_index(strtol(token, &end, 10), vt_count);
+        } else {
+            end = token;
+        }
+        if (*end == '/') {
+            corner->vn = resolve_index(strtol(end + 1, &end, 10), vn_count);
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s input.obj output.amesh\n", argv[0]);
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "r");
+    if (!file) {
+        fprintf(stderr, "obj2amesh: cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    array_t obj_positions = {NULL, 0, 0, sizeof(amos_vec3_t)};
+    array_t obj_texcoords = {NULL, 0, 0, sizeof(amos_vec2_t)};
+    array_t obj_normals = {NULL, 0, 0, sizeof(amos_vec3_t)};
+    array_t corners = {NULL, 0, 0, sizeof(corner_t)};
+    array_t indices = {NULL, 0, 0, sizeof(uint32_t)};
+    corner_map_t map = {NULL, 0, 0};
+    bool any_texcoords = false;
+    bool any_normals = false;
+
+    char line[4096];
+    while (fgets(line, sizeof(line), file)) {
+        // A cut-off line would silently drop face corners
+        if (!strchr(line, '\n') && !feof(file)) {
+            fprintf(stderr, "obj2amesh: line longer than %zu bytes in %s\n", sizeof(line) - 1, argv[1]);
+            fclose(file);
+            return 1;
+        }
+
+        if (line[0] == 'v' && line[1] == ' ') {
+            amos_vec3_t* p = (amos_vec3_t*)array_push(&obj_positions);
+            if (sscanf(line + 2, "%f %f %f", &p->x, &p->y, &p->z) != 3) {
+                obj_positions.count--;
+            }
+        } else if (line[0] == 'v' && line[1] == 't') {
+            amos_vec2_t* t = (amos_vec2_t*)array_push(&obj_texcoords);
+            if (sscanf(line + 3, "%f %f", &t->x, &t->y) != 2) {
+                obj_texcoords.count--;
+            }
+        } else if (line[0] == 'v' && line[1] == 'n') {
+            amos_vec3_t* n = (amos_vec3_t*)array_push(&obj_normals);
+            if (sscanf(line + 3, "%f %f %f", &n->x, &n->y, &n->z) != 3) {
+                obj_normals.count--;
+            }
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            // Fan triangulation as the corners arrive, so faces of any size work
+            uint32_t first = 0;
+            uint32_t previous = 0;
+            int face_count = 0;
+
+            for (char* token = strtok(line + 2, " \t\r\n"); token;
+                 token = strtok(NULL, " \t\r\n")) {
+                corner_t corner;
+                if (!parse_corner(token, obj_positions.count, obj_texcoords.count,
+                                  obj_normals.count, &corner)) {
+                    continue;
+                }
+
+                uint32_t index = (uint32_t)corners.count;
+                bool inserted;
+                corner_map_find_or_insert(&map, &corner, &index, &inserted);
+                if (inserted) {
+                    *(corner_t*)array_push(&corners) = corner;
+                    any_texcoords |= corner.vt >= 0;
+                    any_normals |= corner.vn >= 0;
+                }
+
+                if (face_count == 0) {
+                    first = index;
+                } else if (face_count >= 2) {
+                    *(uint32_t*)array_push(&indices) = first;
+                    *(uint32_t*)array_push(&indices) = previous;
+                    *(uint32_t*)array_push(&indices) = index;
+                }
+                previous = index;
+                face_count++;
+            }
+        }
+    }
+    fclose(file);
+
+    if (corners.count == 0 || indices.count == 0) {
+        fprintf(stderr, "obj2amesh: %s contains no faces\n", argv[1]);
+        return 1;
+    }
+
+    // Expand corners into SoA streams
+    uint32_t vertex_count = (uint32_t)corners.count;
+    amos_vec3_t* positions = (amos_vec3_t*)malloc(vertex_count * sizeof(amos_vec3_t));
+    amos_vec3_t* normals = (amos_vec3_t*)calloc(vertex_count, sizeof(amos_vec3_t));
+    amos_vec2_t* texcoords = any_texcoords ? (amos_vec2_t*)calloc(vertex_count, sizeof(amos_vec2_t)) : NULL;
+    if (!positions || !normals || (any_texcoords && !texcoords)) {
+        fprintf(stderr, "obj2amesh: out of memory\n");
+        return 1;
+    }
+
+    const corner_t* c = (const corner_t*)corners.data;
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        positions[i] = ((amos_vec3_t*)obj_positions.data)[c[i].v];
+        if (texcoords && c[i].vt >= 0) {
+            texcoords[i] = ((amos_vec2_t*)obj_texcoords.data)[c[i].vt];
+        }
+        if (any_normals && c[i].vn >= 0) {
+            normals[i] = ((amos_vec3_t*)obj_normals.data)[c[i].vn];
+        }
+    }
+
+    // Generate area-weighted normals when the model has none
+    const uint32_t* idx = (const uint32_t*)indices.data;
+    if (!any_normals) {
+        for (size_t t = 0; t + 2 < indices.count; t += 3) {
+            amos_vec3_t e1, e2, n;
+            amos_vec3_subtract(&positions[idx[t + 1]], &positions[idx[t]], &e1);
+            amos_vec3_subtract(&positions[idx[t + 2]], &positions[idx[t]], &e2);
+            amos_vec3_cross(&e1, &e2, &n);
+            for (int k = 0; k < 3; k++) {
+                amos_vec3_add(&normals[idx[t + k]], &n, &normals[idx[t + k]]);
+            }
+        }
+        for (uint32_t i = 0; i < vertex_count; i++) {
+            amos_vec3_normalize_exact(&normals[i], &normals[i]);
+        }
+    }
+
+    amos_mesh_file_data_t data = {
+        .positions = positions,
+        .normals = normals,
+        .texcoords = texcoords,
+        .colors = NULL,
+        .indices = idx,
+        .vertex_count = vertex_count,
+        .index_count = (uint32_t)indices.count,
+        .build_meshlets = true
+    };
+
+    if (!amos_mesh_file_write(argv[2], &data)) {
+        return 1;
+    }
+
+    printf("%s: %u vertices, %zu triangles\n", argv[2], vertex_count, indices.count / 3);
+
+    free(positions);
+    free(normals);
+    free(texcoords);
+    free(obj_positions.data);
+    free(obj_texcoords.data);
+    free(obj_normals.data);
+    free(corners.data);
+    free(indices.data);
+    free(map.slots);
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#!/bin/bash
+# composite_smoke_xvfb.sh - Smoke test the window manager's compositing mode on Xvfb
+#
+# Starts a private Xvfb server, runs the window manager on it with
+# --composite, and runs src/bench/composite_smoke.c: it checks that the
+# window manager holds the root's redirection, that a mapped client's
+# color can be read back from the screen, and that uncovering the client
+# restores its pixels without exposing it. Exits non-zero if any check
+# fails or the window manager fell back to uncomposited drawing.
+#
+# Usage: scripts/composite_smoke_xvfb.sh [wm-binary]
+
+WM_BIN=${1:-./bin/amos-wm}
+DISPLAY_NUM=${DISPLAY_NUM:-88}
+
+if ! command -v Xvfb >/dev/null; then
+    echo "Xvfb not found"
+    exit 1
+fi
+if [ ! -x "$WM_BIN" ]; then
+    echo "Window manager binary $WM_BIN not found"
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+cleanup() {
+    [ -n "$WM_PID" ] && kill $WM_PID 2>/dev/null
+    [ -n "$XVFB_PID" ] && kill $XVFB_PID 2>/dev/null
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+# Build the client
+SRC_DIR=$(cd "$(dirname "$0")/../src" && pwd)
+gcc -O2 -Wall -Wextra -o "$WORK_DIR/composite_smoke" "$SRC_DIR/bench/composite_smoke.c" \
+    -lXcomposite -lX11 || exit 1
+
+# Composite, Damage, XFixes and Render are on by default
+Xvfb :$DISPLAY_NUM -screen 0 1024x768x24 -nolisten tcp &
+XVFB_PID=$!
+for i in $(seq 50); do
+    [ -e /tmp/.X11-unix/X$DISPLAY_NUM ] && break
+    sleep 0.1
+done
+export DISPLAY=:$DISPLAY_NUM
+
+"$WM_BIN" --composite > "$WORK_DIR/wm.log" 2>&1 &
+WM_PID=$!
+sleep 1
+if ! kill -0 $WM_PID 2>/dev/null; then
+    echo "Window manager exited during startup:"
+    cat "$WORK_DIR/wm.log"
+    exit 1
+fi
+
+"$WORK_DIR/composite_smoke"
+STATUS=$?
+
+if ! kill -0 $WM_PID 2>/dev/null; then
+    echo "Window manager died during the run:"
+    tail -20 "$WORK_DIR/wm.log"
+    exit 1
+fi
+if [ $STATUS -ne 0 ]; then
+    echo "Window manager log:"
+    tail -20 "$WORK_DIR/wm.log"
+fi
+exit $STATUS
@@ -0,0 +1,74 @@
+#!/bin/bash
+# wm_stress_xvfb.sh - Stress the AMOS window manager with thousands of clients on Xvfb
+#
+# Starts a private Xvfb server, runs the window manager on it, maps the
+# given number of client windows with src/bench/stress_clients.c and
+# reports how long framing and teardown took and how much CPU time the
+# window manager used. Exits non-zero if a window was not framed, a
+# frame outlived its client or the window manager died.
+#
+# Usage: scripts/wm_stress_xvfb.sh [wm-binary] [windows] [connections]
+
+WM_BIN=${1:-./bin/amos-wm}
+WINDOWS=${2:-2000}
+CONNECTIONS=${3:-100}
+DISPLAY_NUM=${DISPLAY_NUM:-87}
+
+if ! command -v Xvfb >/dev/null; then
+    echo "Xvfb not found"
+    exit 1
+fi
+if [ ! -x "$WM_BIN" ]; then
+    echo "Window manager binary $WM_BIN not found"
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+cleanup() {
+    [ -n "$WM_PID" ] && kill $WM_PID 2>/dev/null
+    [ -n "$XVFB_PID" ] && kill $XVFB_PID 2>/dev/null
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+# Build the client
+SRC_DIR=$(cd "$(dirname "$0")/../src" && pwd)
+gcc -O2 -Wall -Wextra -o "$WORK_DIR/stress_clients" "$SRC_DIR/bench/stress_clients.c" -lX11 || exit 1
+
+# Start the server with room for every connection
+Xvfb :$DISPLAY_NUM -screen 0 1920x1080x24 -nolisten tcp -maxclients 2048 &
+XVFB_PID=$!
+for i in $(seq 50); do
+    [ -e /tmp/.X11-unix/X$DISPLAY_NUM ] && break
+    sleep 0.1
+done
+export DISPLAY=:$DISPLAY_NUM
+
+"$WM_BIN" > "$WORK_DIR/wm.log" 2>&1 &
+WM_PID=$!
+sleep 1
+if ! kill -0 $WM_PID 2>/dev/null; then
+    echo "Window manager exited during startup:"
+    cat "$WORK_DIR/wm.log"
+    exit 1
+fi
+
+# CPU time in clock ticks (utime + stime)
+wm_ticks() {
+    awk '{ print $14 + $15 }' /proc/$WM_PID/stat
+}
+
+TICKS_BEFORE=$(wm_ticks)
+"$WORK_DIR/stress_clients" $WINDOWS $CONNECTIONS
+STATUS=$?
+TICKS_AFTER=$(wm_ticks)
+
+if ! kill -0 $WM_PID 2>/dev/null; then
+    echo "Window manager died during the run:"
+    tail -20 "$WORK_DIR/wm.log"
+    exit 1
+fi
+
+HZ=$(getconf CLK_TCK)
+echo "wm cpu:  $(( (TICKS_AFTER - TICKS_BEFORE) * 1000 / HZ )) ms"
+exit $STATUS
@@ -0,0 +1,220 @@
+/*
+ * composite_smoke.c - Check that the window manager's compositing mode draws
+ *
+ * Run against a window manager started with --composite on a throwaway
+ * server; see scripts/composite_smoke_xvfb.sh. It checks that:
+ *
+ *   redirect:  top-level windows are already redirected manually, so the
+ *              window manager really is compositing
+ *   map:       a mapped client's color reaches the screen, read back
+ *              from the root window once it has been framed
+ *   restack:   an override-redirect window mapped over the client and
+ *              destroyed again leaves the client's pixels restored
+ *              without a single Expose event reaching it
+ *
+ *   gcc -O2 -Wall -Wextra -o composite_smoke src/bench/composite_smoke.c -lXcomposite -lX11
+ *
+ * Usage: composite_smoke [timeout_s]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xcomposite.h>
+
+#define CLIENT_WIDTH 200
+#define CLIENT_HEIGHT 150
+
+static int redirect_refused;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static int probe_error_handler(Display *dpy, XErrorEvent *error) {
+    (void)dpy;
+    if (error->error_code == BadAccess) {
+        redirect_refused = 1;
+    }
+    return 0;
+}
+
+// Only one client may redirect the root's children manually; if that
+// is refused, the compositor holds it
+static int compositor_running(Display *dpy) {
+    XSync(dpy, False);
+    XErrorHandler previous = XSetErrorHandler(probe_error_handler);
+    redirect_refused = 0;
+    XCompositeRedirectSubwindows(dpy, DefaultRootWindow(dpy), CompositeRedirectManual);
+    XSync(dpy, False);
+    if (!redirect_refused) {
+        XCompositeUnredirectSubwindows(dpy, DefaultRootWindow(dpy), CompositeRedirectManual);
+        XSync(dpy, False);
+    }
+    XSetErrorHandler(previous);
+    return redirect_refused;
+}
+
+static unsigned long alloc_pixel(Display *dpy, unsigned short r, unsigned short g, unsigned short b) {
+    XColor color = { 0 };
+    color.red = r;
+    color.green = g;
+    color.blue = b;
+    if (!XAllocColor(dpy, DefaultColormap(dpy, DefaultScreen(dpy)), &color)) {
+        return BlackPixel(dpy, DefaultScreen(dpy));
+    }
+    return color.pixel;
+}
+
+static Window create_client(Display *dpy, int x, int y, unsigned long pixel, const char *title) {
+    Window win = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy), x, y, CLIENT_WIDTH, CLIENT_HEIGHT,
+                                     0, pixel, pixel);
+    XSelectInput(dpy, win, StructureNotifyMask | ExposureMask);
+    XStoreName(dpy, win, title);
+    XMapWindow(dpy, win);
+    XFlush(dpy);
+    return win;
+}
+
+// An unmanaged window centered on a point, which the window manager
+// neither frames nor moves
+static Window create_cover(Display *dpy, int x, int y, unsigned long pixel) {
+    XSetWindowAttributes attrs;
+    attrs.override_redirect = True;
+    attrs.background_pixel = pixel;
+    Window win = XCreateWindow(dpy, DefaultRootWindow(dpy), x - CLIENT_WIDTH / 4, y - CLIENT_HEIGHT / 4,
+                               CLIENT_WIDTH / 2, CLIENT_HEIGHT / 2, 0, CopyFromParent, InputOutput,
+                               CopyFromParent, CWOverrideRedirect | CWBackPixel, &attrs);
+    XMapRaised(dpy, win);
+    XFlush(dpy);
+    return win;
+}
+
+// Drain the queue, counting Expose events for a window
+// Sets *framed once the window has been reparented away from the root
+static int count_exposes(Display *dpy, Window win, int *framed) {
+    int exposes = 0;
+    while (XPending(dpy)) {
+        XEvent ev;
+        XNextEvent(dpy, &ev);
+        if (ev.type == Expose && ev.xexpose.window == win) {
+            exposes++;
+        } else if (ev.type == ReparentNotify && ev.xreparent.window == win && framed) {
+            *framed = ev.xreparent.parent != DefaultRootWindow(dpy);
+        }
+    }
+    return exposes;
+}
+
+// Where a window's center is on the screen
+static void window_center(Display *dpy, Window win, int *x, int *y) {
+    Window child;
+    XTranslateCoordinates(dpy, win, DefaultRootWindow(dpy), CLIENT_WIDTH / 2, CLIENT_HEIGHT / 2,
+                          x, y, &child);
+}
+
+// The pixel the screen shows at a window's center
+static unsigned long screen_pixel(Display *dpy, Window win) {
+    int x, y;
+    window_center(dpy, win, &x, &y);
+    XImage *image = XGetImage(dpy, DefaultRootWindow(dpy), x, y, 1, 1, AllPlanes, ZPixmap);
+    if (!image) {
+        return ~0UL;
+    }
+    unsigned long pixel = XGetPixel(image, 0, 0);
+    XDestroyImage(image);
+    return pixel;
+}
+
+// Wait until the screen shows a pixel at a window's center
+static int wait_for_pixel(Display *dpy, Window win, unsigned long expected, double timeout_ms,
+                          unsigned long *seen) {
+    double start = now_ms();
+    do {
+        *seen = screen_pixel(dpy, win);
+        if (*seen == expected) {
+            return 1;
+        }
+        sleep_ms(10);
+    } while (now_ms() - start < timeout_ms);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    double timeout_ms = (argc > 1 ? atof(argv[1]) : 5.0) * 1000.0;
+    if (timeout_ms <= 0) {
+        fprintf(stderr, "Usage: %s [timeout_s]\n", argv[0]);
+        return 1;
+    }
+
+    Display *dpy = XOpenDisplay(NULL);
+    if (!dpy) {
+        fprintf(stderr, "Cannot open display\n");
+        return 1;
+    }
+
+    int event_base, error_base;
+    if (!XCompositeQueryExtension(dpy, &event_base, &error_base)) {
+        fprintf(stderr, "Server has no Composite extension\n");
+        return 1;
+    }
+
+    int ok = 1;
+    int redirected = compositor_running(dpy);
+    printf("redirect: %s  %s\n", redirected ? "held by the window manager" : "free",
+           redirected ? "ok" : "FAILED");
+    ok &= redirected;
+
+    unsigned long green = alloc_pixel(dpy, 0x2000, 0xc000, 0x4000);
+    unsigned long red = alloc_pixel(dpy, 0xd000, 0x1000, 0x1000);
+
+    // Map a client and wait for its frame
+    Window first = create_client(dpy, 100, 100, green, "composite smoke");
+    int framed = 0;
+    double start = now_ms();
+    while (!framed && now_ms() - start < timeout_ms) {
+        count_exposes(dpy, first, &framed);
+        sleep_ms(10);
+    }
+
+    unsigned long seen = 0;
+    int mapped = framed && wait_for_pixel(dpy, first, green, timeout_ms, &seen);
+    printf("map:      framed %s, pixel 0x%06lx, want 0x%06lx  %s\n", framed ? "yes" : "no",
+           seen, green, mapped ? "ok" : "FAILED");
+    ok &= mapped;
+
+    // Let the first paint's Expose arrive before counting
+    sleep_ms(200);
+    count_exposes(dpy, first, NULL);
+
+    // Cover its center, then uncover it
+    int x, y;
+    window_center(dpy, first, &x, &y);
+    Window cover = create_cover(dpy, x, y, red);
+    int covered = wait_for_pixel(dpy, first, red, timeout_ms, &seen);
+    XDestroyWindow(dpy, cover);
+    XFlush(dpy);
+    int restored = wait_for_pixel(dpy, first, green, timeout_ms, &seen);
+
+    // Give a stray Expose time to arrive
+    sleep_ms(200);
+    int exposes = count_exposes(dpy, first, NULL);
+    int restacked = covered && restored && exposes == 0;
+    printf("restack:  covered %s, restored %s, %d Expose events  %s\n", covered ? "yes" : "no",
+           restored ? "yes" : "no", exposes, restacked ? "ok" : "FAILED");
+    ok &= restacked;
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    XDestroyWindow(dpy, first);
+    XCloseDisplay(dpy);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+/*
+ * gc_cache_bench.c - Harness for the shared GC cache
+ *
+ * Runs gc_cache.c against a fake 24-bit display whose GC and pixmap
+ * requests only count what is live:
+ *
+ *   reuse:     20 keys drawn over 1000 redraws create 20 GCs; times an
+ *              acquire/release pair on a cache hit
+ *   eviction:  with every slot taken, new keys evict only idle GCs
+ *   overflow:  with every slot held, a new key gets an uncached GC that
+ *              is freed on release
+ *   depths:    cycling 10 non-default depths over 100 redraws keeps at
+ *              most GC_CACHE_DEPTHS (4) pixmaps live
+ *   flush:     flushing an idle cache leaves no GCs
+ *
+ * Needs the X11 headers but neither the library nor a server:
+ *   gcc -O2 -Wall -Wextra -o gc_cache_bench src/bench/gc_cache_bench.c src/ui/gc_cache.c
+ *
+ * Usage: gc_cache_bench [redraws]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <X11/Xlib.h>
+
+#include "../ui/gc_cache.h"
+
+#define FAKE_DEPTH 24
+#define FAKE_ROOT 1
+#define CACHE_SLOTS 64      // GC_CACHE_SIZE in gc_cache.c
+#define CACHE_DEPTHS 4      // GC_CACHE_DEPTHS in gc_cache.c
+#define REUSE_KEYS 20
+
+static __typeof__(*(_XPrivDisplay)NULL) fake_display;
+static Screen fake_screen;
+
+// What the fake server holds
+static long gcs_live;
+static long gcs_created;
+static long pixmaps_live;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+Pixmap XCreatePixmap(Display *dpy, Drawable d, unsigned int width, unsigned int height,
+                     unsigned int depth) {
+    (void)dpy;
+    (void)d;
+    (void)width;
+    (void)height;
+    (void)depth;
+    static Pixmap next_pixmap = 0x100;
+    pixmaps_live++;
+    return next_pixmap++;
+}
+
+int XFreePixmap(Display *dpy, Pixmap pixmap) {
+    (void)dpy;
+    (void)pixmap;
+    pixmaps_live--;
+    return 1;
+}
+
+// GCs are never dereferenced, so any distinct handle will do
+GC XCreateGC(Display *dpy, Drawable d, unsigned long mask, XGCValues *values) {
+    (void)dpy;
+    (void)d;
+    (void)mask;
+    (void)values;
+    gcs_live++;
+    return (GC)(uintptr_t)(0x1000 + ++gcs_created);
+}
+
+int XFreeGC(Display *dpy, GC gc) {
+    (void)dpy;
+    (void)gc;
+    gcs_live--;
+    return 1;
+}
+
+static GCKey make_key(int depth, unsigned long foreground) {
+    GCKey key = { depth, foreground, 0, None, 1, LineSolid };
+    return key;
+}
+
+// Start a check with an empty cache and nothing live
+static void reset_cache(void) {
+    flush_gc_cache();
+    init_gc_cache((Display *)&fake_display, FAKE_ROOT);
+    gcs_live = 0;
+    gcs_created = 0;
+    pixmaps_live = 0;
+}
+
+static int check_reuse(int redraws) {
+    reset_cache();
+
+    double start = now_us();
+    for (int r = 0; r < redraws; r++) {
+        for (int k = 0; k < REUSE_KEYS; k++) {
+            GCKey key = make_key(FAKE_DEPTH, (unsigned long)k);
+            release_gc(acquire_gc(&key));
+        }
+    }
+    double pair_us = (now_us() - start) / ((double)redraws * REUSE_KEYS);
+
+    int ok = gcs_created == REUSE_KEYS && gcs_live == REUSE_KEYS;
+    printf("reuse:     %d keys over %d redraws created %ld GCs, %.3f us per acquire/release  %s\n",
+           REUSE_KEYS, redraws, gcs_created, pair_us, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int check_eviction(void) {
+    reset_cache();
+
+    // Fill every slot, and keep the even keys held
+    GC held[CACHE_SLOTS];
+    for (int k = 0; k < CACHE_SLOTS; k++) {
+        GCKey key = make_key(FAKE_DEPTH, (unsigned long)k);
+        held[k] = acquire_gc(&key);
+        if (k % 2) {
+            release_gc(held[k]);
+        }
+    }
+
+    // Each new key takes an idle slot
+    for (int k = 0; k < CACHE_SLOTS / 2; k++) {
+        GCKey key = make_key(FAKE_DEPTH, (unsigned long)(CACHE_SLOTS + k));
+        release_gc(acquire_gc(&key));
+    }
+    long evicted = gcs_created - gcs_live;
+
+    // The held GCs are still cached: acquiring them again creates nothing
+    long created = gcs_created;
+    int ok = evicted == CACHE_SLOTS / 2;
+    for (int k = 0; k < CACHE_SLOTS; k += 2) {
+        GCKey key = make_key(FAKE_DEPTH, (unsigned long)k);
+        ok &= acquire_gc(&key) == held[k];
+        release_gc(held[k]);
+        release_gc(held[k]);
+    }
+    ok &= gcs_created == created;
+
+    printf("eviction:  %ld idle GCs evicted, %d held GCs kept  %s\n", evicted, CACHE_SLOTS / 2,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int check_overflow(void) {
+    reset_cache();
+
+    GC held[CACHE_SLOTS];
+    for (int k = 0; k < CACHE_SLOTS; k++) {
+        GCKey key = make_key(FAKE_DEPTH, (unsigned long)k);
+        held[k] = acquire_gc(&key);
+    }
+
+    GCKey key = make_key(FAKE_DEPTH, CACHE_SLOTS);
+    GC extra = acquire_gc(&key);
+    int ok = extra != NULL && gcs_live == CACHE_SLOTS + 1;
+    release_gc(extra);
+    ok &= gcs_live == CACHE_SLOTS;
+
+    for (int k = 0; k < CACHE_SLOTS; k++) {
+        release_gc(held[k]);
+    }
+    printf("overflow:  uncached GC freed on release, %ld GCs live  %s\n", gcs_live, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int check_depths(void) {
+    reset_cache();
+
+    for (int r = 0; r < 100; r++) {
+        for (int depth = 1; depth <= 10; depth++) {
+            GCKey key = make_key(depth, (unsigned long)r);
+            release_gc(acquire_gc(&key));
+        }
+    }
+
+    int ok = pixmaps_live == CACHE_DEPTHS;
+    printf("depths:    10 depths over 100 redraws, %ld pixmaps live  %s\n", pixmaps_live,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static int check_flush(void) {
+    // Whatever the previous check left cached is idle
+    flush_gc_cache();
+    int ok = gcs_live == 0;
+    printf("flush:     %ld GCs live after flushing  %s\n", gcs_live, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int redraws = argc > 1 ? atoi(argv[1]) : 1000;
+    if (redraws <= 0) {
+        fprintf(stderr, "Usage: %s [redraws]\n", argv[0]);
+        return 1;
+    }
+
+    fake_screen.root_depth = FAKE_DEPTH;
+    fake_display.screens = &fake_screen;
+    fake_display.nscreens = 1;
+    fake_display.default_screen = 0;
+
+    int ok = 1;
+    ok &= check_reuse(redraws);
+    ok &= check_eviction();
+    ok &= check_overflow();
+    ok &= check_depths();
+    ok &= check_flush();
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/*
+ * registry_bench.c - Micro-benchmark for the window manager's XID registry
+ *
+ * Registers six XIDs per client (client window plus the frame, titlebar
+ * and three buttons the window manager creates), the way window.c does,
+ * and times lookups against a linear scan of the same windows as the
+ * old find_window did. A churn phase then inserts and removes random
+ * XIDs and checks every answer against a reference array.
+ *
+ * Needs the X11 headers but not the X server:
+ *   gcc -O2 -Wall -Wextra -o registry_bench src/bench/registry_bench.c src/wm/registry.c
+ *
+ * Usage: registry_bench [clients] [lookups]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../wm/registry.h"
+
+#define XIDS_PER_CLIENT 6
+#define CHURN_OPS 2000000
+#define CHURN_IDS 50000
+
+// The XIDs of one managed window, as in WMWindow
+typedef struct {
+    Window xids[XIDS_PER_CLIENT];
+} bench_window_t;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Small deterministic generator so runs are repeatable
+static unsigned long long rng_state = 88172645463325252ULL;
+static unsigned long next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned long)rng_state;
+}
+
+// Every X client gets its own resource ID base; the WM's frames share the WM's
+static void make_windows(bench_window_t *windows, int count) {
+    Window wm_base = 0x00200000;
+    for (int i = 0; i < count; i++) {
+        Window client_base = (Window)(i + 2) << 21;
+        windows[i].xids[0] = client_base | 0x0a;
+        for (int j = 1; j < XIDS_PER_CLIENT; j++) {
+            windows[i].xids[j] = wm_base + (Window)(i * (XIDS_PER_CLIENT - 1) + j);
+        }
+    }
+}
+
+// Old find_window: compare every XID of every window
+static bench_window_t *linear_find(bench_window_t *windows, int count, Window xid) {
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < XIDS_PER_CLIENT; j++) {
+            if (windows[i].xids[j] == xid) {
+                return &windows[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Insert and remove random XIDs, checking each answer against a plain array
+static int check_churn(void) {
+    void **reference = (void **)calloc(CHURN_IDS, sizeof(void *));
+    if (!reference) {
+        return 1;
+    }
+
+    Registry reg;
+    registry_init(&reg);
+
+    int failures = 0;
+    unsigned long live = 0;
+    for (long op = 0; op < CHURN_OPS; op++) {
+        unsigned long id = next_random() % CHURN_IDS;
+        Window xid = ((Window)(id % 97 + 2) << 21) | id;
+        void *data = (void *)(reference + id);
+        int role = -1;
+
+        switch (next_random() % 3) {
+            case 0:
+                if (!registry_insert(&reg, xid, (int)(id & 7), data)) {
+                    failures++;
+                }
+                if (!reference[id]) {
+                    live++;
+                }
+                reference[id] = data;
+                break;
+            case 1:
+                if (registry_remove(&reg, xid) != (reference[id] != NULL)) {
+                    failures++;
+                }
+                if (reference[id]) {
+                    live--;
+                }
+                reference[id] = NULL;
+                break;
+            default:
+                if (registry_lookup(&reg, xid, &role) != reference[id] ||
+                    (reference[id] && role != (int)(id & 7))) {
+                    failures++;
+                }
+                break;
+        }
+    }
+
+    if (reg.count != live) {
+        failures++;
+    }
+
+    printf("churn:   %d ops over %d XIDs, %lu live, %d mismatches  %s\n",
+           CHURN_OPS, CHURN_IDS, live, failures, failures ? "FAILED" : "ok");
+
+    registry_destroy(&reg);
+    free(reference);
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int clients = argc > 1 ? atoi(argv[1]) : 2000;
+    long lookups = argc > 2 ? atol(argv[2]) : 10000000;
+    if (clients <= 0 || lookups <= 0) {
+        fprintf(stderr, "Usage: %s [clients] [lookups]\n", argv[0]);
+        return 1;
+    }
+
+    bench_window_t *windows = (bench_window_t *)calloc((size_t)clients, sizeof(bench_window_t));
+    Window *queries = (Window *)malloc(4096 * sizeof(Window));
+    unsigned char *managed = (unsigned char *)malloc(4096);
+    if (!windows || !queries || !managed) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    make_windows(windows, clients);
+
+    Registry reg;
+    registry_init(&reg);
+
+    double start = now_ns();
+    for (int i = 0; i < clients; i++) {
+        for (int j = 0; j < XIDS_PER_CLIENT; j++) {
+            registry_insert(&reg, windows[i].xids[j], j, &windows[i]);
+        }
+    }
+    double insert_ns = (now_ns() - start) / ((double)clients * XIDS_PER_CLIENT);
+
+    // Events name any of a window's XIDs; every eighth is for an unmanaged window
+    for (int i = 0; i < 4096; i++) {
+        int w = (int)(next_random() % (unsigned long)clients);
+        managed[i] = i % 8 != 7;
+        if (managed[i]) {
+            queries[i] = windows[w].xids[next_random() % XIDS_PER_CLIENT];
+        } else {
+            queries[i] = ((Window)(clients + 10 + w) << 21) | 0x0a;
+        }
+    }
+
+    int failures = 0;
+    unsigned long found = 0;
+    start = now_ns();
+    for (long i = 0; i < lookups; i++) {
+        Window xid = queries[i & 4095];
+        int role;
+        bench_window_t *w = (bench_window_t *)registry_lookup(&reg, xid, &role);
+        if (w) {
+            found++;
+            if (w->xids[role] != xid) {
+                failures++;
+            }
+        }
+    }
+    double lookup_ns = (now_ns() - start) / lookups;
+
+    // The scan is slow enough that far fewer lookups give a stable figure
+    long scans = lookups / 1000 > 4096 ? lookups / 1000 : 4096;
+    unsigned long scan_found = 0;
+    start = now_ns();
+    for (long i = 0; i < scans; i++) {
+        if (linear_find(windows, clients, queries[i & 4095])) {
+            scan_found++;
+        }
+    }
+    double scan_ns = (now_ns() - start) / scans;
+
+    unsigned long expected = 0;
+    for (long i = 0; i < lookups; i++) {
+        expected += managed[i & 4095];
+    }
+    if (found != expected) {
+        failures++;
+    }
+
+    printf("%d clients, %lu XIDs, capacity %lu\n", clients, reg.count, reg.capacity);
+    printf("insert:  %.1f ns/XID\n", insert_ns);
+    printf("lookup:  %.1f ns (registry)  %.1f ns (linear scan)  %.0fx\n",
+           lookup_ns, scan_ns, scan_ns / lookup_ns);
+    printf("found:   %lu of %ld registry, %lu of %ld scan\n", found, lookups, scan_found, scans);
+
+    failures += check_churn();
+
+    registry_destroy(&reg);
+    free(managed);
+    free(queries);
+    free(windows);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * state_bench.c - Harness for the window state manager
+ *
+ * Runs the state manager without an X server: find_window is stubbed
+ * with a fake window cache, and the state directory is a scratch
+ * directory. Each phase runs in a child process, as a WM session would:
+ *
+ *   empty:  starting and stopping with no state file writes nothing
+ *   save:   times save_window_state for 2000 windows, and
+ *           store_application_state and remove_window_state for 100;
+ *           their files are gone once the manager has shut down
+ *   reuse:  a window ID reused after its window was removed keeps the
+ *           state stored for the new window, whether the flush thread
+ *           or shutdown writes it
+ *   retry:  a snapshot that cannot be written is written by a later flush
+ *   load:   the snapshot written by the save phase loads back
+ *
+ *   gcc -O2 -Wall -Wextra -DSTATE_DIR='"/tmp/amos_state_bench"' -o state_bench \
+ *       src/bench/state_bench.c src/state/state_manager.c src/wm/registry.c -lpthread
+ *
+ * Usage: state_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../state/state_manager.h"
+#include "../wm/window.h"
+
+#ifndef STATE_DIR
+#error "Build with -DSTATE_DIR pointing at a scratch directory"
+#endif
+
+#define BENCH_WINDOWS 2000
+#define BENCH_SAVE_ROUNDS 50
+#define BENCH_REMOVED 100
+#define BENCH_FIRST_XID 0x400000
+
+static WMWindow fake_window;
+static char fake_title[64];
+
+// Results go here; the state manager's own logging goes to /dev/null
+static FILE *report;
+
+// Stand-in for the window manager's cache
+WMWindow *find_window(Window win) {
+    fake_window.window = win;
+    fake_window.x = (int)(win % 1000);
+    fake_window.y = (int)(win % 700);
+    fake_window.width = 300;
+    fake_window.height = 200;
+    fake_window.group_id = -1;
+    fake_window.tab_id = -1;
+    snprintf(fake_title, sizeof(fake_title), "Window %lu", win);
+    fake_window.title = fake_title;
+    return &fake_window;
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int file_exists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+static void app_state_path(char *path, size_t size, Window win) {
+    snprintf(path, size, "%s/app_state/%lu.state", STATE_DIR, win);
+}
+
+static int phase_empty(void) {
+    init_state_manager();
+    shutdown_state_manager();
+    return !file_exists(STATE_DIR "/windows.state");
+}
+
+static int phase_save(void) {
+    init_state_manager();
+
+    double start = now_us();
+    for (int round = 0; round < BENCH_SAVE_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_WINDOWS; i++) {
+            save_window_state(BENCH_FIRST_XID + i);
+        }
+    }
+    double save_us = (now_us() - start) / (BENCH_SAVE_ROUNDS * BENCH_WINDOWS);
+
+    int value = 42;
+    start = now_us();
+    for (int i = 0; i < BENCH_REMOVED; i++) {
+        store_application_state(BENCH_FIRST_XID + i, &value, sizeof(value));
+    }
+    double store_us = (now_us() - start) / BENCH_REMOVED;
+
+    start = now_us();
+    for (int i = 0; i < BENCH_REMOVED; i++) {
+        remove_window_state(BENCH_FIRST_XID + i);
+    }
+    double remove_us = (now_us() - start) / BENCH_REMOVED;
+
+    shutdown_state_manager();
+
+    int ok = file_exists(STATE_DIR "/windows.state");
+    for (int i = 0; i < BENCH_REMOVED; i++) {
+        char path[256];
+        app_state_path(path, sizeof(path), BENCH_FIRST_XID + i);
+        if (file_exists(path)) {
+            ok = 0;
+        }
+    }
+
+    fprintf(report, "save:   %.2f us per save_window_state, %.2f us per store_application_state, "
+           "%.2f us per remove_window_state\n", save_us, store_us, remove_us);
+    return ok;
+}
+
+// The int in a window's app state file, or -1 if there is none
+static int read_app_state_file(Window win) {
+    char path[256];
+    app_state_path(path, sizeof(path), win);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    size_t size = 0;
+    int value = -1;
+    if (fread(&size, sizeof(size), 1, f) != 1 || size != sizeof(value) ||
+        fread(&value, sizeof(value), 1, f) != 1) {
+        value = -1;
+    }
+    fclose(f);
+    return value;
+}
+
+// The app state an untracked window would get back, or -1 if there is none
+static int retrieve_value(Window win) {
+    size_t size = 0;
+    int *data = (int *)retrieve_application_state(win, &size);
+    int value = data && size == sizeof(int) ? *data : -1;
+    free(data);
+    return value;
+}
+
+static int phase_reuse(void) {
+    init_state_manager();
+    Window reused = BENCH_FIRST_XID;
+    Window closed = BENCH_FIRST_XID + 1;
+    int values[] = {1, 2, 3, 4};
+
+    // The X server hands a closed window's ID to a new one
+    store_application_state(reused, &values[0], sizeof(int));
+    remove_window_state(reused);
+    store_application_state(reused, &values[1], sizeof(int));
+
+    // Until the flush, a closed window reads back as closed
+    store_application_state(closed, &values[2], sizeof(int));
+    remove_window_state(closed);
+    int ok = retrieve_value(closed) == -1;
+
+    // Applied by the flush thread
+    sleep(2);
+    ok &= read_app_state_file(reused) == 2 && read_app_state_file(closed) == -1;
+
+    // Applied at shutdown
+    remove_window_state(reused);
+    store_application_state(reused, &values[3], sizeof(int));
+    shutdown_state_manager();
+    ok &= read_app_state_file(reused) == 4;
+    return ok;
+}
+
+static int phase_retry(void) {
+    init_state_manager();
+
+    // Take the directory away before the first flush can write
+    save_window_state(BENCH_FIRST_XID + BENCH_WINDOWS);
+    system("rm -rf " STATE_DIR);
+    sleep(2);
+
+    // The failed snapshot must still be pending
+    mkdir(STATE_DIR, 0755);
+    sleep(2);
+    int ok = file_exists(STATE_DIR "/windows.state");
+
+    shutdown_state_manager();
+    return ok;
+}
+
+static int phase_load(void) {
+    init_state_manager();
+
+    WindowState state;
+    int ok = get_window_state(BENCH_FIRST_XID + BENCH_WINDOWS - 1, &state) &&
+             state.x == (int)((BENCH_FIRST_XID + BENCH_WINDOWS - 1) % 1000) &&
+             !get_window_state(BENCH_FIRST_XID, &state);
+
+    shutdown_state_manager();
+    return ok;
+}
+
+// Run a phase in a child so each one starts with a fresh state manager
+static int run_phase(const char *name, int (*phase)(void)) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        report = fdopen(dup(STDOUT_FILENO), "w");
+        if (!report || !freopen("/dev/null", "w", stdout) || !freopen("/dev/null", "w", stderr)) {
+            _exit(2);
+        }
+        int ok = phase();
+        fclose(report);
+        _exit(ok ? 0 : 1);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    int ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("%-6s  %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(void) {
+    if (system("rm -rf " STATE_DIR) != 0) {
+        return 1;
+    }
+
+    int ok = 1;
+    ok &= run_phase("empty", phase_empty);
+    ok &= run_phase("save", phase_save);
+    ok &= run_phase("load", phase_load);
+    ok &= run_phase("reuse", phase_reuse);
+    ok &= run_phase("retry", phase_retry);
+
+    system("rm -rf " STATE_DIR);
+    return ok ? 0 : 1;
+}
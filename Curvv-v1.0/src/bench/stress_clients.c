@@ -0,0 +1,162 @@
+/*
+ * stress_clients.c - Map many client windows and time the window manager
+ *
+ * Opens a number of X connections, creates and maps top-level windows
+ * spread across them, and waits until the window manager has framed
+ * every one (ReparentNotify). It then moves the pointer over the
+ * windows, destroys them all and waits until the root window is back to
+ * the children it had before, so frames of dead clients must have been
+ * removed. Run it against a window manager on a throwaway server; see
+ * scripts/wm_stress_xvfb.sh.
+ *
+ *   gcc -O2 -Wall -Wextra -o stress_clients src/bench/stress_clients.c -lX11
+ *
+ * Usage: stress_clients [windows] [connections] [timeout_s]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+#define POINTER_STEPS 2000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+// Children of the root window, including frames and override-redirect windows
+static unsigned int root_children(Display *dpy) {
+    Window root_return, parent;
+    Window *children = NULL;
+    unsigned int count = 0;
+    if (XQueryTree(dpy, DefaultRootWindow(dpy), &root_return, &parent, &children, &count) && children) {
+        XFree(children);
+    }
+    return count;
+}
+
+// Drain every connection, counting ReparentNotify events away from the root
+static int count_reparented(Display **conns, int connections) {
+    int reparented = 0;
+    for (int c = 0; c < connections; c++) {
+        while (XPending(conns[c])) {
+            XEvent ev;
+            XNextEvent(conns[c], &ev);
+            if (ev.type == ReparentNotify && ev.xreparent.parent != DefaultRootWindow(conns[c])) {
+                reparented++;
+            }
+        }
+    }
+    return reparented;
+}
+
+int main(int argc, char **argv) {
+    int windows = argc > 1 ? atoi(argv[1]) : 2000;
+    int connections = argc > 2 ? atoi(argv[2]) : 100;
+    double timeout_ms = (argc > 3 ? atof(argv[3]) : 60.0) * 1000.0;
+    if (windows <= 0 || connections <= 0) {
+        fprintf(stderr, "Usage: %s [windows] [connections] [timeout_s]\n", argv[0]);
+        return 1;
+    }
+    if (connections > windows) {
+        connections = windows;
+    }
+
+    Display **conns = (Display **)calloc((size_t)connections, sizeof(Display *));
+    Window *wins = (Window *)calloc((size_t)windows, sizeof(Window));
+    if (!conns || !wins) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (int c = 0; c < connections; c++) {
+        conns[c] = XOpenDisplay(NULL);
+        if (!conns[c]) {
+            fprintf(stderr, "Cannot open connection %d (server client limit?)\n", c);
+            return 1;
+        }
+    }
+
+    Display *dpy = conns[0];
+    int screen_w = DisplayWidth(dpy, DefaultScreen(dpy));
+    int screen_h = DisplayHeight(dpy, DefaultScreen(dpy));
+    unsigned int baseline = root_children(dpy);
+
+    srand(42);
+    double start = now_ms();
+    for (int i = 0; i < windows; i++) {
+        Display *d = conns[i % connections];
+        int w = 120 + rand() % 200;
+        int h = 80 + rand() % 150;
+        wins[i] = XCreateSimpleWindow(d, DefaultRootWindow(d), rand() % (screen_w - w),
+                                      rand() % (screen_h - h), (unsigned int)w, (unsigned int)h, 0,
+                                      BlackPixel(d, DefaultScreen(d)), WhitePixel(d, DefaultScreen(d)));
+        XSelectInput(d, wins[i], StructureNotifyMask);
+
+        char title[32];
+        snprintf(title, sizeof(title), "stress %d", i);
+        XStoreName(d, wins[i], title);
+        XMapWindow(d, wins[i]);
+    }
+    for (int c = 0; c < connections; c++) {
+        XFlush(conns[c]);
+    }
+
+    int framed = 0;
+    while (framed < windows && now_ms() - start < timeout_ms) {
+        framed += count_reparented(conns, connections);
+        if (framed < windows) {
+            sleep_ms(5);
+        }
+    }
+    double map_ms = now_ms() - start;
+    printf("map:     %d of %d windows framed in %.0f ms (%d connections)\n",
+           framed, windows, map_ms, connections);
+
+    // Sweep the pointer across the desktop so every step crosses windows
+    start = now_ms();
+    for (int i = 0; i < POINTER_STEPS; i++) {
+        XWarpPointer(dpy, None, DefaultRootWindow(dpy), 0, 0, 0, 0,
+                     (i * 7) % screen_w, (i * 5) % screen_h);
+    }
+    // Only the server's side is timed; the script reports the WM's CPU time
+    XSync(dpy, False);
+    double pointer_ms = now_ms() - start;
+    printf("pointer: %d warps in %.0f ms\n", POINTER_STEPS, pointer_ms);
+
+    start = now_ms();
+    for (int i = 0; i < windows; i++) {
+        XDestroyWindow(conns[i % connections], wins[i]);
+    }
+    for (int c = 0; c < connections; c++) {
+        XSync(conns[c], True);
+    }
+
+    unsigned int remaining = root_children(dpy);
+    while (remaining > baseline && now_ms() - start < timeout_ms) {
+        sleep_ms(5);
+        remaining = root_children(dpy);
+    }
+    double destroy_ms = now_ms() - start;
+    printf("destroy: root back to %u of %u children in %.0f ms\n", remaining, baseline, destroy_ms);
+
+    int ok = framed == windows && remaining <= baseline;
+    printf("%s\n", ok ? "ok" : "FAILED");
+
+    for (int c = 0; c < connections; c++) {
+        XCloseDisplay(conns[c]);
+    }
+    free(wins);
+    free(conns);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+/*
+ * theme_bench.c - Harness for theme loading and its pixel cache
+ *
+ * Runs themes.c against a fake display whose default visual can be
+ * switched between TrueColor and PseudoColor, and a fake XCB connection
+ * that answers color allocations locally:
+ *
+ *   truecolor:  loads need no server requests; times a cold load and a
+ *               switch between cached themes; every load flushes the
+ *               GC cache, whose GCs hold the old theme's colors
+ *   failure:    a color the colormap cannot allocate falls back to
+ *               BlackPixel and is allocated again on the next load
+ *   eviction:   loading a theme on more colormaps than the cache holds
+ *               gives the evicted entries' colors back to their colormaps
+ *
+ * Needs the X11 and XCB headers but neither library nor a server:
+ *   gcc -O2 -Wall -Wextra -o theme_bench src/bench/theme_bench.c src/ui/themes.c
+ *
+ * Usage: theme_bench [switches]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+
+#include "../ui/themes.h"
+#include "../ui/gc_cache.h"
+
+#define FAKE_COLORMAPS 16
+#define FAKE_BLACK_PIXEL 0
+#define FAKE_ALLOCATED_BIT 0x1000000UL  // Set in every pixel the fake colormap hands out
+#define THEME_COLORS 25                  // Colors each theme allocates
+
+// The display themes.c draws on
+Display *display;
+int screen;
+
+static __typeof__(*(_XPrivDisplay)NULL) fake_display;
+static Screen fake_screen;
+static Visual fake_visual;
+
+// Fake colormaps: live cells per colormap, and a color that cannot be allocated
+static long live_cells[FAKE_COLORMAPS];
+static unsigned int failing_rgb = 0xffffffff;
+static int bad_frees;
+
+// Outstanding alloc requests, indexed by sequence number
+typedef struct {
+    xcb_colormap_t cmap;
+    unsigned int rgb;
+} fake_alloc_t;
+
+static fake_alloc_t fake_allocs[4096];
+static unsigned int sent_sequence;
+static unsigned long alloc_requests;
+static unsigned long gc_flushes;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+xcb_connection_t *XGetXCBConnection(Display *dpy) {
+    return (xcb_connection_t *)dpy;
+}
+
+int xcb_flush(xcb_connection_t *c) {
+    (void)c;
+    return 1;
+}
+
+xcb_alloc_color_cookie_t xcb_alloc_color(xcb_connection_t *c, xcb_colormap_t cmap,
+                                         uint16_t red, uint16_t green, uint16_t blue) {
+    (void)c;
+    unsigned int sequence = ++sent_sequence % 4096;
+    fake_allocs[sequence].cmap = cmap;
+    fake_allocs[sequence].rgb = (unsigned int)(red >> 8) << 16 | (unsigned int)(green >> 8) << 8 | (blue >> 8);
+    alloc_requests++;
+    xcb_alloc_color_cookie_t cookie = { sequence };
+    return cookie;
+}
+
+xcb_alloc_color_reply_t *xcb_alloc_color_reply(xcb_connection_t *c, xcb_alloc_color_cookie_t cookie,
+                                               xcb_generic_error_t **e) {
+    (void)c;
+    (void)e;
+    const fake_alloc_t *alloc = &fake_allocs[cookie.sequence];
+    if (alloc->rgb == failing_rgb || alloc->cmap >= FAKE_COLORMAPS) {
+        return NULL;
+    }
+    xcb_alloc_color_reply_t *reply = (xcb_alloc_color_reply_t *)calloc(1, sizeof(*reply));
+    if (reply) {
+        reply->pixel = FAKE_ALLOCATED_BIT | alloc->rgb;
+        live_cells[alloc->cmap]++;
+    }
+    return reply;
+}
+
+int XFreeColors(Display *dpy, Colormap cmap, unsigned long *pixels, int npixels, unsigned long planes) {
+    (void)dpy;
+    (void)planes;
+    for (int i = 0; i < npixels; i++) {
+        if (cmap >= FAKE_COLORMAPS || !(pixels[i] & FAKE_ALLOCATED_BIT) || live_cells[cmap] <= 0) {
+            bad_frees++;
+            continue;
+        }
+        live_cells[cmap]--;
+    }
+    return 1;
+}
+
+void flush_gc_cache() {
+    gc_flushes++;
+}
+
+VisualID XVisualIDFromVisual(Visual *visual) {
+    return visual->visualid;
+}
+
+int XSetWindowBackground(Display *dpy, Window w, unsigned long pixel) {
+    (void)dpy;
+    (void)w;
+    (void)pixel;
+    return 1;
+}
+
+int XSetWindowBorder(Display *dpy, Window w, unsigned long pixel) {
+    (void)dpy;
+    (void)w;
+    (void)pixel;
+    return 1;
+}
+
+int XClearWindow(Display *dpy, Window w) {
+    (void)dpy;
+    (void)w;
+    return 1;
+}
+
+static void use_visual(int class, VisualID id, Colormap cmap) {
+    fake_visual.class = class;
+    fake_visual.visualid = id;
+    fake_visual.red_mask = class == TrueColor ? 0xff0000 : 0;
+    fake_visual.green_mask = class == TrueColor ? 0x00ff00 : 0;
+    fake_visual.blue_mask = class == TrueColor ? 0x0000ff : 0;
+    fake_screen.root_visual = &fake_visual;
+    fake_screen.cmap = cmap;
+}
+
+static long total_live_cells(void) {
+    long total = 0;
+    for (int i = 0; i < FAKE_COLORMAPS; i++) {
+        total += live_cells[i];
+    }
+    return total;
+}
+
+static int check_truecolor(int switches) {
+    use_visual(TrueColor, 0x21, 1);
+    Theme theme = { 0 };
+
+    double start = now_us();
+    load_theme(&theme, "default");
+    double cold_us = now_us() - start;
+    load_theme(&theme, "dark");
+    load_theme(&theme, "light");
+
+    static const char *names[] = { "default", "dark", "light" };
+    start = now_us();
+    for (int i = 0; i < switches; i++) {
+        load_theme(&theme, names[i % 3]);
+    }
+    double switch_us = (now_us() - start) / switches;
+
+    load_theme(&theme, "default");
+    int ok = alloc_requests == 0 && theme.bg_color == 0xd6d6d6 && theme.title_active_bg_color == 0x5294e2 &&
+             gc_flushes == (unsigned long)switches + 4;
+    printf("truecolor: cold load %.2f us, switch %.2f us, %lu requests, %lu GC cache flushes  %s\n",
+           cold_us, switch_us, alloc_requests, gc_flushes, ok ? "ok" : "FAILED");
+
+    free_theme(&theme);
+    return ok;
+}
+
+static int check_failure(void) {
+    use_visual(PseudoColor, 0x22, 1);
+    Theme theme = { 0 };
+
+    // The active title color is in every theme; the colormap is out of room for it
+    failing_rgb = 0x5294e2;
+    load_theme(&theme, "default");
+    int fell_back = theme.title_active_bg_color == FAKE_BLACK_PIXEL &&
+                    theme.bg_color == (FAKE_ALLOCATED_BIT | 0xd6d6d6);
+
+    failing_rgb = 0xffffffff;
+    unsigned long before = alloc_requests;
+    load_theme(&theme, "default");
+    unsigned long retried = alloc_requests - before;
+    int recovered = theme.title_active_bg_color == (FAKE_ALLOCATED_BIT | 0x5294e2);
+
+    before = alloc_requests;
+    load_theme(&theme, "default");
+    int cached = alloc_requests == before;
+
+    // Only the colors that failed are asked for again
+    int ok = fell_back && recovered && retried > 0 && retried < THEME_COLORS && cached &&
+             live_cells[1] == THEME_COLORS;
+    printf("failure:   fallback %s, retried %lu of %d colors, then cached  %s\n",
+           fell_back ? "BlackPixel" : "wrong", retried, THEME_COLORS, ok ? "ok" : "FAILED");
+
+    free_theme(&theme);
+    return ok;
+}
+
+static int check_eviction(void) {
+    Theme theme = { 0 };
+
+    // Colormap 1 already holds the default theme from the failure phase
+    long peak = 0;
+    for (Colormap cmap = 2; cmap < FAKE_COLORMAPS; cmap++) {
+        use_visual(PseudoColor, 0x22, cmap);
+        load_theme(&theme, "default");
+        if (total_live_cells() > peak) {
+            peak = total_live_cells();
+        }
+    }
+
+    // Only the four newest colormaps still hold the theme's colors
+    int ok = peak <= 4 * THEME_COLORS && total_live_cells() == 4 * THEME_COLORS &&
+             live_cells[FAKE_COLORMAPS - 1] == THEME_COLORS && live_cells[1] == 0 && bad_frees == 0;
+    printf("eviction:  %d colormaps, peak %ld cells, %ld live, %d bad frees  %s\n",
+           FAKE_COLORMAPS - 1, peak, total_live_cells(), bad_frees, ok ? "ok" : "FAILED");
+
+    free_theme(&theme);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int switches = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (switches <= 0) {
+        fprintf(stderr, "Usage: %s [switches]\n", argv[0]);
+        return 1;
+    }
+
+    fake_screen.black_pixel = FAKE_BLACK_PIXEL;
+    fake_screen.white_pixel = 0xffffff;
+    fake_display.screens = &fake_screen;
+    fake_display.nscreens = 1;
+    display = (Display *)&fake_display;
+    screen = 0;
+
+    int ok = 1;
+    ok &= check_truecolor(switches);
+    ok &= check_failure();
+    ok &= check_eviction();
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
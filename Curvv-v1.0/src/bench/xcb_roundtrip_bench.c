@@ -0,0 +1,312 @@
+/*
+ * xcb_roundtrip_bench.c - Count the round trips the XCB backend makes
+ *
+ * Links xcb_backend.c against a fake XCB connection that answers every
+ * request locally and counts round trips the way a real connection
+ * incurs them: waiting for a reply whose request the server has not
+ * answered yet costs one round trip, which answers everything sent
+ * before it. Fetching a batch of windows must cost one round trip
+ * however large the batch, including windows that vanish meanwhile.
+ *
+ * Needs the X11 and XCB headers but neither library nor a server:
+ *   gcc -O2 -Wall -Wextra -o xcb_roundtrip_bench src/bench/xcb_roundtrip_bench.c src/wm/xcb_backend.c
+ *
+ * Usage: xcb_roundtrip_bench [windows]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+
+#include "../wm/xcb_backend.h"
+
+// Windows with an XID divisible by this are destroyed before the replies arrive
+#define VANISHED_EVERY 7
+
+// Fake connection state
+static unsigned int sent_sequence;       // Last request sent
+static unsigned int answered_sequence;   // Last request the server has answered
+static unsigned long requests;
+static unsigned long round_trips;
+
+// Wait for the reply to a request, as xcb_wait_for_reply would
+static void wait_for(unsigned int sequence) {
+    if (sequence > answered_sequence) {
+        // Unflushed requests are flushed first; the server answers them all
+        round_trips++;
+        answered_sequence = sent_sequence;
+    }
+}
+
+static unsigned int send_request(void) {
+    requests++;
+    return ++sent_sequence;
+}
+
+// Remember what each request asked for, indexed by sequence number
+typedef struct {
+    xcb_window_t window;
+    xcb_atom_t property;
+} fake_request_t;
+
+static fake_request_t *fake_requests;
+static unsigned int fake_request_capacity;
+
+static unsigned int record_request(xcb_window_t window, xcb_atom_t property) {
+    unsigned int sequence = send_request();
+    if (sequence >= fake_request_capacity) {
+        fake_request_capacity = fake_request_capacity ? fake_request_capacity * 2 : 1024;
+        fake_requests = (fake_request_t *)realloc(fake_requests,
+                                                  fake_request_capacity * sizeof(fake_request_t));
+        if (!fake_requests) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    fake_requests[sequence].window = window;
+    fake_requests[sequence].property = property;
+    return sequence;
+}
+
+static int window_exists(xcb_window_t window) {
+    return window % VANISHED_EVERY != 0;
+}
+
+xcb_connection_t *XGetXCBConnection(Display *dpy) {
+    return (xcb_connection_t *)dpy;
+}
+
+int xcb_flush(xcb_connection_t *c) {
+    (void)c;
+    return 1;
+}
+
+const xcb_setup_t *xcb_get_setup(xcb_connection_t *c) {
+    (void)c;
+    static xcb_setup_t setup;
+    setup.resource_id_base = 0x00200000;
+    setup.resource_id_mask = 0x001fffff;
+    return &setup;
+}
+
+xcb_intern_atom_cookie_t xcb_intern_atom(xcb_connection_t *c, uint8_t only_if_exists,
+                                         uint16_t name_len, const char *name) {
+    (void)c;
+    (void)only_if_exists;
+    (void)name_len;
+    (void)name;
+    xcb_intern_atom_cookie_t cookie = { record_request(None, None) };
+    return cookie;
+}
+
+xcb_intern_atom_reply_t *xcb_intern_atom_reply(xcb_connection_t *c, xcb_intern_atom_cookie_t cookie,
+                                               xcb_generic_error_t **e) {
+    (void)c;
+    (void)e;
+    wait_for(cookie.sequence);
+    xcb_intern_atom_reply_t *reply = (xcb_intern_atom_reply_t *)calloc(1, sizeof(*reply));
+    if (reply) {
+        reply->atom = 300 + cookie.sequence;
+    }
+    return reply;
+}
+
+xcb_get_window_attributes_cookie_t xcb_get_window_attributes(xcb_connection_t *c, xcb_window_t window) {
+    (void)c;
+    xcb_get_window_attributes_cookie_t cookie = { record_request(window, None) };
+    return cookie;
+}
+
+xcb_get_window_attributes_reply_t *xcb_get_window_attributes_reply(xcb_connection_t *c,
+                                                                   xcb_get_window_attributes_cookie_t cookie,
+                                                                   xcb_generic_error_t **e) {
+    (void)c;
+    (void)e;
+    wait_for(cookie.sequence);
+    if (!window_exists(fake_requests[cookie.sequence].window)) {
+        return NULL;
+    }
+    xcb_get_window_attributes_reply_t *reply = (xcb_get_window_attributes_reply_t *)calloc(1, sizeof(*reply));
+    if (reply) {
+        reply->map_state = XCB_MAP_STATE_VIEWABLE;
+        reply->_class = XCB_WINDOW_CLASS_INPUT_OUTPUT;
+    }
+    return reply;
+}
+
+xcb_get_geometry_cookie_t xcb_get_geometry(xcb_connection_t *c, xcb_drawable_t drawable) {
+    (void)c;
+    xcb_get_geometry_cookie_t cookie = { record_request(drawable, None) };
+    return cookie;
+}
+
+xcb_get_geometry_reply_t *xcb_get_geometry_reply(xcb_connection_t *c, xcb_get_geometry_cookie_t cookie,
+                                                 xcb_generic_error_t **e) {
+    (void)c;
+    (void)e;
+    wait_for(cookie.sequence);
+    xcb_window_t window = fake_requests[cookie.sequence].window;
+    if (!window_exists(window)) {
+        return NULL;
+    }
+    xcb_get_geometry_reply_t *reply = (xcb_get_geometry_reply_t *)calloc(1, sizeof(*reply));
+    if (reply) {
+        reply->x = (int16_t)(window % 1000);
+        reply->y = (int16_t)(window % 700);
+        reply->width = 300;
+        reply->height = 200;
+    }
+    return reply;
+}
+
+xcb_get_property_cookie_t xcb_get_property(xcb_connection_t *c, uint8_t _delete, xcb_window_t window,
+                                           xcb_atom_t property, xcb_atom_t type,
+                                           uint32_t long_offset, uint32_t long_length) {
+    (void)c;
+    (void)_delete;
+    (void)type;
+    (void)long_offset;
+    (void)long_length;
+    xcb_get_property_cookie_t cookie = { record_request(window, property) };
+    return cookie;
+}
+
+// Odd windows have a UTF-8 name, the others only WM_NAME
+xcb_get_property_reply_t *xcb_get_property_reply(xcb_connection_t *c, xcb_get_property_cookie_t cookie,
+                                                 xcb_generic_error_t **e) {
+    (void)c;
+    (void)e;
+    wait_for(cookie.sequence);
+    const fake_request_t *request = &fake_requests[cookie.sequence];
+    if (!window_exists(request->window)) {
+        return NULL;
+    }
+
+    char title[64] = "";
+    int utf8 = request->window % 2 == 1;
+    if ((request->property == XCB_ATOM_WM_NAME) != utf8) {
+        snprintf(title, sizeof(title), "%s %u", utf8 ? "Client" : "Legacy", request->window);
+    }
+
+    size_t length = strlen(title);
+    xcb_get_property_reply_t *reply = (xcb_get_property_reply_t *)calloc(1, sizeof(*reply) + length + 1);
+    if (reply) {
+        reply->format = length ? 8 : 0;
+        reply->value_len = (uint32_t)length;
+        memcpy(reply + 1, title, length);
+    }
+    return reply;
+}
+
+int xcb_get_property_value_length(const xcb_get_property_reply_t *R) {
+    return (int)R->value_len;
+}
+
+void *xcb_get_property_value(const xcb_get_property_reply_t *R) {
+    return (void *)(R + 1);
+}
+
+xcb_query_tree_cookie_t xcb_query_tree(xcb_connection_t *c, xcb_window_t window) {
+    (void)c;
+    xcb_query_tree_cookie_t cookie = { record_request(window, None) };
+    return cookie;
+}
+
+xcb_query_tree_reply_t *xcb_query_tree_reply(xcb_connection_t *c, xcb_query_tree_cookie_t cookie,
+                                             xcb_generic_error_t **e) {
+    (void)c;
+    (void)e;
+    wait_for(cookie.sequence);
+    return NULL;
+}
+
+int xcb_query_tree_children_length(const xcb_query_tree_reply_t *R) {
+    return R->children_len;
+}
+
+xcb_window_t *xcb_query_tree_children(const xcb_query_tree_reply_t *R) {
+    return (xcb_window_t *)(R + 1);
+}
+
+// Check one batch; returns 1 if it behaved
+static int check_batch(int count) {
+    Window *windows = (Window *)malloc(count * sizeof(Window));
+    ClientInfo *info = (ClientInfo *)malloc(count * sizeof(ClientInfo));
+    if (!windows || !info) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++) {
+        windows[i] = 0x00400001 + i;
+    }
+
+    unsigned long trips_before = round_trips;
+    unsigned long requests_before = requests;
+    int valid = fetch_client_info(windows, count, info);
+    unsigned long trips = round_trips - trips_before;
+
+    int expected_valid = 0;
+    int ok = 1;
+    for (int i = 0; i < count; i++) {
+        if (!window_exists((xcb_window_t)windows[i])) {
+            ok &= !info[i].valid;
+            continue;
+        }
+        expected_valid++;
+
+        char expected[64];
+        snprintf(expected, sizeof(expected), "%s %lu", windows[i] % 2 ? "Client" : "Legacy", windows[i]);
+        ok &= info[i].valid && info[i].title && strcmp(info[i].title, expected) == 0 &&
+              info[i].x == (int)(windows[i] % 1000);
+    }
+    ok &= valid == expected_valid && trips == 1;
+
+    printf("fetch:  %5d windows, %6lu requests, %lu round trip%s, %d still exist  %s\n",
+           count, requests - requests_before, trips, trips == 1 ? "" : "s", valid, ok ? "ok" : "FAILED");
+
+    free_client_info(info, count);
+    free(info);
+    free(windows);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    if (count <= 0) {
+        fprintf(stderr, "Usage: %s [windows]\n", argv[0]);
+        return 1;
+    }
+
+    int ok = 1;
+
+    unsigned long trips_before = round_trips;
+    ok &= init_xcb_backend((Display *)&ok);
+    printf("atoms:  %lu round trip%s\n", round_trips - trips_before,
+           round_trips - trips_before == 1 ? "" : "s");
+    ok &= round_trips - trips_before == 1;
+
+    ok &= check_batch(1);
+    ok &= check_batch(100);
+    ok &= check_batch(count);
+
+    Window titled[64];
+    char *titles[64];
+    for (int i = 0; i < 64; i++) {
+        titled[i] = 0x00500001 + i;
+    }
+    trips_before = round_trips;
+    fetch_window_titles(titled, 64, titles);
+    unsigned long title_trips = round_trips - trips_before;
+    printf("titles: 64 windows, %lu round trip%s\n", title_trips, title_trips == 1 ? "" : "s");
+    ok &= title_trips == 1;
+    for (int i = 0; i < 64; i++) {
+        free(titles[i]);
+    }
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    free(fake_requests);
+    return ok ? 0 : 1;
+}
@@ -4,13 +4,24 @@
  * This module provides functionality to store and retrieve window state,
  * as well as application-specific data, allowing for persistence between
  * sessions or when windows are redrawn.
+ *
+ * Window state changes only mark the in-memory table dirty. A background
+ * thread writes it out at most once per STATE_FLUSH_INTERVAL_MS, and on
+ * shutdown, as a binary snapshot: written to a temporary file, synced and
+ * renamed over the previous one, so a crash never leaves a torn file.
+ * Application state files are written, and those of removed windows
+ * deleted, by the same thread in the order they were requested, so
+ * neither storing state nor closing a window waits on the disk.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
@@ -18,53 +29,123 @@
 
 #include "state_manager.h"
 #include "../wm/window.h"
+#include "../wm/registry.h"
 
-#define MAX_WINDOWS 128
+#ifndef STATE_DIR
 #define STATE_DIR "/var/amos/state"
+#endif
 #define WINDOW_STATE_FILE STATE_DIR "/windows.state"
+#define WINDOW_STATE_TEMP_FILE STATE_DIR "/windows.state.tmp"
 #define APP_STATE_DIR STATE_DIR "/app_state"
 
-// In-memory representation of window states
-static WindowState window_states[MAX_WINDOWS];
+// Snapshot format: "AMWS", version, record count, then one record per window
+#define SNAPSHOT_MAGIC 0x53574D41u
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_HEADER_SIZE 12
+#define SNAPSHOT_RECORD_SIZE 42   // Fixed part; the title follows
+#define SNAPSHOT_FLAG_MINIMIZED 0x01
+#define SNAPSHOT_FLAG_MAXIMIZED 0x02
+
+// Longest interval between a change and its snapshot
+#define STATE_FLUSH_INTERVAL_MS 1000
+
+// In-memory representation of window states, in the order they were added
+static WindowState **window_states = NULL;
 static int window_state_count = 0;
+static int window_state_capacity = 0;
+
+// Window ID to state lookup
+static Registry state_registry;
 
-// Display connection - set during initialization
-static Display *display = NULL;
+// Background flusher; state_lock guards everything above
+static pthread_mutex_t state_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t write_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t app_state_io_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t flush_thread;
+static int flush_thread_running = 0;
+static int states_dirty = 0;
+static int states_changed = 0;  // Set by any change since startup
+static int states_loaded = 0;   // A state file was read at startup
+
+// Application state file writes and deletions, in the order they were made
+typedef struct {
+    Window window;
+    void *data;     // Contents of a write
+    size_t size;
+    int remove;     // Delete the file instead of writing it
+} AppStateOp;
+
+static AppStateOp *app_state_ops = NULL;
+static int app_state_op_count = 0;
+static int app_state_op_capacity = 0;
+
+// Serialized snapshot
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+} SnapshotBuffer;
 
 // Forward declarations
 static void ensure_state_dirs_exist();
-static int find_window_state_index(Window win);
+static WindowState *find_window_state(Window win);
+static WindowState *new_window_state(Window win);
+static WindowState *add_window_state_locked(Window win);
+static void mark_states_dirty();
+static void *state_flush_thread(void *arg);
 static void read_window_state_file();
-static void write_window_state_file();
+static int write_window_state_file();
+static int queue_app_state_op_locked(Window win, const void *data, size_t size, int remove);
+static void apply_app_state_ops();
+static void *read_app_state(Window win, size_t *size);
 
 // Initialize the state manager
 void init_state_manager() {
     printf("Initializing state manager...\n");
     
-    // Get the display connection from the WM
-    display = XOpenDisplay(NULL);
-    if (!display) {
-        fprintf(stderr, "State manager: cannot connect to X display\n");
-        return;
-    }
-    
     // Make sure state directories exist
     ensure_state_dirs_exist();
     
-    // Initialize window state array
-    for (int i = 0; i < MAX_WINDOWS; i++) {
-        window_states[i].window = None;
-        window_states[i].title = NULL;
-        window_states[i].application_state = NULL;
-        window_states[i].app_state_size = 0;
-    }
+    // Start with no states; the table grows as windows are added
+    registry_init(&state_registry);
     
     // Load saved states
     read_window_state_file();
     
+    // Start the write-behind thread
+    flush_thread_running = 1;
+    if (pthread_create(&flush_thread, NULL, state_flush_thread, NULL) != 0) {
+        fprintf(stderr, "Failed to start state flush thread; state is saved on exit only\n");
+        flush_thread_running = 0;
+    }
+    
     printf("State manager initialized\n");
 }
 
+// Stop the flush thread and write the final snapshot
+void shutdown_state_manager() {
+    pthread_mutex_lock(&state_lock);
+    int running = flush_thread_running;
+    flush_thread_running = 0;
+    pthread_cond_signal(&flush_cond);
+    pthread_mutex_unlock(&state_lock);
+    
+    if (running) {
+        pthread_join(flush_thread, NULL);
+    }
+    
+    apply_app_state_ops();
+    
+    // Nothing to write if there was no state file and nothing changed
+    pthread_mutex_lock(&state_lock);
+    int needs_write = states_loaded || states_changed;
+    pthread_mutex_unlock(&state_lock);
+    if (needs_write) {
+        save_all_window_states();
+    }
+}
+
 // Ensure state directories exist
 static void ensure_state_dirs_exist() {
     struct stat st = {0};
@@ -84,26 +165,51 @@ static void ensure_state_dirs_exist() {
     }
 }
 
-// Add a window to state management
-void add_window_state(Window win) {
-    if (window_state_count >= MAX_WINDOWS) {
-        fprintf(stderr, "Maximum number of window states reached\n");
-        return;
+// Allocate a state for a window and register it
+static WindowState *new_window_state(Window win) {
+    // Grow the state array as needed
+    if (window_state_count == window_state_capacity) {
+        int capacity = window_state_capacity ? window_state_capacity * 2 : 64;
+        WindowState **grown = (WindowState **)realloc(window_states, capacity * sizeof(WindowState *));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow window state table\n");
+            return NULL;
+        }
+        window_states = grown;
+        window_state_capacity = capacity;
     }
     
+    WindowState *state = (WindowState *)calloc(1, sizeof(WindowState));
+    if (!state) {
+        fprintf(stderr, "Failed to allocate window state\n");
+        return NULL;
+    }
+    
+    if (!registry_insert(&state_registry, win, 0, state)) {
+        free(state);
+        return NULL;
+    }
+    
+    state->window = win;
+    window_states[window_state_count++] = state;
+    return state;
+}
+
+// Add a window to state management; state_lock must be held
+static WindowState *add_window_state_locked(Window win) {
     // Check if this window is already tracked
-    for (int i = 0; i < window_state_count; i++) {
-        if (window_states[i].window == win) {
-            return;  // Already tracked
-        }
+    WindowState *state = find_window_state(win);
+    if (state) {
+        return state;  // Already tracked
     }
     
     // Add the window to our state tracking
-    int idx = window_state_count++;
-    WindowState *state = &window_states[idx];
+    state = new_window_state(win);
+    if (!state) {
+        return NULL;
+    }
     
     // Initialize with default values
-    state->window = win;
     state->x = 0;
     state->y = 0;
     state->width = 300;
@@ -117,172 +223,461 @@ void add_window_state(Window win) {
     state->application_state = NULL;
     state->app_state_size = 0;
     
-    // Get the window's current geometry
-    XWindowAttributes attr;
-    if (XGetWindowAttributes(display, win, &attr)) {
-        state->width = attr.width;
-        state->height = attr.height;
-        state->x = attr.x;
-        state->y = attr.y;
-    }
-    
-    // Get the window title
-    XTextProperty text_prop;
-    if (XGetWMName(display, win, &text_prop) && text_prop.value) {
-        state->title = strdup((char *)text_prop.value);
-        XFree(text_prop.value);
-    } else {
-        state->title = strdup("Untitled");
+    // Take the geometry and title from the WM's cache
+    WMWindow *w = find_window(win);
+    if (w) {
+        state->width = w->width;
+        state->height = w->height;
+        state->x = w->x;
+        state->y = w->y;
     }
+    state->title = strdup(w && w->title ? w->title : "Untitled");
     
     printf("Added window state for %lu: %s (%d,%d) %dx%d\n", 
            win, state->title, state->x, state->y, state->width, state->height);
+    return state;
+}
+
+// Add a window to state management
+void add_window_state(Window win) {
+    pthread_mutex_lock(&state_lock);
+    add_window_state_locked(win);
+    pthread_mutex_unlock(&state_lock);
+    mark_states_dirty();
 }
 
 // Remove a window from state management
 void remove_window_state(Window win) {
-    int idx = find_window_state_index(win);
-    if (idx == -1) {
+    pthread_mutex_lock(&state_lock);
+    WindowState *state = find_window_state(win);
+    if (!state) {
+        pthread_mutex_unlock(&state_lock);
         return;  // Not found
     }
     
     // Free resources
-    if (window_states[idx].title) {
-        free(window_states[idx].title);
+    if (state->title) {
+        free(state->title);
     }
     
-    if (window_states[idx].application_state) {
-        free(window_states[idx].application_state);
+    if (state->application_state) {
+        free(state->application_state);
     }
     
-    // Remove app state file if it exists
-    char filename[256];
-    snprintf(filename, sizeof(filename), "%s/%lu.state", APP_STATE_DIR, win);
-    unlink(filename);
+    // The flush thread removes the app state file, if there is one
+    if (!queue_app_state_op_locked(win, NULL, 0, 1)) {
+        fprintf(stderr, "Failed to queue app state file of window %lu for removal\n", win);
+    }
     
-    // Remove the state by shifting everything down
+    // Remove the state by shifting everything after it down
+    int idx = 0;
+    while (window_states[idx] != state) {
+        idx++;
+    }
     for (int i = idx; i < window_state_count - 1; i++) {
         window_states[i] = window_states[i + 1];
     }
     
     window_state_count--;
+    registry_remove(&state_registry, win);
+    free(state);
+    pthread_mutex_unlock(&state_lock);
+    mark_states_dirty();
     
     printf("Removed window state for %lu\n", win);
 }
 
-// Find the index of a window in our state array
-static int find_window_state_index(Window win) {
-    for (int i = 0; i < window_state_count; i++) {
-        if (window_states[i].window == win) {
-            return i;
+// Find the state of a window; state_lock must be held
+static WindowState *find_window_state(Window win) {
+    return (WindowState *)registry_lookup(&state_registry, win, NULL);
+}
+
+// Record that the table changed; the flush thread writes it out later
+static void mark_states_dirty() {
+    pthread_mutex_lock(&state_lock);
+    states_changed = 1;
+    if (!states_dirty) {
+        states_dirty = 1;
+        pthread_cond_signal(&flush_cond);
+    }
+    pthread_mutex_unlock(&state_lock);
+}
+
+// Queue a write or deletion of a window's app state file; state_lock must be held
+static int queue_app_state_op_locked(Window win, const void *data, size_t size, int remove) {
+    if (app_state_op_count == app_state_op_capacity) {
+        int capacity = app_state_op_capacity ? app_state_op_capacity * 2 : 16;
+        AppStateOp *grown = (AppStateOp *)realloc(app_state_ops, capacity * sizeof(AppStateOp));
+        if (!grown) {
+            return 0;
+        }
+        app_state_ops = grown;
+        app_state_op_capacity = capacity;
+    }
+    
+    AppStateOp *op = &app_state_ops[app_state_op_count];
+    op->window = win;
+    op->data = NULL;
+    op->size = remove ? 0 : size;
+    op->remove = remove;
+    if (op->size > 0) {
+        op->data = malloc(op->size);
+        if (!op->data) {
+            return 0;
+        }
+        memcpy(op->data, data, op->size);
+    }
+    app_state_op_count++;
+    
+    // Wake the flush thread if it is idle; it applies the queue with the next snapshot
+    if (app_state_op_count == 1 && !states_dirty) {
+        pthread_cond_signal(&flush_cond);
+    }
+    return 1;
+}
+
+// Apply queued app state file operations in order. app_state_io_lock keeps
+// batches in order too, so a deletion never overtakes a later write to a
+// reused window ID.
+static void apply_app_state_ops() {
+    pthread_mutex_lock(&app_state_io_lock);
+    pthread_mutex_lock(&state_lock);
+    AppStateOp *ops = app_state_ops;
+    int count = app_state_op_count;
+    app_state_ops = NULL;
+    app_state_op_count = 0;
+    app_state_op_capacity = 0;
+    pthread_mutex_unlock(&state_lock);
+    
+    for (int i = 0; i < count; i++) {
+        char filename[256];
+        snprintf(filename, sizeof(filename), "%s/%lu.state", APP_STATE_DIR, ops[i].window);
+        
+        if (ops[i].remove) {
+            unlink(filename);
+            continue;
+        }
+        
+        FILE *f = fopen(filename, "wb");
+        if (f) {
+            fwrite(&ops[i].size, sizeof(size_t), 1, f);
+            if (ops[i].size > 0) {
+                fwrite(ops[i].data, 1, ops[i].size, f);
+            }
+            fclose(f);
+        } else {
+            fprintf(stderr, "Failed to write app state file for window %lu: %s\n", 
+                    ops[i].window, strerror(errno));
         }
+        free(ops[i].data);
     }
-    return -1;
+    pthread_mutex_unlock(&app_state_io_lock);
+    
+    free(ops);
 }
 
 // Save the state of a window
 void save_window_state(Window win) {
-    int idx = find_window_state_index(win);
-    if (idx == -1) {
-        add_window_state(win);
-        idx = find_window_state_index(win);
-        if (idx == -1) return;  // Failed to add
-    }
-    
-    // Get the window's current geometry
-    XWindowAttributes attr;
-    if (XGetWindowAttributes(display, win, &attr)) {
-        window_states[idx].width = attr.width;
-        window_states[idx].height = attr.height;
-        window_states[idx].x = attr.x;
-        window_states[idx].y = attr.y;
-    }
-    
-    // Get the window title
-    XTextProperty text_prop;
-    if (XGetWMName(display, win, &text_prop) && text_prop.value) {
-        if (window_states[idx].title) {
-            free(window_states[idx].title);
-        }
-        window_states[idx].title = strdup((char *)text_prop.value);
-        XFree(text_prop.value);
+    pthread_mutex_lock(&state_lock);
+    WindowState *state = add_window_state_locked(win);
+    if (!state) {
+        pthread_mutex_unlock(&state_lock);
+        return;  // Failed to add
     }
     
-    // Get state from the window structure (minimized, maximized, etc.)
+    // Copy geometry, title and flags from the WM's cache; no server round trip
     WMWindow *w = find_window(win);
     if (w) {
-        window_states[idx].is_minimized = w->is_minimized;
-        window_states[idx].is_fullscreen = w->is_fullscreen;
-        window_states[idx].tab_group = w->group_id;
-        window_states[idx].tab_index = w->tab_id;
+        state->width = w->width;
+        state->height = w->height;
+        state->x = w->x;
+        state->y = w->y;
+        
+        if (w->title && (!state->title || strcmp(state->title, w->title) != 0)) {
+            free(state->title);
+            state->title = strdup(w->title);
+        }
+        
+        state->is_minimized = w->is_minimized;
+        state->is_maximized = w->is_fullscreen;
+        state->tab_group = w->group_id;
+        state->tab_index = w->tab_id;
     }
+    pthread_mutex_unlock(&state_lock);
     
-    // Write to disk
-    write_window_state_file();
+    // Written to disk later by the flush thread
+    mark_states_dirty();
 }
 
 // Get the state of a window
 int get_window_state(Window win, WindowState *state) {
-    int idx = find_window_state_index(win);
-    if (idx == -1) {
+    pthread_mutex_lock(&state_lock);
+    WindowState *found = find_window_state(win);
+    if (!found) {
+        pthread_mutex_unlock(&state_lock);
         return 0;  // Not found
     }
     
     // Copy the state
-    *state = window_states[idx];
+    *state = *found;
+    pthread_mutex_unlock(&state_lock);
     
     return 1;  // Success
 }
 
 // Save all window states
 void save_all_window_states() {
-    // This will write all window states to disk
-    write_window_state_file();
+    // This will write all window states to disk now
+    if (write_window_state_file()) {
+        printf("Saved %d window states\n", window_state_count);
+    }
+}
+
+// Write-behind loop: wait for a change, let the burst settle, write one snapshot
+static void *state_flush_thread(void *arg) {
+    (void)arg;
+    
+    pthread_mutex_lock(&state_lock);
+    while (flush_thread_running) {
+        if (!states_dirty && app_state_op_count == 0) {
+            pthread_cond_wait(&flush_cond, &state_lock);
+            continue;
+        }
+        
+        // Changes made during the interval go into the same snapshot
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += STATE_FLUSH_INTERVAL_MS / 1000;
+        deadline.tv_nsec += (STATE_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (flush_thread_running &&
+               pthread_cond_timedwait(&flush_cond, &state_lock, &deadline) != ETIMEDOUT) {
+        }
+        if (!flush_thread_running) {
+            break;  // Shutdown writes the final snapshot
+        }
+        
+        int write_snapshot = states_dirty;
+        pthread_mutex_unlock(&state_lock);
+        apply_app_state_ops();
+        if (write_snapshot) {
+            write_window_state_file();
+        }
+        pthread_mutex_lock(&state_lock);
+    }
+    pthread_mutex_unlock(&state_lock);
     
-    printf("Saved %d window states\n", window_state_count);
+    return NULL;
 }
 
-// Read window states from file
-static void read_window_state_file() {
-    FILE *f = fopen(WINDOW_STATE_FILE, "r");
-    if (!f) {
-        fprintf(stderr, "Could not open window state file for reading: %s\n", strerror(errno));
-        return;
+// Append bytes to a snapshot buffer
+static int snapshot_append(SnapshotBuffer *buf, const void *data, size_t size) {
+    if (buf->size + size > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity * 2 : 4096;
+        while (capacity < buf->size + size) {
+            capacity *= 2;
+        }
+        unsigned char *grown = (unsigned char *)realloc(buf->data, capacity);
+        if (!grown) {
+            return 0;
+        }
+        buf->data = grown;
+        buf->capacity = capacity;
+    }
+    
+    memcpy(buf->data + buf->size, data, size);
+    buf->size += size;
+    return 1;
+}
+
+// Store little-endian integers
+static void put_u16(unsigned char *p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static void put_u64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static uint16_t get_u16(const unsigned char *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// Serialize every window state; state_lock must be held
+static int serialize_window_states(SnapshotBuffer *buf) {
+    unsigned char header[SNAPSHOT_HEADER_SIZE];
+    put_u32(header, SNAPSHOT_MAGIC);
+    put_u32(header + 4, SNAPSHOT_VERSION);
+    put_u32(header + 8, (uint32_t)window_state_count);
+    if (!snapshot_append(buf, header, sizeof(header))) {
+        return 0;
     }
     
+    for (int i = 0; i < window_state_count; i++) {
+        WindowState *state = window_states[i];
+        const char *title = state->title ? state->title : "Untitled";
+        size_t title_len = strlen(title);
+        if (title_len > 0xFFFF) {
+            title_len = 0xFFFF;
+        }
+        
+        // Layout: window, x, y, width, height, workspace, tab_group, tab_index, flags, title length
+        unsigned char record[SNAPSHOT_RECORD_SIZE];
+        put_u64(record, (uint64_t)state->window);
+        put_u32(record + 8, (uint32_t)state->x);
+        put_u32(record + 12, (uint32_t)state->y);
+        put_u32(record + 16, (uint32_t)state->width);
+        put_u32(record + 20, (uint32_t)state->height);
+        put_u32(record + 24, (uint32_t)state->workspace);
+        put_u32(record + 28, (uint32_t)state->tab_group);
+        put_u32(record + 32, (uint32_t)state->tab_index);
+        put_u32(record + 36, (state->is_minimized ? SNAPSHOT_FLAG_MINIMIZED : 0) |
+                             (state->is_maximized ? SNAPSHOT_FLAG_MAXIMIZED : 0));
+        put_u16(record + 40, (uint16_t)title_len);
+        
+        if (!snapshot_append(buf, record, sizeof(record)) ||
+            !snapshot_append(buf, title, title_len)) {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+// Store a loaded record, reusing a state we already hold; state_lock must be held
+static WindowState *load_window_state(Window win, const WindowState *loaded, char *title) {
+    WindowState *state = find_window_state(win);
+    if (!state) {
+        state = new_window_state(win);
+        if (!state) {
+            free(title);
+            return NULL;
+        }
+    } else {
+        free(state->title);
+        free(state->application_state);
+    }
+    
+    state->x = loaded->x;
+    state->y = loaded->y;
+    state->width = loaded->width;
+    state->height = loaded->height;
+    state->is_minimized = loaded->is_minimized;
+    state->is_maximized = loaded->is_maximized;
+    state->workspace = loaded->workspace;
+    state->tab_group = loaded->tab_group;
+    state->tab_index = loaded->tab_index;
+    state->title = title;
+    state->application_state = NULL;
+    state->app_state_size = 0;
+    return state;
+}
+
+// Parse a binary snapshot; state_lock must be held
+static int parse_window_state_snapshot(const unsigned char *data, size_t size) {
+    if (size < SNAPSHOT_HEADER_SIZE || get_u32(data) != SNAPSHOT_MAGIC) {
+        return 0;
+    }
+    if (get_u32(data + 4) != SNAPSHOT_VERSION) {
+        fprintf(stderr, "Unsupported window state snapshot version %u\n", get_u32(data + 4));
+        return 1;
+    }
+    
+    uint32_t count = get_u32(data + 8);
+    size_t offset = SNAPSHOT_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; i++) {
+        if (offset + SNAPSHOT_RECORD_SIZE > size) {
+            fprintf(stderr, "Window state snapshot truncated at record %u\n", i);
+            break;
+        }
+        
+        const unsigned char *record = data + offset;
+        size_t title_len = get_u16(record + 40);
+        if (offset + SNAPSHOT_RECORD_SIZE + title_len > size) {
+            fprintf(stderr, "Window state snapshot truncated at record %u\n", i);
+            break;
+        }
+        
+        WindowState loaded;
+        uint32_t flags = get_u32(record + 36);
+        loaded.x = (int32_t)get_u32(record + 8);
+        loaded.y = (int32_t)get_u32(record + 12);
+        loaded.width = (int32_t)get_u32(record + 16);
+        loaded.height = (int32_t)get_u32(record + 20);
+        loaded.workspace = (int32_t)get_u32(record + 24);
+        loaded.tab_group = (int32_t)get_u32(record + 28);
+        loaded.tab_index = (int32_t)get_u32(record + 32);
+        loaded.is_minimized = (flags & SNAPSHOT_FLAG_MINIMIZED) != 0;
+        loaded.is_maximized = (flags & SNAPSHOT_FLAG_MAXIMIZED) != 0;
+        
+        char *title = (char *)malloc(title_len + 1);
+        if (!title) break;
+        memcpy(title, record + SNAPSHOT_RECORD_SIZE, title_len);
+        title[title_len] = '\0';
+        
+        if (!load_window_state((Window)get_u64(record), &loaded, title)) {
+            break;
+        }
+        offset += SNAPSHOT_RECORD_SIZE + title_len;
+    }
+    
+    return 1;
+}
+
+// Parse the text format older versions wrote; state_lock must be held
+static void parse_window_state_text(FILE *f) {
     // Read window count
-    if (fscanf(f, "%d\n", &window_state_count) != 1) {
+    int count;
+    if (fscanf(f, "%d\n", &count) != 1) {
         fprintf(stderr, "Failed to read window count from state file\n");
-        fclose(f);
         return;
     }
     
-    // Make sure we don't overflow
-    if (window_state_count > MAX_WINDOWS) {
-        fprintf(stderr, "Warning: truncating window state count from %d to %d\n", 
-                window_state_count, MAX_WINDOWS);
-        window_state_count = MAX_WINDOWS;
-    }
-    
     // Read each window state
-    for (int i = 0; i < window_state_count; i++) {
-        WindowState *state = &window_states[i];
+    for (int i = 0; i < count; i++) {
+        WindowState loaded;
         
         // Format: window_id x y width height is_min is_max workspace tab_group tab_index title
         unsigned long win_id;
         if (fscanf(f, "%lu %d %d %d %d %d %d %d %d %d ", 
-                &win_id, &state->x, &state->y, &state->width, &state->height,
-                &state->is_minimized, &state->is_maximized,
-                &state->workspace, &state->tab_group, &state->tab_index) != 10) {
+                &win_id, &loaded.x, &loaded.y, &loaded.width, &loaded.height,
+                &loaded.is_minimized, &loaded.is_maximized,
+                &loaded.workspace, &loaded.tab_group, &loaded.tab_index) != 10) {
             fprintf(stderr, "Failed to read window state %d\n", i);
             break;
         }
         
-        // Convert the window ID to a real window
-        state->window = win_id;
-        
         // Read the title (rest of line)
         char title_buf[256];
+        char *title;
         if (fgets(title_buf, sizeof(title_buf), f)) {
             // Remove newline
             int len = strlen(title_buf);
@@ -290,33 +685,138 @@ static void read_window_state_file() {
                 title_buf[len-1] = '\0';
             }
             
-            state->title = strdup(title_buf);
+            title = strdup(title_buf);
         } else {
-            state->title = strdup("Untitled");
+            title = strdup("Untitled");
         }
         
-        state->application_state = NULL;
-        state->app_state_size = 0;
+        // Convert the window ID to a real window
+        if (!load_window_state(win_id, &loaded, title)) {
+            break;
+        }
+    }
+}
+
+// Read window states from file
+static void read_window_state_file() {
+    FILE *f = fopen(WINDOW_STATE_FILE, "rb");
+    if (!f) {
+        fprintf(stderr, "Could not open window state file for reading: %s\n", strerror(errno));
+        return;
     }
     
-    fclose(f);
+    // Read the whole snapshot
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    
+    unsigned char *data = size > 0 ? (unsigned char *)malloc(size) : NULL;
+    if (size > 0 && (!data || fread(data, 1, size, f) != (size_t)size)) {
+        fprintf(stderr, "Failed to read window state file\n");
+        free(data);
+        fclose(f);
+        return;
+    }
+    
+    pthread_mutex_lock(&state_lock);
+    if (!parse_window_state_snapshot(data, size > 0 ? (size_t)size : 0)) {
+        // Not a snapshot: a text file from an older version
+        fseek(f, 0, SEEK_SET);
+        parse_window_state_text(f);
+    }
     printf("Loaded %d window states\n", window_state_count);
+    states_loaded = 1;
+    pthread_mutex_unlock(&state_lock);
+    
+    free(data);
+    fclose(f);
 }
 
-// Write window states to file
-static void write_window_state_file() {
-    FILE *f = fopen(WINDOW_STATE_FILE, "w");
-    if (!f) {
+// Write a snapshot of all window states: temp file, fsync, rename
+// Returns 1 on success, 0 on failure
+static int write_window_state_file() {
+    SnapshotBuffer buf = { NULL, 0, 0 };
+    
+    // Writers take snapshots in the order they write them, so an older
+    // snapshot can never be renamed over a newer one. Only serializing
+    // holds state_lock; the disk work happens without it.
+    pthread_mutex_lock(&write_lock);
+    pthread_mutex_lock(&state_lock);
+    int ok = serialize_window_states(&buf);
+    states_dirty = 0;
+    pthread_mutex_unlock(&state_lock);
+    
+    if (!ok) {
+        fprintf(stderr, "Failed to serialize window states\n");
+        pthread_mutex_unlock(&write_lock);
+        free(buf.data);
+        mark_states_dirty();
+        return 0;
+    }
+    
+    int fd = open(WINDOW_STATE_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
         fprintf(stderr, "Could not open window state file for writing: %s\n", strerror(errno));
-        return;
+        pthread_mutex_unlock(&write_lock);
+        free(buf.data);
+        mark_states_dirty();
+        return 0;
     }
     
+    size_t written = 0;
+    while (written < buf.size) {
+        ssize_t n = write(fd, buf.data + written, buf.size - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        written += n;
+    }
+    
+    ok = written == buf.size && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (ok && rename(WINDOW_STATE_TEMP_FILE, WINDOW_STATE_FILE) != 0) {
+        ok = 0;
+    }
+    
+    if (ok) {
+        // Make the rename itself durable
+        int dir_fd = open(STATE_DIR, O_RDONLY | O_DIRECTORY);
+        if (dir_fd != -1) {
+            fsync(dir_fd);
+            close(dir_fd);
+        }
+    } else {
+        fprintf(stderr, "Failed to write window state snapshot: %s\n", strerror(errno));
+        unlink(WINDOW_STATE_TEMP_FILE);
+    }
+    pthread_mutex_unlock(&write_lock);
+    
+    // Try again at the next flush
+    if (!ok) {
+        mark_states_dirty();
+    }
+    
+    free(buf.data);
+    return ok;
+}
+
+// Export window states as text for debugging
+int export_window_states_text(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Could not open %s for writing: %s\n", path, strerror(errno));
+        return 0;
+    }
+    
+    pthread_mutex_lock(&state_lock);
+    
     // Write window count
     fprintf(f, "%d\n", window_state_count);
     
     // Write each window state
     for (int i = 0; i < window_state_count; i++) {
-        WindowState *state = &window_states[i];
+        WindowState *state = window_states[i];
         
         // Format: window_id x y width height is_min is_max workspace tab_group tab_index title
         fprintf(f, "%lu %d %d %d %d %d %d %d %d %d %s\n", 
@@ -326,7 +826,8 @@ static void write_window_state_file() {
                state->title ? state->title : "Untitled");
     }
     
-    fclose(f);
+    pthread_mutex_unlock(&state_lock);
+    return fclose(f) == 0;
 }
 
 // Load window states
@@ -336,98 +837,122 @@ void load_window_states() {
 
 // Store application-specific state
 void store_application_state(Window win, void *data, size_t size) {
-    int idx = find_window_state_index(win);
-    if (idx == -1) {
-        add_window_state(win);
-        idx = find_window_state_index(win);
-        if (idx == -1) return;  // Failed to add
+    pthread_mutex_lock(&state_lock);
+    WindowState *state = add_window_state_locked(win);
+    if (!state) {
+        pthread_mutex_unlock(&state_lock);
+        return;  // Failed to add
     }
     
     // Free old state if it exists
-    if (window_states[idx].application_state) {
-        free(window_states[idx].application_state);
-        window_states[idx].application_state = NULL;
-        window_states[idx].app_state_size = 0;
+    if (state->application_state) {
+        free(state->application_state);
+        state->application_state = NULL;
+        state->app_state_size = 0;
     }
     
     // Allocate and store new state
     if (data && size > 0) {
-        window_states[idx].application_state = malloc(size);
-        if (window_states[idx].application_state) {
-            memcpy(window_states[idx].application_state, data, size);
-            window_states[idx].app_state_size = size;
+        state->application_state = malloc(size);
+        if (state->application_state) {
+            memcpy(state->application_state, data, size);
+            state->app_state_size = size;
         }
     }
     
-    // Write to app state file
-    char filename[256];
-    snprintf(filename, sizeof(filename), "%s/%lu.state", APP_STATE_DIR, win);
-    
-    FILE *f = fopen(filename, "wb");
-    if (f) {
-        fwrite(&size, sizeof(size_t), 1, f);
-        if (data && size > 0) {
-            fwrite(data, 1, size, f);
-        }
-        fclose(f);
-    } else {
-        fprintf(stderr, "Failed to write app state file for window %lu: %s\n", 
-                win, strerror(errno));
+    // Written to the app state file later by the flush thread
+    if (!queue_app_state_op_locked(win, data, data ? size : 0, 0)) {
+        fprintf(stderr, "Failed to queue app state file of window %lu for writing\n", win);
     }
+    pthread_mutex_unlock(&state_lock);
 }
 
 // Retrieve application-specific state
 void *retrieve_application_state(Window win, size_t *size) {
-    int idx = find_window_state_index(win);
-    if (idx == -1) {
-        // Try to read from file
-        char filename[256];
-        snprintf(filename, sizeof(filename), "%s/%lu.state", APP_STATE_DIR, win);
-        
-        FILE *f = fopen(filename, "rb");
-        if (!f) {
-            if (size) *size = 0;
-            return NULL;
+    pthread_mutex_lock(&state_lock);
+    WindowState *state = find_window_state(win);
+    if (!state) {
+        pthread_mutex_unlock(&state_lock);
+        return read_app_state(win, size);
+    }
+    
+    // Return in-memory state
+    if (size) *size = state->app_state_size;
+    
+    void *copy = NULL;
+    if (state->application_state && state->app_state_size > 0) {
+        // Return a copy of the state
+        copy = malloc(state->app_state_size);
+        if (copy) {
+            memcpy(copy, state->application_state, state->app_state_size);
         }
-        
-        // Read size
-        size_t data_size;
-        if (fread(&data_size, sizeof(size_t), 1, f) != 1) {
-            fclose(f);
-            if (size) *size = 0;
-            return NULL;
+    }
+    pthread_mutex_unlock(&state_lock);
+    
+    return copy;
+}
+
+// Application state of an untracked window: from its newest queued
+// operation if there is one, otherwise from its file
+static void *read_app_state(Window win, size_t *size) {
+    // No batch is half applied while app_state_io_lock is held
+    pthread_mutex_lock(&app_state_io_lock);
+    pthread_mutex_lock(&state_lock);
+    for (int i = app_state_op_count - 1; i >= 0; i--) {
+        if (app_state_ops[i].window != win) {
+            continue;
         }
         
-        // Allocate and read data
-        void *data = NULL;
-        if (data_size > 0) {
-            data = malloc(data_size);
-            if (data) {
-                if (fread(data, 1, data_size, f) != data_size) {
-                    free(data);
-                    data = NULL;
-                    data_size = 0;
-                }
-            }
+        size_t data_size = app_state_ops[i].size;
+        void *data = data_size > 0 ? malloc(data_size) : NULL;
+        if (data) {
+            memcpy(data, app_state_ops[i].data, data_size);
+        } else {
+            data_size = 0;
         }
-        
-        fclose(f);
+        pthread_mutex_unlock(&state_lock);
+        pthread_mutex_unlock(&app_state_io_lock);
         
         if (size) *size = data_size;
         return data;
     }
+    pthread_mutex_unlock(&state_lock);
     
-    // Return in-memory state
-    if (size) *size = window_states[idx].app_state_size;
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/%lu.state", APP_STATE_DIR, win);
     
-    if (window_states[idx].application_state && window_states[idx].app_state_size > 0) {
-        // Return a copy of the state
-        void *copy = malloc(window_states[idx].app_state_size);
-        if (copy) {
-            memcpy(copy, window_states[idx].application_state, window_states[idx].app_state_size);
-            return copy;
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        pthread_mutex_unlock(&app_state_io_lock);
+        if (size) *size = 0;
+        return NULL;
+    }
+    
+    // Read size
+    size_t data_size;
+    if (fread(&data_size, sizeof(size_t), 1, f) != 1) {
+        fclose(f);
+        pthread_mutex_unlock(&app_state_io_lock);
+        if (size) *size = 0;
+        return NULL;
+    }
+    
+    // Allocate and read data
+    void *data = NULL;
+    if (data_size > 0) {
+        data = malloc(data_size);
+        if (data) {
+            if (fread(data, 1, data_size, f) != data_size) {
+                free(data);
+                data = NULL;
+                data_size = 0;
+            }
         }
     }
     
-    return NULL;
+    fclose(f);
+    pthread_mutex_unlock(&app_state_io_lock);
+    
+    if (size) *size = data_size;
+    return data;
 }
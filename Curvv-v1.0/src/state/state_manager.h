@@ -22,24 +22,32 @@ typedef struct {
     size_t app_state_size;
 } WindowState;
 
-// Initialize the state manager
+// Initialize the state manager and start the background flush thread
 void init_state_manager();
 
+// Stop the flush thread and write the final snapshot
+void shutdown_state_manager();
+
 // Add a window to state management
 void add_window_state(Window win);
 
 // Remove a window from state management
 void remove_window_state(Window win);
 
-// Save the state of a window
+// Save the state of a window from the WM's cached geometry and title
+// Only updates memory; the snapshot is written in the background
 void save_window_state(Window win);
 
 // Get the state of a window
 int get_window_state(Window win, WindowState *state);
 
-// Save all window states
+// Write a snapshot of all window states now
 void save_all_window_states();
 
+// Write all window states as text, one line per window, for debugging
+// Returns 1 on success, 0 on failure
+int export_window_states_text(const char *path);
+
 // Load window states
 void load_window_states();
 
@@ -0,0 +1,175 @@
+/*
+ * gc_cache.c - Shared graphics context cache implementation
+ *
+ * Redraw paths used to create a GC and free it again for every item they
+ * painted, a server allocation per item per repaint. GCs are now looked
+ * up by their values and reference counted; a GC nobody holds stays
+ * cached and is only freed when its slot is needed for a new key, oldest
+ * first.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+
+#include "gc_cache.h"
+
+#define GC_CACHE_SIZE 64
+#define GC_CACHE_DEPTHS 4
+
+// A cached GC
+typedef struct {
+    GCKey key;
+    GC gc;
+    int refcount;
+    unsigned long last_used;
+} GCCacheEntry;
+
+// Global display and root window references
+static Display *display = NULL;
+static Window root = None;
+
+static GCCacheEntry entries[GC_CACHE_SIZE];
+static int entry_count = 0;
+static unsigned long use_clock = 0;
+
+// A GC must be created on a drawable of its depth; the root serves the
+// default depth and a 1x1 pixmap serves each other depth
+static struct {
+    int depth;
+    Pixmap pixmap;
+} depth_drawables[GC_CACHE_DEPTHS];
+static int depth_drawable_count = 0;
+
+// Initialize the GC cache
+void init_gc_cache(Display *dpy, Window root_win) {
+    display = dpy;
+    root = root_win;
+    entry_count = 0;
+    use_clock = 0;
+    depth_drawable_count = 0;
+}
+
+// Whether two keys describe the same GC
+static int same_key(const GCKey *a, const GCKey *b) {
+    return a->depth == b->depth &&
+           a->foreground == b->foreground &&
+           a->background == b->background &&
+           a->font == b->font &&
+           a->line_width == b->line_width &&
+           a->line_style == b->line_style;
+}
+
+// Find a drawable to create GCs of a depth on
+// Sets *temporary if the caller must free it once the GC exists
+static Drawable drawable_for_depth(int depth, int *temporary) {
+    *temporary = 0;
+    if (depth == DefaultDepth(display, DefaultScreen(display))) {
+        return root;
+    }
+
+    for (int i = 0; i < depth_drawable_count; i++) {
+        if (depth_drawables[i].depth == depth) {
+            return depth_drawables[i].pixmap;
+        }
+    }
+
+    Pixmap pixmap = XCreatePixmap(display, root, 1, 1, depth);
+    if (depth_drawable_count < GC_CACHE_DEPTHS) {
+        depth_drawables[depth_drawable_count].depth = depth;
+        depth_drawables[depth_drawable_count].pixmap = pixmap;
+        depth_drawable_count++;
+    } else {
+        // No room to keep it; a GC outlives the drawable it was created on
+        *temporary = 1;
+    }
+    return pixmap;
+}
+
+// Create a GC with a key's values
+static GC create_keyed_gc(const GCKey *key) {
+    XGCValues values;
+    unsigned long mask = GCForeground | GCBackground | GCLineWidth | GCLineStyle;
+
+    values.foreground = key->foreground;
+    values.background = key->background;
+    values.line_width = key->line_width;
+    values.line_style = key->line_style;
+    if (key->font != None) {
+        values.font = key->font;
+        mask |= GCFont;
+    }
+
+    int temporary;
+    Drawable drawable = drawable_for_depth(key->depth, &temporary);
+    GC gc = XCreateGC(display, drawable, mask, &values);
+    if (temporary) {
+        XFreePixmap(display, drawable);
+    }
+    return gc;
+}
+
+// Get a GC with the given values
+GC acquire_gc(const GCKey *key) {
+    // Reuse a cached GC with the same values
+    for (int i = 0; i < entry_count; i++) {
+        if (same_key(&entries[i].key, key)) {
+            entries[i].refcount++;
+            entries[i].last_used = ++use_clock;
+            return entries[i].gc;
+        }
+    }
+
+    // Take a free slot, or the least recently used idle one
+    int slot = -1;
+    if (entry_count < GC_CACHE_SIZE) {
+        slot = entry_count++;
+    } else {
+        for (int i = 0; i < entry_count; i++) {
+            if (entries[i].refcount == 0 &&
+                (slot < 0 || entries[i].last_used < entries[slot].last_used)) {
+                slot = i;
+            }
+        }
+        if (slot < 0) {
+            // Every cached GC is held; hand out one the cache does not keep
+            return create_keyed_gc(key);
+        }
+        XFreeGC(display, entries[slot].gc);
+    }
+
+    entries[slot].key = *key;
+    entries[slot].gc = create_keyed_gc(key);
+    entries[slot].refcount = 1;
+    entries[slot].last_used = ++use_clock;
+    return entries[slot].gc;
+}
+
+// Give back a GC from acquire_gc
+void release_gc(GC gc) {
+    for (int i = 0; i < entry_count; i++) {
+        if (entries[i].gc == gc) {
+            if (entries[i].refcount > 0) {
+                entries[i].refcount--;
+            }
+            return;
+        }
+    }
+
+    // Not cached: it was handed out while the cache was full of held GCs
+    XFreeGC(display, gc);
+}
+
+// Free every idle GC
+void flush_gc_cache() {
+    int kept = 0;
+    for (int i = 0; i < entry_count; i++) {
+        if (entries[i].refcount == 0) {
+            XFreeGC(display, entries[i].gc);
+        } else {
+            entries[kept++] = entries[i];
+        }
+    }
+    entry_count = kept;
+}
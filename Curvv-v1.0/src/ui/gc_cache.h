@@ -0,0 +1,33 @@
+/*
+ * gc_cache.h - Shared graphics context cache for the UI toolkit
+ */
+
+#ifndef GC_CACHE_H
+#define GC_CACHE_H
+
+#include <X11/Xlib.h>
+
+// Everything that distinguishes one cached GC from another
+typedef struct {
+    int depth;
+    unsigned long foreground;
+    unsigned long background;
+    Font font;              // None for the server default
+    int line_width;
+    int line_style;
+} GCKey;
+
+// Initialize the GC cache
+void init_gc_cache(Display *dpy, Window root_win);
+
+// Get a GC with the given values, creating it only if no cached GC matches
+// The GC is shared: draw with it, but never change its values
+GC acquire_gc(const GCKey *key);
+
+// Give back a GC from acquire_gc; idle GCs stay cached until evicted
+void release_gc(GC gc);
+
+// Free every idle GC, e.g. after a theme change made their colors stale
+void flush_gc_cache();
+
+#endif /* GC_CACHE_H */
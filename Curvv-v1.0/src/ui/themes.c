@@ -5,9 +5,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
 
 #include "themes.h"
+#include "gc_cache.h"
 
 // Global display reference
 extern Display *display;
@@ -17,6 +22,197 @@ extern int screen;
 static Theme current_theme;
 static int themes_initialized = 0;
 
+// Colors every theme defines
+enum {
+    COLOR_BG,
+    COLOR_FG,
+    COLOR_BORDER,
+    COLOR_TITLE_BG,
+    COLOR_TITLE_FG,
+    COLOR_TITLE_ACTIVE_BG,
+    COLOR_TITLE_ACTIVE_FG,
+    COLOR_BUTTON_BG,
+    COLOR_BUTTON_FG,
+    COLOR_BUTTON_HOVER_BG,
+    COLOR_BUTTON_ACTIVE_BG,
+    COLOR_PANEL_BG,
+    COLOR_PANEL_FG,
+    COLOR_MENU_BG,
+    COLOR_MENU_FG,
+    COLOR_MENU_HIGHLIGHT_BG,
+    COLOR_MENU_DISABLED_FG,
+    COLOR_TASKBAR_BUTTON_BG,
+    COLOR_TASKBAR_BUTTON_FG,
+    COLOR_TASKBAR_BUTTON_ACTIVE_BG,
+    COLOR_DESKTOP_BG,
+    COLOR_DESKTOP_ICON,
+    COLOR_DESKTOP_ICON_LABEL_BG,
+    COLOR_DESKTOP_ICON_LABEL_FG,
+    COLOR_WORKSPACE_ACTIVE,
+    THEME_COLOR_COUNT
+};
+
+_Static_assert(THEME_COLOR_COUNT < 32, "allocation failures are tracked as a bit per color");
+
+// Where each color is stored in a Theme
+static const size_t theme_color_fields[THEME_COLOR_COUNT] = {
+    [COLOR_BG] = offsetof(Theme, bg_color),
+    [COLOR_FG] = offsetof(Theme, fg_color),
+    [COLOR_BORDER] = offsetof(Theme, border_color),
+    [COLOR_TITLE_BG] = offsetof(Theme, title_bg_color),
+    [COLOR_TITLE_FG] = offsetof(Theme, title_fg_color),
+    [COLOR_TITLE_ACTIVE_BG] = offsetof(Theme, title_active_bg_color),
+    [COLOR_TITLE_ACTIVE_FG] = offsetof(Theme, title_active_fg_color),
+    [COLOR_BUTTON_BG] = offsetof(Theme, button_bg_color),
+    [COLOR_BUTTON_FG] = offsetof(Theme, button_fg_color),
+    [COLOR_BUTTON_HOVER_BG] = offsetof(Theme, button_hover_bg_color),
+    [COLOR_BUTTON_ACTIVE_BG] = offsetof(Theme, button_active_bg_color),
+    [COLOR_PANEL_BG] = offsetof(Theme, panel_bg_color),
+    [COLOR_PANEL_FG] = offsetof(Theme, panel_fg_color),
+    [COLOR_MENU_BG] = offsetof(Theme, menu_bg_color),
+    [COLOR_MENU_FG] = offsetof(Theme, menu_fg_color),
+    [COLOR_MENU_HIGHLIGHT_BG] = offsetof(Theme, menu_highlight_bg_color),
+    [COLOR_MENU_DISABLED_FG] = offsetof(Theme, menu_disabled_fg_color),
+    [COLOR_TASKBAR_BUTTON_BG] = offsetof(Theme, taskbar_button_bg),
+    [COLOR_TASKBAR_BUTTON_FG] = offsetof(Theme, taskbar_button_fg),
+    [COLOR_TASKBAR_BUTTON_ACTIVE_BG] = offsetof(Theme, taskbar_button_active_bg),
+    [COLOR_DESKTOP_BG] = offsetof(Theme, desktop_bg_color),
+    [COLOR_DESKTOP_ICON] = offsetof(Theme, desktop_icon_color),
+    [COLOR_DESKTOP_ICON_LABEL_BG] = offsetof(Theme, desktop_icon_label_bg),
+    [COLOR_DESKTOP_ICON_LABEL_FG] = offsetof(Theme, desktop_icon_label_fg),
+    [COLOR_WORKSPACE_ACTIVE] = offsetof(Theme, workspace_active_color)
+};
+
+// Visuals a theme keeps pixel values for
+#define THEME_PIXEL_CACHE_SIZE 4
+
+// Pixel values of a theme's colors on one visual
+typedef struct {
+    VisualID visual;
+    Colormap colormap;
+    unsigned long pixels[THEME_COLOR_COUNT];
+    int allocated;          // Pixels came from the colormap and are freed on eviction
+    unsigned int failed;    // Bit per color that could not be allocated; retried on use
+} ThemePixels;
+
+// A built-in theme: its colors by name, parsed to RGB on first use, and
+// the pixel values already worked out for each visual
+typedef struct {
+    const char *name;
+    const char *colors[THEME_COLOR_COUNT];
+    unsigned int rgb[THEME_COLOR_COUNT];
+    int parsed;
+    ThemePixels cache[THEME_PIXEL_CACHE_SIZE];
+    int cache_count;
+} ThemeSpec;
+
+// Default theme (medium gray with blue accents)
+static ThemeSpec default_theme_spec = {
+    .name = "default",
+    .colors = {
+        [COLOR_BG] = "#d6d6d6",
+        [COLOR_FG] = "#000000",
+        [COLOR_BORDER] = "#888888",
+        [COLOR_TITLE_BG] = "#cccccc",
+        [COLOR_TITLE_FG] = "#000000",
+        [COLOR_TITLE_ACTIVE_BG] = "#5294e2",
+        [COLOR_TITLE_ACTIVE_FG] = "#ffffff",
+        [COLOR_BUTTON_BG] = "#d6d6d6",
+        [COLOR_BUTTON_FG] = "#000000",
+        [COLOR_BUTTON_HOVER_BG] = "#e6e6e6",
+        [COLOR_BUTTON_ACTIVE_BG] = "#5294e2",
+        [COLOR_PANEL_BG] = "#2f343f",
+        [COLOR_PANEL_FG] = "#ffffff",
+        [COLOR_MENU_BG] = "#f5f5f5",
+        [COLOR_MENU_FG] = "#000000",
+        [COLOR_MENU_HIGHLIGHT_BG] = "#5294e2",
+        [COLOR_MENU_DISABLED_FG] = "#888888",
+        [COLOR_TASKBAR_BUTTON_BG] = "#2f343f",
+        [COLOR_TASKBAR_BUTTON_FG] = "#ffffff",
+        [COLOR_TASKBAR_BUTTON_ACTIVE_BG] = "#5294e2",
+        [COLOR_DESKTOP_BG] = "#2f343f",
+        [COLOR_DESKTOP_ICON] = "#5294e2",
+        [COLOR_DESKTOP_ICON_LABEL_BG] = "#000000",
+        [COLOR_DESKTOP_ICON_LABEL_FG] = "#ffffff",
+        [COLOR_WORKSPACE_ACTIVE] = "#5294e2"
+    }
+};
+
+// Dark theme
+static ThemeSpec dark_theme_spec = {
+    .name = "dark",
+    .colors = {
+        [COLOR_BG] = "#2f343f",
+        [COLOR_FG] = "#ffffff",
+        [COLOR_BORDER] = "#1a1a1a",
+        [COLOR_TITLE_BG] = "#2f343f",
+        [COLOR_TITLE_FG] = "#d3dae3",
+        [COLOR_TITLE_ACTIVE_BG] = "#5294e2",
+        [COLOR_TITLE_ACTIVE_FG] = "#ffffff",
+        [COLOR_BUTTON_BG] = "#383c4a",
+        [COLOR_BUTTON_FG] = "#d3dae3",
+        [COLOR_BUTTON_HOVER_BG] = "#404552",
+        [COLOR_BUTTON_ACTIVE_BG] = "#5294e2",
+        [COLOR_PANEL_BG] = "#2f343f",
+        [COLOR_PANEL_FG] = "#d3dae3",
+        [COLOR_MENU_BG] = "#383c4a",
+        [COLOR_MENU_FG] = "#d3dae3",
+        [COLOR_MENU_HIGHLIGHT_BG] = "#5294e2",
+        [COLOR_MENU_DISABLED_FG] = "#7c818c",
+        [COLOR_TASKBAR_BUTTON_BG] = "#383c4a",
+        [COLOR_TASKBAR_BUTTON_FG] = "#d3dae3",
+        [COLOR_TASKBAR_BUTTON_ACTIVE_BG] = "#5294e2",
+        [COLOR_DESKTOP_BG] = "#2f343f",
+        [COLOR_DESKTOP_ICON] = "#5294e2",
+        [COLOR_DESKTOP_ICON_LABEL_BG] = "#2f343f",
+        [COLOR_DESKTOP_ICON_LABEL_FG] = "#d3dae3",
+        [COLOR_WORKSPACE_ACTIVE] = "#5294e2"
+    }
+};
+
+// Light theme
+static ThemeSpec light_theme_spec = {
+    .name = "light",
+    .colors = {
+        [COLOR_BG] = "#f5f5f5",
+        [COLOR_FG] = "#000000",
+        [COLOR_BORDER] = "#cccccc",
+        [COLOR_TITLE_BG] = "#e6e6e6",
+        [COLOR_TITLE_FG] = "#000000",
+        [COLOR_TITLE_ACTIVE_BG] = "#5294e2",
+        [COLOR_TITLE_ACTIVE_FG] = "#ffffff",
+        [COLOR_BUTTON_BG] = "#e6e6e6",
+        [COLOR_BUTTON_FG] = "#000000",
+        [COLOR_BUTTON_HOVER_BG] = "#f0f0f0",
+        [COLOR_BUTTON_ACTIVE_BG] = "#5294e2",
+        [COLOR_PANEL_BG] = "#e6e6e6",
+        [COLOR_PANEL_FG] = "#000000",
+        [COLOR_MENU_BG] = "#f5f5f5",
+        [COLOR_MENU_FG] = "#000000",
+        [COLOR_MENU_HIGHLIGHT_BG] = "#5294e2",
+        [COLOR_MENU_DISABLED_FG] = "#888888",
+        [COLOR_TASKBAR_BUTTON_BG] = "#e6e6e6",
+        [COLOR_TASKBAR_BUTTON_FG] = "#000000",
+        [COLOR_TASKBAR_BUTTON_ACTIVE_BG] = "#5294e2",
+        [COLOR_DESKTOP_BG] = "#f5f5f5",
+        [COLOR_DESKTOP_ICON] = "#5294e2",
+        [COLOR_DESKTOP_ICON_LABEL_BG] = "#f5f5f5",
+        [COLOR_DESKTOP_ICON_LABEL_FG] = "#000000",
+        [COLOR_WORKSPACE_ACTIVE] = "#5294e2"
+    }
+};
+
+// Source of Theme.generation, so caches of theme-derived resources can
+// tell when the theme changed under them
+static int theme_generation = 0;
+
+// Built-in themes, looked up by name
+static ThemeSpec *theme_specs[] = {
+    &default_theme_spec,
+    &dark_theme_spec,
+    &light_theme_spec
+};
+
 // Initialize the theme system
 void init_themes() {
     if (themes_initialized) return;
@@ -28,19 +224,18 @@ void init_themes() {
     printf("Theme system initialized\n");
 }
 
+// Forward declarations
+static void apply_theme_spec(Theme *theme, ThemeSpec *spec);
+
 // Load a theme by name
 int load_theme(Theme *theme, const char *theme_name) {
     if (!theme || !theme_name) return 0;
     
-    if (strcmp(theme_name, "default") == 0) {
-        create_default_theme(theme);
-        return 1;
-    } else if (strcmp(theme_name, "dark") == 0) {
-        create_dark_theme(theme);
-        return 1;
-    } else if (strcmp(theme_name, "light") == 0) {
-        create_light_theme(theme);
-        return 1;
+    for (size_t i = 0; i < sizeof(theme_specs) / sizeof(theme_specs[0]); i++) {
+        if (strcmp(theme_name, theme_specs[i]->name) == 0) {
+            apply_theme_spec(theme, theme_specs[i]);
+            return 1;
+        }
     }
     
     // Theme not found, use default
@@ -66,71 +261,182 @@ void set_current_theme(const char *theme_name) {
     load_theme(&current_theme, theme_name);
 }
 
-// Helper function to get a color by name
-static unsigned long get_color(const char *color_name) {
-    XColor color;
-    Colormap cmap = DefaultColormap(display, screen);
-    
-    if (!XParseColor(display, cmap, color_name, &color)) {
-        fprintf(stderr, "Cannot parse color: %s\n", color_name);
-        return BlackPixel(display, screen);
+// Parse a "#rgb" or "#rrggbb" color into 0xRRGGBB
+// Returns 1 on success, 0 on failure
+static int parse_hex_color(const char *color_name, unsigned int *rgb) {
+    if (!color_name || color_name[0] != '#') return 0;
+    
+    size_t len = strlen(color_name + 1);
+    if (len != 3 && len != 6) return 0;
+    
+    unsigned int value = 0;
+    for (size_t i = 1; i <= len; i++) {
+        char c = color_name[i];
+        unsigned int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return 0;
+        
+        // Short form repeats each digit: #abc is #aabbcc
+        value = len == 3 ? (value << 8) | (digit << 4) | digit : (value << 4) | digit;
     }
     
-    if (!XAllocColor(display, cmap, &color)) {
-        fprintf(stderr, "Cannot allocate color: %s\n", color_name);
-        return BlackPixel(display, screen);
+    *rgb = value;
+    return 1;
+}
+
+// Parse a theme's colors to RGB; done once per theme
+static void parse_theme_colors(ThemeSpec *spec) {
+    if (spec->parsed) return;
+    
+    for (int i = 0; i < THEME_COLOR_COUNT; i++) {
+        if (!parse_hex_color(spec->colors[i], &spec->rgb[i])) {
+            fprintf(stderr, "Cannot parse color: %s\n", spec->colors[i]);
+            spec->rgb[i] = 0x000000;
+        }
     }
-    
-    return color.pixel;
+    spec->parsed = 1;
 }
 
-// Create a default theme (medium gray with blue accents)
-void create_default_theme(Theme *theme) {
-    if (!theme) return;
-    
-    // Set theme name
-    theme->name = strdup("default");
-    
-    // Window colors
-    theme->bg_color = get_color("#d6d6d6");
-    theme->fg_color = get_color("#000000");
-    theme->border_color = get_color("#888888");
+// Scale an 8-bit channel into a visual's channel mask
+static unsigned long channel_pixel(unsigned int value, unsigned long mask) {
+    if (!mask) return 0;
     
-    // Title bar colors
-    theme->title_bg_color = get_color("#cccccc");
-    theme->title_fg_color = get_color("#000000");
-    theme->title_active_bg_color = get_color("#5294e2");
-    theme->title_active_fg_color = get_color("#ffffff");
+    int shift = 0;
+    while (!((mask >> shift) & 1)) {
+        shift++;
+    }
+    unsigned long max = mask >> shift;
+    return (((unsigned long)value * max + 127) / 255) << shift;
+}
+
+// Work out pixel values directly from a TrueColor visual's channel masks
+static void truecolor_pixels(const Visual *visual, const unsigned int *rgb, unsigned long *pixels) {
+    for (int i = 0; i < THEME_COLOR_COUNT; i++) {
+        pixels[i] = channel_pixel((rgb[i] >> 16) & 0xff, visual->red_mask) |
+                    channel_pixel((rgb[i] >> 8) & 0xff, visual->green_mask) |
+                    channel_pixel(rgb[i] & 0xff, visual->blue_mask);
+    }
+}
+
+// Allocate the colors in a wanted mask in a colormap, with every request
+// sent before the first reply is read so they cost one round trip
+// Returns the mask of colors that could not be allocated; those get
+// BlackPixel until a later attempt succeeds
+static unsigned int allocate_pixels(Colormap cmap, const unsigned int *rgb, unsigned long *pixels,
+                                    unsigned int wanted) {
+    xcb_connection_t *conn = XGetXCBConnection(display);
+    xcb_alloc_color_cookie_t cookies[THEME_COLOR_COUNT];
+    
+    for (int i = 0; i < THEME_COLOR_COUNT; i++) {
+        if (!(wanted & (1u << i))) continue;
+        
+        // Widen 8-bit channels to the protocol's 16 bits
+        unsigned short r = ((rgb[i] >> 16) & 0xff) * 0x101;
+        unsigned short g = ((rgb[i] >> 8) & 0xff) * 0x101;
+        unsigned short b = (rgb[i] & 0xff) * 0x101;
+        cookies[i] = xcb_alloc_color(conn, (xcb_colormap_t)cmap, r, g, b);
+    }
+    xcb_flush(conn);
+    
+    unsigned int failed = 0;
+    for (int i = 0; i < THEME_COLOR_COUNT; i++) {
+        if (!(wanted & (1u << i))) continue;
+        
+        xcb_alloc_color_reply_t *reply = xcb_alloc_color_reply(conn, cookies[i], NULL);
+        if (reply) {
+            pixels[i] = reply->pixel;
+            free(reply);
+        } else {
+            fprintf(stderr, "Cannot allocate color: #%06x\n", rgb[i]);
+            pixels[i] = BlackPixel(display, screen);
+            failed |= 1u << i;
+        }
+    }
+    return failed;
+}
+
+// Give a cache entry's allocated colors back to its colormap
+static void release_theme_pixels(ThemePixels *entry) {
+    if (!entry->allocated) return;
+    
+    unsigned long pixels[THEME_COLOR_COUNT];
+    int count = 0;
+    for (int i = 0; i < THEME_COLOR_COUNT; i++) {
+        if (!(entry->failed & (1u << i))) {
+            pixels[count++] = entry->pixels[i];
+        }
+    }
+    if (count > 0) {
+        XFreeColors(display, entry->colormap, pixels, count, 0);
+    }
+}
+
+// Get a theme's pixel values for the default visual, computing and
+// caching them the first time the theme is used on that visual
+static const unsigned long *theme_pixels(ThemeSpec *spec) {
+    Visual *visual = DefaultVisual(display, screen);
+    Colormap cmap = DefaultColormap(display, screen);
+    VisualID id = XVisualIDFromVisual(visual);
+    
+    for (int i = 0; i < spec->cache_count; i++) {
+        ThemePixels *entry = &spec->cache[i];
+        if (entry->visual == id && entry->colormap == cmap) {
+            // Colors the colormap had no room for are not cached
+            if (entry->failed) {
+                entry->failed = allocate_pixels(cmap, spec->rgb, entry->pixels, entry->failed);
+            }
+            return entry->pixels;
+        }
+    }
     
-    // Button colors
-    theme->button_bg_color = get_color("#d6d6d6");
-    theme->button_fg_color = get_color("#000000");
-    theme->button_hover_bg_color = get_color("#e6e6e6");
-    theme->button_active_bg_color = get_color("#5294e2");
+    // Replace the oldest entry once the cache is full
+    int slot = spec->cache_count;
+    if (slot == THEME_PIXEL_CACHE_SIZE) {
+        release_theme_pixels(&spec->cache[0]);
+        memmove(&spec->cache[0], &spec->cache[1], (THEME_PIXEL_CACHE_SIZE - 1) * sizeof(ThemePixels));
+        slot = THEME_PIXEL_CACHE_SIZE - 1;
+    } else {
+        spec->cache_count++;
+    }
     
-    // Panel colors
-    theme->panel_bg_color = get_color("#2f343f");
-    theme->panel_fg_color = get_color("#ffffff");
+    ThemePixels *entry = &spec->cache[slot];
+    entry->visual = id;
+    entry->colormap = cmap;
+    
+    parse_theme_colors(spec);
+    if (visual->class == TrueColor) {
+        // No server involvement: the pixel is the channels packed by mask
+        truecolor_pixels(visual, spec->rgb, entry->pixels);
+        entry->allocated = 0;
+        entry->failed = 0;
+    } else {
+        entry->allocated = 1;
+        entry->failed = allocate_pixels(cmap, spec->rgb, entry->pixels, (1u << THEME_COLOR_COUNT) - 1);
+    }
     
-    // Menu colors
-    theme->menu_bg_color = get_color("#f5f5f5");
-    theme->menu_fg_color = get_color("#000000");
-    theme->menu_highlight_bg_color = get_color("#5294e2");
-    theme->menu_disabled_fg_color = get_color("#888888");
+    return entry->pixels;
+}
+
+// Fill a theme from a built-in theme's cached colors
+static void apply_theme_spec(Theme *theme, ThemeSpec *spec) {
+    if (!theme) return;
     
-    // Taskbar colors
-    theme->taskbar_button_bg = get_color("#2f343f");
-    theme->taskbar_button_fg = get_color("#ffffff");
-    theme->taskbar_button_active_bg = get_color("#5294e2");
+    // Set theme name, releasing the previous theme's strings
+    free(theme->name);
+    free(theme->font_name);
+    theme->name = strdup(spec->name);
+    theme->generation = ++theme_generation;
     
-    // Desktop colors
-    theme->desktop_bg_color = get_color("#2f343f");
-    theme->desktop_icon_color = get_color("#5294e2");
-    theme->desktop_icon_label_bg = get_color("#000000");
-    theme->desktop_icon_label_fg = get_color("#ffffff");
+    // Cached GCs hold the old theme's colors
+    flush_gc_cache();
     
-    // Workspace switcher colors
-    theme->workspace_active_color = get_color("#5294e2");
+    // Colors
+    const unsigned long *pixels = theme_pixels(spec);
+    for (int i = 0; i < THEME_COLOR_COUNT; i++) {
+        *(unsigned long *)((char *)theme + theme_color_fields[i]) = pixels[i];
+    }
     
     // Font configuration
     theme->font_name = strdup("fixed");
@@ -147,130 +453,19 @@ void create_default_theme(Theme *theme) {
     theme->button_corner_radius = 2;
 }
 
+// Create a default theme (medium gray with blue accents)
+void create_default_theme(Theme *theme) {
+    apply_theme_spec(theme, &default_theme_spec);
+}
+
 // Create a dark theme
 void create_dark_theme(Theme *theme) {
-    if (!theme) return;
-    
-    // Set theme name
-    theme->name = strdup("dark");
-    
-    // Window colors
-    theme->bg_color = get_color("#2f343f");
-    theme->fg_color = get_color("#ffffff");
-    theme->border_color = get_color("#1a1a1a");
-    
-    // Title bar colors
-    theme->title_bg_color = get_color("#2f343f");
-    theme->title_fg_color = get_color("#d3dae3");
-    theme->title_active_bg_color = get_color("#5294e2");
-    theme->title_active_fg_color = get_color("#ffffff");
-    
-    // Button colors
-    theme->button_bg_color = get_color("#383c4a");
-    theme->button_fg_color = get_color("#d3dae3");
-    theme->button_hover_bg_color = get_color("#404552");
-    theme->button_active_bg_color = get_color("#5294e2");
-    
-    // Panel colors
-    theme->panel_bg_color = get_color("#2f343f");
-    theme->panel_fg_color = get_color("#d3dae3");
-    
-    // Menu colors
-    theme->menu_bg_color = get_color("#383c4a");
-    theme->menu_fg_color = get_color("#d3dae3");
-    theme->menu_highlight_bg_color = get_color("#5294e2");
-    theme->menu_disabled_fg_color = get_color("#7c818c");
-    
-    // Taskbar colors
-    theme->taskbar_button_bg = get_color("#383c4a");
-    theme->taskbar_button_fg = get_color("#d3dae3");
-    theme->taskbar_button_active_bg = get_color("#5294e2");
-    
-    // Desktop colors
-    theme->desktop_bg_color = get_color("#2f343f");
-    theme->desktop_icon_color = get_color("#5294e2");
-    theme->desktop_icon_label_bg = get_color("#2f343f");
-    theme->desktop_icon_label_fg = get_color("#d3dae3");
-    
-    // Workspace switcher colors
-    theme->workspace_active_color = get_color("#5294e2");
-    
-    // Font configuration
-    theme->font_name = strdup("fixed");
-    theme->font_size = 12;
-    
-    // Border widths
-    theme->window_border_width = 1;
-    theme->button_border_width = 1;
-    
-    // Dimensions
-    theme->titlebar_height = 20;
-    theme->panel_height = 30;
-    theme->menu_item_height = 20;
-    theme->button_corner_radius = 2;
+    apply_theme_spec(theme, &dark_theme_spec);
 }
 
 // Create a light theme
 void create_light_theme(Theme *theme) {
-    if (!theme) return;
-    
-    // Set theme name
-    theme->name = strdup("light");
-    
-    // Window colors
-    theme->bg_color = get_color("#f5f5f5");
-    theme->fg_color = get_color("#000000");
-    theme->border_color = get_color("#cccccc");
-    
-    // Title bar colors
-    theme->title_bg_color = get_color("#e6e6e6");
-    theme->title_fg_color = get_color("#000000");
-    theme->title_active_bg_color = get_color("#5294e2");
-    theme->title_active_fg_color = get_color("#ffffff");
-    
-    // Button colors
-    theme->button_bg_color = get_color("#e6e6e6");
-    theme->button_fg_color = get_color("#000000");
-    theme->button_hover_bg_color = get_color("#f0f0f0");
-    theme->button_active_bg_color = get_color("#5294e2");
-    
-    // Panel colors
-    theme->panel_bg_color = get_color("#e6e6e6");
-    theme->panel_fg_color = get_color("#000000");
-    
-    // Menu colors
-    theme->menu_bg_color = get_color("#f5f5f5");
-    theme->menu_fg_color = get_color("#000000");
-    theme->menu_highlight_bg_color = get_color("#5294e2");
-    theme->menu_disabled_fg_color = get_color("#888888");
-    
-    // Taskbar colors
-    theme->taskbar_button_bg = get_color("#e6e6e6");
-    theme->taskbar_button_fg = get_color("#000000");
-    theme->taskbar_button_active_bg = get_color("#5294e2");
-    
-    // Desktop colors
-    theme->desktop_bg_color = get_color("#f5f5f5");
-    theme->desktop_icon_color = get_color("#5294e2");
-    theme->desktop_icon_label_bg = get_color("#f5f5f5");
-    theme->desktop_icon_label_fg = get_color("#000000");
-    
-    // Workspace switcher colors
-    theme->workspace_active_color = get_color("#5294e2");
-    
-    // Font configuration
-    theme->font_name = strdup("fixed");
-    theme->font_size = 12;
-    
-    // Border widths
-    theme->window_border_width = 1;
-    theme->button_border_width = 1;
-    
-    // Dimensions
-    theme->titlebar_height = 20;
-    theme->panel_height = 30;
-    theme->menu_item_height = 20;
-    theme->button_corner_radius = 2;
+    apply_theme_spec(theme, &light_theme_spec);
 }
 
 // Apply a theme to a window
@@ -290,4 +485,6 @@ void free_theme(Theme *theme) {
     // Free strings
     if (theme->name) free(theme->name);
     if (theme->font_name) free(theme->font_name);
+    theme->name = NULL;
+    theme->font_name = NULL;
 }
@@ -10,6 +10,7 @@
 // Theme structure
 typedef struct {
     char *name;
+    int generation;     // Changes every time a theme is loaded into this struct
     
     // Window colors
     unsigned long bg_color;
@@ -71,6 +72,8 @@ typedef struct {
 void init_themes();
 
 // Load a theme by name
+// theme must be zeroed or hold a previously loaded theme, whose strings
+// are released; colors are parsed and allocated once per theme and visual
 int load_theme(Theme *theme, const char *theme_name);
 
 // Get the current theme
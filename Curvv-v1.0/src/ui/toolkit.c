@@ -12,6 +12,7 @@
 #include "toolkit.h"
 #include "themes.h"
 #include "widgets.h"
+#include "gc_cache.h"
 
 // Global display and window references
 static Display *display;
@@ -41,6 +42,9 @@ void init_toolkit(Display *dpy, Window root_win, int scr) {
         fprintf(stderr, "Failed to load default font, using server default\n");
     }
     
+    // Share GCs between redraws
+    init_gc_cache(display, root);
+    
     // Create default GC
     default_gc = XCreateGC(display, root, 0, NULL);
     if (default_font) {
@@ -120,17 +124,36 @@ unsigned long get_color(Display *dpy, const char *color_name) {
     return color.pixel;
 }
 
-// Create a graphics context
+// Get a shared graphics context from the cache
 GC create_gc(Display *dpy, Window win, unsigned long foreground, unsigned long background) {
-    GC gc;
+    (void)win;
+    GCKey key;
+    
+    // Toolkit windows all have the default depth
+    key.depth = DefaultDepth(dpy, DefaultScreen(dpy));
+    key.foreground = foreground;
+    key.background = background;
+    key.font = default_font ? default_font->fid : None;
+    key.line_width = 1;
+    key.line_style = LineSolid;
+    
+    return acquire_gc(&key);
+}
+
+// Give back a shared graphics context
+void free_gc(Display *dpy, GC gc) {
+    (void)dpy;
+    release_gc(gc);
+}
+
+// Create a graphics context owned by one widget
+GC create_widget_gc(Display *dpy, Drawable drawable) {
     XGCValues values;
     
-    values.foreground = foreground;
-    values.background = background;
     values.line_width = 1;
     values.line_style = LineSolid;
     
-    gc = XCreateGC(dpy, win, GCForeground | GCBackground | GCLineWidth | GCLineStyle, &values);
+    GC gc = XCreateGC(dpy, drawable, GCLineWidth | GCLineStyle, &values);
     
     // Set font if available
     if (default_font) {
@@ -140,9 +163,11 @@ GC create_gc(Display *dpy, Window win, unsigned long foreground, unsigned long b
     return gc;
 }
 
-// Free a graphics context
-void free_gc(Display *dpy, GC gc) {
-    XFreeGC(dpy, gc);
+// Free a widget's graphics context
+void free_widget_gc(Display *dpy, GC gc) {
+    if (gc) {
+        XFreeGC(dpy, gc);
+    }
 }
 
 // Drawing primitives
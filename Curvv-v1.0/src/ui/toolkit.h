@@ -241,9 +241,18 @@ void draw_image(Display *dpy, Window win, GC gc, int x, int y, const char *xpm_d
 
 // Color utilities
 unsigned long get_color(Display *dpy, const char *color_name);
+
+// Graphics contexts
+// Shared GCs come from a cache and must not be changed; give them back
+// with free_gc when the redraw is done
 GC create_gc(Display *dpy, Window win, unsigned long foreground, unsigned long background);
 void free_gc(Display *dpy, GC gc);
 
+// A widget that switches colors while drawing keeps its own GC for its
+// lifetime and only changes the foreground
+GC create_widget_gc(Display *dpy, Drawable drawable);
+void free_widget_gc(Display *dpy, GC gc);
+
 // Event handling for widgets
 int handle_widget_event(XEvent *event);
 
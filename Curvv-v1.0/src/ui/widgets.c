@@ -82,6 +82,9 @@ DesktopIcon *create_desktop_icon(int x, int y, const char *label,
     
     XChangeWindowAttributes(display, icon->window, CWOverrideRedirect | CWEventMask, &attrs);
     
+    // One GC serves every redraw of the icon
+    icon->gc = create_widget_gc(display, icon->window);
+    
     // Map the window
     XMapWindow(display, icon->window);
     
@@ -102,7 +105,8 @@ void destroy_desktop_icon(DesktopIcon *icon) {
     if (icon->icon_path) free(icon->icon_path);
     if (icon->command) free(icon->command);
     
-    // Destroy the window
+    // Destroy the GC and the window
+    free_widget_gc(display, icon->gc);
     XDestroyWindow(display, icon->window);
     
     // Remove from our tracking array
@@ -127,8 +131,7 @@ void draw_desktop_icon(DesktopIcon *icon) {
     // Clear the window
     XClearWindow(display, icon->window);
     
-    // Create a GC for drawing
-    GC gc = create_gc(display, icon->window, current_theme.text_color, 0);
+    GC gc = icon->gc;
     
     // Draw a folder icon (since we don't load images)
     XSetForeground(display, gc, current_theme.desktop_icon_color);
@@ -151,9 +154,6 @@ void draw_desktop_icon(DesktopIcon *icon) {
         XDrawString(display, icon->window, gc, text_x, ICON_HEIGHT + 15, 
                    icon->label, strlen(icon->label));
     }
-    
-    // Free the GC
-    free_gc(display, gc);
 }
 
 static void desktop_icon_click_handler(XEvent *event, DesktopIcon *icon) {
@@ -401,6 +401,7 @@ Menu *create_menu() {
     menu->selected_item = -1;
     menu->parent = NULL;
     menu->window = None;
+    menu->gc = NULL;
     
     if (!menu->items) {
         fprintf(stderr, "Failed to allocate memory for menu items\n");
@@ -501,6 +502,9 @@ void show_menu(Menu *menu, int x, int y) {
         // Select events
         XSelectInput(display, menu->window, ExposureMask | ButtonPressMask | 
                                  ButtonReleaseMask | PointerMotionMask | LeaveWindowMask);
+        
+        // One GC serves every redraw of the menu
+        menu->gc = create_widget_gc(display, menu->window);
     }
     
     // Position the menu
@@ -526,7 +530,7 @@ void show_menu(Menu *menu, int x, int y) {
     XMapRaised(display, menu->window);
     
     // Draw the menu
-    GC gc = create_gc(display, menu->window, current_theme.menu_fg_color, current_theme.menu_bg_color);
+    GC gc = menu->gc;
     
     int y_pos = 0;
     for (int i = 0; i < menu->item_count; i++) {
@@ -562,8 +566,6 @@ void show_menu(Menu *menu, int x, int y) {
             y_pos += 20;
         }
     }
-    
-    free_gc(display, gc);
 }
 
 void hide_menu(Menu *menu) {
@@ -618,8 +620,9 @@ WorkspaceSwitcher *create_workspace_switcher(int x, int y, int width, int height
     // Map the window
     XMapWindow(display, switcher->window);
     
-    // Draw the switcher
-    GC gc = create_gc(display, switcher->window, current_theme.text_color, current_theme.panel_bg_color);
+    // Draw the switcher with the GC it keeps for every redraw
+    switcher->gc = create_widget_gc(display, switcher->window);
+    GC gc = switcher->gc;
     
     int cell_width = width / count;
     for (int i = 0; i < count; i++) {
@@ -639,8 +642,6 @@ WorkspaceSwitcher *create_workspace_switcher(int x, int y, int width, int height
                    height / 2 + 5, num, strlen(num));
     }
     
-    free_gc(display, gc);
-    
     return switcher;
 }
 
@@ -650,7 +651,7 @@ void workspace_switcher_set_current(WorkspaceSwitcher *switcher, int workspace)
     switcher->current_workspace = workspace;
     
     // Redraw the switcher
-    GC gc = create_gc(display, switcher->window, current_theme.text_color, current_theme.panel_bg_color);
+    GC gc = switcher->gc;
     
     XClearWindow(display, switcher->window);
     
@@ -671,14 +672,13 @@ void workspace_switcher_set_current(WorkspaceSwitcher *switcher, int workspace)
         XDrawString(display, switcher->window, gc, i * cell_width + (cell_width / 2) - 3, 
                    switcher->height / 2 + 5, num, strlen(num));
     }
-    
-    free_gc(display, gc);
 }
 
 void destroy_workspace_switcher(WorkspaceSwitcher *switcher) {
     if (!switcher) return;
     
-    // Destroy the window
+    // Destroy the GC and the window
+    free_widget_gc(display, switcher->gc);
     XDestroyWindow(display, switcher->window);
     
     // Free the structure
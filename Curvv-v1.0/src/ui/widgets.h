@@ -19,6 +19,7 @@ typedef struct {
     char *label;
     char *icon_path;
     char *command;
+    GC gc;              // Kept for the icon's lifetime; only the foreground changes
 } DesktopIcon;
 
 // Create a desktop icon
@@ -73,6 +74,7 @@ typedef struct Menu {
     int item_count;
     int selected_item;
     struct Menu *parent;
+    GC gc;              // Created with the window; only the foreground changes
 } Menu;
 
 // Create a menu
@@ -164,6 +166,7 @@ typedef struct {
     int width, height;
     int workspace_count;
     int current_workspace;
+    GC gc;              // Kept for the switcher's lifetime; only the foreground changes
 } WorkspaceSwitcher;
 
 // Create a workspace switcher
@@ -0,0 +1,566 @@
+/*
+ * compositor.c - Optional compositing mode for the window manager
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xfixes.h>
+#include <X11/extensions/Xrender.h>
+#include <X11/extensions/shape.h>
+
+#include "compositor.h"
+#include "registry.h"
+#include "xcb_backend.h"
+
+// A top-level window as the compositor sees it
+typedef struct {
+    Window id;
+    int x, y;               // Outer corner, including the border
+    int width, height;      // Inside the border
+    int border_width;
+    int viewable;
+    int input_only;         // Nothing to draw
+    int has_alpha;          // ARGB visual, blended over what is below
+    XRenderPictFormat *format;
+    Damage damage;
+    Pixmap pixmap;          // Offscreen contents; None until needed again
+    Picture picture;
+    int index;              // Position in the stacking order
+} CompWindow;
+
+// Global display and root window references
+static Display *display;
+static Window root;
+static int screen;
+static Theme *current_theme;
+
+static int active = 0;
+static int damage_event_base;
+
+// Where the finished frame is shown, and the buffer it is built in
+static Window overlay = None;
+static Picture overlay_picture = None;
+static Pixmap back_pixmap = None;
+static Picture back_picture = None;
+static int screen_width, screen_height;
+
+// The desktop color, and the theme generation it was taken from
+static Picture background_picture = None;
+static int background_theme = -1;
+
+// Top-level windows, bottom to top
+static CompWindow **stack = NULL;
+static int stack_count = 0;
+static int stack_capacity = 0;
+static Registry comp_registry;
+
+// Parts of the screen that need rebuilding
+static Region screen_damage = NULL;
+
+// Set when redirecting fails, i.e. another compositor is running
+static int redirect_failed;
+
+// Error handler used while redirecting the screen
+static int redirect_error_handler(Display *dpy, XErrorEvent *event) {
+    (void)dpy;
+    (void)event;
+    redirect_failed = 1;
+    return 0;
+}
+
+// Mark part of the screen for rebuilding
+static void damage_area(int x, int y, int width, int height) {
+    XRectangle rect;
+    rect.x = x;
+    rect.y = y;
+    rect.width = width;
+    rect.height = height;
+    XUnionRectWithRegion(&rect, screen_damage, screen_damage);
+}
+
+// Mark the part of the screen a window covers for rebuilding
+static void damage_window(CompWindow *cw) {
+    damage_area(cw->x, cw->y,
+                cw->width + 2 * cw->border_width, cw->height + 2 * cw->border_width);
+}
+
+// Drop a window's offscreen contents; they are fetched again when needed
+static void release_contents(CompWindow *cw) {
+    if (cw->picture != None) {
+        XRenderFreePicture(display, cw->picture);
+        cw->picture = None;
+    }
+    if (cw->pixmap != None) {
+        XFreePixmap(display, cw->pixmap);
+        cw->pixmap = None;
+    }
+}
+
+// Get a picture of a window's offscreen contents
+// Returns None if the window has nothing to draw
+static Picture window_picture(CompWindow *cw) {
+    if (cw->picture == None && cw->format) {
+        XRenderPictureAttributes pa;
+        pa.subwindow_mode = IncludeInferiors;
+        cw->pixmap = XCompositeNameWindowPixmap(display, cw->id);
+        cw->picture = XRenderCreatePicture(display, cw->pixmap, cw->format,
+                                           CPSubwindowMode, &pa);
+    }
+    return cw->picture;
+}
+
+// Put a window into the stacking order at a position
+static int stack_insert(CompWindow *cw, int position) {
+    if (stack_count == stack_capacity) {
+        int new_capacity = stack_capacity ? stack_capacity * 2 : 64;
+        CompWindow **new_stack = (CompWindow **)realloc(stack, new_capacity * sizeof(CompWindow *));
+        if (!new_stack) {
+            return 0;
+        }
+        stack = new_stack;
+        stack_capacity = new_capacity;
+    }
+
+    for (int i = stack_count; i > position; i--) {
+        stack[i] = stack[i - 1];
+        stack[i]->index = i;
+    }
+    stack[position] = cw;
+    cw->index = position;
+    stack_count++;
+    return 1;
+}
+
+// Take a window out of the stacking order
+static void stack_remove(CompWindow *cw) {
+    for (int i = cw->index; i < stack_count - 1; i++) {
+        stack[i] = stack[i + 1];
+        stack[i]->index = i;
+    }
+    stack_count--;
+}
+
+// Move a window to just above a sibling, or to the bottom for None
+static void restack_window(CompWindow *cw, Window above) {
+    CompWindow *sibling = above != None ? registry_lookup(&comp_registry, above, NULL) : NULL;
+    stack_remove(cw);
+    stack_insert(cw, sibling ? sibling->index + 1 : 0);
+}
+
+// Stop tracking a window
+static void untrack_window(CompWindow *cw, int destroyed) {
+    release_contents(cw);
+
+    // A destroyed window's damage object went with it
+    if (!destroyed && cw->damage != None) {
+        XDamageDestroy(display, cw->damage);
+    }
+
+    registry_remove(&comp_registry, cw->id);
+    stack_remove(cw);
+    free(cw);
+}
+
+// Start tracking a batch of top-level windows, stacked on top in order;
+// their attributes are fetched in one round trip
+static void track_windows(const Window *candidates, int count) {
+    Window *windows = (Window *)malloc(count * sizeof(Window));
+    ClientInfo *info = (ClientInfo *)malloc(count * sizeof(ClientInfo));
+    if (!windows || !info) {
+        fprintf(stderr, "Failed to allocate %d windows to composite\n", count);
+        free(windows);
+        free(info);
+        return;
+    }
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (candidates[i] != overlay && !registry_lookup(&comp_registry, candidates[i], NULL)) {
+            windows[n++] = candidates[i];
+        }
+    }
+
+    fetch_client_info(windows, n, info);
+
+    for (int i = 0; i < n; i++) {
+        if (!info[i].valid) {
+            continue;
+        }
+
+        CompWindow *cw = (CompWindow *)calloc(1, sizeof(CompWindow));
+        if (!cw) {
+            fprintf(stderr, "Failed to allocate composited window\n");
+            break;
+        }
+        cw->id = info[i].window;
+        cw->x = info[i].x;
+        cw->y = info[i].y;
+        cw->width = info[i].width;
+        cw->height = info[i].height;
+        cw->border_width = info[i].border_width;
+        cw->viewable = info[i].map_state == IsViewable;
+        cw->input_only = info[i].input_only;
+        cw->pixmap = None;
+        cw->picture = None;
+        cw->damage = None;
+
+        if (!cw->input_only) {
+            XVisualInfo template;
+            int matches;
+            template.visualid = info[i].visual;
+            XVisualInfo *visual = XGetVisualInfo(display, VisualIDMask, &template, &matches);
+            if (visual) {
+                cw->format = XRenderFindVisualFormat(display, visual->visual);
+                XFree(visual);
+            }
+            cw->has_alpha = cw->format && cw->format->type == PictTypeDirect &&
+                            cw->format->direct.alphaMask != 0;
+            cw->damage = XDamageCreate(display, cw->id, XDamageReportBoundingBox);
+        }
+
+        int tracked = registry_insert(&comp_registry, cw->id, 0, cw);
+        if (tracked && !stack_insert(cw, stack_count)) {
+            registry_remove(&comp_registry, cw->id);
+            tracked = 0;
+        }
+        if (!tracked) {
+            fprintf(stderr, "Failed to track composited window %lu\n", cw->id);
+            if (cw->damage != None) {
+                XDamageDestroy(display, cw->damage);
+            }
+            free(cw);
+            continue;
+        }
+
+        if (cw->viewable) {
+            damage_window(cw);
+        }
+    }
+
+    free_client_info(info, n);
+    free(windows);
+    free(info);
+}
+
+// Redirect the screen's top-level windows and start compositing them
+int init_compositor(Display *dpy, Window root_win, int scr, Theme *theme) {
+    display = dpy;
+    root = root_win;
+    screen = scr;
+    current_theme = theme;
+
+    int event_base, error_base, major, minor;
+    if (!XCompositeQueryExtension(display, &event_base, &error_base)) {
+        fprintf(stderr, "Composite extension not available\n");
+        return 0;
+    }
+    // The overlay window needs Composite 0.3
+    XCompositeQueryVersion(display, &major, &minor);
+    if (major == 0 && minor < 3) {
+        fprintf(stderr, "Composite %d.%d is too old\n", major, minor);
+        return 0;
+    }
+    if (!XDamageQueryExtension(display, &damage_event_base, &error_base)) {
+        fprintf(stderr, "Damage extension not available\n");
+        return 0;
+    }
+    XDamageQueryVersion(display, &major, &minor);
+    if (!XFixesQueryExtension(display, &event_base, &error_base)) {
+        fprintf(stderr, "XFixes extension not available\n");
+        return 0;
+    }
+    XFixesQueryVersion(display, &major, &minor);
+    if (!XRenderQueryExtension(display, &event_base, &error_base)) {
+        fprintf(stderr, "Render extension not available\n");
+        return 0;
+    }
+
+    // Only one client can redirect the screen manually
+    XGrabServer(display);
+    XSync(display, False);
+    redirect_failed = 0;
+    XErrorHandler previous_handler = XSetErrorHandler(redirect_error_handler);
+    XCompositeRedirectSubwindows(display, root, CompositeRedirectManual);
+    XSync(display, False);
+    XSetErrorHandler(previous_handler);
+    if (redirect_failed) {
+        XUngrabServer(display);
+        fprintf(stderr, "Another compositor is running\n");
+        return 0;
+    }
+
+    screen_width = DisplayWidth(display, screen);
+    screen_height = DisplayHeight(display, screen);
+    XRenderPictFormat *format = XRenderFindVisualFormat(display, DefaultVisual(display, screen));
+
+    // Show frames on the overlay, and let input pass through it
+    overlay = XCompositeGetOverlayWindow(display, root);
+    XserverRegion no_input = XFixesCreateRegion(display, NULL, 0);
+    XFixesSetWindowShapeRegion(display, overlay, ShapeInput, 0, 0, no_input);
+    XFixesDestroyRegion(display, no_input);
+    overlay_picture = XRenderCreatePicture(display, overlay, format, 0, NULL);
+
+    back_pixmap = XCreatePixmap(display, root, screen_width, screen_height,
+                                DefaultDepth(display, screen));
+    back_picture = XRenderCreatePicture(display, back_pixmap, format, 0, NULL);
+
+    registry_init(&comp_registry);
+    screen_damage = XCreateRegion();
+    active = 1;
+
+    // Track the windows that already exist, bottom to top
+    int count;
+    Window *existing = query_top_level_windows(root, &count);
+    if (existing) {
+        track_windows(existing, count);
+        free(existing);
+    }
+    XUngrabServer(display);
+
+    damage_area(0, 0, screen_width, screen_height);
+    printf("Compositing %d top-level windows\n", stack_count);
+    return 1;
+}
+
+// Whether compositing is on
+int compositor_active() {
+    return active;
+}
+
+// Start tracking a batch of newly created top-level windows
+void composite_windows_created(const Window *created, int count) {
+    if (active && count > 0) {
+        track_windows(created, count);
+    }
+}
+
+// A top-level window moved, resized or was restacked
+static void configure_window(XConfigureEvent *e) {
+    CompWindow *cw = registry_lookup(&comp_registry, e->window, NULL);
+    if (!cw) return;
+
+    Window below = cw->index > 0 ? stack[cw->index - 1]->id : None;
+    int resized = e->width != cw->width || e->height != cw->height ||
+                  e->border_width != cw->border_width;
+    if (!resized && e->x == cw->x && e->y == cw->y && e->above == below) {
+        return;
+    }
+
+    // Rebuild where it was and where it is; the windows it uncovered or
+    // now covers are drawn from their offscreen contents
+    if (cw->viewable) {
+        damage_window(cw);
+    }
+
+    cw->x = e->x;
+    cw->y = e->y;
+    cw->width = e->width;
+    cw->height = e->height;
+    cw->border_width = e->border_width;
+    if (resized) {
+        release_contents(cw);
+    }
+    if (e->above != below) {
+        restack_window(cw, e->above);
+    }
+
+    if (cw->viewable) {
+        damage_window(cw);
+    }
+}
+
+// A top-level window drew something
+static void window_damaged(XDamageNotifyEvent *e) {
+    // Rearm the report; with bounding box reporting the event covers all
+    // damage since the last one
+    XDamageSubtract(display, e->damage, None, None);
+
+    CompWindow *cw = registry_lookup(&comp_registry, e->drawable, NULL);
+    if (!cw || !cw->viewable) return;
+
+    damage_area(cw->x + cw->border_width + e->area.x,
+                cw->y + cw->border_width + e->area.y,
+                e->area.width, e->area.height);
+}
+
+// Track stacking, geometry and damage from an event
+void handle_composite_event(XEvent *e) {
+    if (!active) return;
+
+    CompWindow *cw;
+    switch (e->type) {
+        case ConfigureNotify:
+            if (e->xconfigure.event == root) {
+                configure_window(&e->xconfigure);
+            }
+            break;
+
+        case MapNotify:
+            cw = registry_lookup(&comp_registry, e->xmap.window, NULL);
+            if (cw && e->xmap.event == root) {
+                // Contents named before the unmap are stale
+                release_contents(cw);
+                cw->viewable = 1;
+                damage_window(cw);
+            }
+            break;
+
+        case UnmapNotify:
+            cw = registry_lookup(&comp_registry, e->xunmap.window, NULL);
+            if (cw && e->xunmap.event == root && cw->viewable) {
+                cw->viewable = 0;
+                damage_window(cw);
+                release_contents(cw);
+            }
+            break;
+
+        case DestroyNotify:
+            cw = registry_lookup(&comp_registry, e->xdestroywindow.window, NULL);
+            if (cw && e->xdestroywindow.event == root) {
+                if (cw->viewable) {
+                    damage_window(cw);
+                }
+                untrack_window(cw, 1);
+            }
+            break;
+
+        case ReparentNotify:
+            if (e->xreparent.event != root) {
+                break;
+            }
+            if (e->xreparent.parent == root) {
+                track_windows(&e->xreparent.window, 1);
+            } else {
+                // Framed clients are drawn as part of their frame
+                cw = registry_lookup(&comp_registry, e->xreparent.window, NULL);
+                if (cw) {
+                    if (cw->viewable) {
+                        damage_window(cw);
+                    }
+                    untrack_window(cw, 0);
+                }
+            }
+            break;
+
+        case CirculateNotify:
+            cw = registry_lookup(&comp_registry, e->xcirculate.window, NULL);
+            if (cw && e->xcirculate.event == root) {
+                stack_remove(cw);
+                stack_insert(cw, e->xcirculate.place == PlaceOnTop ? stack_count : 0);
+                if (cw->viewable) {
+                    damage_window(cw);
+                }
+            }
+            break;
+
+        default:
+            if (e->type == damage_event_base + XDamageNotify) {
+                window_damaged((XDamageNotifyEvent *)e);
+            }
+            break;
+    }
+}
+
+// Fill the desktop color picture from the current theme
+static void update_background() {
+    if (background_picture != None) {
+        XRenderFreePicture(display, background_picture);
+    }
+
+    // A repeating 1x1 picture; the pixmap is freed once the picture holds it
+    Pixmap pixmap = XCreatePixmap(display, root, 1, 1, DefaultDepth(display, screen));
+    GC gc = XCreateGC(display, pixmap, 0, NULL);
+    XSetForeground(display, gc, current_theme->desktop_bg_color);
+    XFillRectangle(display, pixmap, gc, 0, 0, 1, 1);
+    XFreeGC(display, gc);
+
+    XRenderPictureAttributes pa;
+    pa.repeat = True;
+    background_picture = XRenderCreatePicture(display, pixmap,
+        XRenderFindVisualFormat(display, DefaultVisual(display, screen)), CPRepeat, &pa);
+    XFreePixmap(display, pixmap);
+
+    background_theme = current_theme->generation;
+}
+
+// Rebuild the damaged parts of the screen
+void paint_composite() {
+    if (!active) return;
+
+    // A new theme means a new desktop color everywhere
+    if (background_theme != current_theme->generation) {
+        update_background();
+        damage_area(0, 0, screen_width, screen_height);
+    }
+
+    if (XEmptyRegion(screen_damage)) {
+        return;
+    }
+
+    // Build the damaged area in the back buffer, desktop first, then each
+    // window that overlaps it from the bottom up
+    XRenderSetPictureClipRegion(display, back_picture, screen_damage);
+    XRenderComposite(display, PictOpSrc, background_picture, None, back_picture,
+                     0, 0, 0, 0, 0, 0, screen_width, screen_height);
+
+    for (int i = 0; i < stack_count; i++) {
+        CompWindow *cw = stack[i];
+        if (!cw->viewable || cw->input_only) {
+            continue;
+        }
+
+        int width = cw->width + 2 * cw->border_width;
+        int height = cw->height + 2 * cw->border_width;
+        if (XRectInRegion(screen_damage, cw->x, cw->y, width, height) == RectangleOut) {
+            continue;
+        }
+
+        Picture picture = window_picture(cw);
+        if (picture == None) {
+            continue;
+        }
+        XRenderComposite(display, cw->has_alpha ? PictOpOver : PictOpSrc,
+                         picture, None, back_picture,
+                         0, 0, 0, 0, cw->x, cw->y, width, height);
+    }
+
+    // Show the finished area in one copy, so no partial frame is ever seen
+    XRenderSetPictureClipRegion(display, overlay_picture, screen_damage);
+    XRenderComposite(display, PictOpSrc, back_picture, None, overlay_picture,
+                     0, 0, 0, 0, 0, 0, screen_width, screen_height);
+
+    XDestroyRegion(screen_damage);
+    screen_damage = XCreateRegion();
+}
+
+// Stop compositing and let the server draw the windows again
+void shutdown_compositor() {
+    if (!active) return;
+    active = 0;
+
+    while (stack_count > 0) {
+        untrack_window(stack[stack_count - 1], 0);
+    }
+    free(stack);
+    stack = NULL;
+    stack_capacity = 0;
+    registry_destroy(&comp_registry);
+
+    if (background_picture != None) {
+        XRenderFreePicture(display, background_picture);
+        background_picture = None;
+    }
+    XRenderFreePicture(display, back_picture);
+    XFreePixmap(display, back_pixmap);
+    XRenderFreePicture(display, overlay_picture);
+    XCompositeReleaseOverlayWindow(display, root);
+    XCompositeUnredirectSubwindows(display, root, CompositeRedirectManual);
+
+    XDestroyRegion(screen_damage);
+    screen_damage = NULL;
+}
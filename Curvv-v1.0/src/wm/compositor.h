@@ -0,0 +1,37 @@
+/*
+ * compositor.h - Optional compositing mode for the window manager
+ *
+ * With compositing on, every top-level window draws offscreen. What each
+ * window draws is tracked with the Damage extension, and only the damaged
+ * parts of the screen are rebuilt, bottom window first, in a back buffer
+ * that is then copied to the Composite overlay window. Windows keep their
+ * contents offscreen, so one moving above another never exposes it.
+ */
+
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <X11/Xlib.h>
+#include "../ui/themes.h"
+
+// Redirect the screen's top-level windows and start compositing them
+// Returns 1 on success, 0 if the server lacks Composite, Damage, XFixes or
+// Render, or another compositor is running
+int init_compositor(Display *dpy, Window root_win, int scr, Theme *theme);
+
+// Whether compositing is on
+int compositor_active();
+
+// Start tracking a batch of newly created top-level windows
+void composite_windows_created(const Window *created, int count);
+
+// Track stacking, geometry and damage from an event
+void handle_composite_event(XEvent *e);
+
+// Rebuild the damaged parts of the screen
+void paint_composite();
+
+// Stop compositing and let the server draw the windows again
+void shutdown_compositor();
+
+#endif /* COMPOSITOR_H */
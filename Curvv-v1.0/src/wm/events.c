@@ -4,11 +4,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <X11/Xlib.h>
+#include <X11/Xatom.h>
 #include <X11/keysym.h>
 
 #include "events.h"
 #include "window.h"
+#include "xcb_backend.h"
 #include "panel.h"
 #include "menu.h"
 #include "../state/state_manager.h"
@@ -41,6 +45,81 @@ extern Cursor cursor_resize_w;
 // Root menu
 static Menu *root_menu = NULL;
 
+// Most title changes fetched together
+#define TITLE_BATCH_MAX 64
+
+// Drag geometry waiting for the next frame
+#define GEOMETRY_FRAME_MS 16
+
+static struct {
+    int pending;
+    Window window;      // Client window being dragged
+    int x, y;
+    int width, height;
+    double last_apply_ms;
+} pending_geometry;
+
+// Monotonic time in milliseconds
+static double monotonic_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// Move and resize a managed window's frame and client, and update the cache
+static void configure_managed_window(WMWindow *w, int x, int y, int width, int height) {
+    if (width == w->width && height == w->height) {
+        // A move is a single request
+        if (x != w->x || y != w->y) {
+            XMoveWindow(display, w->frame, x, y);
+        }
+    } else {
+        // The buttons have NorthEast gravity and follow the titlebar's right edge
+        XMoveResizeWindow(display, w->frame, x, y, width, height + w->titlebar_height);
+        XResizeWindow(display, w->titlebar, width, w->titlebar_height);
+        XResizeWindow(display, w->window, width, height);
+    }
+    
+    int resized = width != w->width;
+    w->x = x;
+    w->y = y;
+    w->width = width;
+    w->height = height;
+    
+    // The cached titlebar is only valid at the width it was rendered at
+    if (resized) {
+        draw_window_titlebar(w->window, w->is_focused);
+    }
+}
+
+// Send the pending drag geometry to the server as one batch
+static void apply_pending_geometry() {
+    pending_geometry.pending = 0;
+    pending_geometry.last_apply_ms = monotonic_ms();
+    
+    WMWindow *w = find_window(pending_geometry.window);
+    if (!w) return;
+    
+    configure_managed_window(w, pending_geometry.x, pending_geometry.y,
+                             pending_geometry.width, pending_geometry.height);
+}
+
+// Apply pending drag geometry if a frame has passed since the last update
+int flush_pending_geometry() {
+    if (!pending_geometry.pending) {
+        return -1;
+    }
+    
+    double wait = pending_geometry.last_apply_ms + GEOMETRY_FRAME_MS - monotonic_ms();
+    if (wait > 0) {
+        return (int)wait + 1;
+    }
+    
+    apply_pending_geometry();
+    XFlush(display);
+    return -1;
+}
+
 // X error handler
 int error_handler(Display *display, XErrorEvent *event) {
     char error_text[256];
@@ -64,6 +143,9 @@ void handle_window_destroy(Window w) {
     
     // Remove window state
     remove_window_state(w);
+    
+    // Forget the client and its frame
+    unmanage_window(w);
 }
 
 // Handle configure request
@@ -79,60 +161,163 @@ void handle_configure_request(XConfigureRequestEvent *e) {
     changes.sibling = e->above;
     changes.stack_mode = e->detail;
     
-    // Apply the changes
-    XConfigureWindow(display, e->window, e->value_mask, &changes);
+    // Windows we don't manage get exactly what they asked for
+    WindowRole role;
+    WMWindow *w = find_window_role(e->window, &role);
+    if (!w || role != ROLE_CLIENT) {
+        XConfigureWindow(display, e->window, e->value_mask, &changes);
+        return;
+    }
     
-    // Update our state management if we're managing this window
+    // Fill in the fields not in the request from the cache and apply the
+    // geometry to the frame, so the client stays at its place inside it
     if (e->value_mask & (CWWidth | CWHeight | CWX | CWY)) {
-        // Get current values for fields not in the request
-        XWindowAttributes attr;
-        if (XGetWindowAttributes(display, e->window, &attr)) {
-            int x = (e->value_mask & CWX) ? e->x : attr.x;
-            int y = (e->value_mask & CWY) ? e->y : attr.y;
-            int width = (e->value_mask & CWWidth) ? e->width : attr.width;
-            int height = (e->value_mask & CWHeight) ? e->height : attr.height;
-            
-            update_window_geometry(e->window, x, y, width, height);
-        }
+        int x = (e->value_mask & CWX) ? e->x : w->x;
+        int y = (e->value_mask & CWY) ? e->y : w->y;
+        int width = (e->value_mask & CWWidth) ? e->width : w->width;
+        int height = (e->value_mask & CWHeight) ? e->height : w->height;
+        
+        configure_managed_window(w, x, y, width, height);
+        save_window_state(w->window);
+    }
+    
+    // Restacking applies to the frame
+    if (e->value_mask & CWStackMode) {
+        XConfigureWindow(display, w->frame, e->value_mask & (CWSibling | CWStackMode), &changes);
     }
 }
 
 // Handle map request
 void handle_map_request(Window w) {
-    // Get the window attributes
-    XWindowAttributes attr;
-    if (!XGetWindowAttributes(display, w, &attr)) {
-        fprintf(stderr, "Failed to get window attributes for map request\n");
-        return;
+    // Clients seen at creation already have a frame and cached title
+    WMWindow *win = find_window(w);
+    if (!win) {
+        // Not seen at creation; fetch its attributes and title together
+        ClientInfo info;
+        if (!fetch_client_info(&w, 1, &info)) {
+            fprintf(stderr, "Failed to get window attributes for map request\n");
+            free_client_info(&info, 1);
+            return;
+        }
+        
+        // Skip windows we don't want to manage
+        if (info.override_redirect) {
+            free_client_info(&info, 1);
+            XMapWindow(display, w);
+            return;
+        }
+        
+        // Set up the window frame
+        XWindowAttributes attr;
+        client_info_attributes(&info, &attr);
+        setup_window_frame(w, &attr, info.title);
+        free_client_info(&info, 1);
+        win = find_window(w);
+        if (!win) {
+            return;
+        }
     }
     
-    // Skip windows we don't want to manage
-    if (attr.override_redirect) {
-        XMapWindow(display, w);
+    printf("Mapping window: %lu (%s)\n", w, win->title ? win->title : "Unnamed");
+    
+    XMapWindow(display, w);
+    
+    // Add a taskbar button, replacing the one from an earlier mapping
+    remove_panel_taskbutton(w);
+    add_panel_taskbutton(w, win->title);
+    
+    // Set focus to this window
+    set_focus(w);
+}
+
+// Keep the cached geometry in step with the server
+void handle_configure_notify(XConfigureEvent *e) {
+    WindowRole role;
+    WMWindow *w = find_window_role(e->window, &role);
+    if (!w) {
         return;
     }
     
-    // Get the window name
-    char *window_name = NULL;
-    XTextProperty text_prop;
-    if (XGetWMName(display, w, &text_prop) && text_prop.value) {
-        window_name = (char *)text_prop.value;
+    // During a drag we are the source of every change and the cache runs
+    // ahead of these notifications; older ones would roll it back
+    if (resize_mode != RESIZE_NONE && w->window == pending_geometry.window) {
+        return;
     }
     
-    printf("Mapping window: %lu (%s)\n", w, window_name ? window_name : "Unnamed");
-    
-    // Set up the window frame
-    setup_window_frame(w, &attr);
+    // The frame holds the position; the client inside it holds the size
+    if (role == ROLE_FRAME) {
+        w->x = e->x;
+        w->y = e->y;
+    } else if (role == ROLE_CLIENT) {
+        w->width = e->width;
+        w->height = e->height;
+    }
+}
+
+// Whether a property holds a window title
+static int is_title_property(Atom atom) {
+    return atom == XA_WM_NAME || (atom != None && atom == wm_atoms.net_wm_name);
+}
+
+// Match queued title changes
+static Bool is_title_event(Display *dpy, XEvent *ev, XPointer arg) {
+    (void)dpy;
+    (void)arg;
+    return ev->type == PropertyNotify && is_title_property(ev->xproperty.atom);
+}
+
+// Apply a fetched title to a managed window
+static void apply_window_title(WMWindow *w, const char *title) {
+    const char *new_title = title ? title : "Untitled";
+    if (!w->title || strcmp(w->title, new_title) != 0) {
+        update_window_title(w->window, new_title);
+        update_panel_taskbutton(w->window, new_title);
+        save_window_state(w->window);
+    }
+}
+
+// Keep the cached titles in step with the clients' names
+void handle_property_notify(XPropertyEvent *e) {
+    if (!is_title_property(e->atom)) {
+        return;
+    }
     
-    // Add a taskbar button
-    add_panel_taskbutton(w, window_name);
+    // Take every queued title change with this one; clients that retitle
+    // rapidly, or many clients at once, then cost one round trip in all
+    Window windows[TITLE_BATCH_MAX];
+    int count = 0;
+    XEvent queued;
+    XPropertyEvent *next = e;
+    for (;;) {
+        WindowRole role;
+        if (find_window_role(next->window, &role) && role == ROLE_CLIENT) {
+            int seen = 0;
+            for (int i = 0; i < count; i++) {
+                if (windows[i] == next->window) {
+                    seen = 1;
+                    break;
+                }
+            }
+            if (!seen) {
+                windows[count++] = next->window;
+            }
+        }
+        
+        if (count == TITLE_BATCH_MAX || !XCheckIfEvent(display, &queued, is_title_event, NULL)) {
+            break;
+        }
+        next = &queued.xproperty;
+    }
     
-    // Set focus to this window
-    set_focus(w);
+    char *titles[TITLE_BATCH_MAX];
+    fetch_window_titles(windows, count, titles);
     
-    // Free the window name
-    if (text_prop.value) {
-        XFree(text_prop.value);
+    for (int i = 0; i < count; i++) {
+        WMWindow *w = find_window(windows[i]);
+        if (w) {
+            apply_window_title(w, titles[i]);
+        }
+        free(titles[i]);
     }
 }
 
@@ -163,21 +348,22 @@ void handle_button_press(XButtonEvent *e) {
     FramePart part = get_frame_part(e->window, e->x, e->y);
     
     // Handle window specific buttons
-    WMWindow *w = find_window(e->window);
+    WindowRole role;
+    WMWindow *w = find_window_role(e->window, &role);
     if (w) {
-        if (e->window == w->close_button) {
+        if (role == ROLE_CLOSE_BUTTON) {
             // Close button clicked
             close_window(w->window);
             return;
-        } else if (e->window == w->max_button) {
+        } else if (role == ROLE_MAX_BUTTON) {
             // Maximize button clicked
             maximize_window(w->window);
             return;
-        } else if (e->window == w->min_button) {
+        } else if (role == ROLE_MIN_BUTTON) {
             // Minimize button clicked
             minimize_window(w->window);
             return;
-        } else if (e->window == w->titlebar) {
+        } else if (role == ROLE_TITLEBAR) {
             // Titlebar clicked
             if (e->button == Button1) {
                 // Left click - start moving the window
@@ -305,10 +491,16 @@ void handle_button_release(XButtonEvent *e) {
     if (resize_mode != RESIZE_NONE) {
         resize_mode = RESIZE_NONE;
         
-        // Reset cursor
+        // Apply the final geometry now rather than at the next frame
+        if (pending_geometry.pending) {
+            apply_pending_geometry();
+        }
+        
+        // Reset cursor and save the state once for the whole drag
         WMWindow *w = find_window(e->window);
         if (w) {
             XDefineCursor(display, w->frame, cursor_normal);
+            save_window_state(w->window);
         }
         
         // Ungrab pointer
@@ -328,6 +520,21 @@ void handle_motion_notify(XMotionEvent *e) {
         return;
     }
     
+    // Only the latest position matters; skip the motion events queued
+    // right behind this one, but never past another event, so a button
+    // release or a crossing is still handled at the position it happened
+    XMotionEvent latest = *e;
+    XEvent queued;
+    while (XEventsQueued(display, QueuedAlready) > 0) {
+        XPeekEvent(display, &queued);
+        if (queued.type != MotionNotify || queued.xmotion.window != e->window) {
+            break;
+        }
+        XNextEvent(display, &queued);
+        latest = queued.xmotion;
+    }
+    e = &latest;
+    
     // Handle resize/move operations
     if (resize_mode != RESIZE_NONE) {
         WMWindow *w = find_window(e->window);
@@ -336,22 +543,18 @@ void handle_motion_notify(XMotionEvent *e) {
             int dy = e->y_root - drag_start_y;
             
             if (resize_mode == MOVE) {
-                // Move the window
-                int new_x = window_start_x + dx;
-                int new_y = window_start_y + dy;
-                
-                // Move the window
-                XMoveWindow(display, w->frame, new_x, new_y);
-                
-                // Update our state
-                w->x = new_x;
-                w->y = new_y;
+                // Move the window at the next frame
+                pending_geometry.x = window_start_x + dx;
+                pending_geometry.y = window_start_y + dy;
+                pending_geometry.width = window_start_width;
+                pending_geometry.height = window_start_height;
             } else {
-                // Resize operation
-                int new_x = w->x;
-                int new_y = w->y;
-                int new_width = w->width;
-                int new_height = w->height;
+                // Resize operation; edges that don't move keep their
+                // drag-start values, whatever the cache says meanwhile
+                int new_x = window_start_x;
+                int new_y = window_start_y;
+                int new_width = window_start_width;
+                int new_height = window_start_height;
                 
                 // Calculate new size based on resize mode
                 switch (resize_mode) {
@@ -397,31 +600,18 @@ void handle_motion_notify(XMotionEvent *e) {
                 if (new_width < 50) new_width = 50;
                 if (new_height < 50) new_height = 50;
                 
-                // Apply the new size
-                XMoveResizeWindow(display, w->frame, new_x, new_y, 
-                               new_width, new_height + w->titlebar_height);
-                XResizeWindow(display, w->window, new_width, new_height);
-                
-                // Resize the titlebar
-                XResizeWindow(display, w->titlebar, new_width, w->titlebar_height);
-                
-                // Reposition the buttons
-                int button_x = new_width - 16 - 2;
-                XMoveWindow(display, w->close_button, button_x, 2);
-                button_x -= (16 + 2);
-                XMoveWindow(display, w->max_button, button_x, 2);
-                button_x -= (16 + 2);
-                XMoveWindow(display, w->min_button, button_x, 2);
-                
-                // Update our state
-                w->x = new_x;
-                w->y = new_y;
-                w->width = new_width;
-                w->height = new_height;
+                // Apply the new size at the next frame
+                pending_geometry.x = new_x;
+                pending_geometry.y = new_y;
+                pending_geometry.width = new_width;
+                pending_geometry.height = new_height;
             }
             
-            // Save the window state
-            save_window_state(w->window);
+            pending_geometry.window = w->window;
+            pending_geometry.pending = 1;
+            
+            // The first update of a drag goes out immediately
+            flush_pending_geometry();
         }
     } else {
         // Update cursor based on position in window frame
@@ -483,13 +673,8 @@ void handle_key_press(XKeyEvent *e) {
         }
         
         // Find the current window index
-        int current_idx = -1;
-        for (int i = 0; i < count; i++) {
-            if (get_window_at_index(i) == focused_window) {
-                current_idx = i;
-                break;
-            }
-        }
+        WMWindow *current = find_window(focused_window);
+        int current_idx = current ? current->index : -1;
         
         // Move to the next window
         int next_idx = (current_idx + 1) % count;
@@ -24,4 +24,13 @@ void handle_key_press(XKeyEvent *e);
 void handle_enter_window(Window w);
 void handle_client_message(XClientMessageEvent *e);
 
+// Keep the cached window geometry and title current
+void handle_configure_notify(XConfigureEvent *e);
+void handle_property_notify(XPropertyEvent *e);
+
+// Apply drag geometry that is due; move/resize updates are sent at most
+// once per frame. Returns milliseconds until pending geometry is due, or
+// -1 if nothing is pending
+int flush_pending_geometry();
+
 #endif /* EVENTS_H */
@@ -71,6 +71,7 @@ Menu *create_menu() {
     menu->item_count = 0;
     menu->selected_item = -1;
     menu->parent = NULL;
+    menu->gc = NULL;
     
     if (!menu->items) {
         fprintf(stderr, "Failed to allocate memory for menu items\n");
@@ -183,6 +184,9 @@ static void create_menu_window(Menu *menu) {
     XSelectInput(display, menu->window, ExposureMask | ButtonPressMask | 
                                ButtonReleaseMask | PointerMotionMask | 
                                LeaveWindowMask);
+    
+    // One GC serves every redraw of the menu
+    menu->gc = create_widget_gc(display, menu->window);
 }
 
 // Show a menu at a specific position
@@ -290,7 +294,10 @@ static void draw_menu_item(Menu *menu, int index) {
     }
     
     MenuItem *item = menu->items[index];
-    GC gc = XCreateGC(display, menu->window, 0, NULL);
+    GC gc = menu->gc;
+    if (!gc) {
+        return;
+    }
     
     // Calculate the item's position
     int y = 0;
@@ -351,8 +358,6 @@ static void draw_menu_item(Menu *menu, int index) {
             XFillPolygon(display, menu->window, gc, points, 3, Convex, CoordModeOrigin);
         }
     }
-    
-    XFreeGC(display, gc);
 }
 
 // Position a submenu relative to its parent
@@ -650,6 +655,7 @@ void free_menu(Menu *menu) {
     
     // Destroy the window if it exists
     if (menu->window != None) {
+        free_widget_gc(display, menu->gc);
         XDestroyWindow(display, menu->window);
     }
     
@@ -35,6 +35,7 @@ typedef struct Menu {
     int item_count;
     int selected_item;
     struct Menu *parent;
+    GC gc;              // Kept for the menu's lifetime; only the foreground changes
 } Menu;
 
 // Initialize the menu system
@@ -44,6 +44,9 @@ static int panel_item_count = 0;
 static PanelItem panel_items[MAX_PANEL_ITEMS];
 static int panel_next_x = 0;
 
+// Drawing context shared by every panel item; redraws only change its foreground
+static GC panel_gc = NULL;
+
 // Panel clock timer
 static time_t last_clock_update = 0;
 
@@ -80,6 +83,9 @@ void init_panel(Display *dpy, Window root_win, int scr, Theme *theme) {
     // Map the panel window
     XMapWindow(display, panel_window);
     
+    // Items are children of the panel with its depth, so one GC draws them all
+    panel_gc = create_widget_gc(display, panel_window);
+    
     // Position the panel according to the default position
     position_panel();
     
@@ -567,9 +573,9 @@ void add_panel_custom(const char *label, void (*click_handler)(int button, int x
 
 // Draw a single panel item
 static void draw_panel_item(PanelItem *item) {
-    if (!item || !item->window) return;
+    if (!item || !item->window || !panel_gc) return;
     
-    GC gc = XCreateGC(display, item->window, 0, NULL);
+    GC gc = panel_gc;
     
     // Set colors based on item type
     switch (item->type) {
@@ -611,8 +617,6 @@ static void draw_panel_item(PanelItem *item) {
             }
             break;
     }
-    
-    XFreeGC(display, gc);
 }
 
 // Draw the entire panel
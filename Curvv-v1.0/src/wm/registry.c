@@ -0,0 +1,155 @@
+/*
+ * registry.c - XID lookup table implementation
+ *
+ * Linear probing with backward-shift deletion, so removals leave no
+ * tombstones and probe sequences stay short under churn. The table is
+ * kept at most 70% full.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "registry.h"
+
+#define REGISTRY_INITIAL_CAPACITY 64
+
+// Home slot for an XID
+// XIDs from one client differ only in their low bits, so they are
+// spread with a multiplicative hash
+static unsigned long registry_slot(const Registry *reg, Window xid) {
+    unsigned long long h = (unsigned long long)xid * 0x9E3779B97F4A7C15ULL;
+    return (unsigned long)(h >> 32) & (reg->capacity - 1);
+}
+
+// Initialize an empty registry
+void registry_init(Registry *reg) {
+    reg->entries = NULL;
+    reg->capacity = 0;
+    reg->count = 0;
+}
+
+// Free the registry's storage
+void registry_destroy(Registry *reg) {
+    free(reg->entries);
+    reg->entries = NULL;
+    reg->capacity = 0;
+    reg->count = 0;
+}
+
+// Rehash every entry into a table of the given capacity
+static int registry_resize(Registry *reg, unsigned long capacity) {
+    RegistryEntry *old_entries = reg->entries;
+    unsigned long old_capacity = reg->capacity;
+
+    RegistryEntry *entries = (RegistryEntry *)calloc(capacity, sizeof(RegistryEntry));
+    if (!entries) {
+        fprintf(stderr, "Failed to grow window registry to %lu entries\n", capacity);
+        return 0;
+    }
+
+    reg->entries = entries;
+    reg->capacity = capacity;
+
+    for (unsigned long i = 0; i < old_capacity; i++) {
+        if (old_entries[i].xid == None) {
+            continue;
+        }
+        unsigned long slot = registry_slot(reg, old_entries[i].xid);
+        while (entries[slot].xid != None) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        entries[slot] = old_entries[i];
+    }
+
+    free(old_entries);
+    return 1;
+}
+
+// Register an XID, replacing any previous entry for it
+int registry_insert(Registry *reg, Window xid, int role, void *data) {
+    if (xid == None) {
+        return 0;
+    }
+
+    // Keep the load factor under 70%
+    if ((reg->count + 1) * 10 > reg->capacity * 7) {
+        unsigned long capacity = reg->capacity ? reg->capacity * 2 : REGISTRY_INITIAL_CAPACITY;
+        if (!registry_resize(reg, capacity)) {
+            return 0;
+        }
+    }
+
+    unsigned long slot = registry_slot(reg, xid);
+    while (reg->entries[slot].xid != None && reg->entries[slot].xid != xid) {
+        slot = (slot + 1) & (reg->capacity - 1);
+    }
+
+    if (reg->entries[slot].xid == None) {
+        reg->count++;
+    }
+    reg->entries[slot].xid = xid;
+    reg->entries[slot].role = role;
+    reg->entries[slot].data = data;
+    return 1;
+}
+
+// Find the slot holding an XID, or -1
+static long registry_find(const Registry *reg, Window xid) {
+    if (reg->capacity == 0 || xid == None) {
+        return -1;
+    }
+
+    unsigned long slot = registry_slot(reg, xid);
+    while (reg->entries[slot].xid != None) {
+        if (reg->entries[slot].xid == xid) {
+            return (long)slot;
+        }
+        slot = (slot + 1) & (reg->capacity - 1);
+    }
+    return -1;
+}
+
+// Look up an XID
+void *registry_lookup(const Registry *reg, Window xid, int *role) {
+    long slot = registry_find(reg, xid);
+    if (slot < 0) {
+        return NULL;
+    }
+
+    if (role) {
+        *role = reg->entries[slot].role;
+    }
+    return reg->entries[slot].data;
+}
+
+// Unregister an XID
+int registry_remove(Registry *reg, Window xid) {
+    long found = registry_find(reg, xid);
+    if (found < 0) {
+        return 0;
+    }
+
+    // Shift later members of the probe run back into the hole
+    unsigned long mask = reg->capacity - 1;
+    unsigned long hole = (unsigned long)found;
+    unsigned long next = hole;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (reg->entries[next].xid == None) {
+            break;
+        }
+
+        // An entry may move back only if its home slot is not between the hole and it
+        unsigned long home = registry_slot(reg, reg->entries[next].xid);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            reg->entries[hole] = reg->entries[next];
+            hole = next;
+        }
+    }
+
+    reg->entries[hole].xid = None;
+    reg->entries[hole].data = NULL;
+    reg->count--;
+    return 1;
+}
@@ -0,0 +1,47 @@
+/*
+ * registry.h - XID lookup table for the window manager
+ *
+ * An open-addressing hash table from X window IDs to the structure that
+ * owns them, tagged with the role the XID plays. Lookups cost the same
+ * whether the window manager handles ten clients or thousands, and the
+ * table grows as needed.
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <X11/Xlib.h>
+
+// One registered XID
+typedef struct {
+    Window xid;      // None marks an empty slot
+    int role;
+    void *data;
+} RegistryEntry;
+
+// Hash table of registered XIDs
+typedef struct {
+    RegistryEntry *entries;
+    unsigned long capacity;  // Always a power of two
+    unsigned long count;
+} Registry;
+
+// Initialize an empty registry
+void registry_init(Registry *reg);
+
+// Free the registry's storage
+void registry_destroy(Registry *reg);
+
+// Register an XID, replacing any previous entry for it
+// Returns 1 on success, 0 if the table could not grow
+int registry_insert(Registry *reg, Window xid, int role, void *data);
+
+// Look up an XID; stores its role in role if non-NULL
+// Returns the registered data, or NULL if the XID is unknown
+void *registry_lookup(const Registry *reg, Window xid, int *role);
+
+// Unregister an XID
+// Returns 1 if it was registered, 0 otherwise
+int registry_remove(Registry *reg, Window xid);
+
+#endif /* REGISTRY_H */
@@ -10,11 +10,12 @@
 #include <X11/Xatom.h>
 
 #include "window.h"
+#include "registry.h"
+#include "xcb_backend.h"
 #include "../ui/toolkit.h"
 #include "../ui/themes.h"
 #include "../state/state_manager.h"
 
-#define MAX_MANAGED_WINDOWS 128
 #define TITLEBAR_HEIGHT 20
 #define BORDER_WIDTH 4
 #define BUTTON_SIZE 16
@@ -26,15 +27,26 @@ static Window root;
 static int screen;
 static Theme *current_theme;
 
-// Atoms for window management
-static Atom wm_protocols;
-static Atom wm_delete;
-static Atom wm_state;
-static Atom wm_name;
-
-// Window management data
-static WMWindow windows[MAX_MANAGED_WINDOWS];
+// Window management data, in creation order
+static WMWindow **windows = NULL;
 static int window_count = 0;
+static int window_capacity = 0;
+
+// Every client, frame, titlebar and button XID we manage
+static Registry window_registry;
+
+// Decorations are rendered once into pixmaps and set as window
+// backgrounds, so the server repaints them on exposure and a focus
+// change only swaps which pixmap is shown
+static GC decor_gc = None;
+
+// Button faces are the same for every window, so they are shared
+static struct {
+    int theme;          // Theme generation they were rendered with
+    Pixmap close;
+    Pixmap max;
+    Pixmap min;
+} button_pixmaps;
 
 // Initialize window management
 void init_window_management(Display *dpy, Window root_win, int scr, Theme *theme) {
@@ -43,55 +55,56 @@ void init_window_management(Display *dpy, Window root_win, int scr, Theme *theme
     screen = scr;
     current_theme = theme;
 
-    // Initialize atoms
-    wm_protocols = XInternAtom(display, "WM_PROTOCOLS", False);
-    wm_delete = XInternAtom(display, "WM_DELETE_WINDOW", False);
-    wm_state = XInternAtom(display, "WM_STATE", False);
-    wm_name = XInternAtom(display, "WM_NAME", False);
-
-    // Initialize the window array
-    for (int i = 0; i < MAX_MANAGED_WINDOWS; i++) {
-        windows[i].window = None;
-        windows[i].frame = None;
-        windows[i].titlebar = None;
-        windows[i].close_button = None;
-        windows[i].min_button = None;
-        windows[i].max_button = None;
-        windows[i].icon = None;
-        windows[i].title = NULL;
-        windows[i].is_focused = 0;
-        windows[i].is_fullscreen = 0;
-        windows[i].is_minimized = 0;
-        windows[i].is_shaded = 0;
-        windows[i].tab_id = -1;
-        windows[i].group_id = -1;
-    }
+    // Start with an empty registry; it grows with the number of clients
+    registry_init(&window_registry);
 }
 
-// Find a WMWindow by its window ID
+// Find a WMWindow by any of its window IDs
 WMWindow *find_window(Window win) {
-    for (int i = 0; i < window_count; i++) {
-        if (windows[i].window == win || windows[i].frame == win ||
-            windows[i].titlebar == win || windows[i].close_button == win ||
-            windows[i].min_button == win || windows[i].max_button == win) {
-            return &windows[i];
-        }
+    return (WMWindow *)registry_lookup(&window_registry, win, NULL);
+}
+
+// Find a WMWindow by any of its window IDs, along with the ID's role
+WMWindow *find_window_role(Window win, WindowRole *role) {
+    int found_role = ROLE_NONE;
+    WMWindow *w = (WMWindow *)registry_lookup(&window_registry, win, &found_role);
+    if (role) {
+        *role = w ? (WindowRole)found_role : ROLE_NONE;
     }
-    return NULL;
+    return w;
 }
 
 // Find the index of a window in our management array
 int find_window_index(Window win) {
-    for (int i = 0; i < window_count; i++) {
-        if (windows[i].window == win) {
-            return i;
-        }
-    }
-    return -1;
+    WindowRole role;
+    WMWindow *w = find_window_role(win, &role);
+    return (w && role == ROLE_CLIENT) ? w->index : -1;
+}
+
+// Register every XID of a window
+static int register_window(WMWindow *w) {
+    return registry_insert(&window_registry, w->window, ROLE_CLIENT, w) &&
+           registry_insert(&window_registry, w->frame, ROLE_FRAME, w) &&
+           registry_insert(&window_registry, w->titlebar, ROLE_TITLEBAR, w) &&
+           registry_insert(&window_registry, w->close_button, ROLE_CLOSE_BUTTON, w) &&
+           registry_insert(&window_registry, w->min_button, ROLE_MIN_BUTTON, w) &&
+           registry_insert(&window_registry, w->max_button, ROLE_MAX_BUTTON, w) &&
+           (w->icon == None || registry_insert(&window_registry, w->icon, ROLE_ICON, w));
+}
+
+// Unregister every XID of a window
+static void unregister_window(WMWindow *w) {
+    registry_remove(&window_registry, w->window);
+    registry_remove(&window_registry, w->frame);
+    registry_remove(&window_registry, w->titlebar);
+    registry_remove(&window_registry, w->close_button);
+    registry_remove(&window_registry, w->min_button);
+    registry_remove(&window_registry, w->max_button);
+    registry_remove(&window_registry, w->icon);
 }
 
 // Create a window frame for a client window
-Window create_window_frame(Window win, XWindowAttributes *attr) {
+Window create_window_frame(Window win, XWindowAttributes *attr, const char *title) {
     // Create the frame window
     Window frame = XCreateSimpleWindow(
         display, root,
@@ -137,52 +150,91 @@ Window create_window_frame(Window win, XWindowAttributes *attr) {
         1, current_theme->border_color, current_theme->button_bg_color
     );
 
-    // Get window name/title
-    char *window_name = NULL;
-    XTextProperty text_prop;
-    if (XGetWMName(display, win, &text_prop) && text_prop.value) {
-        window_name = strdup((char *)text_prop.value);
-        XFree(text_prop.value);
-    } else {
-        window_name = strdup("Untitled");
+    // Keep the buttons at the right edge when the titlebar is resized,
+    // so a resize does not need a move request per button
+    XSetWindowAttributes button_attr;
+    button_attr.win_gravity = NorthEastGravity;
+    XChangeWindowAttributes(display, close_button, CWWinGravity, &button_attr);
+    XChangeWindowAttributes(display, max_button, CWWinGravity, &button_attr);
+    XChangeWindowAttributes(display, min_button, CWWinGravity, &button_attr);
+
+    // The caller fetched the title along with the attributes
+    char *window_name = strdup(title ? title : "Untitled");
+
+    // Grow the management array as needed
+    if (window_count == window_capacity) {
+        int capacity = window_capacity ? window_capacity * 2 : 64;
+        WMWindow **grown = (WMWindow **)realloc(windows, capacity * sizeof(WMWindow *));
+        if (!grown) {
+            fprintf(stderr, "Failed to grow window list\n");
+            free(window_name);
+            XDestroyWindow(display, frame);
+            return None;
+        }
+        windows = grown;
+        window_capacity = capacity;
     }
 
     // Store the window in our management array
-    int idx = window_count++;
-    windows[idx].window = win;
-    windows[idx].frame = frame;
-    windows[idx].titlebar = titlebar;
-    windows[idx].close_button = close_button;
-    windows[idx].min_button = min_button;
-    windows[idx].max_button = max_button;
-    windows[idx].x = attr->x;
-    windows[idx].y = attr->y;
-    windows[idx].width = attr->width;
-    windows[idx].height = attr->height;
-    windows[idx].border_width = BORDER_WIDTH;
-    windows[idx].titlebar_height = TITLEBAR_HEIGHT;
-    windows[idx].title = window_name;
-    windows[idx].is_focused = 0;
-    windows[idx].is_fullscreen = 0;
-    windows[idx].is_minimized = 0;
-    windows[idx].is_shaded = 0;
+    WMWindow *w = (WMWindow *)calloc(1, sizeof(WMWindow));
+    if (!w) {
+        fprintf(stderr, "Failed to allocate window structure\n");
+        free(window_name);
+        XDestroyWindow(display, frame);
+        return None;
+    }
+    w->window = win;
+    w->frame = frame;
+    w->titlebar = titlebar;
+    w->close_button = close_button;
+    w->min_button = min_button;
+    w->max_button = max_button;
+    w->icon = None;
+    w->x = attr->x;
+    w->y = attr->y;
+    w->width = attr->width;
+    w->height = attr->height;
+    w->border_width = BORDER_WIDTH;
+    w->titlebar_height = TITLEBAR_HEIGHT;
+    w->title = window_name;
+    w->is_focused = 0;
+    w->is_fullscreen = 0;
+    w->is_minimized = 0;
+    w->is_shaded = 0;
+    w->tab_id = -1;
+    w->group_id = -1;
+    w->index = window_count;
+    w->title_pixmaps[0] = None;
+    w->title_pixmaps[1] = None;
+    w->title_pixmap_theme = -1;     // Nothing rendered yet
+    w->button_theme = -1;
+
+    if (!register_window(w)) {
+        unregister_window(w);
+        free(window_name);
+        free(w);
+        XDestroyWindow(display, frame);
+        return None;
+    }
+    windows[window_count++] = w;
 
     // Select events for the frame and its components
     XSelectInput(display, frame, SubstructureRedirectMask | SubstructureNotifyMask |
                               ButtonPressMask | ButtonReleaseMask | 
                               PointerMotionMask | EnterWindowMask | LeaveWindowMask);
     
+    // No exposure events: the decorations are background pixmaps
     XSelectInput(display, titlebar, ButtonPressMask | ButtonReleaseMask | 
-                               PointerMotionMask | ExposureMask);
+                               PointerMotionMask);
     
     XSelectInput(display, close_button, ButtonPressMask | ButtonReleaseMask | 
-                                  EnterWindowMask | LeaveWindowMask | ExposureMask);
+                                  EnterWindowMask | LeaveWindowMask);
     
     XSelectInput(display, max_button, ButtonPressMask | ButtonReleaseMask | 
-                                EnterWindowMask | LeaveWindowMask | ExposureMask);
+                                EnterWindowMask | LeaveWindowMask);
     
     XSelectInput(display, min_button, ButtonPressMask | ButtonReleaseMask | 
-                                EnterWindowMask | LeaveWindowMask | ExposureMask);
+                                EnterWindowMask | LeaveWindowMask);
 
     // Map the subwindows
     XMapWindow(display, titlebar);
@@ -197,9 +249,17 @@ Window create_window_frame(Window win, XWindowAttributes *attr) {
 }
 
 // Set up the window frame and reparent the client window
-void setup_window_frame(Window win, XWindowAttributes *attr) {
+void setup_window_frame(Window win, XWindowAttributes *attr, const char *title) {
+    // Select the client events that keep our cached geometry and title
+    // current; title changes after the caller's fetch are reported
+    XSelectInput(display, win, EnterWindowMask | LeaveWindowMask | PropertyChangeMask |
+                             StructureNotifyMask | FocusChangeMask);
+    
     // Create the frame
-    Window frame = create_window_frame(win, attr);
+    Window frame = create_window_frame(win, attr, title);
+    if (frame == None) {
+        return;
+    }
     
     // Reparent the client window to the frame
     XReparentWindow(display, win, frame, 0, TITLEBAR_HEIGHT);
@@ -211,47 +271,120 @@ void setup_window_frame(Window win, XWindowAttributes *attr) {
     XMapWindow(display, frame);
 }
 
-// Draw window titlebar with title and buttons
-void draw_window_titlebar(Window win, int is_focused) {
-    WMWindow *w = find_window(win);
-    if (!w) return;
+// Get the GC decorations are rendered with
+static GC decoration_gc() {
+    if (decor_gc == None) {
+        decor_gc = create_widget_gc(display, root);
+    }
+    return decor_gc;
+}
 
-    // Get the right colors based on focus state
+// Free the rendered titlebars of a window
+static void invalidate_titlebar_pixmaps(WMWindow *w) {
+    for (int i = 0; i < 2; i++) {
+        if (w->title_pixmaps[i] != None) {
+            XFreePixmap(display, w->title_pixmaps[i]);
+            w->title_pixmaps[i] = None;
+        }
+    }
+}
+
+// Render a window's titlebar for one focus state
+static Pixmap render_titlebar_pixmap(WMWindow *w, int is_focused) {
     unsigned long bg_color = is_focused ? 
         current_theme->title_active_bg_color : current_theme->title_bg_color;
     unsigned long fg_color = is_focused ? 
         current_theme->title_active_fg_color : current_theme->title_fg_color;
 
-    // Set the window's focus state
-    w->is_focused = is_focused;
-
-    // Set the background color
-    XSetWindowBackground(display, w->titlebar, bg_color);
-    XClearWindow(display, w->titlebar);
-
-    // Draw the title text
-    GC gc = XCreateGC(display, w->titlebar, 0, NULL);
-    XSetForeground(display, gc, fg_color);
+    int width = w->width > 0 ? w->width : 1;
+    Pixmap pixmap = XCreatePixmap(display, w->titlebar, width, w->titlebar_height,
+                                  DefaultDepth(display, screen));
+    GC gc = decoration_gc();
+    
+    XSetForeground(display, gc, bg_color);
+    XFillRectangle(display, pixmap, gc, 0, 0, width, w->titlebar_height);
     
     if (w->title) {
-        XDrawString(display, w->titlebar, gc, 5, 15, w->title, strlen(w->title));
+        XSetForeground(display, gc, fg_color);
+        XDrawString(display, pixmap, gc, 5, 15, w->title, strlen(w->title));
     }
+    
+    return pixmap;
+}
 
-    // Draw the button symbols
+// Render the shared button faces for the current theme
+static void render_button_pixmaps() {
+    if (button_pixmaps.close != None) {
+        XFreePixmap(display, button_pixmaps.close);
+        XFreePixmap(display, button_pixmaps.max);
+        XFreePixmap(display, button_pixmaps.min);
+    }
+    
+    int depth = DefaultDepth(display, screen);
+    button_pixmaps.close = XCreatePixmap(display, root, BUTTON_SIZE, BUTTON_SIZE, depth);
+    button_pixmaps.max = XCreatePixmap(display, root, BUTTON_SIZE, BUTTON_SIZE, depth);
+    button_pixmaps.min = XCreatePixmap(display, root, BUTTON_SIZE, BUTTON_SIZE, depth);
+    
+    GC gc = decoration_gc();
+    XSetForeground(display, gc, current_theme->button_bg_color);
+    XFillRectangle(display, button_pixmaps.close, gc, 0, 0, BUTTON_SIZE, BUTTON_SIZE);
+    XFillRectangle(display, button_pixmaps.max, gc, 0, 0, BUTTON_SIZE, BUTTON_SIZE);
+    XFillRectangle(display, button_pixmaps.min, gc, 0, 0, BUTTON_SIZE, BUTTON_SIZE);
+    
     XSetForeground(display, gc, current_theme->button_fg_color);
     
     // Close button (X)
-    XDrawLine(display, w->close_button, gc, 3, 3, BUTTON_SIZE-3, BUTTON_SIZE-3);
-    XDrawLine(display, w->close_button, gc, 3, BUTTON_SIZE-3, BUTTON_SIZE-3, 3);
+    XDrawLine(display, button_pixmaps.close, gc, 3, 3, BUTTON_SIZE-3, BUTTON_SIZE-3);
+    XDrawLine(display, button_pixmaps.close, gc, 3, BUTTON_SIZE-3, BUTTON_SIZE-3, 3);
     
     // Maximize button (square)
-    XDrawRectangle(display, w->max_button, gc, 3, 3, BUTTON_SIZE-6, BUTTON_SIZE-6);
+    XDrawRectangle(display, button_pixmaps.max, gc, 3, 3, BUTTON_SIZE-6, BUTTON_SIZE-6);
     
     // Minimize button (line)
-    XDrawLine(display, w->min_button, gc, 3, BUTTON_SIZE/2, BUTTON_SIZE-3, BUTTON_SIZE/2);
+    XDrawLine(display, button_pixmaps.min, gc, 3, BUTTON_SIZE/2, BUTTON_SIZE-3, BUTTON_SIZE/2);
     
-    // Free graphics context
-    XFreeGC(display, gc);
+    button_pixmaps.theme = current_theme->generation;
+}
+
+// Draw window titlebar with title and buttons
+void draw_window_titlebar(Window win, int is_focused) {
+    WMWindow *w = find_window(win);
+    if (!w) return;
+
+    // Set the window's focus state
+    w->is_focused = is_focused;
+
+    // Re-render only when the size or theme changed since the last render
+    if (w->title_pixmap_width != w->width ||
+        w->title_pixmap_theme != current_theme->generation) {
+        invalidate_titlebar_pixmaps(w);
+        w->title_pixmap_width = w->width;
+        w->title_pixmap_theme = current_theme->generation;
+    }
+    
+    int state = is_focused ? 1 : 0;
+    if (w->title_pixmaps[state] == None) {
+        w->title_pixmaps[state] = render_titlebar_pixmap(w, is_focused);
+    }
+
+    // Show it; the server paints it on every exposure from now on
+    XSetWindowBackgroundPixmap(display, w->titlebar, w->title_pixmaps[state]);
+    XClearWindow(display, w->titlebar);
+
+    // Point the buttons at the current faces
+    if (w->button_theme != current_theme->generation) {
+        if (button_pixmaps.close == None || button_pixmaps.theme != current_theme->generation) {
+            render_button_pixmaps();
+        }
+        
+        XSetWindowBackgroundPixmap(display, w->close_button, button_pixmaps.close);
+        XSetWindowBackgroundPixmap(display, w->max_button, button_pixmaps.max);
+        XSetWindowBackgroundPixmap(display, w->min_button, button_pixmaps.min);
+        XClearWindow(display, w->close_button);
+        XClearWindow(display, w->max_button);
+        XClearWindow(display, w->min_button);
+        w->button_theme = current_theme->generation;
+    }
 }
 
 // Get the part of the frame that the pointer is in
@@ -314,20 +447,15 @@ void resize_window(Window win, int width, int height) {
     // Resize the frame
     XResizeWindow(display, w->frame, width, height + w->titlebar_height);
     
-    // Resize the titlebar
+    // Resize the titlebar; NorthEastGravity keeps its buttons at the right edge
     XResizeWindow(display, w->titlebar, width, w->titlebar_height);
     
-    // Reposition the buttons
-    int button_x = width - BUTTON_SIZE - BUTTON_MARGIN;
-    XMoveWindow(display, w->close_button, button_x, BUTTON_MARGIN);
-    button_x -= (BUTTON_SIZE + BUTTON_MARGIN);
-    XMoveWindow(display, w->max_button, button_x, BUTTON_MARGIN);
-    button_x -= (BUTTON_SIZE + BUTTON_MARGIN);
-    XMoveWindow(display, w->min_button, button_x, BUTTON_MARGIN);
-    
     // Resize the actual client window
     XResizeWindow(display, w->window, width, height);
 
+    // Re-render the titlebar at its new width
+    draw_window_titlebar(win, w->is_focused);
+
     // Update the state
     save_window_state(win);
 }
@@ -387,22 +515,17 @@ void maximize_window(Window win) {
     XResizeWindow(display, w->window, 
                  screen_width, screen_height - w->titlebar_height);
     
-    // Resize the titlebar
+    // Resize the titlebar; NorthEastGravity keeps its buttons at the right edge
     XResizeWindow(display, w->titlebar, screen_width, w->titlebar_height);
     
-    // Reposition the buttons
-    int button_x = screen_width - BUTTON_SIZE - BUTTON_MARGIN;
-    XMoveWindow(display, w->close_button, button_x, BUTTON_MARGIN);
-    button_x -= (BUTTON_SIZE + BUTTON_MARGIN);
-    XMoveWindow(display, w->max_button, button_x, BUTTON_MARGIN);
-    button_x -= (BUTTON_SIZE + BUTTON_MARGIN);
-    XMoveWindow(display, w->min_button, button_x, BUTTON_MARGIN);
-    
     // Update the window dimensions in our state
     w->width = screen_width;
     w->height = screen_height - w->titlebar_height;
     w->x = 0;
     w->y = 0;
+
+    // Re-render the titlebar at its new width
+    draw_window_titlebar(win, w->is_focused);
 }
 
 // Restore a window from minimized or maximized state
@@ -428,22 +551,17 @@ void restore_window(Window win) {
             XResizeWindow(display, w->window, 
                          state.width, state.height);
             
-            // Resize the titlebar
+            // Resize the titlebar; NorthEastGravity keeps its buttons at the right edge
             XResizeWindow(display, w->titlebar, state.width, w->titlebar_height);
             
-            // Reposition the buttons
-            int button_x = state.width - BUTTON_SIZE - BUTTON_MARGIN;
-            XMoveWindow(display, w->close_button, button_x, BUTTON_MARGIN);
-            button_x -= (BUTTON_SIZE + BUTTON_MARGIN);
-            XMoveWindow(display, w->max_button, button_x, BUTTON_MARGIN);
-            button_x -= (BUTTON_SIZE + BUTTON_MARGIN);
-            XMoveWindow(display, w->min_button, button_x, BUTTON_MARGIN);
-            
             // Update our state
             w->width = state.width;
             w->height = state.height;
             w->x = state.x;
             w->y = state.y;
+            
+            // Re-render the titlebar at its new width
+            draw_window_titlebar(win, w->is_focused);
         }
     }
     
@@ -463,7 +581,7 @@ void close_window(Window win) {
     
     if (XGetWMProtocols(display, w->window, &protocols, &num_protocols)) {
         for (int i = 0; i < num_protocols; i++) {
-            if (protocols[i] == wm_delete) {
+            if (protocols[i] == wm_atoms.wm_delete_window) {
                 can_delete = 1;
                 break;
             }
@@ -477,9 +595,9 @@ void close_window(Window win) {
         memset(&ev, 0, sizeof(ev));
         ev.type = ClientMessage;
         ev.xclient.window = w->window;
-        ev.xclient.message_type = wm_protocols;
+        ev.xclient.message_type = wm_atoms.wm_protocols;
         ev.xclient.format = 32;
-        ev.xclient.data.l[0] = wm_delete;
+        ev.xclient.data.l[0] = wm_atoms.wm_delete_window;
         ev.xclient.data.l[1] = CurrentTime;
         XSendEvent(display, w->window, False, NoEventMask, &ev);
     } else {
@@ -495,8 +613,8 @@ void focus_window(Window win) {
 
     // Unfocus currently focused windows
     for (int i = 0; i < window_count; i++) {
-        if (windows[i].is_focused && windows[i].window != win) {
-            draw_window_titlebar(windows[i].window, 0);
+        if (windows[i]->is_focused && windows[i]->window != win) {
+            draw_window_titlebar(windows[i]->window, 0);
         }
     }
 
@@ -527,7 +645,8 @@ void update_window_title(Window win, const char *title) {
     // Store the new title
     w->title = strdup(title);
 
-    // Redraw the titlebar
+    // Redraw the titlebar with the new text
+    invalidate_titlebar_pixmaps(w);
     draw_window_titlebar(win, w->is_focused);
 }
 
@@ -539,7 +658,7 @@ void add_window_to_tab_group(Window win, int group_id) {
     // Count how many windows are already in this group
     int tab_count = 0;
     for (int i = 0; i < window_count; i++) {
-        if (windows[i].group_id == group_id) {
+        if (windows[i]->group_id == group_id) {
             tab_count++;
         }
     }
@@ -550,14 +669,14 @@ void add_window_to_tab_group(Window win, int group_id) {
     
     // Hide all windows in the group except the active one
     for (int i = 0; i < window_count; i++) {
-        if (windows[i].group_id == group_id) {
-            if (windows[i].tab_id == tab_count) {
+        if (windows[i]->group_id == group_id) {
+            if (windows[i]->tab_id == tab_count) {
                 // This is the new active tab
-                XMapWindow(display, windows[i].window);
-                focus_window(windows[i].window);
+                XMapWindow(display, windows[i]->window);
+                focus_window(windows[i]->window);
             } else {
                 // Hide other tabs
-                XUnmapWindow(display, windows[i].window);
+                XUnmapWindow(display, windows[i]->window);
             }
         }
     }
@@ -580,8 +699,8 @@ void remove_window_from_tab_group(Window win) {
     // Reindex the tabs in the group
     int new_tab_id = 0;
     for (int i = 0; i < window_count; i++) {
-        if (windows[i].group_id == old_group) {
-            windows[i].tab_id = new_tab_id++;
+        if (windows[i]->group_id == old_group) {
+            windows[i]->tab_id = new_tab_id++;
         }
     }
     
@@ -591,9 +710,9 @@ void remove_window_from_tab_group(Window win) {
     // Make sure at least one tab in the group is visible
     int visible_tab = 0;
     for (int i = 0; i < window_count; i++) {
-        if (windows[i].group_id == old_group && windows[i].tab_id == 0) {
-            XMapWindow(display, windows[i].window);
-            focus_window(windows[i].window);
+        if (windows[i]->group_id == old_group && windows[i]->tab_id == 0) {
+            XMapWindow(display, windows[i]->window);
+            focus_window(windows[i]->window);
             visible_tab = 1;
             break;
         }
@@ -609,14 +728,14 @@ void switch_to_tab(int group_id, int tab_id) {
     
     // Hide all windows in the group, then show the active one
     for (int i = 0; i < window_count; i++) {
-        if (windows[i].group_id == group_id) {
-            if (windows[i].tab_id == tab_id) {
+        if (windows[i]->group_id == group_id) {
+            if (windows[i]->tab_id == tab_id) {
                 // This is the target tab to show
-                XMapWindow(display, windows[i].window);
-                active_window = windows[i].window;
+                XMapWindow(display, windows[i]->window);
+                active_window = windows[i]->window;
             } else {
                 // Hide other tabs
-                XUnmapWindow(display, windows[i].window);
+                XUnmapWindow(display, windows[i]->window);
             }
         }
     }
@@ -627,6 +746,29 @@ void switch_to_tab(int group_id, int tab_id) {
     }
 }
 
+// Stop managing a destroyed client window and remove its frame
+void unmanage_window(Window win) {
+    WindowRole role;
+    WMWindow *w = find_window_role(win, &role);
+    if (!w || role != ROLE_CLIENT) return;
+
+    unregister_window(w);
+
+    // Close the gap in the management array
+    for (int i = w->index; i < window_count - 1; i++) {
+        windows[i] = windows[i + 1];
+        windows[i]->index = i;
+    }
+    window_count--;
+
+    // The frame and its decorations go with the client
+    XDestroyWindow(display, w->frame);
+    invalidate_titlebar_pixmaps(w);
+
+    free(w->title);
+    free(w);
+}
+
 // Get the number of windows we're managing
 int get_window_count() {
     return window_count;
@@ -635,7 +777,7 @@ int get_window_count() {
 // Get the window at a specific index
 Window get_window_at_index(int index) {
     if (index >= 0 && index < window_count) {
-        return windows[index].window;
+        return windows[index]->window;
     }
     return None;
 }
@@ -22,6 +22,18 @@ typedef enum {
     FRAME_CORNER_SE
 } FramePart;
 
+// Role an XID plays for a managed window
+typedef enum {
+    ROLE_NONE,
+    ROLE_CLIENT,
+    ROLE_FRAME,
+    ROLE_TITLEBAR,
+    ROLE_CLOSE_BUTTON,
+    ROLE_MIN_BUTTON,
+    ROLE_MAX_BUTTON,
+    ROLE_ICON
+} WindowRole;
+
 // Window structure to keep track of window state
 typedef struct {
     Window window;
@@ -42,16 +54,22 @@ typedef struct {
     int is_shaded;
     int tab_id;
     int group_id;
+    int index;       // Position in the managed window list
+    Pixmap title_pixmaps[2];    // Rendered titlebar, unfocused and focused
+    int title_pixmap_width;     // Width the titlebar pixmaps were rendered at
+    int title_pixmap_theme;     // Theme generation they were rendered with
+    int button_theme;           // Theme generation of the buttons' backgrounds
 } WMWindow;
 
 // Initialize window management
 void init_window_management(Display *dpy, Window root, int scr, Theme *theme);
 
 // Create a frame for a window
-Window create_window_frame(Window win, XWindowAttributes *attr);
+// title may be NULL for a client without one
+Window create_window_frame(Window win, XWindowAttributes *attr, const char *title);
 
 // Setup the window decoration and frame
-void setup_window_frame(Window win, XWindowAttributes *attr);
+void setup_window_frame(Window win, XWindowAttributes *attr, const char *title);
 
 // Draw the window titlebar
 void draw_window_titlebar(Window win, int is_focused);
@@ -62,6 +80,12 @@ FramePart get_frame_part(Window frame, int x, int y);
 // Find the window management structure for a window
 WMWindow *find_window(Window win);
 
+// Find the window management structure for any of its XIDs and the XID's role
+WMWindow *find_window_role(Window win, WindowRole *role);
+
+// Stop managing a destroyed client window and remove its frame
+void unmanage_window(Window win);
+
 // Resize a window
 void resize_window(Window win, int width, int height);
 
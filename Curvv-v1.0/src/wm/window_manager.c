@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/select.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/cursorfont.h>
@@ -18,21 +19,22 @@
 #include "panel.h"
 #include "menu.h"
 #include "events.h"
+#include "xcb_backend.h"
+#include "compositor.h"
 #include "../state/state_manager.h"
 #include "../ui/toolkit.h"
 #include "../ui/themes.h"
 
-#define MAX_WINDOWS 128
-
 // Global display and root window
 Display *display;
 Window root;
 int screen;
 XWindowAttributes attr;
 
+// Most windows framed after a single round trip
+#define MANAGE_BATCH_MAX 256
+
 // Window management data structures
-Window windows[MAX_WINDOWS];
-int window_count = 0;
 Window active_window = None;
 Window focused_window = None;
 
@@ -84,6 +86,88 @@ void init_cursors() {
     cursor_resize_w = XCreateFontCursor(display, XC_left_side);
 }
 
+// Frame a batch of clients; their attributes and titles are fetched
+// together, so the batch costs one round trip however large it is
+// Returns the number of windows framed
+static int manage_windows(const Window *candidates, int count, int only_viewable) {
+    Window *windows = (Window *)malloc(count * sizeof(Window));
+    ClientInfo *info = (ClientInfo *)malloc(count * sizeof(ClientInfo));
+    if (!windows || !info) {
+        fprintf(stderr, "Failed to allocate %d windows to manage\n", count);
+        free(windows);
+        free(info);
+        return 0;
+    }
+
+    // Skip our own panel, menus, frames and decorations, and clients we
+    // already manage
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (!is_own_window(candidates[i]) && !find_window(candidates[i])) {
+            windows[n++] = candidates[i];
+        }
+    }
+    if (n == 0) {
+        free(windows);
+        free(info);
+        return 0;
+    }
+
+    fetch_client_info(windows, n, info);
+
+    int managed = 0;
+    for (int i = 0; i < n; i++) {
+        // Skip windows that are gone and windows we don't want to manage
+        if (!info[i].valid || info[i].override_redirect) {
+            continue;
+        }
+        if (only_viewable && info[i].map_state != IsViewable) {
+            continue;
+        }
+
+        printf("Managing new window: %lu\n", windows[i]);
+
+        // Setup window decoration and frame
+        XWindowAttributes attr;
+        client_info_attributes(&info[i], &attr);
+        setup_window_frame(windows[i], &attr, info[i].title);
+        if (!find_window(windows[i])) {
+            continue;
+        }
+
+        // Add window to state management
+        add_window_state(windows[i]);
+        managed++;
+    }
+
+    free_client_info(info, n);
+    free(info);
+    free(windows);
+    return managed;
+}
+
+// Frame the clients that were already mapped when we started
+static void adopt_existing_windows() {
+    int count;
+    Window *windows = query_top_level_windows(root, &count);
+    if (!windows) {
+        return;
+    }
+
+    int adopted = manage_windows(windows, count, 1);
+
+    // Already mapped, so no map request will add their taskbar buttons
+    for (int i = 0; i < count; i++) {
+        WMWindow *w = find_window(windows[i]);
+        if (w && w->window == windows[i]) {
+            add_panel_taskbutton(w->window, w->title);
+        }
+    }
+
+    printf("Adopted %d existing windows\n", adopted);
+    free(windows);
+}
+
 // Initialize the window manager
 int init_window_manager() {
     // Open display connection
@@ -98,6 +182,12 @@ int init_window_manager() {
     root = RootWindow(display, screen);
     XGetWindowAttributes(display, root, &attr);
 
+    // Requests that need replies go through XCB so they can be pipelined
+    if (!init_xcb_backend(display)) {
+        XCloseDisplay(display);
+        return 0;
+    }
+
     // Initialize state management
     init_state_manager();
 
@@ -107,6 +197,9 @@ int init_window_manager() {
     // Initialize theme
     load_theme(&current_theme, "default");
 
+    // Initialize window frames and the window registry
+    init_window_management(display, root, screen, &current_theme);
+
     // Initialize the panel
     init_panel(display, root, screen, &current_theme);
 
@@ -127,6 +220,7 @@ int init_window_manager() {
     // Let X know we want to handle these events
     XGrabServer(display);
     XSetErrorHandler(error_handler);
+    adopt_existing_windows();
     XUngrabServer(display);
     XSync(display, False);
 
@@ -137,45 +231,46 @@ int init_window_manager() {
     return 1;
 }
 
-// Handle a new window creation
-void handle_new_window(Window w) {
-    if (window_count >= MAX_WINDOWS) {
-        fprintf(stderr, "Maximum number of windows reached\n");
-        return;
+// Handle a burst of window creations
+void handle_new_windows(XCreateWindowEvent *first) {
+    // Take the creations already queued along with this one, so a burst
+    // such as a session restore is framed after a single round trip
+    Window windows[MANAGE_BATCH_MAX];
+    Window created[MANAGE_BATCH_MAX];
+    int count = 0;
+    int created_count = 0;
+    XEvent queued;
+    XCreateWindowEvent *e = first;
+    for (;;) {
+        created[created_count++] = e->window;
+        if (!e->override_redirect) {
+            windows[count++] = e->window;
+        }
+        if (created_count == MANAGE_BATCH_MAX || !XCheckTypedEvent(display, CreateNotify, &queued)) {
+            break;
+        }
+        e = &queued.xcreatewindow;
     }
 
-    // Get window attributes
-    XWindowAttributes attr;
-    if (!XGetWindowAttributes(display, w, &attr)) {
-        fprintf(stderr, "Failed to get window attributes\n");
-        return;
-    }
+    // The compositor draws every top-level window, override-redirect too
+    composite_windows_created(created, created_count);
 
-    // Skip windows we don't want to manage
-    if (attr.override_redirect) {
+    if (manage_windows(windows, count, 0) == 0) {
         return;
     }
 
-    printf("Managing new window: %lu\n", w);
-
-    // Add window to our management list
-    windows[window_count++] = w;
-
-    // Select the events we want to receive for this window
-    XSelectInput(display, w, EnterWindowMask | LeaveWindowMask | PropertyChangeMask |
-                           StructureNotifyMask | FocusChangeMask);
-
-    // Setup window decoration and frame
-    setup_window_frame(w, &attr);
-
-    // Add window to state management
-    add_window_state(w);
-
-    // Map the window
-    XMapWindow(display, w);
-
-    // Set focus to this window
-    set_focus(w);
+    // Map the new windows and focus the last one
+    Window last = None;
+    for (int i = 0; i < count; i++) {
+        WMWindow *w = find_window(windows[i]);
+        if (w && w->window == windows[i]) {
+            XMapWindow(display, w->window);
+            last = w->window;
+        }
+    }
+    if (last != None) {
+        set_focus(last);
+    }
 }
 
 // Handle window resize operation
@@ -184,14 +279,16 @@ void handle_resize(Window w, int pointer_x, int pointer_y) {
         return;
     }
 
-    // Get the current geometry
-    XWindowAttributes attr;
-    XGetWindowAttributes(display, w, &attr);
+    // Start from the cached geometry
+    WMWindow *win = find_window(w);
+    if (!win) {
+        return;
+    }
 
-    int new_x = attr.x;
-    int new_y = attr.y;
-    int new_width = attr.width;
-    int new_height = attr.height;
+    int new_x = win->x;
+    int new_y = win->y;
+    int new_width = win->width;
+    int new_height = win->height;
 
     int dx = pointer_x - drag_start_x;
     int dy = pointer_y - drag_start_y;
@@ -269,17 +366,60 @@ void set_focus(Window w) {
     active_window = w;
 }
 
+// Wait up to timeout_ms for data on the X connection
+static void wait_for_events(int timeout_ms) {
+    int fd = ConnectionNumber(display);
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+
+    struct timeval tv;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    select(fd + 1, &fds, NULL, NULL, &tv);
+}
+
 // Main event loop
 void event_loop() {
     XEvent event;
 
     while (1) {
+        // Apply drag geometry once per frame; while some is pending, only
+        // block until it is due
+        int timeout_ms = flush_pending_geometry();
+
+        // Composite what changed once the queued events are handled
+        if (!XPending(display)) {
+            paint_composite();
+        }
+
+        if (timeout_ms > 0 && !XPending(display)) {
+            wait_for_events(timeout_ms);
+            if (!XPending(display)) {
+                continue;
+            }
+        }
+
         XNextEvent(display, &event);
 
+        // The compositor follows stacking, geometry and damage alongside
+        // the handlers below
+        handle_composite_event(&event);
+
         switch (event.type) {
             case CreateNotify:
                 // A new window was created
-                handle_new_window(event.xcreatewindow.window);
+                handle_new_windows(&event.xcreatewindow);
+                break;
+
+            case ConfigureNotify:
+                // A window's geometry changed
+                handle_configure_notify(&event.xconfigure);
+                break;
+
+            case PropertyNotify:
+                // A window property changed
+                handle_property_notify(&event.xproperty);
                 break;
 
             case DestroyNotify:
@@ -349,19 +489,37 @@ void cleanup() {
     XFreeCursor(display, cursor_resize_s);
     XFreeCursor(display, cursor_resize_w);
 
-    // Save states
-    save_all_window_states();
+    // Let the server draw the windows again
+    shutdown_compositor();
+
+    // Stop the state flusher and save the final snapshot
+    shutdown_state_manager();
 
     // Close display
     XCloseDisplay(display);
 }
 
 // Main function
-int main() {
+int main(int argc, char *argv[]) {
+    int composite = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--composite") == 0) {
+            composite = 1;
+        } else {
+            fprintf(stderr, "Usage: %s [--composite]\n", argv[0]);
+            return 1;
+        }
+    }
+
     if (!init_window_manager()) {
         return 1;
     }
 
+    // Compositing is optional; without it the server draws the windows
+    if (composite && !init_compositor(display, root, screen, &current_theme)) {
+        fprintf(stderr, "Compositing unavailable, continuing without it\n");
+    }
+
     // Run the main event loop
     event_loop();
 
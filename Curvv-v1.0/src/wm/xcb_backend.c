@@ -0,0 +1,237 @@
+/*
+ * xcb_backend.c - Pipelined XCB requests for the window manager
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+
+#include "xcb_backend.h"
+
+// Longest title we read, in 32-bit units
+#define TITLE_MAX_LONGS 256
+
+// The display's XCB connection
+static xcb_connection_t *conn = NULL;
+
+WMAtoms wm_atoms;
+
+// Outstanding requests for one window in a batch
+typedef struct {
+    xcb_get_window_attributes_cookie_t attr;
+    xcb_get_geometry_cookie_t geometry;
+    xcb_get_property_cookie_t name;
+    xcb_get_property_cookie_t net_name;
+} ClientCookies;
+
+// Attach to the display's XCB connection and intern the WM's atoms
+int init_xcb_backend(Display *dpy) {
+    conn = XGetXCBConnection(dpy);
+    if (!conn) {
+        fprintf(stderr, "Display has no XCB connection\n");
+        return 0;
+    }
+
+    static const char *names[] = {
+        "WM_PROTOCOLS", "WM_DELETE_WINDOW", "WM_STATE",
+        "WM_NAME", "_NET_WM_NAME", "UTF8_STRING"
+    };
+    Atom *atoms[] = {
+        &wm_atoms.wm_protocols, &wm_atoms.wm_delete_window, &wm_atoms.wm_state,
+        &wm_atoms.wm_name, &wm_atoms.net_wm_name, &wm_atoms.utf8_string
+    };
+    int count = (int)(sizeof(names) / sizeof(names[0]));
+
+    // Send every request before waiting for the first reply
+    xcb_intern_atom_cookie_t cookies[sizeof(names) / sizeof(names[0])];
+    for (int i = 0; i < count; i++) {
+        cookies[i] = xcb_intern_atom(conn, 0, strlen(names[i]), names[i]);
+    }
+
+    int ok = 1;
+    for (int i = 0; i < count; i++) {
+        xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(conn, cookies[i], NULL);
+        if (reply) {
+            *atoms[i] = reply->atom;
+            free(reply);
+        } else {
+            fprintf(stderr, "Failed to intern atom %s\n", names[i]);
+            *atoms[i] = None;
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+// Request a window's title property
+static xcb_get_property_cookie_t request_title(Window win, Atom property, Atom type) {
+    return xcb_get_property(conn, 0, (xcb_window_t)win, (xcb_atom_t)property,
+                            (xcb_atom_t)type, 0, TITLE_MAX_LONGS);
+}
+
+// Collect a title property reply as a string, or NULL
+static char *title_reply(xcb_get_property_cookie_t cookie) {
+    xcb_get_property_reply_t *reply = xcb_get_property_reply(conn, cookie, NULL);
+    if (!reply) {
+        return NULL;
+    }
+
+    char *title = NULL;
+    int length = xcb_get_property_value_length(reply);
+    if (reply->format == 8 && length > 0) {
+        title = (char *)malloc(length + 1);
+        if (title) {
+            memcpy(title, xcb_get_property_value(reply), length);
+            title[length] = '\0';
+        }
+    }
+    free(reply);
+    return title;
+}
+
+// Collect a window's title, preferring the UTF-8 EWMH name over WM_NAME
+static char *collect_title(xcb_get_property_cookie_t net_name, xcb_get_property_cookie_t name) {
+    char *title = title_reply(net_name);
+    char *legacy = title_reply(name);
+    if (title) {
+        free(legacy);
+        return title;
+    }
+    return legacy;
+}
+
+// Fetch attributes, geometry and title for a batch of windows in one round trip
+int fetch_client_info(const Window *windows, int count, ClientInfo *info) {
+    if (count <= 0) {
+        return 0;
+    }
+
+    ClientCookies *cookies = (ClientCookies *)malloc(count * sizeof(ClientCookies));
+    if (!cookies) {
+        fprintf(stderr, "Failed to allocate requests for %d windows\n", count);
+        return 0;
+    }
+
+    // Send every request before waiting for the first reply
+    for (int i = 0; i < count; i++) {
+        xcb_window_t win = (xcb_window_t)windows[i];
+        cookies[i].attr = xcb_get_window_attributes(conn, win);
+        cookies[i].geometry = xcb_get_geometry(conn, win);
+        cookies[i].net_name = request_title(windows[i], wm_atoms.net_wm_name, wm_atoms.utf8_string);
+        cookies[i].name = request_title(windows[i], XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY);
+    }
+    xcb_flush(conn);
+
+    // A window destroyed in the meantime answers with errors, which the
+    // reply functions absorb
+    int valid = 0;
+    for (int i = 0; i < count; i++) {
+        ClientInfo *ci = &info[i];
+        memset(ci, 0, sizeof(*ci));
+        ci->window = windows[i];
+
+        xcb_get_window_attributes_reply_t *attr =
+            xcb_get_window_attributes_reply(conn, cookies[i].attr, NULL);
+        xcb_get_geometry_reply_t *geometry =
+            xcb_get_geometry_reply(conn, cookies[i].geometry, NULL);
+        ci->title = collect_title(cookies[i].net_name, cookies[i].name);
+
+        if (attr && geometry) {
+            ci->valid = 1;
+            ci->x = geometry->x;
+            ci->y = geometry->y;
+            ci->width = geometry->width;
+            ci->height = geometry->height;
+            ci->border_width = geometry->border_width;
+            ci->override_redirect = attr->override_redirect;
+            ci->map_state = attr->map_state;
+            ci->input_only = attr->_class == XCB_WINDOW_CLASS_INPUT_ONLY;
+            ci->visual = attr->visual;
+            valid++;
+        }
+        free(attr);
+        free(geometry);
+    }
+
+    free(cookies);
+    return valid;
+}
+
+// Free the titles held by a batch of client info
+void free_client_info(ClientInfo *info, int count) {
+    for (int i = 0; i < count; i++) {
+        free(info[i].title);
+        info[i].title = NULL;
+    }
+}
+
+// Fill the attribute fields the frame code uses from fetched client info
+void client_info_attributes(const ClientInfo *info, XWindowAttributes *attr) {
+    memset(attr, 0, sizeof(*attr));
+    attr->x = info->x;
+    attr->y = info->y;
+    attr->width = info->width;
+    attr->height = info->height;
+    attr->border_width = info->border_width;
+    attr->override_redirect = info->override_redirect;
+    attr->map_state = info->map_state;
+}
+
+// Whether a window was created on our own connection
+int is_own_window(Window win) {
+    const xcb_setup_t *setup = xcb_get_setup(conn);
+    return (win & ~(Window)setup->resource_id_mask) == setup->resource_id_base;
+}
+
+// Fetch the titles of a batch of windows in one round trip
+void fetch_window_titles(const Window *windows, int count, char **titles) {
+    if (count <= 0) {
+        return;
+    }
+
+    xcb_get_property_cookie_t *cookies =
+        (xcb_get_property_cookie_t *)malloc(2 * count * sizeof(xcb_get_property_cookie_t));
+    if (!cookies) {
+        memset(titles, 0, count * sizeof(char *));
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        cookies[2 * i] = request_title(windows[i], wm_atoms.net_wm_name, wm_atoms.utf8_string);
+        cookies[2 * i + 1] = request_title(windows[i], XCB_ATOM_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY);
+    }
+    xcb_flush(conn);
+
+    for (int i = 0; i < count; i++) {
+        titles[i] = collect_title(cookies[2 * i], cookies[2 * i + 1]);
+    }
+
+    free(cookies);
+}
+
+// List the root window's children, bottom to top
+Window *query_top_level_windows(Window root, int *count) {
+    *count = 0;
+
+    xcb_query_tree_reply_t *tree =
+        xcb_query_tree_reply(conn, xcb_query_tree(conn, (xcb_window_t)root), NULL);
+    if (!tree) {
+        return NULL;
+    }
+
+    int n = xcb_query_tree_children_length(tree);
+    Window *windows = n > 0 ? (Window *)malloc(n * sizeof(Window)) : NULL;
+    if (windows) {
+        xcb_window_t *children = xcb_query_tree_children(tree);
+        for (int i = 0; i < n; i++) {
+            windows[i] = children[i];
+        }
+        *count = n;
+    }
+
+    free(tree);
+    return windows;
+}
@@ -0,0 +1,67 @@
+/*
+ * xcb_backend.h - Pipelined XCB requests for the window manager
+ *
+ * Xlib owns the event queue, since the panel, menus and toolkit all
+ * consume XEvents, but everything that waits for a reply goes through
+ * the display's XCB connection: requests for many windows are sent
+ * together and their replies collected afterwards, so a batch costs a
+ * single round trip however many windows it covers.
+ */
+
+#ifndef XCB_BACKEND_H
+#define XCB_BACKEND_H
+
+#include <X11/Xlib.h>
+
+// Atoms the window manager uses, interned together at startup
+typedef struct {
+    Atom wm_protocols;
+    Atom wm_delete_window;
+    Atom wm_state;
+    Atom wm_name;
+    Atom net_wm_name;
+    Atom utf8_string;
+} WMAtoms;
+
+extern WMAtoms wm_atoms;
+
+// What we need to know about a client to manage it
+typedef struct {
+    Window window;
+    int valid;              // 0 if the window was gone by the time we asked
+    int x, y;
+    int width, height;
+    int border_width;
+    int override_redirect;
+    int map_state;          // IsUnmapped, IsUnviewable or IsViewable
+    int input_only;         // 1 for InputOnly windows, which have no contents
+    VisualID visual;
+    char *title;            // Allocated; NULL if the client has no title
+} ClientInfo;
+
+// Attach to the display's XCB connection and intern the WM's atoms
+// Returns 1 on success, 0 on failure
+int init_xcb_backend(Display *dpy);
+
+// Fetch attributes, geometry and title for a batch of windows in one round trip
+// Returns the number of windows that still exist
+int fetch_client_info(const Window *windows, int count, ClientInfo *info);
+
+// Free the titles held by a batch of client info
+void free_client_info(ClientInfo *info, int count);
+
+// Fill the attribute fields the frame code uses from fetched client info
+void client_info_attributes(const ClientInfo *info, XWindowAttributes *attr);
+
+// Whether a window was created on our own connection (panel, menus, frames)
+int is_own_window(Window win);
+
+// Fetch the titles of a batch of windows in one round trip
+// Each title is allocated, or NULL if that window has none
+void fetch_window_titles(const Window *windows, int count, char **titles);
+
+// List the root window's children, bottom to top
+// Returns an allocated list, or NULL if there are none
+Window *query_top_level_windows(Window root, int *count);
+
+#endif /* XCB_BACKEND_H */